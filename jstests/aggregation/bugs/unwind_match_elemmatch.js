@@ -0,0 +1,55 @@
+// A $match on fields of unwound array elements adds an $elemMatch before the $unwind, so
+// documents with no element that could match aren't unwound. The original $match must still
+// filter the unwound documents.
+var t = db.unwind_match_elemmatch;
+t.drop();
+
+t.insert({_id: 0, items: [{sku: 1, qty: 5}, {sku: 2, qty: 1}]});
+t.insert({_id: 1, items: [{sku: 2, qty: 7}]});
+t.insert({_id: 2, items: [{sku: 3, qty: 9}, 2]});
+t.insert({_id: 3, items: []});
+// unwinding gives an array, whose elements "items.sku" then looks at
+t.insert({_id: 4, items: [[{sku: 2}], {sku: 4}]});
+t.ensureIndex({"items.sku": 1});
+
+function check(pipeline, expected) {
+    var res = t.aggregate(pipeline).toArray();
+    res.sort(function(a, b) { return a._id - b._id || (tojson(a) < tojson(b) ? -1 : 1); });
+    assert.eq(expected, res, tojson(pipeline));
+}
+
+var pipeline = [{$unwind: "$items"}, {$match: {"items.sku": 2}}];
+check(pipeline, [{_id: 0, items: {sku: 2, qty: 1}},
+                 {_id: 1, items: {sku: 2, qty: 7}},
+                 {_id: 4, items: [{sku: 2}]}]);
+
+var explained = t.runCommand("aggregate", {pipeline: pipeline, explain: true});
+assert.commandWorked(explained);
+var cursorStage = explained.stages[0].$cursor;
+assert.eq({$or: [{items: {$elemMatch: {sku: 2}}}, {items: {$elemMatch: {$type: 4}}}]},
+          cursorStage.query, tojson(explained));
+assert.eq({$unwind: "$items"}, explained.stages[1], tojson(explained));
+assert.eq({$match: {"items.sku": 2}}, explained.stages[2], tojson(explained));
+
+// conditions on different elements must not be combined into one $elemMatch incorrectly
+check([{$unwind: "$items"}, {$match: {"items.sku": 1, "items.qty": 1}}], []);
+check([{$unwind: "$items"}, {$match: {"items.sku": {$gte: 2}, "items.qty": {$gt: 5}}}],
+      [{_id: 1, items: {sku: 2, qty: 7}},
+       {_id: 2, items: {sku: 3, qty: 9}}]);
+
+// the same for the elements of a nested array, which needn't be the same element either
+t.insert({_id: 5, items: [[{sku: 7}, {qty: 8}]]});
+check([{$unwind: "$items"}, {$match: {"items.sku": 7, "items.qty": 8}}],
+      [{_id: 5, items: [{sku: 7}, {qty: 8}]}]);
+
+// conditions that could match missing fields aren't pushed down
+check([{$unwind: "$items"}, {$match: {"items.sku": {$exists: false}}}],
+      [{_id: 2, items: 2}]);
+check([{$unwind: "$items"}, {$match: {"items.sku": {$ne: 1}}}],
+      [{_id: 0, items: {sku: 2, qty: 1}},
+       {_id: 1, items: {sku: 2, qty: 7}},
+       {_id: 2, items: 2},
+       {_id: 2, items: {sku: 3, qty: 9}},
+       {_id: 4, items: [{sku: 2}]},
+       {_id: 4, items: {sku: 4}},
+       {_id: 5, items: [{sku: 7}, {qty: 8}]}]);
@@ -0,0 +1,66 @@
+//
+// Runs of documents in an insert batch go to the collection as groups.  A failure inside a group
+// must be reported against the right document, and leave the collection and its indexes as
+// inserting the documents one at a time would have.
+//
+
+var coll = db.getCollection( "batch_write_insert_group" );
+coll.drop();
+coll.ensureIndex( { a: 1 } );
+coll.ensureIndex( { b: 1 }, { unique: true } );
+coll.ensureIndex( { arr: 1 } );
+
+var result;
+
+function makeDocs( start, n ) {
+    var docs = [];
+    for ( var i = start; i < start + n; i++ ) {
+        docs.push( { _id: i, a: i % 7, b: i, arr: [ i, i + 1 ] } );
+    }
+    return docs;
+}
+
+//
+// A large batch succeeds whole
+result = coll.runCommand( { insert: coll.getName(), documents: makeDocs( 0, 500 ) } );
+printjson( result );
+assert( result.ok );
+assert.eq( 500, result.n );
+assert.eq( 500, coll.count() );
+assert.eq( 71, coll.find( { a: 3 } ).hint( { a: 1 } ).itcount() );
+assert.eq( 2, coll.find( { arr: 101 } ).hint( { arr: 1 } ).itcount() );
+
+//
+// Ordered: stops at the duplicate in the middle of a group
+var docs = makeDocs( 1000, 100 );
+docs[ 40 ].b = 3; // duplicate in the unique index
+result = coll.runCommand( { insert: coll.getName(), documents: docs, ordered: true } );
+printjson( result );
+assert( result.ok );
+assert.eq( 40, result.n );
+assert.eq( 1, result.writeErrors.length );
+assert.eq( 40, result.writeErrors[ 0 ].index );
+assert.eq( 540, coll.count() );
+assert.eq( 0, coll.find( { _id: { $gte: 1040 } } ).itcount() );
+
+//
+// Unordered: only the duplicates are left out
+coll.remove( { _id: { $gte: 1000 } } );
+docs = makeDocs( 1000, 100 );
+docs[ 10 ].b = 5;
+docs[ 70 ]._id = 20; // duplicate _id
+result = coll.runCommand( { insert: coll.getName(), documents: docs, ordered: false } );
+printjson( result );
+assert( result.ok );
+assert.eq( 98, result.n );
+assert.eq( 2, result.writeErrors.length );
+assert.eq( 10, result.writeErrors[ 0 ].index );
+assert.eq( 70, result.writeErrors[ 1 ].index );
+assert.eq( 598, coll.count() );
+assert.eq( 598, coll.find().hint( { b: 1 } ).itcount() );
+assert.eq( 598, coll.find().hint( { a: 1 } ).itcount() );
+assert.eq( 1, coll.find( { arr: 1071 } ).hint( { arr: 1 } ).itcount() ); // only _id 1071
+
+assert( coll.validate( true ).valid );
+
+coll.drop();
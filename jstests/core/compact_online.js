@@ -0,0 +1,62 @@
+// Online compact moves documents out of the last extents in small batches and frees them,
+// keeping indexes and padding intact.
+
+var t = db.jstests_compact_online;
+t.drop();
+db.createCollection( t.getName(), { size: 64 * 1024 } );
+t.ensureIndex( { x: 1 } );
+
+var str = new Array( 200 ).join( "x" );
+var N = 20000;
+for ( var i = 0; i < N; i++ ) {
+    t.insert( { _id: i, x: i % 50, s: str } );
+}
+assert.eq( null, db.getLastError() );
+
+// leave most of the collection free, spread across all of its extents
+t.remove( { _id: { $mod: [ 4, 0 ] } } );
+t.remove( { _id: { $mod: [ 4, 1 ] } } );
+t.remove( { _id: { $mod: [ 4, 2 ] } } );
+assert.eq( null, db.getLastError() );
+var remaining = N / 4;
+assert.eq( remaining, t.count() );
+
+var before = t.stats();
+printjson( before );
+
+assert.commandFailed( db.runCommand( { compact: t.getName(), online: true, batchSize: 0 } ) );
+assert.commandFailed( db.runCommand( { compact: t.getName(), online: true, paddingFactor: 1.5 } ) );
+
+var res = db.runCommand( { compact: t.getName(), online: true, batchSize: 100 } );
+printjson( res );
+assert.commandWorked( res );
+assert.lt( 0, res.recordsMoved, tojson( res ) );
+assert.lt( 0, res.extentsFreed, tojson( res ) );
+assert.lt( 1, res.batches, tojson( res ) );
+
+var after = t.stats();
+printjson( after );
+assert.eq( before.numExtents - res.extentsFreed, after.numExtents );
+assert.gt( before.storageSize, after.storageSize );
+assert.eq( before.paddingFactor, after.paddingFactor );
+
+// every document is still there, and still reachable through the indexes
+assert.eq( remaining, t.count() );
+assert.eq( remaining, t.find().itcount() );
+assert.eq( N / 100, t.find( { x: 3 } ).hint( { x: 1 } ).itcount() );
+assert.eq( 1, t.find( { _id: 4003 } ).hint( { _id: 1 } ).itcount() );
+assert( t.validate( true ).valid );
+
+// the collection keeps working afterwards
+t.insert( { _id: "new", x: 3 } );
+assert.eq( null, db.getLastError() );
+assert.eq( remaining + 1, t.count() );
+
+// capped collections are refused
+var c = db.jstests_compact_online_capped;
+c.drop();
+db.createCollection( c.getName(), { capped: true, size: 4096 } );
+assert.commandFailed( db.runCommand( { compact: c.getName(), online: true } ) );
+
+t.drop();
+c.drop();
@@ -0,0 +1,54 @@
+// Tests that space freed by removes is found again by size and that collStats reports the
+// collection's deleted records.
+
+var t = db.jstests_deleted_records_stats;
+t.drop();
+db.createCollection( t.getName(), { usePowerOf2Sizes: false } );
+
+// records of many different sizes
+var n = 2000;
+for ( var i = 0; i < n; i++ ) {
+    t.insert( { _id: i, s: new Array( 100 + ( i % 50 ) * 40 ).join( "x" ) } );
+}
+assert.eq( null, db.getLastError() );
+
+var stats = t.stats();
+printjson( stats.deletedRecords );
+assert( stats.deletedRecords, tojson( stats ) );
+assert( stats.deletedRecords.indexed, tojson( stats ) );
+assert.gte( stats.deletedRecords.fragmentation, 0 );
+assert.lte( stats.deletedRecords.fragmentation, 1 );
+
+// free every other record, then insert the same sizes again: they fit in the holes
+t.remove( { _id: { $mod: [ 2, 0 ] } } );
+assert.eq( null, db.getLastError() );
+var holes = t.stats();
+printjson( holes.deletedRecords );
+assert.gte( holes.deletedRecords.count, n / 2 );
+assert.gt( holes.deletedRecords.size, stats.deletedRecords.size );
+
+for ( var i = 0; i < n; i += 2 ) {
+    t.insert( { _id: i, s: new Array( 100 + ( i % 50 ) * 40 ).join( "x" ) } );
+}
+assert.eq( null, db.getLastError() );
+
+var refilled = t.stats();
+printjson( refilled.deletedRecords );
+assert.eq( n, t.count() );
+assert.eq( holes.storageSize, refilled.storageSize, "reinserts should reuse the freed space" );
+assert.lt( refilled.deletedRecords.size, holes.deletedRecords.size );
+
+// the free list is consistent with the collection afterwards
+assert( t.validate( true ).valid );
+
+// scale applies to the sizes
+var scaled = t.stats( 1024 ).deletedRecords;
+assert.eq( Math.floor( refilled.deletedRecords.size / 1024 ), scaled.size );
+
+// capped collections don't report them
+db.jstests_deleted_records_stats_capped.drop();
+db.createCollection( "jstests_deleted_records_stats_capped", { capped: true, size: 4096 } );
+assert.eq( undefined, db.jstests_deleted_records_stats_capped.stats().deletedRecords );
+db.jstests_deleted_records_stats_capped.drop();
+
+t.drop();
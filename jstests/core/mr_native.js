@@ -0,0 +1,94 @@
+// Tests mapReduce with aggregation expressions in place of javascript map, reduce and finalize.
+
+t = db.mr_native;
+t.drop();
+
+outName = "mr_native_out";
+out = db[outName];
+out.drop();
+
+for ( var i = 0; i < 100; i++ ) {
+    t.insert( { _id : i , cust : "c" + ( i % 5 ) , qty : i } );
+}
+
+function run( extra ) {
+    var cmd = { mapreduce : t.getName() ,
+                map : { key : "$cust" , value : { total : "$qty" , n : { $literal : 1 } ,
+                                                  avg : "$qty" , maxQty : "$qty" } } ,
+                reduce : { total : "$sum" , n : "$sum" , avg : "$avg" , maxQty : "$max" } };
+    Object.extend( cmd , extra );
+    var res = db.runCommand( cmd );
+    assert.commandWorked( res );
+    return res;
+}
+
+function check( results ) {
+    assert.eq( 5 , results.length , tojson( results ) );
+    results.forEach( function( doc ) {
+        var c = parseInt( doc._id.substring( 1 ) );
+        var total = 0;
+        for ( var i = c; i < 100; i += 5 )
+            total += i;
+        assert.eq( total , doc.value.total , tojson( doc ) );
+        assert.eq( 20 , doc.value.n , tojson( doc ) );
+        assert.eq( total / 20 , doc.value.avg , tojson( doc ) );
+        assert.eq( 95 + c , doc.value.maxQty , tojson( doc ) );
+    } );
+}
+
+// inline
+res = run( { out : { inline : 1 } } );
+check( res.results );
+assert.eq( 100 , res.counts.input , "A" );
+assert.eq( 100 , res.counts.emit , "B" );
+
+// to a collection
+res = run( { out : outName } );
+check( out.find().toArray() );
+
+// with a query
+res = run( { out : { inline : 1 } , query : { qty : { $lt : 50 } } } );
+assert.eq( 50 , res.counts.input , "C" );
+
+// finalize
+res = run( { out : { inline : 1 } ,
+             finalize : { total : "$value.total" , double : { $multiply : [ "$value.n" , 2 ] } } } );
+assert.eq( 5 , res.results.length , "D" );
+res.results.forEach( function( doc ) {
+    assert.eq( 40 , doc.value.double , tojson( doc ) );
+    assert.eq( undefined , doc.value.avg , tojson( doc ) );
+} );
+
+// reduce output merges with the existing results
+out.drop();
+cmd = { mapreduce : t.getName() ,
+        map : { key : "$cust" , value : { total : "$qty" } } ,
+        reduce : { total : "$sum" } ,
+        out : { reduce : outName } };
+assert.commandWorked( db.runCommand( cmd ) );
+assert.commandWorked( db.runCommand( cmd ) );
+assert.eq( 2 * ( 0 + 5 + 10 + 15 + 20 + 25 + 30 + 35 + 40 + 45 + 50 + 55 + 60 + 65 + 70 + 75 +
+                 80 + 85 + 90 + 95 ) ,
+           out.findOne( { _id : "c0" } ).value.total , "E" );
+
+// $avg can't be merged into existing output
+assert.commandFailed( db.runCommand( { mapreduce : t.getName() ,
+                                       map : { key : "$cust" , value : { a : "$qty" } } ,
+                                       reduce : { a : "$avg" } ,
+                                       out : { reduce : outName } } ) , "F" );
+
+// bad specs
+assert.commandFailed( db.runCommand( { mapreduce : t.getName() ,
+                                       map : { key : "$cust" , value : { a : "$qty" } } ,
+                                       reduce : function( k , vs ) { return Array.sum( vs ); } ,
+                                       out : { inline : 1 } } ) , "G" );
+assert.commandFailed( db.runCommand( { mapreduce : t.getName() ,
+                                       map : { key : "$cust" , value : { a : "$qty" } } ,
+                                       reduce : { a : "$bogus" } ,
+                                       out : { inline : 1 } } ) , "H" );
+assert.commandFailed( db.runCommand( { mapreduce : t.getName() ,
+                                       map : { key : "$cust" } ,
+                                       reduce : { a : "$sum" } ,
+                                       out : { inline : 1 } } ) , "I" );
+
+out.drop();
@@ -0,0 +1,75 @@
+// Compares split points that splitVector estimates from the upper levels of the index
+// ({sampled: true}) against the ones from walking every key.
+
+var f = db.jstests_splitvector_sampled;
+f.drop();
+f.ensureIndex( { x: 1 } );
+
+var numDocs = 100000;
+var docs = [];
+for ( var i = 0; i < numDocs; i++ ) {
+    docs.push( { x: i, y: "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa" } );
+    if ( docs.length == 1000 ) {
+        f.insert( docs );
+        docs = [];
+    }
+}
+assert.eq( numDocs, f.count() );
+
+var cmd = { splitVector: f.getFullName(), keyPattern: { x: 1 }, maxChunkSize: 1 };
+var exact = db.runCommand( cmd );
+assert.commandWorked( exact );
+assert( !exact.sampled, tojson( exact ) );
+
+cmd.sampled = true;
+var sampled = db.runCommand( cmd );
+assert.commandWorked( sampled );
+assert( sampled.sampled, tojson( sampled ) );
+print( "splitVector exact: " + exact.timeMillis + "ms, sampled: " + sampled.timeMillis + "ms" );
+
+// about as many split points as the exact walk, each about as far from the previous one
+assert.close( exact.splitKeys.length, sampled.splitKeys.length, "number of split keys", -1 );
+
+var perChunk = f.find( { x: { $lt: exact.splitKeys[0].x } } ).count();
+var prev = MinKey;
+for ( var i = 0; i < sampled.splitKeys.length; i++ ) {
+    var key = sampled.splitKeys[i];
+    assert.eq( [ "x" ], Object.keySet( key ) );
+    var n = f.find( { x: { $gte: prev, $lt: key.x } } ).count();
+    assert.lt( perChunk * 0.5, n, tojson( sampled.splitKeys ) );
+    assert.gt( perChunk * 1.5, n, tojson( sampled.splitKeys ) );
+    prev = key.x;
+}
+
+// maxSplitPoints is honoured
+cmd.maxSplitPoints = 2;
+sampled = db.runCommand( cmd );
+assert.commandWorked( sampled );
+assert.eq( 2, sampled.splitKeys.length, tojson( sampled ) );
+delete cmd.maxSplitPoints;
+
+// sub-ranges, including ones that start and end in the middle of leaf buckets
+cmd.min = { x: 12345 };
+cmd.max = { x: 67890 };
+sampled = db.runCommand( cmd );
+assert.commandWorked( sampled );
+assert.lt( 0, sampled.splitKeys.length );
+sampled.splitKeys.forEach( function( key ) {
+    assert.lt( 12345, key.x );
+    assert.gt( 67890, key.x );
+} );
+
+// a range smaller than a chunk has no split points
+cmd.max = { x: 12400 };
+sampled = db.runCommand( cmd );
+assert.commandWorked( sampled );
+assert.eq( [], sampled.splitKeys );
+
+// 'force' still finds the median by walking the range
+cmd.force = true;
+sampled = db.runCommand( cmd );
+assert.commandWorked( sampled );
+assert( !sampled.sampled, tojson( sampled ) );
+assert.eq( 1, sampled.splitKeys.length );
+
+f.drop();
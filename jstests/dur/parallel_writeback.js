@@ -0,0 +1,51 @@
+// Tests that group commits copied back to the data files by several writeback threads leave the
+// data files complete, and that the commit phases are reported in serverStatus().dur
+
+var path = MongoRunner.dataPath + "/parallel_writeback";
+var conn = startMongodEmpty("--port", 30001, "--dbpath", path, "--dur", "--smallfiles",
+                            "--setParameter", "journalWritebackThreads=4");
+
+// write to several databases and data files so each commit touches more than one file
+var big = new Array(4 * 1024).join("x");
+var dbs = ["wb1", "wb2", "wb3"];
+for (var i = 0; i < 3000; i++) {
+    var d = conn.getDB(dbs[i % dbs.length]);
+    d.foo.insert({ _id: i, s: big });
+    d.bar.update({ _id: i % 10 }, { $inc: { n: 1 } }, true);
+}
+dbs.forEach(function(name) {
+    assert.eq(null, conn.getDB(name).getLastError(1, 0, true));
+});
+
+// the dur section reports the previous interval, so wait for one with commits in it
+var dur;
+assert.soon(function() {
+    var d = conn.getDB(dbs[0]);
+    d.bar.update({ _id: 0 }, { $inc: { n: 0 } });
+    d.getLastError(1, 0, true);
+    dur = d.serverStatus().dur;
+    return dur.writeIntents > 0;
+}, "no write intents reported", 60 * 1000, 100);
+printjson(dur);
+assert.gte(dur.timeMs.mergeIntents, 0, tojson(dur));
+assert.gte(dur.timeMs.prepBasicWrites, 0, tojson(dur));
+assert.lte(dur.timeMs.mergeIntents + dur.timeMs.prepBasicWrites,
+           dur.timeMs.prepLogBuffer + 2, tojson(dur));
+
+// a clean shutdown removes the journal, so everything must have reached the data files
+stopMongod(30001);
+conn = startMongodNoReset("--port", 30001, "--dbpath", path, "--dur", "--smallfiles");
+
+dbs.forEach(function(name) {
+    var d = conn.getDB(name);
+    assert.eq(1000, d.foo.count(), name);
+    assert.eq(10, d.bar.count(), name);
+    assert(d.foo.validate(true).valid, name);
+});
+var total = 0;
+dbs.forEach(function(name) {
+    conn.getDB(name).bar.find().forEach(function(doc) { total += doc.n; });
+});
+assert.eq(3000, total);
+
+stopMongod(30001);
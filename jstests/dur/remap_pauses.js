@@ -0,0 +1,46 @@
+// Tests that the private views are remapped in bounded pieces and that the pause times are
+// reported in serverStatus().dur
+
+var path = MongoRunner.dataPath + "/remap_pauses";
+var conn = startMongodEmpty("--port", 30001, "--dbpath", path, "--dur", "--smallfiles",
+                            "--setParameter", "journalRemapMaxMBPerPause=16");
+var d = conn.getDB("test");
+
+// write to several data files so there is something to remap
+var big = new Array(16 * 1024).join("x");
+for (var i = 0; i < 4000; i++) {
+    d.foo.insert({ _id: i, s: big });
+}
+assert.eq(null, d.getLastError());
+
+// the dur section reports the previous interval, so wait for one with remaps in it
+var dur;
+assert.soon(function() {
+    d.foo.update({ _id: Random.randInt(4000) }, { $set: { t: new Date() } });
+    d.getLastError(1, 0, true);
+    dur = d.serverStatus().dur;
+    return dur.remapPrivateViewPauses && dur.remapPrivateViewPauses.remappedMB > 0;
+}, "no remaps reported", 60 * 1000, 100);
+printjson(dur);
+
+var pauses = dur.remapPrivateViewPauses;
+var n = 0;
+for (var bucket in pauses) {
+    if (bucket != "maxMs" && bucket != "remappedMB")
+        n += pauses[bucket];
+}
+assert.gt(n, 0, tojson(pauses));
+assert.gte(pauses.maxMs, 0, tojson(pauses));
+
+// each pause stays within journalRemapMaxMBPerPause, give or take the one 16MB region a pass can
+// run over by, unless the write rate forced a faster remap
+var capMB = (16 + 16) * 1024 * 1024 / 1000000;
+assert.gt(pauses.maxMB, 0, tojson(pauses));
+assert.lte(pauses.maxMB, pauses.remappedMB, tojson(pauses));
+if (pauses.overMaxMBPerPause == 0)
+    assert.lte(pauses.maxMB, capMB, tojson(pauses));
+
+assert.commandWorked(d.adminCommand({ setParameter: 1, journalRemapMaxMBPerPause: 64 }));
+assert.eq(4000, d.foo.count());
+
+stopMongod(30001);
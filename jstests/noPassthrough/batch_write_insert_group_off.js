@@ -0,0 +1,40 @@
+//
+// An insert batch gives the same results with grouping turned off (insertGroupMaxDocs: 1) as with
+// documents inserted in groups.
+//
+
+var path = MongoRunner.dataPath + "/batch_write_insert_group_off";
+var conn = startMongodEmpty( "--port", 30001, "--dbpath", path, "--smallfiles" );
+var db = conn.getDB( "test" );
+
+var coll = db.getCollection( "batch_write_insert_group_off" );
+coll.ensureIndex( { a: 1 } );
+coll.ensureIndex( { b: 1 }, { unique: true } );
+
+var docs = [];
+for ( var i = 0; i < 100; i++ ) {
+    docs.push( { _id: i, a: i % 7, b: i } );
+}
+docs[ 10 ].b = 5; // duplicate in the unique index
+docs[ 70 ]._id = 20; // duplicate _id
+
+function insertUnordered( maxDocs ) {
+    assert.commandWorked( db.adminCommand( { setParameter: 1, insertGroupMaxDocs: maxDocs } ) );
+    coll.remove( {} );
+    var result = coll.runCommand( { insert: coll.getName(), documents: docs, ordered: false } );
+    printjson( result );
+    assert( result.ok );
+    assert.eq( 98, result.n );
+    assert.eq( 2, result.writeErrors.length );
+    assert.eq( 10, result.writeErrors[ 0 ].index );
+    assert.eq( 70, result.writeErrors[ 1 ].index );
+    assert.eq( 98, coll.count() );
+    assert.eq( 98, coll.find().hint( { b: 1 } ).itcount() );
+    assert.eq( 98, coll.find().hint( { a: 1 } ).itcount() );
+    assert( coll.validate( true ).valid );
+}
+
+insertUnordered( 64 );
+insertUnordered( 1 );
+
+stopMongod( 30001 );
@@ -0,0 +1,57 @@
+// Tests that a getMore on a tailable awaitData cursor over a capped collection returns as soon
+// as a document is inserted, and otherwise waits for awaitDataMaxWaitMillis
+
+var path = MongoRunner.dataPath + "/capped_await_data";
+var conn = startMongodEmpty("--port", 30001, "--dbpath", path, "--smallfiles",
+                            "--setParameter", "awaitDataMaxWaitMillis=1500");
+db = conn.getDB("test");
+
+var t = db.capped_await_data;
+t.drop();
+assert.commandWorked( db.createCollection( t.getName(), { capped: true, size: 4096 } ) );
+t.insert( { _id: 0 } );
+
+var tail = function() {
+    var cursor = t.find().addOption( DBQuery.Option.tailable )
+                         .addOption( DBQuery.Option.awaitData );
+    assert.eq( 0, cursor.next()._id );
+    return cursor;
+};
+
+// nothing new: the getMore waits out the max wait and comes back empty
+var cursor = tail();
+var start = new Date();
+assert( !cursor.hasNext() );
+var elapsed = new Date() - start;
+printjson( { emptyGetMoreMillis: elapsed } );
+assert.gte( elapsed, 1000 );
+assert.lt( elapsed, 10000 );
+
+// an insert from another connection wakes the waiting getMore up well before the max wait
+assert.commandWorked( db.adminCommand( { setParameter: 1, awaitDataMaxWaitMillis: 30000 } ) );
+cursor = tail();
+var join = startParallelShell( "sleep( 500 ); db.capped_await_data.insert( { _id: 1 } );", 30001 );
+start = new Date();
+assert( cursor.hasNext() );
+elapsed = new Date() - start;
+printjson( { wokenGetMoreMillis: elapsed } );
+assert.eq( 1, cursor.next()._id );
+assert.lt( elapsed, 20000 );
+join();
+
+// dropping the collection doesn't leave the getMore waiting for inserts that never come
+cursor = tail();
+join = startParallelShell( "sleep( 500 ); db.capped_await_data.drop();", 30001 );
+start = new Date();
+try {
+    cursor.hasNext();
+}
+catch ( e ) {
+    print( "getMore after drop: " + e );
+}
+elapsed = new Date() - start;
+printjson( { droppedGetMoreMillis: elapsed } );
+assert.lt( elapsed, 20000 );
+join();
+
+stopMongod(30001);
@@ -0,0 +1,55 @@
+// Online compact stops, leaving the document where it was and still indexed, when a document it
+// moves cannot be indexed at its new location.  Here that is a key too long for the index,
+// inserted while failIndexKeyTooLong was off.
+
+var path = MongoRunner.dataPath + "/compact_online_index_failure";
+var conn = startMongodEmpty("--port", 30001, "--dbpath", path, "--smallfiles",
+                            "--setParameter", "failIndexKeyTooLong=false");
+var db = conn.getDB("test");
+var t = db.compact_online_index_failure;
+
+db.createCollection(t.getName(), { size: 64 * 1024 });
+t.ensureIndex({ k: 1 });
+
+var str = new Array(200).join("x");
+var N = 8000;
+for (var i = 0; i < N; i++) {
+    t.insert({ _id: i, k: i % 50, s: str });
+}
+// last in the last extent, and without an entry in { k: 1 }
+var longKey = new Array(2000).join("k");
+t.insert({ _id: N, k: longKey, s: str });
+assert.eq(null, db.getLastError());
+
+t.remove({ _id: { $mod: [ 4, 0 ] } });
+t.remove({ _id: { $mod: [ 4, 1 ] } });
+t.remove({ _id: { $mod: [ 4, 2 ] } });
+assert.eq(null, db.getLastError());
+var remaining = N / 4 + 1;
+assert.eq(remaining, t.count());
+
+assert.commandWorked(db.adminCommand({ setParameter: 1, failIndexKeyTooLong: true }));
+
+var res = db.runCommand({ compact: t.getName(), online: true, batchSize: 10 });
+printjson(res);
+assert.commandWorked(res);
+assert(/could not index document/.test(res.note), tojson(res));
+
+// nothing is lost from the collection or its indexes
+assert.eq(remaining, t.count());
+assert.eq(remaining, t.find().hint({ _id: 1 }).itcount());
+assert.eq(remaining - 1, t.find().hint({ k: 1 }).itcount());
+assert.eq(1, t.find({ _id: N }).hint({ _id: 1 }).itcount());
+assert(t.validate(true).valid);
+
+// once the key is allowed to be left out again, compact gets past the document
+assert.commandWorked(db.adminCommand({ setParameter: 1, failIndexKeyTooLong: false }));
+res = db.runCommand({ compact: t.getName(), online: true, batchSize: 10 });
+printjson(res);
+assert.commandWorked(res);
+assert(!/could not index document/.test(res.note), tojson(res));
+assert.eq(remaining, t.find().hint({ _id: 1 }).itcount());
+assert.eq(remaining - 1, t.find().hint({ k: 1 }).itcount());
+assert(t.validate(true).valid);
+
+stopMongod(30001);
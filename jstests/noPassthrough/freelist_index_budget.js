@@ -0,0 +1,47 @@
+// Tests that the deleted records of all collections together are indexed up to
+// freelistIndexMaxTotalRecords, and that collStats doesn't report totals it would have to walk
+// the deleted lists for
+
+var path = MongoRunner.dataPath + "/freelist_index_budget";
+var conn = startMongodEmpty("--port", 30001, "--dbpath", path, "--smallfiles",
+                            "--setParameter", "freelistIndexMaxTotalRecords=500");
+db = conn.getDB("test");
+
+/** inserts n records of many sizes and removes every other one */
+function makeHoles( t, n ) {
+    assert.commandWorked( db.createCollection( t.getName(), { usePowerOf2Sizes: false } ) );
+    for ( var i = 0; i < n; i++ ) {
+        t.insert( { _id: i, s: new Array( 100 + ( i % 50 ) * 40 ).join( "x" ) } );
+    }
+    t.remove( { _id: { $mod: [ 2, 0 ] } } );
+    assert.eq( null, db.getLastError() );
+}
+
+// more deleted records than the whole budget: the collection goes unindexed, and collStats
+// only says so
+var big = db.freelist_index_budget_big;
+makeHoles( big, 2000 );
+var stats = big.stats().deletedRecords;
+printjson( stats );
+assert.eq( false, stats.indexed, tojson( stats ) );
+assert.eq( undefined, stats.count, tojson( stats ) );
+assert.eq( undefined, stats.size, tojson( stats ) );
+
+// the big collection gave its share back, so a small one still fits
+var small = db.freelist_index_budget_small;
+makeHoles( small, 200 );
+stats = small.stats().deletedRecords;
+printjson( stats );
+assert.eq( true, stats.indexed, tojson( stats ) );
+assert.gte( stats.count, 100, tojson( stats ) );
+
+// both still allocate from their free space
+for ( var i = 0; i < 200; i += 2 ) {
+    big.insert( { _id: i, s: new Array( 100 + ( i % 50 ) * 40 ).join( "x" ) } );
+    small.insert( { _id: i, s: new Array( 100 + ( i % 50 ) * 40 ).join( "x" ) } );
+}
+assert.eq( null, db.getLastError() );
+assert( big.validate( true ).valid );
+assert( small.validate( true ).valid );
+
+stopMongod(30001);
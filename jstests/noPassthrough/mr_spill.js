@@ -0,0 +1,54 @@
+// Tests mapReduce output when the intermediate results are too large for the final reduce's
+// sorter memory and get spilled to disk in sorted runs, which are then merged and reduced.
+
+var path = MongoRunner.dataPath + "/mr_spill";
+var conn = startMongodEmpty("--port", 30001, "--dbpath", path, "--smallfiles",
+                            "--setParameter", "internalMapReduceSorterMaxMemoryBytes=65536");
+var db = conn.getDB("test");
+
+t = db.mr_spill;
+t.drop();
+
+outName = "mr_spill_out";
+out = db[outName];
+out.drop();
+
+var nKeys = 20000;
+var padding = new Array( 100 ).join( "x" );
+for ( var i = 0; i < 3 * nKeys; i++ ) {
+    t.insert( { k : i % nKeys , padding : padding } );
+}
+assert.eq( null , db.getLastError() );
+
+m = function() { emit( this.k , { n : 1 , padding : this.padding } ); }
+r = function( k , vs ) {
+    var n = 0;
+    vs.forEach( function( v ) { n += v.n; } );
+    return { n : n , padding : vs[0].padding };
+}
+
+res = t.mapReduce( m , r , { out : outName , verbose : true } );
+printjson( res );
+assert.commandWorked( res );
+assert.gt( res.timing.spillFiles , 1 , "the sorter should have written several runs" );
+assert.eq( 3 * nKeys , res.counts.emit , "A" );
+assert.eq( nKeys , res.counts.output , "B" );
+assert.eq( nKeys , out.count() , "C" );
+assert.eq( 0 , out.find( { "value.n" : { $ne : 3 } } ).itcount() , "D" );
+assert.eq( padding , out.findOne( { _id : nKeys - 1 } ).value.padding , "E" );
+
+// the intermediate results must not have been written to a collection
+db.getCollectionNames().forEach( function( name ) {
+    assert( !/^tmp\.mr\..*_inc$/.test( name ) , name );
+} );
+
+// with the default threshold the same job stays in memory
+assert.commandWorked( db.adminCommand( { setParameter : 1 ,
+                                         internalMapReduceSorterMaxMemoryBytes : 100 * 1024 * 1024 } ) );
+res = t.mapReduce( m , r , { out : outName , verbose : true } );
+assert.commandWorked( res );
+assert.eq( 0 , res.timing.spillFiles , "F" );
+assert.eq( nKeys , out.count() , "G" );
+assert.eq( 0 , out.find( { "value.n" : { $ne : 3 } } ).itcount() , "H" );
+
+stopMongod(30001);
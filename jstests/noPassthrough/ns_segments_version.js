@@ -0,0 +1,30 @@
+// Once the .ns file overflows into <db>.ns.N segments, data file 0 is flagged so that versions
+// which only read the .ns file refuse to open the database.
+
+var NS_SEGMENTS = 1 << 5;
+
+var path = MongoRunner.dataPath + "/ns_segments_version";
+var conn = startMongodEmpty("--port", 30001, "--dbpath", path, "--smallfiles", "--nssize", "1");
+var db = conn.getDB("test");
+
+db.createCollection("c0");
+assert.eq(0, db.stats().dataFileVersion.minor & NS_SEGMENTS);
+
+// each collection takes two namespaces, itself and its _id index
+for (var i = 1; i < 1000; i++) {
+    db.createCollection("c" + i);
+}
+assert.eq(null, db.getLastError());
+assert.gt(db.stats().nsSizeMB, 1);
+assert.eq(NS_SEGMENTS, db.stats().dataFileVersion.minor & NS_SEGMENTS);
+
+stopMongod(30001);
+
+// still flagged, and everything is there, after a restart
+conn = startMongoProgram("mongod", "--port", 30001, "--dbpath", path, "--smallfiles",
+                         "--nssize", "1");
+db = conn.getDB("test");
+assert.eq(NS_SEGMENTS, db.stats().dataFileVersion.minor & NS_SEGMENTS);
+assert.eq(1000, db.getCollectionNames().filter(function(n) { return /^c\d+$/.test(n); }).length);
+
+stopMongod(30001);
@@ -0,0 +1,45 @@
+// Tests that mongod persists a snapshot of its working set and reads it back in after a restart,
+// reporting both in serverStatus().workingSetSnapshot
+
+var path = MongoRunner.dataPath + "/working_set_snapshot";
+var conn = startMongodEmpty("--port", 30001, "--dbpath", path, "--smallfiles",
+                            "--setParameter", "workingSetSnapshotIntervalSecs=1");
+var d = conn.getDB("test");
+
+var status = d.serverStatus().workingSetSnapshot;
+printjson(status);
+assert.eq("none", status.warmup.state, tojson(status));
+
+var big = new Array(4 * 1024).join("x");
+for (var i = 0; i < 2000; i++) {
+    d.foo.insert({ _id: i, s: big });
+}
+assert.eq(null, d.getLastError());
+
+assert.soon(function() {
+    d.foo.find().itcount();
+    status = d.serverStatus().workingSetSnapshot;
+    return status.lastSnapshot.pages > 0;
+}, "no working set snapshot written", 60 * 1000, 500);
+printjson(status);
+assert.lte(status.lastSnapshot.ranges, status.lastSnapshot.pages, tojson(status));
+assert(status.lastSnapshot.time, tojson(status));
+
+// 0 turns the snapshots off
+assert.commandWorked(d.adminCommand({ setParameter: 1, workingSetSnapshotIntervalSecs: 0 }));
+stopMongod(30001);
+
+conn = startMongodNoReset("--port", 30001, "--dbpath", path, "--smallfiles",
+                          "--setParameter", "workingSetWarmupThreads=2");
+d = conn.getDB("test");
+assert.soon(function() {
+    status = d.serverStatus().workingSetSnapshot;
+    return status.warmup.state == "done";
+}, "warm-up never finished", 60 * 1000, 100);
+printjson(status);
+assert.gt(status.warmup.bytesTotal, 0, tojson(status));
+assert.eq(status.warmup.bytesTotal, status.warmup.bytesRead, tojson(status));
+assert.eq(0, status.warmup.filesMissing, tojson(status));
+assert.eq(2000, d.foo.count());
+
+stopMongod(30001);
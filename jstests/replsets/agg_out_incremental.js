@@ -0,0 +1,135 @@
+// test $out with mode "incremental", which folds newly inserted documents into earlier results
+var name = "agg_out_incremental";
+var replTest = new ReplSetTest( {name: name, nodes: 1} );
+replTest.startSet();
+replTest.initiate();
+
+var db = replTest.getMaster().getDB(name);
+var refreshState = db.getSiblingDB("local").aggregate.refresh;
+
+var pipeline = [{$match: {x: {$gte: 0}}},
+                {$group: {_id: "$k", total: {$sum: "$x"}, n: {$sum: 1}, hi: {$max: "$x"}}},
+                {$out: {collection: "out", mode: "incremental"}}];
+
+function expected() {
+    return db.in.aggregate(pipeline.slice(0, 2)).toArray().sort(function(a, b) {
+        return a._id < b._id ? -1 : 1;
+    });
+}
+
+function check() {
+    db.in.aggregate(pipeline);
+    assert.eq(expected(), db.out.find().sort({_id: 1}).toArray());
+}
+
+function lastRefresh() {
+    return refreshState.findOne({_id: db.out.getFullName()}).ts;
+}
+
+function lastRefreshKind() {
+    var state = refreshState.findOne({_id: db.out.getFullName()});
+    return state ? state.refresh : null;
+}
+
+for (var i = 0; i < 20; i++) {
+    db.in.insert({k: i % 3, x: i});
+}
+
+// the first run builds the output from scratch
+check();
+assert.eq("rebuild", lastRefreshKind());
+var ts = lastRefresh();
+
+// inserts since the last run are merged in, including new groups and filtered out documents
+db.in.insert({k: 1, x: 100});
+db.in.insert({k: 7, x: 5});
+db.in.insert({k: 2, x: -1});
+check();
+assert.eq("delta", lastRefreshKind());
+assert.neq(tojson(ts), tojson(lastRefresh()));
+
+// nothing new: still the same output
+check();
+assert.eq("delta", lastRefreshKind());
+
+// an update forces a rebuild, which must still give the right answer
+db.in.update({k: 7}, {$set: {x: 50}});
+check();
+assert.eq("rebuild", lastRefreshKind());
+
+// a remove too
+db.in.remove({k: 1, x: 100});
+check();
+assert.eq("rebuild", lastRefreshKind());
+
+// inserts made while a rebuild runs are left out of it and merged in by the next refresh, which
+// doesn't need to rebuild again
+var bulk = db.in.initializeUnorderedBulkOp();
+for (var i = 0; i < 50000; i++) {
+    bulk.insert({k: i % 100, x: i % 10});
+}
+assert.writeOK(bulk.execute());
+db.in.update({k: 7}, {$set: {x: 51}}, false, true);
+
+db.flags.drop();
+var inserter = startParallelShell(
+    "db = db.getSiblingDB('" + name + "');" +
+    "for (var i = 0; !db.flags.findOne({stop: true}); i++) {" +
+    "    db.in.insert({k: i % 200, x: 1});" +
+    "    if (i == 100) db.flags.insert({started: true});" +
+    "}" +
+    "db.flags.insert({inserted: i});",
+    replTest.ports[0]);
+assert.soon(function() { return db.flags.findOne({started: true}); });
+
+var countBefore = db.in.count();
+db.in.aggregate(pipeline);
+var countAfter = db.in.count();
+assert.eq("rebuild", lastRefreshKind());
+db.flags.insert({stop: true});
+inserter();
+printjson({before: countBefore, after: countAfter, inserted: db.flags.findOne({inserted: {$exists: true}})});
+assert.lt(countBefore, countAfter, "no inserts while the rebuild ran");
+
+check();
+assert.eq("delta", lastRefreshKind());
+
+// the output is rebuilt if it was dropped
+db.out.drop();
+check();
+
+// a different pipeline into the same output doesn't reuse the old results
+pipeline[1].$group.n = {$sum: 2};
+check();
+
+// $avg results can't be merged
+assert.throws(function() {
+    db.in.aggregate({$group: {_id: "$k", a: {$avg: "$x"}}},
+                    {$out: {collection: "out", mode: "incremental"}});
+});
+
+// incremental $out must directly follow a $group
+assert.throws(function() {
+    db.in.aggregate({$group: {_id: "$k"}}, {$sort: {_id: 1}},
+                    {$out: {collection: "out", mode: "incremental"}});
+});
+
+// and only stages that handle one document at a time may come before it
+assert.throws(function() {
+    db.in.aggregate({$limit: 5}, {$group: {_id: "$k"}},
+                    {$out: {collection: "out", mode: "incremental"}});
+});
+
+// bad options
+assert.throws(function() {
+    db.in.aggregate({$out: {collection: "out", mode: "sometimes"}});
+});
+assert.throws(function() {
+    db.in.aggregate({$out: {mode: "replace"}});
+});
+
+// mode "replace" is the same as the string form
+db.in.aggregate({$group: {_id: "$k"}}, {$out: {collection: "out2", mode: "replace"}});
+assert.eq(db.in.distinct("k").length, db.out2.count());
+
+replTest.stopSet();
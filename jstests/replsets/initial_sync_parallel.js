@@ -0,0 +1,102 @@
+// Test that initial sync clones the collections of a database in parallel and reports its
+// progress in replSetGetStatus.
+
+load("jstests/replsets/rslib.js");
+var basename = "jstests_initsync_parallel";
+
+print("1. Bring up set");
+var replTest = new ReplSetTest( {name: basename, nodes: 1} );
+replTest.startSet();
+replTest.initiate();
+
+var m = replTest.getMaster();
+
+print("2. Insert data into several collections of two databases");
+var N = 2000;
+var dbs = ["d1", "d2"];
+var colls = ["a", "b", "c", "d", "e"];
+dbs.forEach( function( dbName ) {
+    colls.forEach( function( collName ) {
+        var coll = m.getDB( dbName )[collName];
+        coll.ensureIndex( {x: 1} );
+        var bulk = coll.initializeUnorderedBulkOp();
+        for ( var i = 0; i < N; ++i ) {
+            bulk.insert( {_id: i, x: i % 100, s: "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"} );
+        }
+        assert.writeOK( bulk.execute() );
+    } );
+} );
+
+print("3. Bring up a new node that clones three collections at a time");
+var ports = allocatePorts( 3 );
+var hostname = getHostName();
+
+var s = startMongodTest( ports[2], basename, false, {replSet: basename, oplogSize: 2} );
+assert.commandWorked( s.getDB( "admin" ).runCommand( {setParameter: 1,
+                                                       initialSyncParallelCollections: 3} ) );
+// hold the new node in STARTUP2 once the data is copied, so the final counters can be read
+assert.commandWorked( s.getDB( "admin" ).runCommand( {configureFailPoint: "initialSyncHangAfterDataCopy",
+                                                       mode: "alwaysOn"} ) );
+
+var config = replTest.getReplSetConfig();
+config.version = 2;
+config.members.push( {_id: 2, host: hostname + ":" + ports[2]} );
+try {
+    m.getDB( "admin" ).runCommand( {replSetReconfig: config} );
+}
+catch(e) {
+    print(e);
+}
+reconnect(s);
+
+print("4. Watch initial sync progress");
+var getProgress = function() {
+    var status = s.getDB( "admin" ).runCommand( {replSetGetStatus: 1} );
+    if ( !status.ok || !status.members )
+        return null;
+    var self = status.members.filter( function( member ) { return member.self; } )[0];
+    return self.initialSyncProgress || null;
+};
+
+var progress;
+var samples = 0;
+assert.soon( function() {
+    progress = getProgress();
+    if ( !progress )
+        return false;
+    samples++;
+    assert.lte( progress.collectionsCloned, progress.collectionsToClone );
+    assert.lte( progress.collectionsInProgress, 3 );
+    return progress.collectionsToClone > 0 &&
+           progress.collectionsCloned == progress.collectionsToClone;
+}, "initial sync never finished copying the data", 5 * 60 * 1000, 100 );
+printjson( progress );
+assert.gt( samples, 0 );
+assert.gte( progress.collectionsCloned, dbs.length * colls.length );
+assert.gte( progress.documentsCloned, dbs.length * colls.length * N );
+assert.eq( 0, progress.collectionsInProgress );
+// collections were copied at the same time, but never more than the parameter allows
+assert.gt( progress.maxCollectionsInProgress, 1 );
+assert.lte( progress.maxCollectionsInProgress, 3 );
+
+assert.commandWorked( s.getDB( "admin" ).runCommand( {configureFailPoint: "initialSyncHangAfterDataCopy",
+                                                       mode: "off"} ) );
+assert.soon( function() {
+    var status = s.getDB( "admin" ).runCommand( {replSetGetStatus: 1} );
+    var self = status.members.filter( function( member ) { return member.self; } )[0];
+    return self.stateStr == "SECONDARY";
+}, "new node never became secondary", 5 * 60 * 1000, 100 );
+
+print("5. Check the data and indexes made it across");
+s.setSlaveOk();
+dbs.forEach( function( dbName ) {
+    colls.forEach( function( collName ) {
+        var coll = s.getDB( dbName )[collName];
+        assert.eq( N, coll.count(), coll.getFullName() );
+        assert.eq( 2, coll.getIndexes().length, coll.getFullName() );
+        assert.eq( N / 100, coll.find( {x: 42} ).hint( {x: 1} ).itcount(), coll.getFullName() );
+    } );
+} );
+
+replTest.stopSet();
+stopMongod( ports[2] );
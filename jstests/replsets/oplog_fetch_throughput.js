@@ -0,0 +1,43 @@
+// Test that a secondary fetching the oplog as a stream keeps up with the primary, and that
+// replSetGetStatus reports its fetch and apply throughput.
+
+var replTest = new ReplSetTest( {name: "oplog_fetch_throughput", nodes: 2} );
+replTest.startSet();
+replTest.initiate();
+
+var master = replTest.getMaster();
+var coll = master.getDB( "test" ).foo;
+
+// batches of inserts, big enough for the sync target to stream several replies
+var N = 20000;
+var bulk = coll.initializeUnorderedBulkOp();
+for ( var i = 0; i < N; ++i ) {
+    bulk.insert( {_id: i, s: "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"} );
+}
+assert.writeOK( bulk.execute() );
+replTest.awaitReplication();
+
+var secondary = replTest.getSecondary();
+secondary.setSlaveOk();
+assert.eq( N, secondary.getDB( "test" ).foo.count() );
+
+var status = secondary.getDB( "admin" ).runCommand( {replSetGetStatus: 1} );
+assert.commandWorked( status );
+var self = status.members.filter( function( member ) { return member.self; } )[0];
+printjson( self.syncThroughput );
+assert( self.syncThroughput, tojson( self ) );
+assert.gte( self.syncThroughput.fetchedOps, N, tojson( self.syncThroughput ) );
+assert.gte( self.syncThroughput.appliedOps, N, tojson( self.syncThroughput ) );
+assert.gt( self.syncThroughput.fetchedBytes, 0, tojson( self.syncThroughput ) );
+assert.lte( self.syncThroughput.bufferSizeBytes, self.syncThroughput.bufferMaxSizeBytes );
+assert.gte( self.syncThroughput.fetchedOpsPerSec, 0 );
+assert.gte( self.syncThroughput.appliedOpsPerSec, 0 );
+
+// fetching without exhaust still works
+assert.commandWorked( secondary.getDB( "admin" ).runCommand( {setParameter: 1,
+                                                               replExhaustOplogFetch: false} ) );
+assert.writeOK( coll.insert( {_id: N} ) );
+replTest.awaitReplication();
+assert.eq( N + 1, secondary.getDB( "test" ).foo.count() );
+
+replTest.stopSet();
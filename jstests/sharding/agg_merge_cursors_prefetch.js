@@ -0,0 +1,59 @@
+// Test that $mergeCursors returns every document exactly once while prefetching getMores from
+// the shards, both with the default in-flight byte budget and with a budget small enough that
+// only a single getMore may be outstanding at a time.
+
+var st = new ShardingTest({shards: 2});
+st.stopBalancer();
+var mongos = st.s0;
+var shards = [st.shard0, st.shard1];
+var coll = mongos.getCollection("foo.bar");
+var admin = mongos.getDB("admin");
+
+//
+// Pre-split collection: shard 0 takes {_id: {$lt: 0}}, shard 1 takes {_id: {$gte: 0}}.
+//
+assert.commandWorked(admin.runCommand({enableSharding: coll.getDB().getName()}));
+admin.runCommand({movePrimary: coll.getDB().getName(), to: "shard0000"});
+assert.commandWorked(admin.runCommand({shardCollection: coll.getFullName(), key: {_id: 1}}));
+assert.commandWorked(admin.runCommand({split: coll.getFullName(), middle: {_id: 0}}));
+assert.commandWorked(admin.runCommand({moveChunk: coll.getFullName(),
+                                       find: {_id: 0},
+                                       to: "shard0001"}));
+
+// Make the documents large enough that each shard needs several getMores.
+var nDocsPerShard = 2000;
+var padding = new Array(4 * 1024).join("x");
+for (var i = -nDocsPerShard; i < nDocsPerShard; i++) {
+    coll.insert({_id: i, padding: padding});
+}
+assert.eq(null, coll.getDB().getLastError());
+
+var setPrefetchBytes = function(bytes) {
+    var conns = [mongos].concat(shards);
+    for (var i = 0; i < conns.length; i++) {
+        assert.commandWorked(conns[i].getDB("admin").runCommand(
+            {setParameter: 1, internalAggMergeCursorsPrefetchBytes: bytes}));
+    }
+};
+
+var checkResults = function() {
+    var results = coll.aggregate([{$project: {_id: 1}}], {cursor: {batchSize: 0}}).toArray();
+    assert.eq(2 * nDocsPerShard, results.length);
+
+    var seen = {};
+    results.forEach(function(doc) {
+        assert(!seen[doc._id], "duplicate _id " + doc._id);
+        seen[doc._id] = true;
+    });
+
+    // $out forces the merge onto the primary shard.
+    coll.aggregate([{$project: {_id: 1}}, {$out: "out"}]);
+    assert.eq(2 * nDocsPerShard, coll.getDB().out.count());
+};
+
+checkResults();
+
+setPrefetchBytes(1);
+checkResults();
+
+st.stop();
@@ -0,0 +1,95 @@
+//
+// Tests that the balancer runs migrations of one collection at the same time when they don't
+// share a shard, and that it reports them in config.changelog and serverStatus
+//
+
+var st = new ShardingTest({shards : 4, mongos : 1, other : {chunksize : 1}});
+
+st.stopBalancer();
+
+var mongos = st.s0;
+var admin = mongos.getDB("admin");
+var config = mongos.getDB("config");
+var coll = mongos.getCollection("balconc.coll");
+
+var shards = config.shards.find().sort({_id : 1}).toArray();
+var shardConns = [st.shard0, st.shard1, st.shard2, st.shard3];
+
+assert.commandWorked(admin.runCommand({enableSharding : coll.getDB() + ""}));
+var primary = config.databases.findOne({_id : coll.getDB() + ""}).primary;
+if (primary != shards[0]._id) {
+    assert.commandWorked(admin.runCommand({movePrimary : coll.getDB() + "", to : shards[0]._id}));
+}
+assert.commandWorked(admin.runCommand({shardCollection : coll + "", key : {_id : 1}}));
+for (var i = 0; i < 19; i++) {
+    assert.commandWorked(admin.runCommand({split : coll + "", middle : {_id : i}}));
+}
+
+// Give both shard0 and shard1 more chunks than they should have, so the balancer has two
+// donors with nothing in common
+for (var i = 10; i < 19; i++) {
+    assert.commandWorked(admin.runCommand({moveChunk : coll + "",
+                                           find : {_id : i},
+                                           to : shards[1]._id}));
+}
+
+var status = admin.serverStatus().balancer;
+assert(status, "no balancer section in serverStatus");
+assert.eq([], status.activeMigrations);
+
+// Hold every donor once it has its locks, so overlapping migrations stay visible
+shardConns.forEach(function(conn) {
+    assert.commandWorked(conn.getDB("admin").runCommand({configureFailPoint : "moveChunkHangAtStep3",
+                                                         mode : "alwaysOn"}));
+});
+
+st.startBalancer();
+
+// Both donors get a migration of the same collection in flight at once, which a balancer that
+// moves one chunk of a collection at a time would never do
+assert.soon(function() {
+    status = admin.serverStatus().balancer;
+    var froms = {};
+    status.activeMigrations.forEach(function(migration) {
+        if (migration.ns == coll + "") {
+            froms[migration.from] = true;
+        }
+    });
+    return froms[shards[0]._id] && froms[shards[1]._id];
+}, "balancer didn't migrate chunks of both donors at once", 5 * 60 * 1000);
+
+// Both donors took their locks and started, which is logged after the locks are held, and
+// neither has committed yet. The 9 moves above account for the other starts.
+assert.soon(function() {
+    return config.changelog.count({what : "moveChunk.start", ns : coll + ""}) >= 11;
+});
+var started = config.changelog.find({what : "moveChunk.start", ns : coll + ""})
+                              .sort({time : -1}).limit(2).toArray();
+assert.eq(2, started.length);
+assert.neq(started[0].details.from, started[1].details.from, tojson(started));
+assert.eq(0, config.changelog.count({what : "moveChunk.commit",
+                                     ns : coll + "",
+                                     time : {$gt : started[1].time}}));
+
+shardConns.forEach(function(conn) {
+    assert.commandWorked(conn.getDB("admin").runCommand({configureFailPoint : "moveChunkHangAtStep3",
+                                                         mode : "off"}));
+});
+
+// Both migrations commit, and each is logged by the balancer
+assert.soon(function() {
+    return config.changelog.count({what : "balancer.moveChunk",
+                                   ns : coll + "",
+                                   "details.ok" : true}) >= 2;
+}, "balancer didn't finish its concurrent migrations", 5 * 60 * 1000);
+
+var entry = config.changelog.findOne({what : "balancer.moveChunk"});
+assert(entry.details.from, tojson(entry));
+assert(entry.details.to, tojson(entry));
+assert(entry.details.min, tojson(entry));
+assert(entry.details.max, tojson(entry));
+
+status = admin.serverStatus().balancer;
+assert.gt(status.migrationsSucceeded, 1, tojson(status));
+
+st.stop();
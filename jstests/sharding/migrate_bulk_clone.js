@@ -0,0 +1,62 @@
+//
+// Tests that the recipient of a migration clones the chunk in batches, builds the indexes it
+// deferred with migrateDeferSecondaryIndexes once the clone is done, and records the clone
+// phases in config.changelog
+//
+
+var st = new ShardingTest({ shards : 2, mongos : 1 });
+st.stopBalancer();
+
+var mongos = st.s0;
+var shards = mongos.getDB( "config" ).shards.find().toArray();
+var admin = mongos.getDB( "admin" );
+var config = mongos.getDB( "config" );
+var coll = mongos.getCollection( "foo.bar" );
+
+assert( admin.runCommand({ enableSharding : coll.getDB() + "" }).ok );
+printjson( admin.runCommand({ movePrimary : coll.getDB() + "", to : shards[0]._id }) );
+assert( admin.runCommand({ shardCollection : coll + "", key : { skey : 1 } }).ok );
+
+coll.ensureIndex({ a : 1 });
+coll.ensureIndex({ b : 1 }, { unique : true });
+
+// enough data for several _migrateClone batches
+var str = new Array( 10 * 1024 ).join( "x" );
+for ( var i = 0; i < 5000; i++ ) {
+    coll.insert({ skey : i, a : i % 10, b : i, s : str });
+}
+assert.eq( null, coll.getDB().getLastError() );
+
+assert.commandWorked( st.shard1.getDB( "admin" ).runCommand({ setParameter : 1,
+                                                                migrateDeferSecondaryIndexes : true }) );
+assert( admin.runCommand({ moveChunk : coll + "", find : { skey : 0 }, to : shards[1]._id }).ok );
+
+var recipient = st.shard1.getCollection( coll + "" );
+assert.eq( 5000, recipient.find().itcount() );
+
+// every index the donor has exists on the recipient and covers all of the documents
+var indexes = recipient.getIndexes().map( function( idx ) { return tojson( idx.key ); } ).sort();
+assert.eq( [ tojson({ _id : 1 }), tojson({ a : 1 }), tojson({ b : 1 }), tojson({ skey : 1 }) ],
+           indexes );
+assert.eq( 500, recipient.find({ a : 3 }).hint({ a : 1 }).itcount() );
+recipient.getIndexes().forEach( function( idx ) {
+    // deferred indexes are built in the foreground, with the donor's options
+    assert.eq( undefined, idx.background, tojson( idx ) );
+});
+assert.eq( true, recipient.getIndexes().filter( function( idx ) {
+    return friendlyEqual( idx.key, { b : 1 } );
+})[0].unique );
+assert.eq( 1, recipient.find({ b : 4321 }).hint({ b : 1 }).itcount() );
+
+var entry = config.changelog.find({ what : "moveChunk.to", ns : coll + "" })
+                            .sort({ time : -1 }).next();
+printjson( entry );
+assert.eq( "success", entry.details.note );
+assert( entry.details.cloneFetchMillis >= 0, tojson( entry ) );
+assert( entry.details.cloneApplyMillis >= 0, tojson( entry ) );
+assert( entry.details.cloneIndexMillis >= 0, tojson( entry ) );
+
+// mongos sees each document once
+assert.eq( 5000, coll.find().itcount() );
+
+st.stop();
@@ -0,0 +1,79 @@
+//
+// Tests that with shardConnectionsPerHost set, mongos never checks out more than that many
+// connections to a shard at once, and reports saturation and wait times in connPoolStats
+//
+
+var st = new ShardingTest({ shards : 2, mongos : 1,
+                            other : { mongosOptions : { setParameter : "shardConnectionsPerHost=2" } } });
+st.stopBalancer();
+
+var mongos = st.s0;
+var admin = mongos.getDB( "admin" );
+var coll = mongos.getCollection( "foo.bar" );
+var shards = mongos.getDB( "config" ).shards.find().toArray();
+
+assert.commandWorked( admin.runCommand({ enableSharding : coll.getDB() + "" }) );
+printjson( admin.runCommand({ movePrimary : coll.getDB() + "", to : shards[0]._id }) );
+assert.commandWorked( admin.runCommand({ shardCollection : coll + "", key : { _id : 1 } }) );
+assert.commandWorked( admin.runCommand({ split : coll + "", middle : { _id : 0 } }) );
+assert.commandWorked( admin.runCommand({ moveChunk : coll + "", find : { _id : 0 },
+                                         to : shards[1]._id }) );
+
+for ( var i = -100; i < 100; i++ ) {
+    coll.insert({ _id : i });
+}
+assert.eq( null, coll.getDB().getLastError() );
+
+var stats = admin.runCommand({ connPoolStats : 1 });
+assert.commandWorked( stats );
+printjson( stats.sharedShardConnections );
+assert.eq( 2, stats.sharedShardConnections.perHostLimit );
+
+// Many clients issuing slow queries at once have to share the two connections to each shard
+var query = "db.getSiblingDB( 'foo' ).bar.find({ $where : 'sleep( 50 ); return true;' })" +
+            "  .batchSize( 5 ).limit( 5 ).itcount();";
+var joins = [];
+for ( var i = 0; i < 6; i++ ) {
+    joins.push( startParallelShell( query, mongos.port ) );
+}
+joins.forEach( function( join ) { join(); } );
+
+stats = admin.runCommand({ connPoolStats : 1 }).sharedShardConnections;
+printjson( stats );
+assert.eq( 0, stats.totalInUse, tojson( stats ) );
+assert.gt( stats.totalWaits, 0, tojson( stats ) );
+assert.gte( stats.totalWaitMicros, 0, tojson( stats ) );
+for ( var host in stats.hosts ) {
+    assert.lte( stats.hosts[host].peakInUse, 2, tojson( stats ) );
+    assert.gt( stats.hosts[host].checkouts, 0, tojson( stats ) );
+}
+
+// shardConnPoolStats reports the same section
+assert.eq( 2, admin.runCommand({ shardConnPoolStats : 1 }).sharedShardConnections.perHostLimit );
+
+// An open cursor holds its connections until it is exhausted or reaped.  Reaping happens on the
+// cursor timeout thread, but the slots must be given back against the thread that opened it.
+function threadsInUse() {
+    var inUse = 0;
+    admin.runCommand({ shardConnPoolStats : 1 }).threads.forEach( function( thread ) {
+        thread.hosts.forEach( function( host ) { inUse += host.inUse; } );
+    });
+    return inUse;
+}
+
+var otherConn = new Mongo( mongos.host );
+var cursor = otherConn.getCollection( coll + "" ).find().batchSize( 2 );
+cursor.next();
+assert.gt( admin.runCommand({ connPoolStats : 1 }).sharedShardConnections.totalInUse, 0 );
+assert.gt( threadsInUse(), 0 );
+
+assert.commandWorked( admin.runCommand({ cursorInfo : 1, setTimeout : 1000 }) );
+assert.soon( function() {
+    return admin.runCommand({ connPoolStats : 1 }).sharedShardConnections.totalInUse == 0;
+}, "reaped cursor kept its connections", 30 * 1000 );
+assert.eq( 0, threadsInUse() );
+assert.commandWorked( admin.runCommand({ cursorInfo : 1, setTimeout : 600000 }) );
+
+assert.eq( 200, coll.find().itcount() );
+
+st.stop();
@@ -0,0 +1,124 @@
+//
+// Tests that a query sorted on a prefix of the shard key is merged shard by shard in key order, so
+// that a sort + limit only queries the shards it needs, and that the full results stay in order
+// when a shard owns several separate ranges
+//
+
+var st = new ShardingTest({ shards : 3, mongos : 1 });
+st.stopBalancer();
+
+var mongos = st.s0;
+var admin = mongos.getDB( "admin" );
+var coll = mongos.getCollection( "foo.bar" );
+var shards = mongos.getDB( "config" ).shards.find().sort({ _id : 1 }).toArray();
+
+assert.commandWorked( admin.runCommand({ enableSharding : coll.getDB() + "" }) );
+printjson( admin.runCommand({ movePrimary : coll.getDB() + "", to : shards[0]._id }) );
+assert.commandWorked( admin.runCommand({ shardCollection : coll + "", key : { a : 1, b : 1 } }) );
+
+// shard0 : [MinKey, 100) and [200, 300), shard1 : [100, 200), shard2 : [300, MaxKey)
+[ 100, 200, 300 ].forEach( function( split ) {
+    assert.commandWorked( admin.runCommand({ split : coll + "", middle : { a : split, b : 0 } }) );
+});
+assert.commandWorked( admin.runCommand({ moveChunk : coll + "", find : { a : 150, b : 0 },
+                                         to : shards[1]._id, _waitForDelete : true }) );
+assert.commandWorked( admin.runCommand({ moveChunk : coll + "", find : { a : 350, b : 0 },
+                                         to : shards[2]._id, _waitForDelete : true }) );
+
+for ( var i = 0; i < 400; i++ ) {
+    coll.insert({ a : i, b : i % 7, c : i % 3 });
+}
+assert.eq( null, coll.getDB().getLastError() );
+
+var shardConns = [ st.shard0, st.shard1, st.shard2 ];
+var queryCounts = function() {
+    return shardConns.map( function( conn ) {
+        return conn.getDB( "admin" ).serverStatus().opcounters.query;
+    });
+};
+
+var checkOrder = function( docs, dir ) {
+    for ( var i = 1; i < docs.length; i++ ) {
+        assert.lte( 0, dir * ( docs[i].a - docs[i - 1].a ), tojson( docs.slice( i - 1, i + 1 ) ) );
+    }
+};
+
+// Full scans come back complete and in order, in both directions
+var docs = coll.find().sort({ a : 1 }).toArray();
+assert.eq( 400, docs.length );
+checkOrder( docs, 1 );
+docs = coll.find().sort({ a : -1, b : -1 }).toArray();
+assert.eq( 400, docs.length );
+checkOrder( docs, -1 );
+docs = coll.find({ c : 1 }).sort({ a : 1 }).batchSize( 7 ).toArray();
+assert.eq( 133, docs.length );
+checkOrder( docs, 1 );
+
+// The lowest keys only live on shard0
+var before = queryCounts();
+docs = coll.find().sort({ a : 1 }).limit( -10 ).toArray();
+var after = queryCounts();
+assert.eq( 10, docs.length );
+assert.eq( 0, docs[0].a );
+printjson({ before : before, after : after });
+assert.eq( before[1], after[1], "shard1 queried for the first keys" );
+assert.eq( before[2], after[2], "shard2 queried for the first keys" );
+
+// ... and the highest ones on shard2
+before = queryCounts();
+docs = coll.find().sort({ a : -1 }).limit( -10 ).toArray();
+after = queryCounts();
+assert.eq( 399, docs[0].a );
+assert.eq( before[0], after[0], "shard0 queried for the last keys" );
+assert.eq( before[1], after[1], "shard1 queried for the last keys" );
+
+// A range starting on shard1 doesn't need shard2 for its first results
+before = queryCounts();
+docs = coll.find({ a : { $gte : 150 } }).sort({ a : 1 }).limit( -20 ).toArray();
+after = queryCounts();
+assert.eq( 150, docs[0].a );
+checkOrder( docs, 1 );
+assert.eq( before[2], after[2], "shard2 queried for keys from 150" );
+
+// A positive limit only needs the shards its first batch reaches too
+before = queryCounts();
+docs = coll.find().sort({ a : 1 }).limit( 10 ).toArray();
+after = queryCounts();
+assert.eq( 10, docs.length );
+assert.eq( 0, docs[0].a );
+printjson({ before : before, after : after });
+assert.eq( before[1], after[1], "shard1 queried for a limit of 10" );
+assert.eq( before[2], after[2], "shard2 queried for a limit of 10" );
+
+before = queryCounts();
+docs = coll.find().sort({ a : 1 }).limit( 150 ).toArray();
+after = queryCounts();
+assert.eq( 150, docs.length );
+checkOrder( docs, 1 );
+assert.eq( 149, docs[149].a );
+assert.lt( before[1], after[1], "shard1 not queried for a limit of 150" );
+assert.eq( before[2], after[2], "shard2 queried for a limit of 150" );
+
+// Later batches open the shards they reach as they go
+before = queryCounts();
+docs = coll.find().sort({ a : 1 }).batchSize( 50 ).limit( 250 ).toArray();
+after = queryCounts();
+assert.eq( 250, docs.length );
+checkOrder( docs, 1 );
+assert.eq( 249, docs[249].a );
+assert.eq( before[2], after[2], "shard2 queried for the first 250 keys" );
+
+// Sorts that don't follow the shard key are merged from every shard as before
+docs = coll.find().sort({ b : 1, a : 1 }).limit( 10 ).toArray();
+assert.eq( 10, docs.length );
+docs.forEach( function( doc ) { assert.eq( 0, doc.b ); } );
+
+// Turning it off queries every shard up front
+assert.commandWorked( admin.runCommand({ setParameter : 1, shardKeyOrderedMerge : false }) );
+before = queryCounts();
+docs = coll.find().sort({ a : 1 }).limit( -10 ).toArray();
+after = queryCounts();
+assert.eq( 0, docs[0].a );
+assert.lt( before[2], after[2] );
+
+st.stop();
@@ -235,7 +235,11 @@ namespace mongo {
         if ( cursorId == 0 )
             return false;
 
-        requestMore();
+        // an exhaust cursor's next batch is already on its way
+        if ( opts & QueryOption_Exhaust )
+            exhaustReceiveMore();
+        else
+            requestMore();
         return batch.pos < batch.nReturned;
     }
 
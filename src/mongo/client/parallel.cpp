@@ -24,6 +24,7 @@
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/query/lite_parsed_query.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/chunk.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/config.h"
@@ -35,6 +36,9 @@ namespace mongo {
 
     LabeledLevel pc( "pcursor", 2 );
 
+    // Query shards lazily, in shard key order, when a sort follows the shard key
+    MONGO_EXPORT_SERVER_PARAMETER(shardKeyOrderedMerge, bool, true);
+
     void ParallelSortClusteredCursor::init() {
         if ( _didInit )
             return;
@@ -300,6 +304,7 @@ namespace mongo {
         _numServers = _servers.size();
         _lastFrom = 0;
         _cursors = 0;
+        _nextDeferred = 0;
 
         if( ! _qSpec.isEmpty() ){
 
@@ -620,7 +625,183 @@ namespace mongo {
             }
         }
     }
-    
+
+    DBClientCursor* ParallelSortClusteredCursor::_newShardCursor( DBClientBase* conn ) {
+        return new DBClientCursor( conn, _qSpec.ns(), _qSpec.query(),
+                                   isCommand() ? 1 : 0, // nToReturn (0 if query indicates multi)
+                                   0, // nToSkip
+                                   // Does this need to be a ptr?
+                                   _qSpec.fields().isEmpty() ? 0 : _qSpec.fieldsData(), // fieldsToReturn
+                                   _qSpec.options(), // options
+                                   // NtoReturn is weird.
+                                   // If zero, it means use default size, so we do that for all cursors
+                                   // If positive, it's the batch size (we don't want this cursor limiting results), that's
+                                   // done at a higher level
+                                   // If negative, it's the batch size, but we don't create a cursor - so we don't want
+                                   // to create a child cursor either.
+                                   // Either way, if non-zero, we want to pull back the batch size + the skip amount as
+                                   // quickly as possible.  Potentially, for a cursor on a single shard or if we keep better track of
+                                   // chunks, we can actually add the skip value into the cursor and/or make some assumptions about the
+                                   // return value size ( (batch size + skip amount) / num_servers ).
+                                   _qSpec.ntoreturn() == 0 ? 0 :
+                                       ( _qSpec.ntoreturn() > 0 ? _qSpec.ntoreturn() + _qSpec.ntoskip() :
+                                                                  _qSpec.ntoreturn() - _qSpec.ntoskip() ) ); // batchSize
+    }
+
+    namespace {
+
+        /**
+         * Orders shards by the first shard key they can return, in the direction of the sort.
+         */
+        class ShardBoundLess {
+        public:
+            ShardBoundLess( bool ascending ) : _ascending( ascending ) {}
+
+            bool operator()( const pair<Shard,BSONObj>& a, const pair<Shard,BSONObj>& b ) const {
+                int comp = a.second.woCompare( b.second );
+                return _ascending ? comp < 0 : comp > 0;
+            }
+
+        private:
+            bool _ascending;
+        };
+
+        /**
+         * Compares 'doc' with a shard key 'bound' on the fields of 'sortKey', in sort order.
+         * Returns 0 if 'doc' is missing any of them, since it can't be placed.
+         */
+        int compareToShardBound( const BSONObj& doc, const BSONObj& bound, const BSONObj& sortKey ) {
+            BSONObjIterator i( sortKey );
+            while ( i.more() ) {
+                BSONElement s = i.next();
+                BSONElement d = doc.getFieldDotted( s.fieldName() );
+                if ( d.eoo() )
+                    return 0;
+
+                int comp = d.woCompare( bound[ s.fieldName() ], false );
+                if ( s.number() < 0 )
+                    comp = -comp;
+                if ( comp != 0 )
+                    return comp;
+            }
+            return 0;
+        }
+    }
+
+    void ParallelSortClusteredCursor::_deferShardsInKeyOrder( set<Shard>& todo,
+                                                               ChunkManagerPtr manager ) {
+        _deferredShards.clear();
+        _nextDeferred = 0;
+        _deferredManager.reset();
+
+        if ( ! shardKeyOrderedMerge || todo.size() < 2 ) return;
+        if ( ! _cInfo.isEmpty() || isCommand() || isExplain() ) return;
+        if ( _qSpec.options() & QueryOption_PartialResults ) return;
+        if ( _sortKey.isEmpty() ) return;
+
+        // Only queries with a limit or batch size: without one the client normally reads
+        // everything, and every shard is needed anyway.  A shard found to be stale while the
+        // first batch is built is retried from scratch by Strategy::queryOp; once results have
+        // gone back, a later batch fails instead.
+        if ( _qSpec.ntoreturn() == 0 ) return;
+
+        // The sort has to be a prefix of the shard key, all in one direction, for the chunk
+        // ranges to come up in sort order.  Hashed shard keys never match here.
+        bool ascending = _sortKey.firstElement().number() > 0;
+        BSONObjIterator keyIt( manager->getShardKey().key() );
+        BSONObjIterator sortIt( _sortKey );
+        while ( sortIt.more() ) {
+            BSONElement s = sortIt.next();
+            if ( ! keyIt.more() ) return;
+            BSONElement k = keyIt.next();
+            if ( ! str::equals( s.fieldName(), k.fieldName() ) ) return;
+            if ( ! s.isNumber() || ! k.isNumber() || k.number() != 1 ) return;
+            if ( ( s.number() > 0 ) != ascending || s.number() == 0 ) return;
+        }
+
+        ChunkManager::ShardBoundsMap bounds;
+        manager->getShardBoundsForQuery( bounds, _qSpec.filter() );
+
+        vector< pair<Shard,BSONObj> > ordered;
+        for ( set<Shard>::const_iterator i = todo.begin(); i != todo.end(); ++i ) {
+            ChunkManager::ShardBoundsMap::const_iterator b = bounds.find( *i );
+            if ( b == bounds.end() ) return;
+            ordered.push_back( make_pair( *i, ascending ? b->second.first : b->second.second ) );
+        }
+        std::sort( ordered.begin(), ordered.end(), ShardBoundLess( ascending ) );
+
+        // Only the shard whose range comes first is queried now
+        for ( size_t i = 1; i < ordered.size(); i++ ) {
+            todo.erase( ordered[i].first );
+        }
+        _deferredShards.assign( ordered.begin() + 1, ordered.end() );
+        _deferredManager = manager;
+
+        LOG( pc ) << "deferring " << _deferredShards.size() << " shards until the merge on "
+                  << _sortKey << " reaches their ranges" << endl;
+    }
+
+    void ParallelSortClusteredCursor::_openDeferredShards() {
+        while ( _nextDeferred < _deferredShards.size() ) {
+
+            BSONObj best;
+            for ( int i = 0; i < _numServers; i++ ) {
+                if ( ! _cursors[i].more() ) continue;
+                BSONObj me = _cursors[i].peek();
+                if ( best.isEmpty() || best.woSortOrder( me, _sortKey, true ) > 0 )
+                    best = me;
+            }
+
+            // Nothing in the next shard's range can come before the best result we already have
+            const pair<Shard,BSONObj>& next = _deferredShards[ _nextDeferred ];
+            if ( ! best.isEmpty() && compareToShardBound( best, next.second, _sortKey ) < 0 )
+                return;
+
+            _nextDeferred++;
+            _openShard( next.first );
+        }
+    }
+
+    void ParallelSortClusteredCursor::_openShard( const Shard& shard ) {
+
+        LOG( pc ) << "opening deferred cursor on shard " << shard << endl;
+
+        PCMData& mdata = _cursorMap[ shard ];
+        mdata.pcState.reset( new PCState() );
+        PCStatePtr state = mdata.pcState;
+
+        // Results have already been merged, so a stale version can't be retried here.  The
+        // chunk manager is reloaded, and if nothing has been sent back yet Strategy::queryOp
+        // retries the query from the start.
+        try {
+            setupVersionAndHandleSlaveOk( state, shard, ShardPtr(), NamespaceString( _qSpec.ns() ),
+                                          "", _deferredManager );
+
+            state->cursor.reset( _newShardCursor( state->conn->get() ) );
+            mdata.initialized = true;
+            mdata.finished = true;
+
+            uassert( 28629, str::stream() << "could not initialize cursor on shard "
+                     << shard.toString() << ", current connection state is "
+                     << mdata.toBSON().toString(), state->cursor->init() );
+
+            _checkCursor( state->cursor.get() );
+        }
+        catch( StaleConfigException& e ){
+            NamespaceString staleNS( e.getns().size() ? e.getns() : _qSpec.ns() );
+            warning() << "stale config of ns " << staleNS << " when opening deferred cursor on "
+                      << shard << causedBy( e ) << endl;
+            mdata.errored = true;
+            _handleStaleNS( staleNS, true, e.requiresFullReload() );
+            throw;
+        }
+
+        state->cursor->attach( state->conn.get() ); // Closes connection for us
+        mdata.completed = true;
+
+        _cursors[ _numServers++ ].reset( state->cursor.get(), &mdata );
+    }
+
     void ParallelSortClusteredCursor::startInit() {
 
         const bool returnPartial = ( _qSpec.options() & QueryOption_PartialResults );
@@ -666,6 +847,9 @@ namespace mongo {
             if( manager ) manager->getShardsForQuery( todo, !_cInfo.isEmpty() ? _cInfo.cmdFilter : _qSpec.filter() );
             else if( primary ) todo.insert( *primary );
 
+            if( manager ) _deferShardsInKeyOrder( todo, manager );
+            else _deferredShards.clear();
+
             // Close all cursors on extra shards first, as these will be invalid
             for( map< Shard, PCMData >::iterator i = _cursorMap.begin(), end = _cursorMap.end(); i != end; ++i ){
 
@@ -758,25 +942,7 @@ namespace mongo {
                     // or if the number of shards to query is > 1
                     if( ( isVersioned() && ! primary ) || _qShards.size() > 1 ){
 
-                        state->cursor.reset( new DBClientCursor( state->conn->get(), ns, _qSpec.query(),
-                                                                 isCommand() ? 1 : 0, // nToReturn (0 if query indicates multi)
-                                                                 0, // nToSkip
-                                                                 // Does this need to be a ptr?
-                                                                 _qSpec.fields().isEmpty() ? 0 : _qSpec.fieldsData(), // fieldsToReturn
-                                                                 _qSpec.options(), // options
-                                                                 // NtoReturn is weird.
-                                                                 // If zero, it means use default size, so we do that for all cursors
-                                                                 // If positive, it's the batch size (we don't want this cursor limiting results), that's
-                                                                 // done at a higher level
-                                                                 // If negative, it's the batch size, but we don't create a cursor - so we don't want
-                                                                 // to create a child cursor either.
-                                                                 // Either way, if non-zero, we want to pull back the batch size + the skip amount as
-                                                                 // quickly as possible.  Potentially, for a cursor on a single shard or if we keep better track of
-                                                                 // chunks, we can actually add the skip value into the cursor and/or make some assumptions about the
-                                                                 // return value size ( (batch size + skip amount) / num_servers ).
-                                                                 _qSpec.ntoreturn() == 0 ? 0 :
-                                                                     ( _qSpec.ntoreturn() > 0 ? _qSpec.ntoreturn() + _qSpec.ntoskip() :
-                                                                                                _qSpec.ntoreturn() - _qSpec.ntoskip() ) ) ); // batchSize
+                        state->cursor.reset( _newShardCursor( state->conn->get() ) );
                     }
                     else{
 
@@ -1103,7 +1269,8 @@ namespace mongo {
 
         // LEGACY STUFF NOW
 
-        _cursors = new FilteringClientCursor[ _cursorMap.size() ];
+        // Leave room for the shards opened later on
+        _cursors = new FilteringClientCursor[ _cursorMap.size() + _deferredShards.size() ];
 
         // Put the cursors in the legacy format
         int index = 0;
@@ -1470,6 +1637,8 @@ namespace mongo {
             _needToSkip = n;
         }
 
+        _openDeferredShards();
+
         for ( int i=0; i<_numServers; i++ ) {
             if ( _cursors[i].more() )
                 return true;
@@ -1478,6 +1647,8 @@ namespace mongo {
     }
 
     BSONObj ParallelSortClusteredCursor::next() {
+        _openDeferredShards();
+
         BSONObj best = BSONObj();
         int bestFrom = -1;
 
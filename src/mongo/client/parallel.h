@@ -211,6 +211,13 @@ namespace mongo {
         void _markStaleNS( const NamespaceString& staleNS, const StaleConfigException& e, bool& forceReload, bool& fullReload );
         void _handleStaleNS( const NamespaceString& staleNS, bool forceReload, bool fullReload );
 
+        DBClientCursor* _newShardCursor( DBClientBase* conn );
+
+        // Shard key ordered merging
+        void _deferShardsInKeyOrder( set<Shard>& todo, ChunkManagerPtr manager );
+        void _openDeferredShards();
+        void _openShard( const Shard& shard );
+
         bool _didInit;
         bool _done;
 
@@ -224,6 +231,13 @@ namespace mongo {
 
         map<Shard,PCMData> _cursorMap;
 
+        // When the sort of a single batch query follows the shard key, shards other than the first
+        // one in sort order are only queried once the merge reaches the start of their range, so
+        // a sort + limit may never touch them.  Each entry is a shard and the first shard key it can return.
+        vector< pair<Shard,BSONObj> > _deferredShards;
+        size_t _nextDeferred;
+        ChunkManagerPtr _deferredManager;
+
         // LEGACY BELOW
         int _numServers;
         int _lastFrom;
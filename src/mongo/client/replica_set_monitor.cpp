@@ -236,6 +236,26 @@ namespace {
         bool operator() (const Node& node) { return !_hosts.count(node.host); }
         const std::set<HostAndPort>& _hosts;
     };
+
+    /**
+     * Calls isMaster on host. Returns the reply, or an empty object if the host couldn't be
+     * reached or the call failed.
+     */
+    BSONObj callIsMaster(const HostAndPort& host, int64_t* pingMicros) {
+        BSONObj reply;
+        try {
+            ScopedDbConnection conn(ConnectionString(host), socketTimeoutSecs);
+            bool ignoredOutParam = false;
+            Timer timer;
+            conn->isMaster(ignoredOutParam, &reply);
+            *pingMicros = timer.micros();
+            conn.done(); // return to pool on success.
+        }
+        catch (...) {
+            reply = BSONObj(); // should be a no-op but want to be sure
+        }
+        return reply;
+    }
 } // namespace
 
     // At 1 check every 10 seconds, 30 checks takes 5 minutes
@@ -431,6 +451,22 @@ namespace {
             hosts.append(builder.obj());
         }
         hosts.done();
+
+        BSONObjBuilder refreshes(bsonObjBuilder.subobjStart("refreshes"));
+        refreshes.appendNumber("completed", static_cast<long long>(_state->scansCompleted));
+        refreshes.appendNumber("totalMicros", static_cast<long long>(_state->totalScanMicros));
+        refreshes.appendNumber("lastMicros", static_cast<long long>(_state->lastScanMicros));
+        refreshes.appendBool("inProgress", _state->currentScan != NULL);
+
+        BSONObjBuilder durations(refreshes.subobjStart("durationMillis"));
+        for (int i = 0; i <= SetState::numScanDurationBuckets; i++) {
+            const std::string bucket = i < SetState::numScanDurationBuckets ?
+                str::stream() << "lt" << SetState::scanDurationBucketMillis[i] :
+                str::stream() << "gte" << SetState::scanDurationBucketMillis[i - 1];
+            durations.appendNumber(bucket, static_cast<long long>(_state->scanDurations[i]));
+        }
+        durations.done();
+        refreshes.done();
     }
 
     void ReplicaSetMonitor::cleanup() {
@@ -491,6 +527,8 @@ namespace {
                 }
             }
 
+            _set->recordScanDuration(_scan->timer.micros());
+
             if (_scan->foundAnyUpNodes) {
                 _set->consecutiveFailedScans = 0;
             }
@@ -731,22 +769,23 @@ namespace {
                 continue;
 
             case NextStep::CONTACT_HOST: {
-                BSONObj reply; // empty on error
-                int64_t pingMicros = 0;
-
                 DEV _set->checkInvariants();
-                lk.unlock(); // relocked after attempting to call isMaster
+
+                // Contact the host from its own thread and go on to the next one, so a down host
+                // doesn't hold up the rest of the scan or this caller. Replies wake us up
+                // through the WAIT step.
                 try {
-                    ScopedDbConnection conn(ConnectionString(ns.host), socketTimeoutSecs);
-                    bool ignoredOutParam = false;
-                    Timer timer;
-                    conn->isMaster(ignoredOutParam, &reply);
-                    pingMicros = timer.micros();
-                    conn.done(); // return to pool on success.
+                    boost::thread(boost::bind(&Refresher::_contactHost, _set, _scan, ns.host))
+                        .detach();
+                    continue;
                 }
-                catch (...) {
-                    reply = BSONObj(); // should be a no-op but want to be sure
+                catch (const boost::thread_resource_error&) {
+                    // fall back to contacting the host from this thread
                 }
+
+                int64_t pingMicros = 0;
+                lk.unlock(); // relocked after attempting to call isMaster
+                BSONObj reply = callIsMaster(ns.host, &pingMicros); // empty on error
                 lk.lock();
 
                 // Ignore the reply and return if we are no longer the current scan. This might
@@ -763,6 +802,30 @@ namespace {
         }
     }
 
+    void Refresher::_contactHost(SetStatePtr set, ScanStatePtr scan, HostAndPort host) {
+        int64_t pingMicros = 0;
+        BSONObj reply = callIsMaster(host, &pingMicros); // empty on error
+
+        if (StaticObserver::_destroyingStatics)
+            return;
+
+        boost::mutex::scoped_lock lk(set->mutex);
+
+        // Ignore the reply if we are no longer the current scan, as the inline path does.
+        if (scan != set->currentScan) {
+            set->cv.notify_all();
+            return;
+        }
+
+        Refresher refresher(set); // joins 'scan' since it is current
+        if (reply.isEmpty())
+            refresher.failedHost(host);
+        else
+            refresher.receivedIsMaster(host, pingMicros, reply);
+
+        DEV set->checkInvariants();
+    }
+
     void IsMasterReply::parse(const BSONObj& obj) {
         try {
             raw = obj.getOwned(); // don't use obj again after this line
@@ -859,6 +922,10 @@ namespace {
         , latencyThresholdMicros(serverGlobalParams.defaultLocalThresholdMillis * 1000)
         , rand(int64_t(time(0)))
         , roundRobin(0)
+        , scansCompleted(0)
+        , totalScanMicros(0)
+        , lastScanMicros(0)
+        , scanDurations(numScanDurationBuckets + 1, 0)
     {
         uassert(13642, "Replica set seed list can't be empty", !seedNodes.empty());
 
@@ -991,6 +1058,23 @@ namespace {
         node->update(reply);
     }
 
+    const int SetState::scanDurationBucketMillis[] = {1, 10, 100, 1000, 10000};
+    const int SetState::numScanDurationBuckets =
+        sizeof(scanDurationBucketMillis) / sizeof(scanDurationBucketMillis[0]);
+
+    void SetState::recordScanDuration(int64_t micros) {
+        scansCompleted++;
+        totalScanMicros += micros;
+        lastScanMicros = micros;
+
+        int bucket = 0;
+        while (bucket < numScanDurationBuckets &&
+               micros >= scanDurationBucketMillis[bucket] * 1000LL) {
+            bucket++;
+        }
+        scanDurations[bucket]++;
+    }
+
     std::string SetState::getServerAddress() const {
         StringBuilder ss;
         if (!name.empty())
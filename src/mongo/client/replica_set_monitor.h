@@ -118,7 +118,8 @@ namespace mongo {
         bool contains(const HostAndPort& server) const;
 
         /**
-         * Writes information about our cached view of the set to a BSONObjBuilder.
+         * Writes information about our cached view of the set, and how long refreshing it has
+         * taken, to a BSONObjBuilder.
          */
         void appendInfo(BSONObjBuilder& b) const;
 
@@ -313,6 +314,14 @@ namespace mongo {
          */
         HostAndPort _refreshUntilMatches(const ReadPreferenceSetting* criteria);
 
+        /**
+         * Calls isMaster on a host returned by getNextStep and applies the reply to 'scan', if it
+         * is still the current scan of 'set'. Run on its own thread, so that every host of a
+         * scan is contacted at once and a host that is down only delays its own reply.
+         * Handles own locking.
+         */
+        static void _contactHost(SetStatePtr set, ScanStatePtr scan, HostAndPort host);
+
         // Both pointers are never NULL
         SetStatePtr _set;
         ScanStatePtr _scan; // May differ from _set->currentScan if a new scan has started.
@@ -33,6 +33,7 @@
 #include "mongo/platform/cstdint.h"
 #include "mongo/platform/random.h"
 #include "mongo/util/net/hostandport.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
     struct ReplicaSetMonitor::IsMasterReply {
@@ -141,6 +142,11 @@ namespace mongo {
 
         std::string getServerAddress() const;
 
+        /**
+         * Records how long a completed scan took, for appendInfo().
+         */
+        void recordScanDuration(int64_t micros);
+
         /**
          * Before unlocking, do DEV checkInvariants();
          */
@@ -168,6 +174,16 @@ namespace mongo {
         int64_t latencyThresholdMicros;
         mutable PseudoRandom rand; // only used for host selection to balance load
         mutable int roundRobin; // used when useDeterministicHostSelection is true
+
+        // Upper bounds, in milliseconds, of the buckets of scanDurations. The last bucket holds
+        // everything slower.
+        static const int scanDurationBucketMillis[];
+        static const int numScanDurationBuckets;
+
+        int64_t scansCompleted;
+        int64_t totalScanMicros;
+        int64_t lastScanMicros;
+        std::vector<int64_t> scanDurations; // numScanDurationBuckets + 1 counts
     };
 
     struct ReplicaSetMonitor::ScanState {
@@ -182,6 +198,8 @@ namespace mongo {
         template <typename Container>
         void enqueAllUntriedHosts(const Container& container, PseudoRandom& rand);
 
+        Timer timer; // started when the scan is
+
         // Access to fields is guarded by associated SetState's mutex.
         bool foundUpMaster;
         bool foundAnyUpNodes;
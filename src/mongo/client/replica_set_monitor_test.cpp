@@ -780,3 +780,30 @@ TEST(ReplicaSetMonitorTests, OutOfBandFailedHost) {
         }
     }
 }
+
+// Completed scans are counted in the refresh duration histogram that appendInfo reports
+TEST(ReplicaSetMonitorTests, ScanDurations) {
+    SetStatePtr state = boost::make_shared<SetState>("name", basicSeedsSet);
+    ReplicaSetMonitor rsm(state);
+
+    state->recordScanDuration(500); // 0.5ms
+    state->recordScanDuration(5 * 1000);
+    state->recordScanDuration(5 * 1000);
+    state->recordScanDuration(60 * 1000 * 1000);
+
+    ASSERT_EQUALS(state->scansCompleted, 4);
+    ASSERT_EQUALS(state->lastScanMicros, 60 * 1000 * 1000);
+
+    BSONObjBuilder bob;
+    rsm.appendInfo(bob);
+    BSONObj refreshes = bob.obj()["refreshes"].Obj();
+    ASSERT_EQUALS(refreshes["completed"].numberLong(), 4);
+    ASSERT_EQUALS(refreshes["totalMicros"].numberLong(), 500 + 10 * 1000 + 60 * 1000 * 1000);
+    ASSERT(!refreshes["inProgress"].trueValue());
+
+    BSONObj durations = refreshes["durationMillis"].Obj();
+    ASSERT_EQUALS(durations["lt1"].numberLong(), 1);
+    ASSERT_EQUALS(durations["lt10"].numberLong(), 2);
+    ASSERT_EQUALS(durations["lt100"].numberLong(), 0);
+    ASSERT_EQUALS(durations["gte10000"].numberLong(), 1);
+}
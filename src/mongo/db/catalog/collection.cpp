@@ -70,6 +70,43 @@ namespace mongo {
 
     // ----
 
+    CappedInsertNotifier::CappedInsertNotifier() : _version( 0 ), _dead( false ) {
+    }
+
+    void CappedInsertNotifier::notifyOfInsert() {
+        boost::mutex::scoped_lock lk( _mutex );
+        ++_version;
+        _notifier.notify_all();
+    }
+
+    uint64_t CappedInsertNotifier::getVersion() const {
+        boost::mutex::scoped_lock lk( _mutex );
+        return _version;
+    }
+
+    void CappedInsertNotifier::waitForInsert( uint64_t referenceVersion,
+                                              int timeoutMillis ) const {
+        boost::system_time deadline =
+            boost::get_system_time() + boost::posix_time::milliseconds( timeoutMillis );
+
+        boost::mutex::scoped_lock lk( _mutex );
+        while ( !_dead && _version == referenceVersion ) {
+            if ( !_notifier.timed_wait( lk, deadline ) )
+                return; // timed out
+        }
+    }
+
+    void CappedInsertNotifier::kill() {
+        boost::mutex::scoped_lock lk( _mutex );
+        _dead = true;
+        _notifier.notify_all();
+    }
+
+    bool CappedInsertNotifier::isDead() const {
+        boost::mutex::scoped_lock lk( _mutex );
+        return _dead;
+    }
+
     Collection::Collection( const StringData& fullNS,
                             NamespaceDetails* details,
                             Database* database )
@@ -93,6 +130,10 @@ namespace mongo {
                                                          &database->getExtentManager(),
                                                          _ns.coll() == "system.indexes" ) );
         }
+        if ( details->isCapped() ) {
+            _cappedNotifier.reset( new CappedInsertNotifier() );
+        }
+
         _magic = 1357924;
         _indexCatalog.init();
     }
@@ -100,6 +141,10 @@ namespace mongo {
     Collection::~Collection() {
         verify( ok() );
         _magic = 0;
+
+        if ( _cappedNotifier ) {
+            _cappedNotifier->kill();
+        }
     }
 
     bool Collection::requiresIdIndex() const {
@@ -165,6 +210,10 @@ namespace mongo {
         if ( !loc.isOK() )
             return loc;
 
+        if ( _cappedNotifier ) {
+            _cappedNotifier->notifyOfInsert();
+        }
+
         return StatusWith<DiskLoc>( loc );
     }
 
@@ -194,6 +243,71 @@ namespace mongo {
         return status;
     }
 
+    Status Collection::insertDocuments( const std::vector<BSONObj>& docs,
+                                        bool enforceQuota,
+                                        const PregeneratedKeys* preGen,
+                                        std::vector<DiskLoc>* locs ) {
+        bool oneAtATime = docs.size() < 2 || _details->isCapped();
+        if ( _indexCatalog.findIdIndex() ) {
+            for ( size_t i = 0; i < docs.size(); i++ ) {
+                if ( docs[i]["_id"].eoo() )
+                    oneAtATime = true; // so the error comes at the right document
+            }
+        }
+
+        if ( oneAtATime ) {
+            for ( size_t i = 0; i < docs.size(); i++ ) {
+                StatusWith<DiskLoc> loc = insertDocument( docs[i], enforceQuota,
+                                                          preGen ? &preGen[i] : NULL );
+                if ( !loc.isOK() )
+                    return loc.getStatus();
+                locs->push_back( loc.getValue() );
+            }
+            return Status::OK();
+        }
+
+        if ( preGen ) {
+            for ( size_t i = 0; i < docs.size(); i++ )
+                _indexCatalog.touch( &preGen[i] );
+        }
+
+        std::vector<DiskLoc> newLocs;
+        Status status = _recordStore->insertRecords( docs,
+                                                     enforceQuota ? largestFileNumberInQuota() : 0,
+                                                     &newLocs );
+        if ( !status.isOK() )
+            return status;
+
+        _infoCache.notifyOfWriteOp();
+
+        try {
+            _indexCatalog.indexRecords( docs, newLocs, preGen );
+        }
+        catch ( AssertionException& ) {
+            // none of the batch is in any index now.  find the document that fails, keeping
+            // the ones before it just as single inserts would have
+            for ( size_t i = 0; i < docs.size(); i++ ) {
+                try {
+                    _indexCatalog.indexRecord( docs[i], newLocs[i], preGen ? &preGen[i] : NULL );
+                }
+                catch ( AssertionException& e ) {
+                    for ( size_t j = i; j < newLocs.size(); j++ )
+                        _recordStore->deleteRecord( newLocs[j] );
+                    newLocs.resize( i );
+                    status = e.toStatus( "insertDocuments" );
+                    break;
+                }
+            }
+        }
+
+        for ( size_t i = 0; i < newLocs.size(); i++ ) {
+            _details->paddingFits();
+            locs->push_back( newLocs[i] );
+        }
+
+        return status;
+    }
+
     StatusWith<DiskLoc> Collection::insertDocument( const BSONObj& doc,
                                                     MultiIndexBlock& indexBlock ) {
         StatusWith<DiskLoc> loc = _recordStore->insertRecord( doc.objdata(),
@@ -252,6 +366,10 @@ namespace mongo {
             return StatusWith<DiskLoc>( e.toStatus( "insertDocument" ) );
         }
 
+        if ( _cappedNotifier ) {
+            _cappedNotifier->notifyOfInsert();
+        }
+
         return loc;
     }
 
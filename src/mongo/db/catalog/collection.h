@@ -31,6 +31,8 @@
 #pragma once
 
 #include <string>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include "mongo/base/string_data.h"
 #include "mongo/db/catalog/collection_cursor_cache.h"
@@ -101,6 +103,57 @@ namespace mongo {
         long long corruptDocuments;
     };
 
+    struct OnlineCompactStats {
+        OnlineCompactStats() {
+            recordsMoved = 0;
+            extentsFreed = 0;
+            bytesFreed = 0;
+        }
+
+        long long recordsMoved;
+        int extentsFreed;
+        long long bytesFreed;
+        std::string stopReason; // why the last extent could not be emptied, if it couldn't
+
+        DiskLoc emptyingExtent; // kept off the deleted lists across batches, null between extents
+    };
+
+    /**
+     * Lets tailable awaitData cursors on a capped collection sleep until the next insert, rather
+     * than polling.  Shared with the waiters, so it can outlive its Collection, which kills it
+     * on the way out.
+     */
+    class CappedInsertNotifier {
+    public:
+        CappedInsertNotifier();
+
+        /**
+         * Wakes up everyone waiting.  Called after each insert, with the collection write locked.
+         */
+        void notifyOfInsert();
+
+        /**
+         * Read this before looking for new documents and hand it to waitForInsert(), so that an
+         * insert in between is not missed.
+         */
+        uint64_t getVersion() const;
+
+        /**
+         * Waits until there has been an insert since 'referenceVersion' was read, the collection
+         * went away, or 'timeoutMillis' passed.  Must be called without any locks held.
+         */
+        void waitForInsert( uint64_t referenceVersion, int timeoutMillis ) const;
+
+        void kill();
+        bool isDead() const;
+
+    private:
+        mutable boost::mutex _mutex;
+        mutable boost::condition_variable _notifier;
+        uint64_t _version;
+        bool _dead;
+    };
+
     /**
      * this is NOT safe through a yield right now
      * not sure if it will be, or what yet
@@ -128,6 +181,11 @@ namespace mongo {
 
         CollectionCursorCache* cursorCache() const { return &_cursorCache; }
 
+        /** NULL unless the collection is capped */
+        shared_ptr<CappedInsertNotifier> getCappedInsertNotifier() const {
+            return _cappedNotifier;
+        }
+
         bool requiresIdIndex() const;
 
         BSONObj docFor( const DiskLoc& loc );
@@ -162,6 +220,15 @@ namespace mongo {
 
         StatusWith<DiskLoc> insertDocument( const DocWriter* doc, bool enforceQuota );
 
+        /**
+         * insertDocument() for each of docs, in order, stopping at the first that fails.
+         * preGen is NULL or holds the keys of docs[i] at preGen[i].  locs gets the location of
+         * every document inserted.  the records of the batch share one allocation and the
+         * index keys are inserted sorted; capped collections take the documents one at a time.
+         */
+        Status insertDocuments( const std::vector<BSONObj>& docs, bool enforceQuota,
+                                const PregeneratedKeys* preGen, std::vector<DiskLoc>* locs );
+
         StatusWith<DiskLoc> insertDocument( const BSONObj& doc, MultiIndexBlock& indexBlock );
 
         /**
@@ -181,6 +248,22 @@ namespace mongo {
 
         StatusWith<CompactStats> compact( const CompactOptions* options );
 
+        /**
+         * one batch of an online compact: moves up to maxRecords documents out of the last
+         * extent into free space earlier in the collection, keeping their padding, and frees
+         * the extent once it is empty.  the caller holds the db write lock for the batch only.
+         * the extent stays off the deleted lists from its first batch to its last, see
+         * stopCompactingLastExtent().
+         * @return true if there is more to do
+         */
+        StatusWith<bool> compactLastExtent( int maxRecords, OnlineCompactStats* stats );
+
+        /**
+         * puts the free space of the extent compactLastExtent was emptying back on the deleted
+         * lists.  for when compacting stops between batches, e.g. on an interrupt.
+         */
+        void stopCompactingLastExtent( OnlineCompactStats* stats );
+
         // -----------
 
 
@@ -241,6 +324,8 @@ namespace mongo {
         // should be about the data.
         mutable CollectionCursorCache _cursorCache;
 
+        shared_ptr<CappedInsertNotifier> _cappedNotifier;
+
         friend class Database;
         friend class FlatIterator;
         friend class CappedIterator;
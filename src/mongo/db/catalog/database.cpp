@@ -234,6 +234,8 @@ namespace mongo {
                     }
                     _namespaceIndex.kill_ns( oldFreeList );
                 }
+
+                _markNsSegments();
             }
             _magic = 781231;
         }
@@ -804,6 +806,16 @@ namespace mongo {
             collection = createCollection( _namespacesName );
         StatusWith<DiskLoc> loc = collection->insertDocument( obj, false );
         uassertStatusOK( loc.getStatus() );
+
+        _markNsSegments();
+    }
+
+    void Database::_markNsSegments() {
+        if ( _namespaceIndex.numSegments() <= 1 || _extentManager.numFiles() == 0 )
+            return;
+        DataFileHeader* h = _extentManager.getFile( 0 )->getHeader();
+        if ( !h->hasNsSegments() )
+            h->setHasNsSegments();
     }
 
     Status Database::_dropNS( const StringData& ns ) {
@@ -224,6 +224,9 @@ namespace mongo {
 
         void openAllFiles();
 
+        /** flags data file 0 once the .ns file has overflow segments, see pdfile_version.h */
+        void _markNsSegments();
+
         Status _renameSingleNamespace( const StringData& fromNS, const StringData& toNS,
                                        bool stayTemp );
 
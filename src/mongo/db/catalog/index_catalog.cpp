@@ -1191,6 +1191,37 @@ namespace mongo {
         return index->accessMethod()->insert(obj, loc, options, &inserted, prep );
     }
 
+    Status IndexCatalog::_indexRecords( IndexCatalogEntry* index,
+                                        const std::vector<BSONObj>& docs,
+                                        const std::vector<DiskLoc>& locs,
+                                        const std::vector<const PregeneratedKeysOnIndex*>* prep ) {
+        InsertDeleteOptions options;
+        options.logIfError = false;
+
+        bool isUnique =
+            index->descriptor()->isIdIndex() ||
+            index->descriptor()->unique();
+
+        options.dupsAllowed = ignoreUniqueIndex( index->descriptor() ) || !isUnique;
+
+        int64_t inserted;
+        if ( options.dupsAllowed )
+            return index->accessMethod()->insertMany( docs, locs, options, &inserted, prep );
+
+        // which document a duplicate key error is reported against depends on the order
+        // they go in, so keep insertion order here
+        for ( size_t i = 0; i < docs.size(); i++ ) {
+            Status s = index->accessMethod()->insert( docs[i], locs[i], options, &inserted,
+                                                      prep ? (*prep)[i] : NULL );
+            if ( !s.isOK() ) {
+                for ( size_t j = 0; j <= i; j++ )
+                    _unindexRecord( index, docs[j], locs[j], false );
+                return s;
+            }
+        }
+        return Status::OK();
+    }
+
     Status IndexCatalog::_unindexRecord( IndexCatalogEntry* index,
                                          const BSONObj& obj,
                                          const DiskLoc &loc,
@@ -1276,6 +1307,105 @@ namespace mongo {
 
     }
 
+    void IndexCatalog::indexRecords( const std::vector<BSONObj>& docs,
+                                     const std::vector<DiskLoc>& locs,
+                                     const PregeneratedKeys* preGen ) {
+        invariant( docs.size() == locs.size() );
+
+        for ( IndexCatalogEntryContainer::const_iterator i = _entries.begin();
+              i != _entries.end();
+              ++i ) {
+
+            IndexCatalogEntry* entry = *i;
+
+            std::vector<const PregeneratedKeysOnIndex*> perIndex;
+            if ( preGen ) {
+                for ( size_t k = 0; k < docs.size(); k++ )
+                    perIndex.push_back( preGen[k].get( entry ) );
+            }
+
+            try {
+                Status s = _indexRecords( entry, docs, locs, preGen ? &perIndex : NULL );
+                uassert(s.location(), s.reason(), s.isOK() );
+            }
+            catch ( AssertionException& ae ) {
+
+                LOG(2) << "IndexCatalog::indexRecords failed: " << ae;
+
+                // _indexRecords() already cleaned up entry itself
+                for ( IndexCatalogEntryContainer::const_iterator j = _entries.begin();
+                      *j != entry;
+                      ++j ) {
+
+                    for ( size_t k = 0; k < docs.size(); k++ ) {
+                        try {
+                            _unindexRecord( *j, docs[k], locs[k], false );
+                        }
+                        catch ( DBException& e ) {
+                            LOG(1) << "IndexCatalog::indexRecords rollback failed: " << e;
+                        }
+                    }
+                }
+
+                throw;
+            }
+        }
+
+    }
+
+    Status IndexCatalog::relocateIndexEntries( const BSONObj& obj,
+                                               const DiskLoc& from,
+                                               const DiskLoc& to ) {
+        // while both are in, a unique index holds the key twice
+        InsertDeleteOptions options;
+        options.logIfError = false;
+        options.dupsAllowed = true;
+
+        for ( IndexCatalogEntryContainer::const_iterator i = _entries.begin();
+              i != _entries.end();
+              ++i ) {
+
+            IndexCatalogEntry* entry = *i;
+
+            Status status = Status::OK();
+            try {
+                int64_t inserted;
+                status = entry->accessMethod()->insert( obj, to, options, &inserted, NULL );
+            }
+            catch ( DBException& e ) {
+                status = e.toStatus( "relocateIndexEntries" );
+            }
+
+            if ( !status.isOK() ) {
+                LOG(2) << "IndexCatalog::relocateIndexEntries failed: " << status;
+
+                // entry may hold some of the keys for 'to' as well
+                for ( IndexCatalogEntryContainer::const_iterator j = _entries.begin();
+                      j != _entries.end();
+                      ++j ) {
+                    try {
+                        _unindexRecord( *j, obj, to, false );
+                    }
+                    catch ( DBException& e ) {
+                        LOG(1) << "IndexCatalog::relocateIndexEntries rollback failed: " << e;
+                    }
+
+                    if ( *j == entry )
+                        break;
+                }
+                return status;
+            }
+        }
+
+        for ( IndexCatalogEntryContainer::const_iterator i = _entries.begin();
+              i != _entries.end();
+              ++i ) {
+            _unindexRecord( *i, obj, from, false );
+        }
+
+        return Status::OK();
+    }
+
     void IndexCatalog::unindexRecord( const BSONObj& obj, const DiskLoc& loc, bool noWarn ) {
         for ( IndexCatalogEntryContainer::const_iterator i = _entries.begin();
               i != _entries.end();
@@ -254,8 +254,25 @@ namespace mongo {
         void indexRecord( const BSONObj& obj, const DiskLoc &loc,
                           const PregeneratedKeys* preGen = NULL );
 
+        /**
+         * indexRecord() for several documents, docs[i] being at locs[i], and preGen NULL or
+         * holding the keys of docs[i] at preGen[i].  indexes that allow duplicates get the keys
+         * of all the documents together, sorted; unique ones get them a document at a time.
+         * this throws like indexRecord(), and then none of the documents are in any index.
+         */
+        void indexRecords( const std::vector<BSONObj>& docs, const std::vector<DiskLoc>& locs,
+                           const PregeneratedKeys* preGen = NULL );
+
         void unindexRecord( const BSONObj& obj, const DiskLoc& loc, bool noWarn );
 
+        /**
+         * points the keys of obj in every index at 'to' instead of 'from'.  the keys for 'to' go
+         * in first, duplicates allowed, and those for 'from' only come out once all of them are
+         * in; on failure the keys for 'to' are taken out again and obj is still indexed at
+         * 'from'.  should not throw
+         */
+        Status relocateIndexEntries( const BSONObj& obj, const DiskLoc& from, const DiskLoc& to );
+
         /**
          * checks all unique indexes and checks for conflicts
          * should not throw
@@ -305,6 +322,12 @@ namespace mongo {
                              const BSONObj& obj, const DiskLoc &loc,
                              const PregeneratedKeysOnIndex* pregen );
 
+        // leaves nothing from docs in index on failure
+        Status _indexRecords( IndexCatalogEntry* index,
+                              const std::vector<BSONObj>& docs,
+                              const std::vector<DiskLoc>& locs,
+                              const std::vector<const PregeneratedKeysOnIndex*>* pregen );
+
         Status _unindexRecord( IndexCatalogEntry* index, const BSONObj& obj, const DiskLoc &loc,
                                bool logIfError );
 
@@ -218,8 +218,11 @@ namespace mongo {
                           << endl;
             }
 
-            if ( rec )
+            if ( rec ) {
+                // start reading whatever the plan expects to need next before blocking on rec
+                Record::issuePrefetches();
                 rec->touch();
+            }
 
             lk.reset(0); // need to release this before dbtempreleasecond
         }
@@ -30,6 +30,8 @@
 
 #include "mongo/pch.h"
 
+#include <boost/thread/thread.hpp>
+
 #include "mongo/base/init.h"
 #include "mongo/base/status.h"
 #include "mongo/bson/util/builder.h"
@@ -121,10 +123,70 @@ namespace mongo {
         return res;
     }
 
-    Cloner::Cloner() { }
+    Cloner::Cloner() : _progress( NULL ) { }
+
+    void CloneProgress::reset() {
+        collectionsToClone.store( 0 );
+        collectionsCloned.store( 0 );
+        collectionsInProgress.store( 0 );
+        maxCollectionsInProgress.store( 0 );
+        documentsCloned.store( 0 );
+        bytesCloned.store( 0 );
+        startMillis.store( curTimeMillis64() );
+    }
+
+    void CloneProgress::append( BSONObjBuilder& b ) const {
+        long long elapsedMillis = curTimeMillis64() - startMillis.load();
+        long long documents = documentsCloned.load();
+        long long bytes = bytesCloned.load();
+
+        b.appendNumber( "collectionsToClone", collectionsToClone.load() );
+        b.appendNumber( "collectionsCloned", collectionsCloned.load() );
+        b.appendNumber( "collectionsInProgress", collectionsInProgress.load() );
+        b.appendNumber( "maxCollectionsInProgress", maxCollectionsInProgress.load() );
+        b.appendNumber( "documentsCloned", documents );
+        b.appendNumber( "bytesCloned", bytes );
+        b.appendNumber( "elapsedMillis", elapsedMillis );
+        if ( elapsedMillis > 0 ) {
+            b.appendNumber( "documentsPerSec", documents * 1000 / elapsedMillis );
+            b.appendNumber( "bytesPerSec", bytes * 1000 / elapsedMillis );
+        }
+    }
+
+    void CloneProgress::collectionStarted() {
+        long long now = collectionsInProgress.addAndFetch( 1 );
+        long long max = maxCollectionsInProgress.load();
+        while ( now > max ) {
+            long long old = maxCollectionsInProgress.compareAndSwap( max, now );
+            if ( old == max )
+                break;
+            max = old;
+        }
+    }
+
+    void CloneProgress::collectionFinished() {
+        collectionsInProgress.subtractAndFetch( 1 );
+    }
+
+    namespace {
+        /** counts a collection as being copied for as long as it is in scope */
+        class CollectionInProgress : boost::noncopyable {
+        public:
+            explicit CollectionInProgress( CloneProgress* progress ) : _progress( progress ) {
+                if ( _progress )
+                    _progress->collectionStarted();
+            }
+            ~CollectionInProgress() {
+                if ( _progress )
+                    _progress->collectionFinished();
+            }
+        private:
+            CloneProgress* _progress;
+        };
+    }
 
     struct Cloner::Fun {
-        Fun( Client::Context& ctx ) : lastLog(0), context( ctx ) { }
+        Fun( Client::Context& ctx ) : lastLog(0), context( ctx ), progress( NULL ) { }
 
         void operator()( DBClientCursorBatchIterator &i ) {
             Lock::GlobalWrite lk;
@@ -197,6 +259,11 @@ namespace mongo {
                 if ( logForRepl )
                     logOp("i", to_collection, js);
 
+                if ( progress ) {
+                    progress->documentsCloned.fetchAndAdd( 1 );
+                    progress->bytesCloned.fetchAndAdd( js.objsize() );
+                }
+
                 getDur().commitIfNeeded();
 
                 RARELY if ( time( 0 ) - saveLast > 60 ) {
@@ -218,6 +285,7 @@ namespace mongo {
         bool logForRepl;
         bool _mayYield;
         bool _mayBeInterrupted;
+        CloneProgress* progress;
     };
 
     /* copy the specified collection
@@ -241,6 +309,7 @@ namespace mongo {
         f.logForRepl = logForRepl;
         f._mayYield = mayYield;
         f._mayBeInterrupted = mayBeInterrupted;
+        f.progress = _progress;
 
         int options = QueryOption_NoCursorTimeout | ( slaveOk ? QueryOption_SlaveOk : 0 );
         {
@@ -346,6 +415,160 @@ namespace mongo {
 
     extern bool inDBRepair;
 
+    bool Cloner::cloneCollection(Client::Context& context, const BSONObj& collection,
+                                 const string& todb, const CloneOptions& opts,
+                                 bool masterSameProcess, string& errmsg) {
+        LOG(2) << "  really will clone: " << collection << endl;
+        const char * from_name = collection["name"].valuestr();
+        BSONObj options = collection.getObjectField("options");
+
+        /* change name "<fromdb>.collection" -> <todb>.collection */
+        const char *p = strchr(from_name, '.');
+        verify(p);
+        string to_name = todb + p;
+
+        {
+            string err;
+            const char *toname = to_name.c_str();
+            /* we defer building id index for performance - building it in batch is much faster */
+            bool createStatus = userCreateNS(toname, options, err, opts.logForRepl, false);
+            if ( !createStatus ) {
+                errmsg = str::stream() << "failed to create collection \"" << to_name << "\": "
+                                       << err;
+                return false;
+            }
+        }
+
+        LOG(1) << "\t\t cloning " << from_name << " -> " << to_name << endl;
+        CollectionInProgress inProgress( opts.progress );
+        Query q;
+        if( opts.snapshot )
+            q.snapshot();
+        copy(context,from_name, to_name.c_str(), false, opts.logForRepl, masterSameProcess,
+             opts.slaveOk, opts.mayYield, opts.mayBeInterrupted, q);
+
+        {
+            /* we need dropDups to be true as we didn't do a true snapshot and this is before applying oplog operations
+               that occur during the initial sync.  inDBRepair makes dropDups be true.
+               */
+            bool old = inDBRepair;
+            try {
+                inDBRepair = true;
+                Collection* c = cc().database()->getCollection( to_name );
+                if ( c )
+                    c->getIndexCatalog()->ensureHaveIdIndex();
+                inDBRepair = old;
+            }
+            catch(...) {
+                inDBRepair = old;
+                throw;
+            }
+        }
+
+        if ( opts.progress )
+            opts.progress->collectionsCloned.fetchAndAdd( 1 );
+        return true;
+    }
+
+    struct Cloner::ParallelCloneState {
+        ParallelCloneState( const list<BSONObj>& colls )
+            : mutex( "ParallelCloneState" ), toClone( colls ), failed( false ) {
+        }
+
+        void fail( const string& msg ) {
+            scoped_lock lk( mutex );
+            if ( !failed ) {
+                failed = true;
+                errmsg = msg;
+            }
+        }
+
+        // protects everything below
+        mongo::mutex mutex;
+        list<BSONObj> toClone;
+        bool failed;
+        string errmsg;
+    };
+
+    void Cloner::parallelCloneWorker(ParallelCloneState* state, const string& masterHost,
+                                     const string& todb, const CloneOptions* opts) {
+        Client::initThread("clonerWorker");
+        cc().getAuthorizationSession()->grantInternalAuthorization();
+
+        try {
+            Cloner cloner;
+            cloner._progress = opts->progress;
+
+            string errmsg;
+            ConnectionString cs = ConnectionString::parse( masterHost, errmsg );
+            auto_ptr<DBClientBase> con( cs.connect( errmsg ) );
+            if ( !con.get() ) {
+                state->fail( str::stream() << "couldn't connect to " << masterHost << ": "
+                                           << errmsg );
+            }
+            else if ( !replAuthenticate( con.get() ) ) {
+                state->fail( str::stream() << "couldn't authenticate to " << masterHost );
+            }
+            else {
+                cloner._conn = con;
+            }
+
+            while ( cloner._conn.get() ) {
+                BSONObj collection;
+                {
+                    scoped_lock lk( state->mutex );
+                    if ( state->failed || state->toClone.empty() )
+                        break;
+                    collection = state->toClone.front();
+                    state->toClone.pop_front();
+                }
+
+                string toName = todb + strchr( collection["name"].valuestr(), '.' );
+                Client::WriteContext ctx( toName );
+                if ( !cloner.cloneCollection( ctx.ctx(), collection, todb, *opts, false,
+                                              errmsg ) ) {
+                    state->fail( errmsg );
+                    break;
+                }
+            }
+        }
+        catch ( const DBException& e ) {
+            state->fail( e.toString() );
+        }
+        catch ( const std::exception& e ) {
+            state->fail( e.what() );
+        }
+
+        cc().shutdown();
+    }
+
+    bool Cloner::cloneCollectionsInParallel(Client::Context& context, const string& masterHost,
+                                            const list<BSONObj>& toClone, const string& todb,
+                                            const CloneOptions& opts, string& errmsg) {
+        ParallelCloneState state( toClone );
+        int numWorkers = std::min( opts.parallelCollections, static_cast<int>( toClone.size() ) );
+
+        LOG(1) << "\t\t cloning " << toClone.size() << " collections with " << numWorkers
+               << " threads" << endl;
+
+        {
+            dbtemprelease r;
+            boost::thread_group workers;
+            for ( int i = 0; i < numWorkers; i++ ) {
+                workers.create_thread( boost::bind( &Cloner::parallelCloneWorker, &state,
+                                                    masterHost, todb, &opts ) );
+            }
+            workers.join_all();
+        }
+        context.relocked();
+
+        if ( state.failed ) {
+            errmsg = state.errmsg;
+            return false;
+        }
+        return true;
+    }
+
     bool Cloner::go(Client::Context& context,
                     const string& masterHost, const CloneOptions& opts, set<string>* clonedColls,
                     string& errmsg, int* errCode) {
@@ -388,6 +611,8 @@ namespace mongo {
             }
         }
 
+        _progress = opts.progress;
+
         string systemNamespacesNS = opts.fromDB + ".system.namespaces";
 
         list<BSONObj> toClone;
@@ -465,56 +690,22 @@ namespace mongo {
             }
         }
 
-        for ( list<BSONObj>::iterator i=toClone.begin(); i != toClone.end(); i++ ) {
-            {
-                mayInterrupt( opts.mayBeInterrupted );
-                dbtempreleaseif r( opts.mayYield );
-            }
-            BSONObj collection = *i;
-            LOG(2) << "  really will clone: " << collection << endl;
-            const char * from_name = collection["name"].valuestr();
-            BSONObj options = collection.getObjectField("options");
-
-            /* change name "<fromdb>.collection" -> <todb>.collection */
-            const char *p = strchr(from_name, '.');
-            verify(p);
-            string to_name = todb + p;
-
-            {
-                string err;
-                const char *toname = to_name.c_str();
-                /* we defer building id index for performance - building it in batch is much faster */
-                bool createStatus = userCreateNS(toname, options, err, opts.logForRepl, false);
-                if ( !createStatus ) {
-                    errmsg = str::stream() << "failed to create collection \"" << to_name << "\": "
-                                           << err;
-                    return false;
-                }
-            }
-
-            LOG(1) << "\t\t cloning " << from_name << " -> " << to_name << endl;
-            Query q;
-            if( opts.snapshot )
-                q.snapshot();
-            copy(context,from_name, to_name.c_str(), false, opts.logForRepl, masterSameProcess,
-                 opts.slaveOk, opts.mayYield, opts.mayBeInterrupted, q);
+        if ( opts.progress )
+            opts.progress->collectionsToClone.fetchAndAdd( toClone.size() );
 
-            {
-                /* we need dropDups to be true as we didn't do a true snapshot and this is before applying oplog operations
-                   that occur during the initial sync.  inDBRepair makes dropDups be true.
-                   */
-                bool old = inDBRepair;
-                try {
-                    inDBRepair = true;
-                    Collection* c = cc().database()->getCollection( to_name );
-                    if ( c )
-                        c->getIndexCatalog()->ensureHaveIdIndex();
-                    inDBRepair = old;
-                }
-                catch(...) {
-                    inDBRepair = old;
-                    throw;
+        if ( opts.parallelCollections > 1 && opts.mayYield && !masterSameProcess &&
+             toClone.size() > 1 ) {
+            if ( !cloneCollectionsInParallel( context, masterHost, toClone, todb, opts, errmsg ) )
+                return false;
+        }
+        else {
+            for ( list<BSONObj>::iterator i=toClone.begin(); i != toClone.end(); i++ ) {
+                {
+                    mayInterrupt( opts.mayBeInterrupted );
+                    dbtempreleaseif r( opts.mayYield );
                 }
+                if ( !cloneCollection( context, *i, todb, opts, masterSameProcess, errmsg ) )
+                    return false;
             }
         }
 
@@ -33,10 +33,12 @@
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/client.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/platform/atomic_word.h"
 
 namespace mongo {
 
     struct CloneOptions;
+    struct CloneProgress;
     class DBClientBase;
     class DBClientCursor;
     class Query;
@@ -93,8 +95,54 @@ namespace mongo {
                   bool masterSameProcess, bool slaveOk, bool mayYield, bool mayBeInterrupted,
                   Query q);
 
+        /**
+         * Creates the collection described by the system.namespaces entry 'collection' in todb,
+         * copies its documents and builds its _id index.
+         */
+        bool cloneCollection(Client::Context& ctx, const BSONObj& collection, const string& todb,
+                             const CloneOptions& opts, bool masterSameProcess, string& errmsg);
+
+        /**
+         * Clones the collections in 'toClone' with opts.parallelCollections threads, each with
+         * its own connection to masterHost.  The caller's lock is released meanwhile.
+         */
+        bool cloneCollectionsInParallel(Client::Context& ctx, const string& masterHost,
+                                        const list<BSONObj>& toClone, const string& todb,
+                                        const CloneOptions& opts, string& errmsg);
+
+        struct ParallelCloneState;
+        static void parallelCloneWorker(ParallelCloneState* state, const string& masterHost,
+                                        const string& todb, const CloneOptions* opts);
+
         struct Fun;
         auto_ptr<DBClientBase> _conn;
+        CloneProgress* _progress;
+    };
+
+    /**
+     * Counters for watching a long running clone, such as the one done by initial sync.  Updated
+     * concurrently by the threads doing the clone.
+     */
+    struct CloneProgress {
+        CloneProgress() { reset(); }
+
+        /** zeroes the counters and restarts the clock */
+        void reset();
+
+        /** appends the counters and the document and byte rates since reset() */
+        void append( BSONObjBuilder& b ) const;
+
+        /** a thread starts or stops copying a collection */
+        void collectionStarted();
+        void collectionFinished();
+
+        AtomicInt64 collectionsToClone;
+        AtomicInt64 collectionsCloned;
+        AtomicInt64 collectionsInProgress;
+        AtomicInt64 maxCollectionsInProgress; // most collections copied at once since reset()
+        AtomicInt64 documentsCloned;
+        AtomicInt64 bytesCloned;
+        AtomicInt64 startMillis;
     };
 
     struct CloneOptions {
@@ -109,6 +157,9 @@ namespace mongo {
 
             syncData = true;
             syncIndexes = true;
+
+            parallelCollections = 1;
+            progress = NULL;
         }
 
         string fromDB;
@@ -123,6 +174,13 @@ namespace mongo {
 
         bool syncData;
         bool syncIndexes;
+
+        // Number of collections to copy at once, each over its own connection.  Only honoured
+        // when cloning from another process with mayYield set.
+        int parallelCollections;
+
+        // If set, counts the collections, documents and bytes copied.
+        CloneProgress* progress;
     };
 
 } // namespace mongo
@@ -324,6 +324,7 @@ namespace mongo {
 }
 
 #include "mongo/client/connpool.h"
+#include "mongo/s/shard.h"
 
 namespace mongo {
 
@@ -369,6 +370,7 @@ namespace mongo {
         }
         virtual bool run(const string&, mongo::BSONObj&, int, std::string&, mongo::BSONObjBuilder& result, bool) {
             pool.appendInfo( result );
+            ShardConnection::appendSharedPoolInfo( result );
             result.append( "numDBClientConnection" , DBClientConnection::getNumConnections() );
             result.append( "numAScopedConnection" , AScopedConnection::getNumConnections() );
             return true;
@@ -147,9 +147,9 @@ namespace mutablebson {
         virtual void redactForLogging(mutablebson::Document* cmdObj);
 
         /* Return true if a replica set secondary should go into "recovering"
-           (unreadable) state while running this command.
+           (unreadable) state while running this command with these arguments.
          */
-        virtual bool maintenanceMode() const { return false; }
+        virtual bool maintenanceMode( const BSONObj& cmdObj ) const { return false; }
 
         /* Return true if command should be permitted when a replica set secondary is in "recovering"
            (unreadable) state.
@@ -54,7 +54,10 @@ namespace mongo {
         virtual LockType locktype() const { return NONE; }
         virtual bool adminOnly() const { return false; }
         virtual bool slaveOk() const { return true; }
-        virtual bool maintenanceMode() const { return true; }
+        virtual bool maintenanceMode( const BSONObj& cmdObj ) const {
+            // an online compact leaves the collection readable throughout
+            return !cmdObj["online"].trueValue();
+        }
         virtual bool logTheOp() { return false; }
         virtual void addRequiredPrivileges(const std::string& dbname,
                                            const BSONObj& cmdObj,
@@ -67,8 +70,11 @@ namespace mongo {
             help << "compact collection\n"
                 "warning: this operation locks the database and is slow. you can cancel with killOp()\n"
                 "{ compact : <collection_name>, [force:<bool>], [validate:<bool>],\n"
-                "  [paddingFactor:<num>], [paddingBytes:<num>] }\n"
+                "  [paddingFactor:<num>], [paddingBytes:<num>], [online:<bool>], [batchSize:<num>] }\n"
                 "  force - allows to run on a replica set primary\n"
+                "  online - move documents out of the last extents into free space earlier in the\n"
+                "           collection, batchSize documents per write lock, and free the emptied\n"
+                "           extents. keeps padding and indexes; allowed on a primary\n"
                 "  validate - check records are noncorrupt before adding to newly compacting extents. slower but safer (defaults to true in this version)\n";
         }
         CompactCmd() : Command("compact") { }
@@ -90,7 +96,9 @@ namespace mongo {
                 return false;
             }
 
-            if( isCurrentlyAReplSetPrimary() && !cmdObj["force"].trueValue() ) {
+            bool online = cmdObj["online"].trueValue();
+
+            if( isCurrentlyAReplSetPrimary() && !cmdObj["force"].trueValue() && !online ) {
                 errmsg = "will not run compact on an active replica set primary as this is a slow blocking operation. use force:true to force";
                 return false;
             }
@@ -108,6 +116,9 @@ namespace mongo {
                 return false;
             }
 
+            if ( online )
+                return runOnline( ns, cmdObj, errmsg, result );
+
             CompactOptions compactOptions;
 
             if ( cmdObj["preservePadding"].trueValue() ) {
@@ -174,6 +185,76 @@ namespace mongo {
 
             return true;
         }
+
+    private:
+        bool runOnline( const NamespaceString& ns, const BSONObj& cmdObj, string& errmsg,
+                        BSONObjBuilder& result ) {
+            if ( cmdObj.hasElement( "paddingFactor" ) || cmdObj.hasElement( "paddingBytes" ) ) {
+                errmsg = "online compact keeps each document's padding";
+                return false;
+            }
+
+            int batchSize = 1000;
+            if ( cmdObj.hasElement( "batchSize" ) ) {
+                batchSize = cmdObj["batchSize"].numberInt();
+                if ( batchSize < 1 ) {
+                    errmsg = "invalid batchSize";
+                    return false;
+                }
+            }
+
+            log() << "compact " << ns << " online begin, batchSize: " << batchSize;
+
+            OnlineCompactStats stats;
+            int batches = 0;
+            bool more = true;
+            while ( more ) {
+                // the lock is only held for a batch, so everything is looked up again each time
+                Lock::DBWrite lk(ns.ns());
+                Client::Context ctx(ns);
+
+                Collection* collection = ctx.db()->getCollection(ns.ns());
+                if( ! collection ) {
+                    errmsg = "namespace does not exist";
+                    return false;
+                }
+
+                if ( collection->isCapped() ) {
+                    errmsg = "cannot compact a capped collection";
+                    return false;
+                }
+
+                StatusWith<bool> status( false );
+                try {
+                    // checked with the lock held, so that the space of the extent being emptied
+                    // can be given back on the way out.  nothing was written yet this batch.
+                    killCurrentOp.checkForInterrupt( false );
+                    BackgroundOperation::assertNoBgOpInProgForNs(ns.ns());
+                    status = collection->compactLastExtent( batchSize, &stats );
+                }
+                catch ( ... ) {
+                    collection->stopCompactingLastExtent( &stats );
+                    throw;
+                }
+                if ( !status.isOK() )
+                    return appendCommandStatus( result, status.getStatus() );
+                more = status.getValue();
+                batches++;
+
+                getDur().commitIfNeeded();
+            }
+
+            result.append( "recordsMoved", stats.recordsMoved );
+            result.append( "extentsFreed", stats.extentsFreed );
+            result.append( "bytesFreed", stats.bytesFreed );
+            result.append( "batches", batches );
+            if ( !stats.stopReason.empty() )
+                result.append( "note", stats.stopReason );
+
+            log() << "compact " << ns << " online end, moved " << stats.recordsMoved
+                  << " documents, freed " << stats.extentsFreed << " extents";
+            return true;
+        }
     };
     static CompactCmd compactCmd;
 
@@ -43,11 +43,15 @@
 #include "mongo/db/instance.h"
 #include "mongo/db/kill_current_op.h"
 #include "mongo/db/matcher.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/value.h"
 #include "mongo/db/query/get_runner.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/repl/is_master.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/range_preserver.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/scripting/engine.h"
 #include "mongo/s/collection_metadata.h"
@@ -60,6 +64,9 @@ namespace mongo {
 
     namespace mr {
 
+        // memory the final reduce's external sorter may use before it writes a run to disk
+        MONGO_EXPORT_SERVER_PARAMETER(internalMapReduceSorterMaxMemoryBytes, int, 100 * 1024 * 1024);
+
         AtomicUInt Config::JOB_NUMBER;
 
         JSFunction::JSFunction( const std::string& type , const BSONElement& e ) {
@@ -239,6 +246,186 @@ namespace mongo {
             _reduce( x , key , endSizeEstimate );
         }
 
+        NativeMapper::NativeMapper( const BSONElement& spec ) : _state( NULL ), _reducer( NULL ) {
+            uassert( 28601 , "map must be javascript code or an object of expressions" ,
+                     spec.type() == Object );
+
+            VariablesIdGenerator idGenerator;
+            VariablesParseState vps( &idGenerator );
+            BSONForEach( e , spec.Obj() ) {
+                if ( str::equals( e.fieldName() , "key" ) ) {
+                    _key = Expression::parseOperand( e , vps )->optimize();
+                }
+                else if ( str::equals( e.fieldName() , "value" ) ) {
+                    uassert( 28602 , "native map value must be an object of expressions" ,
+                             e.type() == Object );
+                    _value = Expression::parseOperand( e , vps )->optimize();
+                }
+                else {
+                    uasserted( 28603 , str::stream() << "unknown native map field: "
+                                                     << e.fieldName() );
+                }
+            }
+            uassert( 28604 , "native map must specify both key and value" , _key && _value );
+
+            _variables.reset( new Variables( idGenerator.getIdCount() ) );
+        }
+
+        void NativeMapper::init( State * state ) {
+            _state = state;
+            _reducer = dynamic_cast<const NativeReducer*>( state->config().reducer.get() );
+            verify( _reducer );
+        }
+
+        /**
+         * Evaluates the key and value expressions against an object and emits a single tuple
+         * {"0": key, "1": value}, with value already in mergeable form.
+         */
+        void NativeMapper::map( const BSONObj& o ) {
+            _variables->setRoot( Document( o ) );
+            const Value key = _key->evaluate( _variables.get() );
+            const Value value = _value->evaluate( _variables.get() );
+            uassert( 28605 , str::stream() << "native map value must evaluate to an object, not "
+                                           << typeName( value.getType() ) ,
+                     value.getType() == Object );
+
+            BSONObjBuilder b;
+            if ( key.missing() || key.getType() == Undefined )
+                b.appendNull( "0" );
+            else
+                key.addToBsonObj( &b , "0" );
+            b.append( "1" , _reducer->toPartial( value.getDocument() ).toBson() );
+            BSONObj tuple = b.obj();
+
+            uassert( 28634 , "an emit can't be more than half max bson size" ,
+                     tuple.objsize() < ( BSONObjMaxUserSize / 2 ) );
+            _state->emit( tuple );
+        }
+
+        NativeReducer::NativeReducer( const BSONElement& spec ) : _finalOutputMergeable( false ) {
+            uassert( 28606 , "a native map requires reduce to be an object of $group operators" ,
+                     spec.type() == Object );
+
+            BSONForEach( e , spec.Obj() ) {
+                uassert( 28607 , str::stream() << "native reduce field '" << e.fieldName()
+                                               << "' must name a $group operator, e.g. \"$sum\"" ,
+                         e.type() == String );
+
+                DocumentSourceGroup::AccumulatorFactory factory =
+                    DocumentSourceGroup::getAccumulatorFactory( e.valuestr() );
+                uassert( 28608 , str::stream() << "unknown group operator '" << e.valuestr() << "'" ,
+                         factory );
+
+                _fields.push_back( e.fieldName() );
+                _accumulators.push_back( factory() );
+            }
+            uassert( 28609 , "native reduce must specify at least one field" , !_fields.empty() );
+        }
+
+        void NativeReducer::init( State * state ) {
+            // shards must hand mergeable values to the mapreduce.shardedfinish pass
+            _finalOutputMergeable = state->config().shardedFirstPass;
+        }
+
+        Document NativeReducer::toPartial( const Document& mapped ) const {
+            MutableDocument out( _fields.size() );
+            for ( size_t i = 0; i < _fields.size(); i++ ) {
+                _accumulators[i]->reset();
+                _accumulators[i]->process( mapped[_fields[i]] , false );
+                out.addField( _fields[i] , _accumulators[i]->getValue( true ) );
+            }
+            return out.freeze();
+        }
+
+        bool NativeReducer::hasDistinctFinalForm() const {
+            for ( size_t i = 0; i < _accumulators.size(); i++ ) {
+                if ( str::equals( _accumulators[i]->getOpName() , "$avg" ) )
+                    return true;
+            }
+            return false;
+        }
+
+        BSONObj NativeReducer::reduce( const BSONList& tuples ) {
+            if ( tuples.size() <= 1 )
+                return tuples[0];
+            return _reduce( tuples , true , "0" , "1" );
+        }
+
+        /**
+         * Unlike JSReducer, a single tuple still goes through the accumulators so that its value
+         * is converted from mergeable to final form.
+         */
+        BSONObj NativeReducer::finalReduce( const BSONList& tuples , Finalizer * finalizer ) {
+            BSONObj res = _reduce( tuples , _finalOutputMergeable , "_id" , "value" );
+
+            if ( finalizer ) {
+                res = finalizer->finalize( res );
+            }
+
+            return res;
+        }
+
+        BSONObj NativeReducer::_reduce( const BSONList& tuples , bool toBeMerged ,
+                                        const char* keyName , const char* valueName ) {
+            uassert( 28635 ,  "need values" , tuples.size() );
+
+            for ( size_t i = 0; i < _accumulators.size(); i++ ) {
+                _accumulators[i]->reset();
+            }
+
+            BSONElement key;
+            for ( BSONList::const_iterator it = tuples.begin(); it != tuples.end(); ++it ) {
+                BSONObjIterator j( *it );
+                BSONElement keyE = j.next();
+                if ( it == tuples.begin() )
+                    key = keyE;
+
+                BSONElement valueE = j.next();
+                uassert( 28610 , "native reduce values must be objects" , valueE.type() == Object );
+                const Document value( valueE.embeddedObject() );
+                for ( size_t i = 0; i < _fields.size(); i++ ) {
+                    _accumulators[i]->process( value[_fields[i]] , true );
+                }
+            }
+            if ( tuples.size() > 1 )
+                ++numReduces;
+
+            BSONObjBuilder b;
+            b.appendAs( key , keyName );
+            BSONObjBuilder valueBuilder( b.subobjStart( valueName ) );
+            for ( size_t i = 0; i < _fields.size(); i++ ) {
+                _accumulators[i]->getValue( toBeMerged ).addToBsonObj( &valueBuilder , _fields[i] );
+            }
+            valueBuilder.done();
+            return b.obj();
+        }
+
+        NativeFinalizer::NativeFinalizer( const BSONElement& spec ) {
+            uassert( 28611 , "a native map requires finalize to be an expression" ,
+                     spec.type() == Object || spec.type() == String );
+
+            VariablesIdGenerator idGenerator;
+            VariablesParseState vps( &idGenerator );
+            _expression = Expression::parseOperand( spec , vps )->optimize();
+            _variables.reset( new Variables( idGenerator.getIdCount() ) );
+        }
+
+        /**
+         * Evaluates the finalize expression against {_id: key, value: val}
+         * Returns tuple obj {_id: key, value: newval}
+         */
+        BSONObj NativeFinalizer::finalize( const BSONObj& o ) {
+            BSONObjIterator it( o );
+            const BSONElement key = it.next();
+            const BSONElement value = it.next();
+            _variables->setRoot( Document( BSON( "_id" << key << "value" << value ) ) );
+
+            BSONObjBuilder b;
+            b.append( key );
+            _expression->evaluate( _variables.get() ).addToBsonObj( &b , "value" );
+            return b.obj();
+        }
+
         Config::Config( const string& _dbname , const BSONObj& cmdObj )
         {
             dbname = _dbname;
@@ -253,6 +440,7 @@ namespace mongo {
             jsMaxKeys = 500000;
             reduceTriggerRatio = 10.0;
             maxInMemSize = 500 * 1024;
+            maxSorterMemSize = internalMapReduceSorterMaxMemoryBytes;
 
             uassert( 13602 , "outType is no longer a valid option" , cmdObj["outType"].eoo() );
 
@@ -273,7 +461,6 @@ namespace mongo {
                         << cmdObj.firstElement().String()
                         << "_"
                         << JOB_NUMBER++;
-                incLong = tempNamespace + "_inc";
             }
 
             {
@@ -282,10 +469,25 @@ namespace mongo {
                 if ( cmdObj["scope"].type() == Object )
                     scopeSetup = cmdObj["scope"].embeddedObjectUserCheck();
 
-                mapper.reset( new JSMapper( cmdObj["map"] ) );
-                reducer.reset( new JSReducer( cmdObj["reduce"] ) );
-                if ( cmdObj["finalize"].type() && cmdObj["finalize"].trueValue() )
-                    finalizer.reset( new JSFinalizer( cmdObj["finalize"] ) );
+                nativeMode = cmdObj["map"].type() == Object;
+                if ( nativeMode ) {
+                    NativeReducer* nativeReducer = new NativeReducer( cmdObj["reduce"] );
+                    reducer.reset( nativeReducer );
+                    mapper.reset( new NativeMapper( cmdObj["map"] ) );
+                    if ( cmdObj["finalize"].type() && cmdObj["finalize"].trueValue() )
+                        finalizer.reset( new NativeFinalizer( cmdObj["finalize"] ) );
+
+                    // existing output values are in final form and can't be merged again
+                    uassert( 28612 , "reduce output is not supported with $avg in a native reduce" ,
+                             outputOptions.outType != REDUCE ||
+                                     !nativeReducer->hasDistinctFinalForm() );
+                }
+                else {
+                    mapper.reset( new JSMapper( cmdObj["map"] ) );
+                    reducer.reset( new JSReducer( cmdObj["reduce"] ) );
+                    if ( cmdObj["finalize"].type() && cmdObj["finalize"].trueValue() )
+                        finalizer.reset( new JSFinalizer( cmdObj["finalize"] ) );
+                }
 
                 if ( cmdObj["mapparams"].type() == Array ) {
                     mapParams = cmdObj["mapparams"].embeddedObjectUserCheck();
@@ -316,22 +518,13 @@ namespace mongo {
         }
 
         /**
-         * Clean up the temporary and incremental collections
+         * Clean up the temporary collection
          */
         void State::dropTempCollections() {
             // Dropping the tempNamespace must be logged as that collection is replicated.
             _db.dropCollection(_config.tempNamespace);
             // Always forget about temporary namespaces, so we don't cache lots of them
             ShardConnection::forgetNS( _config.tempNamespace );
-            if (_useIncremental) {
-                // We don't want to log the deletion of incLong as it isn't replicated. While
-                // harmless, this would lead to a scary looking warning on the secondaries.
-                Client::WriteContext ctx(_config.incLong);
-                ctx.ctx().db()->dropCollection(_config.incLong);
-
-                ShardConnection::forgetNS( _config.incLong );
-            }
-
         }
 
         /**
@@ -342,26 +535,6 @@ namespace mongo {
                 return;
 
             dropTempCollections();
-            if (_useIncremental) {
-                // Create the inc collection and make sure we have index on "0" key.
-                // Intentionally not replicating the inc collection to secondaries.
-                Client::WriteContext incCtx( _config.incLong );
-                Collection* incColl = incCtx.ctx().db()->getCollection( _config.incLong );
-                if ( !incColl ) {
-                    CollectionOptions options;
-                    options.setNoIdIndex();
-                    options.temp = true;
-                    incColl = incCtx.ctx().db()->createCollection( _config.incLong, options );
-                }
-
-                BSONObj indexSpec = BSON( "key" << BSON( "0" << 1 ) << "ns" << _config.incLong
-                                          << "name" << "_temp_0" );
-                Status status = incColl->getIndexCatalog()->createIndex( indexSpec, false );
-                if ( !status.isOK() ) {
-                    uasserted( 17305 , str::stream() << "createIndex failed for mr incLong ns: " <<
-                            _config.incLong << " err: " << status.code() );
-                }
-            }
 
             vector<BSONObj> indexesToInsert;
 
@@ -636,24 +809,44 @@ namespace mongo {
             logOp( "i", ns.c_str(), bo );
         }
 
+        namespace {
+            /**
+             * Orders spilled tuples by key, as TupleKeyCmp does for the in memory map.
+             */
+            class SpilledTupleCmp {
+            public:
+                typedef pair<BSONObj, BSONObj> Data;
+                int operator()( const Data& l, const Data& r ) const {
+                    return l.first.firstElement().woCompare( r.first.firstElement() );
+                }
+            };
+        }
+
         /**
-         * Insert doc into the inc collection. This should not be replicated.
+         * Add tuple to the external sorter. Nothing is written to a collection or the journal.
          */
-        void State::_insertToInc( BSONObj& o ) {
+        void State::_addToSorter( const BSONObj& tuple ) {
             verify( _onDisk );
 
-            Client::WriteContext ctx( _config.incLong );
-            Collection* coll = getCollectionOrUassert(ctx.ctx().db(), _config.incLong);
-            uassertStatusOK( coll->insertDocument( o, true ).getStatus() );
-            getDur().commitIfNeeded();
+            if ( !_sorter ) {
+                _sorter.reset( TupleSorter::make(
+                                   SortOptions().TempDir( storageGlobalParams.dbpath + "/_tmp" )
+                                                .ExtSortAllowed()
+                                                .MaxMemoryUsageBytes( _config.maxSorterMemSize ),
+                                   SpilledTupleCmp() ) );
+            }
+
+            _sorter->add( tuple , BSONObj() );
+            _numSpilled++;
         }
 
         State::State(const Config& c) :
                 _config(c),
-                _useIncremental(true),
                 _size(0),
                 _dupCount(0),
-                _numEmits(0) {
+                _numEmits(0),
+                _numSpilled(0),
+                _numSpillFiles(0) {
             _temp.reset( new InMemory() );
             _onDisk = _config.outputOptions.outType != Config::INMEMORY;
         }
@@ -693,6 +886,16 @@ namespace mongo {
          * Initialize the mapreduce operation, creating the inc collection
          */
         void State::init() {
+            if ( _config.nativeMode ) {
+                // nothing runs in javascript, so don't pay for a scope
+                _config.mapper->init( this );
+                _config.reducer->init( this );
+                if ( _config.finalizer )
+                    _config.finalizer->init( this );
+                _jsMode = false;
+                return;
+            }
+
             // setup js
             const string userToken = ClientBasic::getCurrent()->getAuthorizationSession()
                                                               ->getAuthenticatedUserNamesToken();
@@ -895,7 +1098,8 @@ namespace mongo {
 
             if ( ! _onDisk ) {
                 // all data has already been reduced, just finalize
-                if ( _config.finalizer ) {
+                // native values also need converting from their mergeable form
+                if ( _config.finalizer || _config.nativeMode ) {
                     long size = 0;
                     for ( InMemory::iterator i=_temp->begin(); i!=_temp->end(); ++i ) {
                         BSONObj key = i->first;
@@ -903,7 +1107,9 @@ namespace mongo {
 
                         verify( all.size() == 1 );
 
-                        BSONObj res = _config.finalizer->finalize( all[0] );
+                        BSONObj res = _config.nativeMode ?
+                            _config.reducer->finalReduce( all , _config.finalizer.get() ) :
+                            _config.finalizer->finalize( all[0] );
 
                         all.clear();
                         all.push_back( res );
@@ -914,98 +1120,44 @@ namespace mongo {
                 return;
             }
 
-            // use index on "0" to pull sorted data
+            // merge the sorted runs and reduce each key's tuples together
             verify( _temp->size() == 0 );
-            BSONObj sortKey = BSON( "0" << 1 );
-
-            {
-                Client::WriteContext incCtx( _config.incLong );
-                Collection* incColl = getCollectionOrUassert(incCtx.ctx().db(), _config.incLong );
-
-                bool foundIndex = false;
-                IndexCatalog::IndexIterator ii =
-                    incColl->getIndexCatalog()->getIndexIterator( true );
-                // Iterate over incColl's indexes.
-                while ( ii.more() ) {
-                    IndexDescriptor* currIndex = ii.next();
-                    BSONObj x = currIndex->infoObj();
-                    if ( sortKey.woCompare( x["key"].embeddedObject() ) == 0 ) {
-                        foundIndex = true;
-                        break;
-                    }
-                }
-
-                verify( foundIndex );
-            }
-
-            Client::ReadContext ctx( _config.incLong );
-
-            BSONObj prev;
-            BSONList all;
 
             verify(pm == op->setMessage("m/r: (3/3) final reduce to collection",
                                         "M/R: (3/3) Final Reduce Progress",
-                                        _db.count(_config.incLong, BSONObj(), QueryOption_SlaveOk)));
-
-            CanonicalQuery* cq;
-            verify(CanonicalQuery::canonicalize(_config.incLong, BSONObj(), sortKey, BSONObj(), &cq).isOK());
+                                        _numSpilled));
 
-            Runner* rawRunner;
-            verify(getRunner(cq, &rawRunner, QueryPlannerParams::NO_TABLE_SCAN).isOK());
+            if ( !_sorter ) {
+                pm.finished();
+                return;
+            }
 
-            auto_ptr<Runner> runner(rawRunner);
-            const ScopedRunnerRegistration safety(runner.get());
-            runner->setYieldPolicy(Runner::YIELD_AUTO);
+            const scoped_ptr<TupleSorter::Iterator> sorted( _sorter->done() );
+            _numSpillFiles = _sorter->numFiles();
+            _sorter.reset();
 
-            // iterate over all sorted objects
-            BSONObj o;
-            Runner::RunnerState state;
-            while (Runner::RUNNER_ADVANCED == (state = runner->getNext(&o, NULL))) {
-                o = o.getOwned(); // we will be accessing outside of the lock
+            BSONList all;
+            while ( sorted->more() ) {
+                const TupleSorter::Data next = sorted->next();
                 pm.hit();
 
-                if ( o.woSortOrder( prev , sortKey ) == 0 ) {
-                    // object is same as previous, add to array
-                    all.push_back( o );
-                    if ( pm->hits() % 100 == 0 ) {
-                        killCurrentOp.checkForInterrupt();
-                    }
-                    continue;
-                }
-
-                runner->saveState();
-
-                // can't be a smart pointer since it needs throw annotation on destructor
-                dbtempreleasecond* yield = new dbtempreleasecond();
-
-                try {
+                if ( !all.empty() &&
+                        all.back().firstElement().woCompare( next.first.firstElement() ) != 0 ) {
                     // reduce a finalize array
                     finalReduce( all );
+                    all.clear();
+                    killCurrentOp.checkForInterrupt();
                 }
-                catch (...) {
-                    delete yield; // if throws, replaces current exception rather than terminating.
-                    throw;
-                }
-                delete yield;
-
-                all.clear();
-                prev = o;
-                all.push_back( o );
-
-                if (!runner->restoreState()) {
-                    break;
+                else if ( pm->hits() % 100 == 0 ) {
+                    killCurrentOp.checkForInterrupt();
                 }
 
-                killCurrentOp.checkForInterrupt();
+                // unowned data is only valid until the next call to the iterator
+                all.push_back( next.first.getOwned() );
             }
 
-            {
-                dbtempreleasecond tl;
-                if ( ! tl.unlocked() )
-                    warning() << "map/reduce can't temp release" << endl;
-                // reduce and finalize last array
-                finalReduce( all );
-            }
+            // reduce and finalize last array
+            finalReduce( all );
 
             pm.finished();
         }
@@ -1033,8 +1185,8 @@ namespace mongo {
                 if ( all.size() == 1 ) {
                     // only 1 value for this key
                     if ( _onDisk ) {
-                        // this key has low cardinality, so just write to collection
-                        _insertToInc( *(all.begin()) );
+                        // this key has low cardinality, so just spill it
+                        _addToSorter( all[0] );
                     }
                     else {
                         // add to new map
@@ -1054,21 +1206,19 @@ namespace mongo {
         }
 
         /**
-         * Dumps the entire in memory map to the inc collection.
+         * Dumps the entire in memory map to the external sorter.
          */
-        void State::dumpToInc() {
+        void State::dumpToSorter() {
             if ( ! _onDisk )
                 return;
 
-            Lock::DBWrite kl(_config.incLong);
-
             for ( InMemory::iterator i=_temp->begin(); i!=_temp->end(); i++ ) {
                 BSONList& all = i->second;
                 if ( all.size() < 1 )
                     continue;
 
                 for ( BSONList::iterator j=all.begin(); j!=all.end(); j++ )
-                    _insertToInc( *j );
+                    _addToSorter( *j );
             }
             _temp->clear();
             _size = 0;
@@ -1130,8 +1280,8 @@ namespace mongo {
 
                 // if size is still high, or values are not reducing well, dump
                 if ( _onDisk && (_size > _config.maxInMemSize || _size > oldSize / 2) ) {
-                    dumpToInc();
-                    LOG(1) << "  MR - dumping to db" << endl;
+                    dumpToSorter();
+                    LOG(1) << "  MR - dumping to sorter" << endl;
                 }
             }
         }
@@ -1209,7 +1359,8 @@ namespace mongo {
 
                 LOG(1) << "mr ns: " << config.ns << endl;
 
-                uassert( 16149 , "cannot run map reduce without the js engine", globalScriptEngine );
+                uassert( 16149 , "cannot run map reduce without the js engine",
+                         config.nativeMode || globalScriptEngine );
 
                 CollectionMetadataPtr collMetadata;
 
@@ -1368,14 +1519,15 @@ namespace mongo {
                     // do reduce in memory
                     // this will be the last reduce needed for inline mode
                     state.reduceInMemory();
-                    // if not inline: dump the in memory map to inc collection, all data is on disk
-                    state.dumpToInc();
+                    // if not inline: dump the in memory map to the sorter, all data is spilled
+                    state.dumpToSorter();
                     // final reduce
                     state.finalReduce( op , pm );
                     reduceTime += rt.micros();
                     countsBuilder.appendNumber( "reduce" , state.numReduces() );
                     timingBuilder.appendNumber("reduceTime", reduceTime / 1000);
                     timingBuilder.append( "mode" , state.jsMode() ? "js" : "mixed" );
+                    timingBuilder.appendNumber( "spillFiles" , state.numSpillFiles() );
 
                     long long finalCount = state.postProcessCollection(op, pm);
                     state.appendResults( result );
@@ -1453,10 +1605,6 @@ namespace mongo {
                 State state(config);
                 state.init();
 
-                // no need for incremental collection because records are already sorted
-                state._useIncremental = false;
-                config.incLong = config.tempNamespace;
-
                 BSONObj shardCounts = cmdObj["shardCounts"].embeddedObjectUserCheck();
                 BSONObj counts = cmdObj["counts"].embeddedObjectUserCheck();
 
@@ -1500,9 +1648,9 @@ namespace mongo {
                 if ( confOut->isSharded(config.outputOptions.finalNamespace) ) {
                     ChunkManagerPtr cm = confOut->getChunkManager(
                             config.outputOptions.finalNamespace);
-                    const ChunkMap& chunkMap = cm->getChunkMap();
-                    for ( ChunkMap::const_iterator it = chunkMap.begin(); it != chunkMap.end(); ++it ) {
-                        ChunkPtr chunk = it->second;
+                    const vector<ChunkPtr>& allChunks = cm->getChunks();
+                    for ( vector<ChunkPtr>::const_iterator it = allChunks.begin(); it != allChunks.end(); ++it ) {
+                        ChunkPtr chunk = *it;
                         if (chunk->getShard().getName() == shardName) chunks.push_back(chunk);
                     }
                 }
@@ -1587,3 +1735,5 @@ namespace mongo {
 
 }
 
+#include "mongo/db/sorter/sorter.cpp"
+// Explicit instantiation unneeded since we aren't exposing Sorter outside of this file.
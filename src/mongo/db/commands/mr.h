@@ -38,6 +38,9 @@
 #include "mongo/db/curop.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/pipeline/accumulator.h"
+#include "mongo/db/pipeline/expression.h"
+#include "mongo/db/sorter/sorter.h"
 #include "mongo/scripting/engine.h"
 
 namespace mongo {
@@ -154,6 +157,84 @@ namespace mongo {
 
         };
 
+        // ------------  native (aggregation expression) implementations -----------
+
+        /**
+         * Reduces with $group accumulators instead of javascript.
+         * The spec is an object of the form { <field>: "<$group operator>", ... }, for example
+         * { total: "$sum", maxQty: "$max" }. Each field of the emitted values is combined with its
+         * operator.
+         *
+         * Tuple values are always kept in the accumulators' mergeable form, so they can be reduced
+         * any number of times. They are only converted to their final form by finalReduce(),
+         * unless this is the first pass of a sharded map/reduce.
+         */
+        class NativeReducer : public Reducer {
+        public:
+            NativeReducer( const BSONElement& spec );
+            virtual void init( State * state );
+
+            virtual BSONObj reduce( const BSONList& tuples );
+            virtual BSONObj finalReduce( const BSONList& tuples , Finalizer * finalizer );
+
+            /**
+             * Converts a value produced by NativeMapper into the mergeable form kept in tuples.
+             */
+            Document toPartial( const Document& mapped ) const;
+
+            /** @return true if the final form of some field differs from its mergeable form */
+            bool hasDistinctFinalForm() const;
+
+        private:
+            /**
+             * Merges the values of tuples (key, value) and returns {"0": key, "1": value}, with
+             * value in mergeable form if toBeMerged is true and in final form otherwise.
+             */
+            BSONObj _reduce( const BSONList& tuples , bool toBeMerged , const char* keyName ,
+                             const char* valueName );
+
+            vector<string> _fields;
+            vector<intrusive_ptr<Accumulator> > _accumulators;
+            bool _finalOutputMergeable; // true for the first pass of a sharded map/reduce
+        };
+
+        /**
+         * Maps with aggregation expressions instead of javascript.
+         * The spec is an object of the form { key: <expression>, value: { <field>: <expression>,
+         * ... } } and emits exactly one (key, value) pair per input document.
+         */
+        class NativeMapper : public Mapper {
+        public:
+            NativeMapper( const BSONElement& spec );
+            virtual void init( State * state );
+
+            virtual void map( const BSONObj& o );
+
+        private:
+            intrusive_ptr<Expression> _key;
+            intrusive_ptr<Expression> _value;
+            scoped_ptr<Variables> _variables;
+
+            State * _state;
+            const NativeReducer * _reducer;
+        };
+
+        /**
+         * Finalizes with an aggregation expression instead of javascript. The expression is
+         * evaluated against {_id: key, value: val} and its result replaces val.
+         */
+        class NativeFinalizer : public Finalizer {
+        public:
+            NativeFinalizer( const BSONElement& spec );
+            virtual void init( State * state ) {}
+
+            virtual BSONObj finalize( const BSONObj& tuple );
+
+        private:
+            intrusive_ptr<Expression> _expression;
+            scoped_ptr<Variables> _variables;
+        };
+
         // -----------------
 
 
@@ -180,6 +261,7 @@ namespace mongo {
             // options
             bool verbose;
             bool jsMode;
+            bool nativeMode; // map, reduce and finalize are aggregation expressions, not js
             int splitInfo;
 
             // query options
@@ -198,7 +280,6 @@ namespace mongo {
             BSONObj scopeSetup;
 
             // output tables
-            string incLong;
             string tempNamespace;
 
             enum OutputType {
@@ -224,6 +305,8 @@ namespace mongo {
             float reduceTriggerRatio;
             // maximum size of map before it gets dumped to disk
             long maxInMemSize;
+            // memory the external sorter may use before writing a sorted run to disk
+            size_t maxSorterMemSize;
 
             // true when called from mongos to do phase-1 of M/R
             bool shardedFirstPass;
@@ -257,10 +340,10 @@ namespace mongo {
             /**
             * Checks the size of the transient in-memory results accumulated so far and potentially
             * runs reduce in order to compact them. If the data is still too large, it will be 
-            * spilled to the output collection.
+            * spilled to the external sorter.
             *
-            * NOTE: Make sure that no DB locks are held, when calling this function, because it may
-            * try to acquire write DB lock for the write to the output collection.
+            * NOTE: Make sure that no DB locks are held, when calling this function, because the
+            * spill may write sorted runs to disk.
             */
             void reduceAndSpillInMemoryStateIfNeeded();
 
@@ -270,11 +353,9 @@ namespace mongo {
             void reduceInMemory();
 
             /**
-             * transfers in memory storage to temp collection
+             * transfers in memory storage to the external sorter
              */
-            void dumpToInc();
-            void insertToInc( BSONObj& o );
-            void _insertToInc( BSONObj& o );
+            void dumpToSorter();
 
             // ------ reduce stage -----------
 
@@ -321,6 +402,7 @@ namespace mongo {
 
             long long numEmits() const { if (_jsMode) return _scope->getNumberLongLong("_emitCt"); return _numEmits; }
             long long numReduces() const { if (_jsMode) return _scope->getNumberLongLong("_redCt"); return _config.reducer->numReduces; }
+            int numSpillFiles() const { return _numSpillFiles; }
             long long numInMemKeys() const { if (_jsMode) return _scope->getNumberLongLong("_keyCt"); return _temp->size(); }
 
             bool jsMode() {return _jsMode;}
@@ -331,10 +413,16 @@ namespace mongo {
 
             const Config& _config;
             DBDirectClient _db;
-            bool _useIncremental;   // use an incremental collection
 
         protected:
 
+            typedef Sorter<BSONObj, BSONObj> TupleSorter;
+
+            /**
+             * Adds a tuple {"0": key, "1": val} to the external sorter, creating it if needed.
+             */
+            void _addToSorter( const BSONObj& tuple );
+
             /**
              * Appends a new document to the in-memory list of tuples, which are under that
              * document's key.
@@ -352,6 +440,12 @@ namespace mongo {
 
             long long _numEmits;
 
+            // Tuples spilled from _temp, in sorted runs on disk. The final reduce merges the runs
+            // and reduces each key's tuples together. Only the sort keys (the tuples) are used.
+            scoped_ptr<TupleSorter> _sorter;
+            long long _numSpilled; // tuples added to _sorter
+            int _numSpillFiles; // runs the sorter wrote to disk
+
             bool _jsMode;
             ScriptingFunction _reduceAll;
             ScriptingFunction _reduceAndEmit;
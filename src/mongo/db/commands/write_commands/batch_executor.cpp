@@ -87,6 +87,10 @@ namespace mongo {
     // TODO: Determine queueing behavior we want here
     MONGO_EXPORT_SERVER_PARAMETER( queueForMigrationCommit, bool, true );
 
+    // Consecutive valid documents of an insert batch, up to this many, go to the collection
+    // together.  1 inserts them one at a time.
+    MONGO_EXPORT_SERVER_PARAMETER( insertGroupMaxDocs, int, 64 );
+
     using mongoutils::str::stream;
 
     WriteBatchExecutor::WriteBatchExecutor( const BSONObj& wc,
@@ -618,6 +622,11 @@ namespace mongo {
                               const PregeneratedKeys* pregen,
                               WriteOpResult* result );
 
+    static void groupInsert( const std::vector<BSONObj>& docsToInsert,
+                             Collection* collection,
+                             const PregeneratedKeys* pregen,
+                             WriteOpResult* result );
+
     static void singleCreateIndex( const BSONObj& indexDesc,
                                    Collection* collection,
                                    WriteOpResult* result );
@@ -786,6 +795,37 @@ namespace mongo {
         }
     }
 
+    // Returns how many of the inserts starting at state.currIndex can go to the collection as
+    // one group: they must all be valid documents, and the group is capped in size
+    static size_t insertGroupSize( const WriteBatchExecutor::ExecInsertsState& state ) {
+        static const int maxGroupBytes = 1024 * 1024;
+
+        if ( state.request->isInsertIndexRequest() )
+            return 1;
+
+        size_t maxDocs = std::max( insertGroupMaxDocs, 1 );
+        size_t count = 0;
+        int bytes = 0;
+        for ( size_t i = state.currIndex;
+              i < state.normalizedInserts.size() && count < maxDocs;
+              ++i ) {
+
+            const StatusWith<BSONObj>& normalizedInsert = state.normalizedInserts[i];
+            if ( !normalizedInsert.isOK() )
+                break;
+
+            int size = normalizedInsert.getValue().isEmpty() ?
+                state.request->getInsertRequest()->getDocumentsAt( i ).objsize() :
+                normalizedInsert.getValue().objsize();
+            if ( count > 0 && bytes + size > maxGroupBytes )
+                break;
+
+            bytes += size;
+            ++count;
+        }
+        return count;
+    }
+
     void WriteBatchExecutor::execInserts( const BatchedCommandRequest& request,
                                           std::vector<WriteErrorDetail*>* errors ) {
 
@@ -808,6 +848,9 @@ namespace mongo {
         // particularly on operation interruption.  These kinds of errors necessarily prevent
         // further insertOne calls, and stop the batch.  As a result, the only expected source of
         // such exceptions are interruptions.
+        //
+        // Runs of valid documents are inserted as groups instead, by insertGroup(), which works
+        // the same way for several documents at once and moves state.currIndex past them.
         ExecInsertsState state(&request);
         normalizeInserts(request, &state.normalizedInserts, &state.pregeneratedKeys);
 
@@ -833,7 +876,13 @@ namespace mongo {
             }
 
             WriteErrorDetail* error = NULL;
-            execOneInsert(&state, &error);
+            size_t groupSize = insertGroupSize(state);
+            if (groupSize > 1) {
+                execInsertGroup(&state, groupSize, &error);
+            }
+            else {
+                execOneInsert(&state, &error);
+            }
             if (error) {
                 errors->push_back(error);
                 error->setIndex(state.currIndex);
@@ -1049,6 +1098,97 @@ namespace mongo {
         }
     }
 
+    static void insertGroup(WriteBatchExecutor::ExecInsertsState* state,
+                            size_t count,
+                            WriteOpResult* result) {
+        invariant(state->currIndex + count <= state->normalizedInserts.size());
+
+        std::vector<BSONObj> insertDocs;
+        for (size_t i = state->currIndex; i < state->currIndex + count; ++i) {
+            const StatusWith<BSONObj>& normalizedInsert(state->normalizedInserts[i]);
+            invariant(normalizedInsert.isOK());
+            insertDocs.push_back(normalizedInsert.getValue().isEmpty() ?
+                                 state->request->getInsertRequest()->getDocumentsAt( i ) :
+                                 normalizedInsert.getValue());
+        }
+
+        const PregeneratedKeys* pregen = NULL;
+        if ( state->pregeneratedKeys.size() >= state->currIndex + count )
+            pregen = &state->pregeneratedKeys[state->currIndex];
+
+        cc().clearHasWrittenThisOperation();
+        {
+            PageFaultRetryableSection pageFaultSection;
+            while (true) {
+                try {
+                    if (!state->lockAndCheck(result)) {
+                        break;
+                    }
+
+                    groupInsert(insertDocs, state->getCollection(), pregen, result);
+                    break;
+                }
+                catch (const DBException& ex) {
+                    Status status(ex.toStatus());
+                    if (ErrorCodes::isInterruption(status.code()))
+                        throw;
+                    result->setError(toWriteError(status));
+                    break;
+                }
+                catch (PageFaultException& pfe) {
+                    state->unlock();
+                    pfe.touch();
+                    continue;  // Try the operation again.
+                }
+                fassertFailed(28633);
+            }
+        } // end PageFaultRetryableSection
+
+        // Errors release the write lock, as a matter of policy.
+        if (result->getError())
+            state->unlock();
+    }
+
+    void WriteBatchExecutor::execInsertGroup(ExecInsertsState* state,
+                                             size_t count,
+                                             WriteErrorDetail** error) {
+        // The group is one operation, reported under its first document
+        size_t first = state->currIndex;
+        BatchItemRef firstInsertItem(state->request, first);
+        scoped_ptr<CurOp> currentOp(beginCurrentOp(_client, firstInsertItem));
+
+        WriteOpResult result;
+        insertGroup(state, count, &result);
+
+        if (state->hasLock()) {
+            // See execOneInsert()
+            state->getLock().recordTime();
+            state->getLock().resetTime();
+        }
+
+        // Count the inserts that were attempted; those after a failure in an unordered batch
+        // are attempted again by execInserts()
+        size_t inserted = result.getStats().n;
+        size_t attempted = result.getError() ? inserted + 1 : count;
+        for (size_t i = 0; i < attempted; ++i) {
+            incOpStats(firstInsertItem);
+        }
+
+        incWriteStats(firstInsertItem,
+                      result.getStats(),
+                      result.getError(),
+                      currentOp.get());
+        finishCurrentOp(_client, currentOp.get(), result.getError());
+
+        if (result.getError()) {
+            *error = result.releaseError();
+            state->currIndex = first + inserted;
+        }
+        else {
+            state->currIndex = first + count - 1;
+        }
+    }
+
     /**
      * Perform a single insert into a collection.  Requires the insert be preprocessed and the
      * collection already has been created.
@@ -1076,6 +1216,60 @@ namespace mongo {
         }
     }
 
+    /**
+     * Logs the first locs.size() documents of a group insert, the ones that went in, and counts
+     * them in the result.
+     */
+    static void logGroupInserted( const string& insertNS,
+                                  const std::vector<BSONObj>& docsToInsert,
+                                  const std::vector<DiskLoc>& locs,
+                                  WriteOpResult* result ) {
+        for ( size_t i = 0; i < locs.size(); ++i ) {
+            logOp( "i", insertNS.c_str(), docsToInsert[i] );
+        }
+        if ( !locs.empty() ) {
+            getDur().commitIfNeeded();
+        }
+        result->getStats().n = locs.size();
+    }
+
+    /**
+     * Insert several documents into a collection in order, stopping at the first that fails.
+     * Same requirements as singleInsert().  Every document that went in is logged, even if a
+     * later one throws.  Interruptions are rethrown, as from singleInsert().
+     *
+     * Might fault or error, otherwise populates the result.
+     */
+    static void groupInsert( const std::vector<BSONObj>& docsToInsert,
+                             Collection* collection,
+                             const PregeneratedKeys* pregen,
+                             WriteOpResult* result ) {
+
+        const string& insertNS = collection->ns().ns();
+
+        Lock::assertWriteLocked( insertNS );
+
+        std::vector<DiskLoc> locs;
+        Status status = Status::OK();
+        try {
+            status = collection->insertDocuments( docsToInsert, true, pregen, &locs );
+        }
+        catch ( const DBException& ex ) {
+            if ( ErrorCodes::isInterruption( ex.getCode() ) ) {
+                // the documents already in stay, so they still go to the oplog
+                logGroupInserted( insertNS, docsToInsert, locs, result );
+                throw;
+            }
+            status = ex.toStatus();
+        }
+
+        logGroupInserted( insertNS, docsToInsert, locs, result );
+
+        if ( !status.isOK() ) {
+            result->setError(toWriteError(status));
+        }
+    }
+
     /**
      * Perform a single index insert into a collection.  Requires the index descriptor be
      * preprocessed and the collection already has been created.
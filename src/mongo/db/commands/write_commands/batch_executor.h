@@ -95,6 +95,13 @@ namespace mongo {
          */
         void execOneInsert( ExecInsertsState* state, WriteErrorDetail** error );
 
+        /**
+         * Executes the next "count" inserts of a batch as one write to the collection, stopping
+         * at the first that fails.  Leaves state->currIndex at the failed insert, or at the last
+         * of the group.
+         */
+        void execInsertGroup( ExecInsertsState* state, size_t count, WriteErrorDetail** error );
+
         /**
          * Executes an update item (which may update many documents or upsert), and returns the
          * upserted _id on upsert or error on failure.
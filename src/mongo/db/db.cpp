@@ -72,6 +72,7 @@
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/stats/snapshots.h"
 #include "mongo/db/storage/storage_engine_metadata.h"
+#include "mongo/db/storage/working_set_snapshot.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/db/ttl.h"
 #include "mongo/platform/process_id.h"
@@ -751,6 +752,7 @@ namespace mongo {
 
         d.clientCursorMonitor.go();
         PeriodicTask::startRunningPeriodicTasks();
+        startWorkingSetSnapshots();
         if (missingRepl) {
             // a warning was logged earlier
         }
@@ -770,7 +772,7 @@ namespace mongo {
 
         authindex::configureSystemIndexes("admin");
 
-        getDeleter()->startWorkers();
+        getDeleter()->startWorkers(rangeDeleterWorkers);
 
         // Starts a background thread that rebuilds all incomplete indices. 
         indexRebuilder.go(); 
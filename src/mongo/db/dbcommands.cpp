@@ -221,7 +221,7 @@ namespace mongo {
         virtual bool slaveOk() const {
             return true;
         }
-        virtual bool maintenanceMode() const { return true; }
+        virtual bool maintenanceMode( const BSONObj& cmdObj ) const { return true; }
         virtual void help( stringstream& help ) const {
             help << "repair database.  also compacts. note: slow.";
         }
@@ -1071,8 +1071,8 @@ namespace mongo {
 
             int numExtents;
             BSONArrayBuilder extents;
-            result.appendNumber( "storageSize",
-                                 static_cast<long long>( collection->storageSize( &numExtents , verbose ? &extents : 0  ) / scale ) );
+            long long storageSize = collection->storageSize( &numExtents , verbose ? &extents : 0  );
+            result.appendNumber( "storageSize", storageSize / scale );
             result.append( "numExtents" , numExtents );
             result.append( "nindexes" , collection->getIndexCatalog()->numIndexesReady() );
 
@@ -1090,6 +1090,9 @@ namespace mongo {
                 result.append( "capped" , collection->isCapped() );
                 result.appendNumber( "max" , nsd->maxCappedDocs() );
             }
+            else {
+                nsd->appendDeletedListStats( &result, storageSize, scale );
+            }
 
             if ( verbose )
                 result.appendArray( "extents" , extents.arr() );
@@ -1294,7 +1297,7 @@ namespace mongo {
             result.appendNumber( "indexSize" , indexSize / scale );
             if ( d ) {
                 result.appendNumber( "fileSize" , d->fileSize() / scale );
-                result.appendNumber( "nsSizeMB", (int) d->namespaceIndex().fileLength() / 1024 / 1024 );
+                result.appendNumber( "nsSizeMB", (int) ( d->namespaceIndex().fileLength() / 1024 / 1024 ) );
             }
             else {
                 result.appendNumber( "fileSize" , 0 );
@@ -1532,7 +1535,7 @@ namespace mongo {
 
         client.curop()->setCommand(c);
 
-        if (c->maintenanceMode() && theReplSet) {
+        if (c->maintenanceMode(cmdObj) && theReplSet) {
             mmSetter.reset(new MaintenanceModeSetter());
         }
 
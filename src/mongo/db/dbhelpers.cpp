@@ -41,6 +41,7 @@
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/json.h"
 #include "mongo/db/index/btree_access_method.h"
+#include "mongo/db/kill_current_op.h"
 #include "mongo/db/ops/delete.h"
 #include "mongo/db/ops/update.h"
 #include "mongo/db/ops/update_lifecycle_impl.h"
@@ -53,6 +54,7 @@
 #include "mongo/db/repl/is_master.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/write_concern.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/s/d_logic.h"
@@ -61,6 +63,13 @@ namespace mongo {
 
     const BSONObj reverseNaturalObj = BSON( "$natural" << -1 );
 
+    // Number of documents removeRange() deletes each time it takes the write lock.
+    MONGO_EXPORT_SERVER_PARAMETER(removeRangeBatchSize, int, 100);
+
+    // How many seconds removeRange() may run ahead of replication to a majority of the set
+    // before it pauses.  0 turns this off.
+    MONGO_EXPORT_SERVER_PARAMETER(removeRangeMaxLagSecs, int, 10);
+
     void Helpers::ensureIndex(const char *ns, BSONObj keyPattern, bool unique, const char *name) {
         Database* db = cc().database();
         verify(db);
@@ -361,15 +370,17 @@ namespace mongo {
         
         long long millisWaitingForReplication = 0;
 
-        while ( 1 ) {
+        // Optimes of earlier batches, to tell how far majority replication is behind.
+        std::deque<std::pair<Date_t, OpTime> > batchOps;
+
+        bool done = false;
+        while ( !done ) {
             // Scoping for write lock.
             {
                 Client::WriteContext ctx(ns);
                 Collection* collection = ctx.ctx().db()->getCollection( ns );
                 if ( !collection ) break;
 
-                int oldYieldCount = c.curop()->numYields();
-
                 IndexDescriptor* desc =
                     collection->getIndexCatalog()->findIndexByKeyPattern( indexKeyPattern.toBSON() );
 
@@ -380,13 +391,40 @@ namespace mongo {
 
                 runner->setYieldPolicy(Runner::YIELD_AUTO);
 
-                DiskLoc rloc;
+                // Gather a batch of documents to delete under this lock.  The runner may yield,
+                // after which only the documents found since are known to still be there.
+                const size_t batchSize = std::max(1, removeRangeBatchSize);
+                vector<pair<DiskLoc, BSONObj> > batch;
+                Runner::RunnerState state = Runner::RUNNER_ADVANCED;
                 BSONObj obj;
-                Runner::RunnerState state;
+                bool yielded = false;
+                while ( batch.size() < batchSize ) {
+                    int oldYieldCount = c.curop()->numYields();
+
+                    DiskLoc rloc;
+                    state = runner->getNext(&obj, &rloc);
+
+                    // Checked whatever getNext returned: it may have yielded before reaching
+                    // the end, too.
+                    int newYieldCount = c.curop()->numYields();
+                    if (oldYieldCount != newYieldCount) {
+                        if (!_isMaster()) {
+                            warning() << "current node is not primary anymore, "
+                                      << "aborting removeRange" << endl;
+                            return numDeleted;
+                        }
+                        batch.clear();
+                        yielded = true;
+                    }
+
+                    if (Runner::RUNNER_ADVANCED != state) {
+                        break;
+                    }
+
+                    batch.push_back(make_pair(rloc, obj));
+                }
                 // This may yield so we cannot touch nsd after this.
-                state = runner->getNext(&obj, &rloc);
                 runner.reset();
-                if (Runner::RUNNER_EOF == state) { break; }
 
                 if (Runner::RUNNER_DEAD == state) {
                     warning() << "cursor died: aborting deletion for "
@@ -403,62 +441,104 @@ namespace mongo {
                     break;
                 }
 
-                verify(Runner::RUNNER_ADVANCED == state);
-
-                int newYieldCount = c.curop()->numYields();
-                if (oldYieldCount != newYieldCount && !_isMaster()) {
-                    warning() << "current node is not primary anymore, "
-                              << "aborting removeRange" << endl;
-                    return numDeleted;
+                if (Runner::RUNNER_EOF == state) {
+                    // Documents dropped from the batch after a yield need another pass.
+                    done = !yielded;
                 }
 
-                if ( onlyRemoveOrphanedDocs ) {
-                    // Do a final check in the write lock to make absolutely sure that our
-                    // collection hasn't been modified in a way that invalidates our migration
-                    // cleanup.
+                collection = c.database()->getCollection( ns );
+                if ( !collection ) break;
 
+                CollectionMetadataPtr metadataNow;
+                if ( onlyRemoveOrphanedDocs && !batch.empty() ) {
                     // We should never be able to turn off the sharding state once enabled, but
                     // in the future we might want to.
                     verify(shardingState.enabled());
 
                     // In write lock, so will be the most up-to-date version
-                    CollectionMetadataPtr metadataNow = shardingState.getCollectionMetadata( ns );
-
-                    bool docIsOrphan;
-                    if ( metadataNow ) {
-                        KeyPattern kp( metadataNow->getKeyPattern() );
-                        BSONObj key = kp.extractSingleKey( obj );
-                        docIsOrphan = !metadataNow->keyBelongsToMe( key )
-                            && !metadataNow->keyIsPending( key );
-                    }
-                    else {
-                        docIsOrphan = false;
-                    }
+                    metadataNow = shardingState.getCollectionMetadata( ns );
+                }
 
-                    if ( !docIsOrphan ) {
-                        warning() << "aborting migration cleanup for chunk " << min << " to " << max
-                                  << ( metadataNow ? (string) " at document " + obj.toString() : "" )
-                                  << ", collection " << ns << " has changed " << endl;
-                        break;
+                for ( size_t i = 0; i < batch.size(); i++ ) {
+                    const DiskLoc& rloc = batch[i].first;
+                    const BSONObj& obj = batch[i].second;
+
+                    if ( onlyRemoveOrphanedDocs ) {
+                        // Do a final check in the write lock to make absolutely sure that our
+                        // collection hasn't been modified in a way that invalidates our
+                        // migration cleanup.
+                        bool docIsOrphan;
+                        if ( metadataNow ) {
+                            KeyPattern kp( metadataNow->getKeyPattern() );
+                            BSONObj key = kp.extractSingleKey( obj );
+                            docIsOrphan = !metadataNow->keyBelongsToMe( key )
+                                && !metadataNow->keyIsPending( key );
+                        }
+                        else {
+                            docIsOrphan = false;
+                        }
+
+                        if ( !docIsOrphan ) {
+                            warning() << "aborting migration cleanup for chunk " << min << " to " << max
+                                      << ( metadataNow ? (string) " at document " + obj.toString() : "" )
+                                      << ", collection " << ns << " has changed " << endl;
+                            done = true;
+                            break;
+                        }
                     }
-                }
 
-                if ( callback )
-                    callback->goingToDelete( obj );
+                    if ( callback )
+                        callback->goingToDelete( obj );
 
-                logOp("d", ns.c_str(), obj["_id"].wrap(), 0, 0, fromMigrate);
-                c.database()->getCollection( ns )->deleteDocument( rloc );
-                numDeleted++;
+                    logOp("d", ns.c_str(), obj["_id"].wrap(), 0, 0, fromMigrate);
+                    collection->deleteDocument( rloc );
+                    numDeleted++;
+                }
             }
 
+            if ( done )
+                break;
+
             Timer secondaryThrottleTime;
 
             if ( secondaryThrottle && numDeleted > 0 ) {
                 if ( ! waitForReplication( c.getLastOp(), 2, 60 /* seconds to wait */ ) ) {
                     warning() << "replication to secondaries for removeRange at least 60 seconds behind" << endl;
                 }
-                millisWaitingForReplication += secondaryThrottleTime.millis();
             }
+
+            // read once, the parameter can be changed while we run
+            const long long maxLagMillis = removeRangeMaxLagSecs * 1000LL;
+            if ( replSet && maxLagMillis > 0 && numDeleted > 0 ) {
+                // Whatever was deleted removeRangeMaxLagSecs ago must have reached a majority
+                // of the set before deleting more.
+                const Date_t now = jsTime();
+                batchOps.push_back( make_pair( now, c.getLastOp() ) );
+
+                OpTime mustBeReplicated;
+                while ( !batchOps.empty() &&
+                        static_cast<long long>( now.millis - batchOps.front().first.millis )
+                            >= maxLagMillis ) {
+                    mustBeReplicated = batchOps.front().second;
+                    batchOps.pop_front();
+                }
+
+                if ( !mustBeReplicated.isNull() ) {
+                    Timer lagTime;
+                    while ( !opReplicatedEnough( mustBeReplicated, string( "majority" ) ) ) {
+                        killCurrentOp.checkForInterrupt();
+                        if ( lagTime.seconds() >= 60 ) {
+                            warning() << "majority replication for removeRange at least "
+                                      << maxLagMillis / 1000 + lagTime.seconds()
+                                      << " seconds behind, continuing" << endl;
+                            break;
+                        }
+                        sleepmillis( 100 );
+                    }
+                }
+            }
+
+            millisWaitingForReplication += secondaryThrottleTime.millis();
             
             if ( ! Lock::isLocked() ) {
                 int micros = ( 2 * Client::recommendedYieldMicros() ) - secondaryThrottleTime.micros();
@@ -469,7 +549,7 @@ namespace mongo {
             }
         }
         
-        if ( secondaryThrottle )
+        if ( secondaryThrottle || millisWaitingForReplication > 0 )
             log() << "Helpers::removeRangeUnlocked time spent waiting for replication: "  
                   << millisWaitingForReplication << "ms" << endl;
         
@@ -152,6 +152,10 @@ namespace mongo {
          * Returns -1 when no usable index exists
          *
          * Does oplog the individual document deletions.
+         *
+         * Deletes up to removeRangeBatchSize documents each time it takes the write lock.  On
+         * a replica set, it pauses whenever it gets more than removeRangeMaxLagSecs ahead of
+         * majority replication.
          * // TODO: Refactor this mechanism, it is growing too large
          */
         static long long removeRange( const KeyRange& range,
@@ -48,7 +48,9 @@
          remapping. with many files (e.g., 1000), remapping could be time consuming (several ms), so we don't want
          to be too frequent.
        there could be a slow down immediately after remapping as fresh copy-on-writes for commonly written pages will
-         be required.  so doing these remaps fractionally is helpful. 
+         be required.  so doing these remaps fractionally is helpful.  large files are remapped a region at a
+         time, and each REMAPPRIVATEVIEW remaps at most journalRemapMaxMBPerPause, so the time spent in the
+         write lock stays bounded however much data is mapped.
 
    mutexes:
 
@@ -81,6 +83,7 @@
 #include "mongo/db/dur_journal.h"
 #include "mongo/db/dur_recover.h"
 #include "mongo/db/dur_stats.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/server.h"
 #include "mongo/util/concurrency/race.h"
@@ -147,6 +150,21 @@ namespace mongo {
             return ss.str();
         }
 
+        void Stats::S::recordRemapPause(unsigned long long micros, unsigned long long bytes,
+                                        bool overMax) {
+            unsigned bucket = 0;
+            for( unsigned long long ms = micros / 1000; ms && bucket < NumRemapPauseBuckets - 1; ms >>= 1 )
+                bucket++;
+            _remapPauses[bucket]++;
+            if( micros > _remapPauseMaxMicros )
+                _remapPauseMaxMicros = micros;
+            _remapPrivateViewBytes += bytes;
+            if( bytes > _remapPauseMaxBytes )
+                _remapPauseMaxBytes = bytes;
+            if( overMax )
+                _remapPausesOverMax++;
+        }
+
         //int getAgeOutJournalFiles();
         BSONObj Stats::S::_asObj() {
             BSONObjBuilder b;
@@ -157,13 +175,33 @@ namespace mongo {
                        "compression" << _journaledBytes / (_uncompressedBytes+1.0) <<
                        "commitsInWriteLock" << _commitsInWriteLock <<
                        "earlyCommits" << _earlyCommits << 
+                       "writeIntents" << (long long) _writeIntents <<
                        "timeMs" <<
                        BSON( "dt" << _dtMillis <<
                              "prepLogBuffer" << (unsigned) (_prepLogBufferMicros/1000) <<
+                             "mergeIntents" << (unsigned) (_mergeIntentsMicros/1000) <<
+                             "prepBasicWrites" << (unsigned) (_prepBasicWritesMicros/1000) <<
                              "writeToJournal" << (unsigned) (_writeToJournalMicros/1000) <<
                              "writeToDataFiles" << (unsigned) (_writeToDataFilesMicros/1000) <<
                              "remapPrivateView" << (unsigned) (_remapPrivateViewMicros/1000)
                            );
+            {
+                BSONObjBuilder pauses(b.subobjStart("remapPrivateViewPauses"));
+                unsigned lo = 0;
+                for( unsigned i = 0; i < NumRemapPauseBuckets; i++ ) {
+                    unsigned hi = 1 << i;
+                    if( i == NumRemapPauseBuckets - 1 )
+                        pauses.append(string(str::stream() << lo << "ms+"), _remapPauses[i]);
+                    else
+                        pauses.append(string(str::stream() << lo << '-' << hi << "ms"), _remapPauses[i]);
+                    lo = hi;
+                }
+                pauses.append("maxMs", (unsigned) (_remapPauseMaxMicros/1000));
+                pauses.append("remappedMB", _remapPrivateViewBytes / 1000000.0);
+                pauses.append("maxMB", _remapPauseMaxBytes / 1000000.0);
+                pauses.append("overMaxMBPerPause", _remapPausesOverMax);
+                pauses.done();
+            }
             if (storageGlobalParams.journalCommitInterval != 0)
                 b << "journalCommitIntervalMs" << storageGlobalParams.journalCommitInterval;
             return b.obj();
@@ -481,7 +519,15 @@ namespace mongo {
 
         extern size_t privateMapBytes;
 
-        static void _REMAPPRIVATEVIEW() {
+        /** upper bound on how much of the private views one REMAPPRIVATEVIEW remaps, which bounds
+            how long it holds the write lock no matter how much data is mapped.  Not applied when
+            the write rate forces a faster remap, as the private views would otherwise keep growing.
+        */
+        MONGO_EXPORT_SERVER_PARAMETER(journalRemapMaxMBPerPause, int, 128);
+
+        /** @param overMax set if the write rate made this pass go past journalRemapMaxMBPerPause
+            @return bytes remapped */
+        static unsigned long long _REMAPPRIVATEVIEW(bool* overMax) {
             // todo: Consider using ProcessInfo herein and watching for getResidentSize to drop.  that could be a way 
             //       to assure very good behavior here.
 
@@ -496,10 +542,11 @@ namespace mongo {
             // we want to remap all private views about every 2 seconds.  there could be ~1000 views so
             // we do a little each pass; beyond the remap time, more significantly, there will be copy on write
             // faults after remapping, so doing a little bit at a time will avoid big load spikes on
-            // remapping.
+            // remapping.  a pass over a large file is spread over several calls, a region at a time.
             unsigned long long now = curTimeMicros64();
             double fraction = (now-lastRemap)/2000000.0;
-            if (storageGlobalParams.durOptions & StorageGlobalParams::DurAlwaysRemap)
+            const bool alwaysRemap = storageGlobalParams.durOptions & StorageGlobalParams::DurAlwaysRemap;
+            if (alwaysRemap)
                 fraction = 1;
             lastRemap = now;
 
@@ -518,48 +565,74 @@ namespace mongo {
             set<MongoFile*>& files = MongoFile::getAllFiles();
             unsigned sz = files.size();
             if( sz == 0 )
-                return;
+                return 0;
 
+            bool writePressure = false;
             {
                 // be careful not to use too much memory if the write rate is 
                 // extremely high
                 double f = privateMapBytes / ((double)UncommittedBytesLimit);
                 if( f > fraction ) { 
                     fraction = f;
+                    writePressure = true;
                 }
                 privateMapBytes = 0;
             }
+            if( fraction > 1 )
+                fraction = 1;
+
+            unsigned long long mappedBytes = 0;
+            for( set<MongoFile*>::const_iterator i = files.begin(); i != files.end(); ++i ) {
+                if( (*i)->isDurableMappedFile() )
+                    mappedBytes += ((DurableMappedFile*) *i)->length();
+            }
 
-            unsigned ntodo = (unsigned) (sz * fraction);
-            if( ntodo < 1 ) ntodo = 1;
-            if( ntodo > sz ) ntodo = sz;
+            unsigned long long budget = (unsigned long long) (mappedBytes * fraction);
+            const unsigned long long maxBytes =
+                std::max(journalRemapMaxMBPerPause, 1) * 1024ULL * 1024;
+            if( alwaysRemap ) {
+                budget = mappedBytes;
+            }
+            else if( budget > maxBytes ) {
+                if( writePressure )
+                    *overMax = true;
+                else
+                    budget = maxBytes;
+            }
+            if( budget < DurableMappedFile::RemapRegionBytes )
+                budget = DurableMappedFile::RemapRegionBytes;
 
             const set<MongoFile*>::iterator b = files.begin();
             const set<MongoFile*>::iterator e = files.end();
             set<MongoFile*>::iterator i = b;
             // skip to our starting position
-            for( unsigned x = 0; x < startAt; x++ ) {
+            for( unsigned x = 0; x < startAt % sz; x++ ) {
                 i++;
                 if( i == e ) i = b;
             }
             unsigned startedAt = startAt;
-            startAt = (startAt + ntodo) % sz; // mark where to start next time
 
             Timer t;
-            for( unsigned x = 0; x < ntodo; x++ ) {
+            unsigned long long remapped = 0;
+            unsigned x = 0;
+            for( ; x < sz && remapped < budget; x++ ) {
                 dassert( i != e );
                 if( (*i)->isDurableMappedFile() ) {
                     DurableMappedFile *mmf = (DurableMappedFile*) *i;
                     verify(mmf);
-                    if( mmf->willNeedRemap() ) {
-                        mmf->willNeedRemap() = false;
-                        mmf->remapThePrivateView();
+                    remapped += mmf->remapPrivateViewRegion(budget - remapped);
+                    if( remapped >= budget ) {
+                        // continue with this file next time if its pass isn't finished
+                        break;
                     }
-                    i++;
-                    if( i == e ) i = b;
                 }
+                i++;
+                if( i == e ) i = b;
             }
-            LOG(2) << "journal REMAPPRIVATEVIEW done startedAt: " << startedAt << " n:" << ntodo << ' ' << t.millis() << "ms" << endl;
+            startAt = (startAt + x) % sz; // mark where to start next time
+
+            LOG(2) << "journal REMAPPRIVATEVIEW done startedAt: " << startedAt << " n:" << x << ' ' << remapped / (1024 * 1024) << "MB " << t.millis() << "ms" << endl;
+            return remapped;
         }
 
         /** We need to remap the private views periodically. otherwise they would become very large.
@@ -567,8 +640,11 @@ namespace mongo {
         */
         void REMAPPRIVATEVIEW() {
             Timer t;
-            _REMAPPRIVATEVIEW();
-            stats.curr->_remapPrivateViewMicros += t.micros();
+            bool overMax = false;
+            unsigned long long bytes = _REMAPPRIVATEVIEW(&overMax);
+            unsigned long long micros = t.micros();
+            stats.curr->_remapPrivateViewMicros += micros;
+            stats.curr->recordRemapPause(micros, bytes, overMax);
         }
 
         // this is a pseudo-local variable in the groupcommit functions 
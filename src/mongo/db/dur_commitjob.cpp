@@ -69,6 +69,10 @@ namespace mongo {
             if ( intents.size() == 0 )
                 return;
 
+            // sorted (and with overlaps absorbed) on this thread, so that the commit only has to
+            // merge the runs
+            condense();
+            commitJob.beginRun();
             for( unsigned j = 0; j < intents.size(); j++ ) {
                 commitJob.note(intents[j].start(), intents[j].length());
             }
@@ -161,6 +165,7 @@ namespace mongo {
             commitJob.groupCommitMutex.dassertLocked();
             _alreadyNoted.clear();
             _intents.clear();
+            _runStarts.clear();
             _durOps.clear();
 #if defined(DEBUG_WRITE_INTENT)
             cout << "_debug clear\n";
@@ -189,6 +194,40 @@ namespace mongo {
             _intentsAndDurOps._durOps.push_back(p);
         }
 
+        const vector<WriteIntent>& CommitJob::getIntentsSorted() {
+            groupCommitMutex.dassertLocked();
+            vector<WriteIntent>& intents = _intentsAndDurOps._intents;
+            const vector<size_t>& runStarts = _intentsAndDurOps._runStarts;
+
+            // boundaries of the sorted runs
+            vector<size_t> bounds;
+            bounds.push_back(0);
+            for( size_t i = 0; i < runStarts.size(); i++ ) {
+                if( runStarts[i] > bounds.back() )
+                    bounds.push_back(runStarts[i]);
+            }
+            if( intents.size() > bounds.back() )
+                bounds.push_back(intents.size());
+
+            // merge neighbouring runs until one is left
+            while( bounds.size() > 2 ) {
+                vector<size_t> merged;
+                size_t i = 0;
+                for( ; i + 2 < bounds.size(); i += 2 ) {
+                    inplace_merge(intents.begin() + bounds[i],
+                                  intents.begin() + bounds[i+1],
+                                  intents.begin() + bounds[i+2]);
+                    merged.push_back(bounds[i]);
+                }
+                for( ; i < bounds.size(); i++ )
+                    merged.push_back(bounds[i]);
+                bounds.swap(merged);
+            }
+
+            _intentsAndDurOps._runStarts.clear();
+            return intents;
+        }
+
         size_t privateMapBytes = 0; // used by _REMAPPRIVATEVIEW to track how much / how fast to remap
 
         void CommitJob::commitingBegin() { 
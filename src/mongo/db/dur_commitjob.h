@@ -100,13 +100,21 @@ namespace mongo {
         /** our record of pending/uncommitted write intents */
         class IntentsAndDurOps : boost::noncopyable {
         public:
+            /** sorted runs, one per unspool of a ThreadLocalIntents, that getIntentsSorted() merges */
             vector<WriteIntent> _intents;
+            vector<size_t> _runStarts; // index in _intents where each run begins
             Already<127> _alreadyNoted;
             vector< shared_ptr<DurOp> > _durOps; // all the ops other than basic writes
 
             /** reset the IntentsAndDurOps structure (empties all the above) */
             void clear();
 
+            /** the intents inserted from now on, until the next call, are in sorted order */
+            void beginRun() {
+                if( _runStarts.empty() || _runStarts.back() != _intents.size() )
+                    _runStarts.push_back(_intents.size());
+            }
+
             void insertWriteIntent(void* p, int len) {
                 _intents.push_back(WriteIntent(p,len));
                 wassert( _intents.size() < 2000000 );
@@ -116,9 +124,11 @@ namespace mongo {
             #endif
         };
 
-        /** so we don't have to lock the groupCommitMutex too often */
+        /** so we don't have to lock the groupCommitMutex too often, and so each writer sorts its
+            own intents rather than the commit thread sorting everyone's while holding it
+        */
         class ThreadLocalIntents {
-            enum { N = 21 };
+            enum { N = 64 };
             std::vector<dur::WriteIntent> intents;
             bool condense();
         public:
@@ -141,6 +151,8 @@ namespace mongo {
             void _committingReset();
             ~CommitJob(){ verify(!"shouldn't destroy CommitJob!"); }
 
+            /** start a sorted run of intents; see IntentsAndDurOps::beginRun() */
+            void beginRun() { _intentsAndDurOps.beginRun(); }
             /** record/note an intent to write */
             void note(void* p, int len);
             // only called by : 
@@ -183,13 +195,9 @@ namespace mongo {
             size_t bytes() const { return _bytes; }
 
             /** used in prepbasicwrites. sorted so that overlapping and duplicate items 
-             * can be merged.  we sort here so the caller receives something they must 
-             * keep const from their pov. */
-            const vector<WriteIntent>& getIntentsSorted() {
-                groupCommitMutex.dassertLocked();
-                sort(_intentsAndDurOps._intents.begin(), _intentsAndDurOps._intents.end());
-                return _intentsAndDurOps._intents;
-            }
+             * can be merged.  we merge the threads' sorted runs here so the caller receives
+             * something they must keep const from their pov. */
+            const vector<WriteIntent>& getIntentsSorted();
 
             bool _hasWritten;
 
@@ -140,7 +140,11 @@ namespace mongo {
             RelativePath lastDbPath;
 
             assertNothingSpooled();
+            Timer t;
             const vector<WriteIntent>& _intents = commitJob.getIntentsSorted();
+            unsigned long long mergeMicros = t.micros();
+            stats.curr->_mergeIntentsMicros += mergeMicros;
+            stats.curr->_writeIntents += _intents.size();
 
             // right now the durability code assumes there is at least one write intent
             // this does not have to be true in theory as i could just add or delete a file
@@ -162,6 +166,7 @@ namespace mongo {
                 }
             }
             prepBasicWrite_inlock(bb, &last, lastDbPath);
+            stats.curr->_prepBasicWritesMicros += t.micros() - mergeMicros;
         }
 
         static void resetLogBuffer(/*out*/JSectHeader& h, AlignedBuilder& bb) {
@@ -48,11 +48,13 @@
 #include "mongo/db/kill_current_op.h"
 #include "mongo/db/storage/durable_mapped_file.h"
 #include "mongo/db/pdfile.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/util/bufreader.h"
 #include "mongo/util/checksum.h"
 #include "mongo/util/compress.h"
 #include "mongo/util/concurrency/race.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/startup_test.h"
 
@@ -71,6 +73,17 @@ namespace mongo {
 
     namespace dur {
 
+        // Threads that decompress journal sections and apply their writes at startup.  With 1,
+        // sections are applied one at a time as they are read.
+        MONGO_EXPORT_STARTUP_SERVER_PARAMETER(journalRecoveryThreads, int, 4);
+
+        // Threads that copy each group commit's writes back to the data files, one data file per
+        // thread at a time.  With 1, WRITETODATAFILES applies them in order on the commit thread.
+        MONGO_EXPORT_STARTUP_SERVER_PARAMETER(journalWritebackThreads, int, 2);
+
+        // Compressed bytes of journal decompressed ahead of the writes being applied
+        static const unsigned long long recoveryWindowBytes = 64 * 1024 * 1024;
+
         struct ParsedJournalEntry { /*copyable*/
             ParsedJournalEntry() : e(0) { }
 
@@ -289,7 +302,7 @@ namespace mongo {
 
             DurableMappedFile *mmf = last.newEntry(entry, *this);
 
-            if ((entry.e->ofs + entry.e->len) <= mmf->length()) {
+            if (fitsInFile(entry, mmf)) {
                 verify(mmf->view_write());
                 verify(entry.e->srcData());
 
@@ -297,9 +310,17 @@ namespace mongo {
                 memcpy(dest, entry.e->srcData(), entry.e->len);
                 stats.curr->_writeToDataFilesBytes += entry.e->len;
             }
-            else {
-                massert(13622, "Trying to write past end of file in WRITETODATAFILES", _recovering);
-            }
+        }
+
+        /** @return true if the basic write 'entry' lies within mmf.  a write past the end is
+            dropped while recovering, as a later entry may have truncated the file, and is an
+            error otherwise
+        */
+        bool RecoveryJob::fitsInFile(const ParsedJournalEntry& entry, DurableMappedFile* mmf) const {
+            if ((entry.e->ofs + entry.e->len) <= mmf->length())
+                return true;
+            massert(13622, "Trying to write past end of file in WRITETODATAFILES", _recovering);
+            return false;
         }
 
         void RecoveryJob::applyEntry(Last& last, const ParsedJournalEntry& entry, bool apply, bool dump) {
@@ -394,17 +415,7 @@ namespace mongo {
                 }
             }
 
-            if( _recovering && _lastDataSyncedFromLastRun > h->seqNumber + ExtraKeepTimeMs ) {
-                if( h->seqNumber != _lastSeqMentionedInConsoleLog ) {
-                    static int n;
-                    if( ++n < 10 ) {
-                        log() << "recover skipping application of section seq:" << h->seqNumber << " < lsn:" << _lastDataSyncedFromLastRun << endl;
-                    }
-                    else if( n == 10 ) { 
-                        log() << "recover skipping application of section more..." << endl;
-                    }
-                    _lastSeqMentionedInConsoleLog = h->seqNumber;
-                }
+            if( _recovering && skipSection(h) ) {
                 return;
             }
 
@@ -437,7 +448,265 @@ namespace mongo {
             }
 
             // got all the entries for one group commit.  apply them:
-            applyEntries(entries);
+            if( !_recovering && journalWritebackThreads > 1 ) {
+                if( !_writebackWorkers ) {
+                    // lives as long as the process, as the RecoveryJob does
+                    _writebackWorkers = new ThreadPool(journalWritebackThreads);
+                }
+                writeBackInParallel(entries);
+            }
+            else {
+                applyEntries(entries);
+            }
+        }
+
+        /** @return true if the data files already had this section when the last run ended */
+        bool RecoveryJob::skipSection(const JSectHeader *h) {
+            if( _lastDataSyncedFromLastRun <= h->seqNumber + ExtraKeepTimeMs )
+                return false;
+
+            if( h->seqNumber != _lastSeqMentionedInConsoleLog ) {
+                static int n;
+                if( ++n < 10 ) {
+                    log() << "recover skipping application of section seq:" << h->seqNumber << " < lsn:" << _lastDataSyncedFromLastRun << endl;
+                }
+                else if( n == 10 ) { 
+                    log() << "recover skipping application of section more..." << endl;
+                }
+                _lastSeqMentionedInConsoleLog = h->seqNumber;
+            }
+            return true;
+        }
+
+        /** a journal section found by processFileBuffer(), and what the recovery workers made of it */
+        struct RecoverySection {
+            RecoverySection(const JSectHeader *h, const char *data, unsigned len, const JSectFooter *f) :
+                h(h), data(data), len(len), f(f), skip(false), corrupt(false), error(Status::OK()) { }
+
+            const JSectHeader *h;
+            const char *data;
+            unsigned len;
+            const JSectFooter *f;
+            bool skip; // already in the data files, only the checksum is checked
+
+            // filled in by parseRecoverySection
+            bool corrupt;
+            Status error;
+            boost::shared_ptr<JournalSectionIterator> it; // owns the uncompressed entries
+            vector<ParsedJournalEntry> entries;
+        };
+
+        /** checksums, uncompresses and parses a section.  runs on a recovery worker. */
+        static void parseRecoverySection(RecoverySection *s) {
+            try {
+                if( !s->f->checkHash(s->h, s->len + sizeof(JSectHeader)) ) {
+                    log() << "journal section checksum doesn't match";
+                    s->corrupt = true;
+                    return;
+                }
+                if( s->skip )
+                    return;
+                s->it.reset(new JournalSectionIterator(*s->h, s->data, s->len, true));
+                ParsedJournalEntry e;
+                while( !s->it->atEof() ) {
+                    s->it->next(e);
+                    s->entries.push_back(e);
+                }
+            }
+            catch( const JournalSectionCorruptException& ) {
+                s->corrupt = true;
+            }
+            catch( const BufReader::eof& ) {
+                s->corrupt = true;
+            }
+            catch( const DBException& e ) {
+                s->error = e.toStatus();
+            }
+            catch( const std::exception& e ) {
+                s->error = Status(ErrorCodes::InternalError, e.what());
+            }
+        }
+
+        /** basic writes from recovery, split up by data file so that they can be applied in
+            parallel while the writes to each file stay in journal order.
+        */
+        class PartitionedWrites : boost::noncopyable {
+        public:
+            PartitionedWrites(unsigned nPartitions) : _partitions(nPartitions), _bytes(nPartitions), _pending(0) { }
+
+            unsigned numPartitions() const { return _partitions.size(); }
+
+            void add(unsigned partition, DurableMappedFile *mmf, const JEntry *e) {
+                _partitions[partition].push_back(Write(mmf, e));
+                _pending++;
+            }
+
+            /** applies everything added so far, then forgets it */
+            void apply(threadpool::ThreadPool *workers) {
+                if( _pending == 0 )
+                    return;
+
+                unsigned busy = 0;
+                for( unsigned i = 0; i < _partitions.size(); i++ )
+                    if( !_partitions[i].empty() )
+                        busy++;
+
+                if( busy == 1 || !workers ) {
+                    for( unsigned i = 0; i < _partitions.size(); i++ )
+                        applyPartition(&_partitions[i], &_bytes[i]);
+                }
+                else {
+                    for( unsigned i = 0; i < _partitions.size(); i++ )
+                        if( !_partitions[i].empty() )
+                            workers->schedule(&PartitionedWrites::applyPartition, &_partitions[i], &_bytes[i]);
+                    workers->join();
+                }
+
+                for( unsigned i = 0; i < _partitions.size(); i++ ) {
+                    stats.curr->_writeToDataFilesBytes += _bytes[i];
+                    _bytes[i] = 0;
+                    _partitions[i].clear();
+                }
+                _pending = 0;
+            }
+
+        private:
+            struct Write {
+                Write(DurableMappedFile *mmf, const JEntry *e) : mmf(mmf), e(e) { }
+                DurableMappedFile *mmf;
+                const JEntry *e;
+            };
+
+            static void applyPartition(vector<Write> *writes, unsigned long long *bytes) {
+                for( vector<Write>::const_iterator i = writes->begin(); i != writes->end(); ++i ) {
+                    const JEntry *e = i->e;
+                    // like RecoveryJob::write(), writes past the end of the file are dropped
+                    if( (e->ofs + e->len) <= i->mmf->length() ) {
+                        verify(i->mmf->view_write());
+                        verify(e->srcData());
+                        memcpy((char*)i->mmf->view_write() + e->ofs, e->srcData(), e->len);
+                        *bytes += e->len;
+                    }
+                }
+            }
+
+            vector< vector<Write> > _partitions;
+            vector<unsigned long long> _bytes;
+            unsigned long long _pending;
+        };
+
+        /** WRITETODATAFILES with the writeback workers: the basic writes of one group commit are
+            partitioned by data file and copied in parallel.  DurOp's are applied on this thread
+            once the writes before them are done, as in recovery.
+        */
+        void RecoveryJob::writeBackInParallel(const vector<ParsedJournalEntry>& entries) {
+            PartitionedWrites writes(journalWritebackThreads);
+
+            // data files written by this commit, with the partition their writes go to
+            map< pair<string,int>, pair<DurableMappedFile*,unsigned> > files;
+
+            for( vector<ParsedJournalEntry>::const_iterator e = entries.begin(); e != entries.end(); ++e ) {
+                if( e->e ) {
+                    pair<string,int> key(e->dbName, e->e->getFileNo());
+                    map< pair<string,int>, pair<DurableMappedFile*,unsigned> >::iterator f = files.find(key);
+                    if( f == files.end() ) {
+                        unsigned partition = files.size() % writes.numPartitions();
+                        f = files.insert(make_pair(key, make_pair(getDurableMappedFile(*e), partition))).first;
+                    }
+                    if( fitsInFile(*e, f->second.first) )
+                        writes.add(f->second.second, f->second.first, e->e);
+                }
+                else if( e->op ) {
+                    writes.apply(_writebackWorkers);
+                    if( e->op->needFilesClosed() ) {
+                        _close();
+                    }
+                    e->op->replay();
+                    files.clear(); // files may have been closed, created or removed
+                }
+            }
+
+            writes.apply(_writebackWorkers);
+        }
+
+        /** apply the sections of a journal file using the recovery workers.  sections are
+            checksummed and uncompressed in parallel, a window at a time; then their basic writes
+            are applied in parallel, partitioned by data file.  DurOp's (file creation, dropping a
+            database) are applied on this thread once the writes before them are done.
+            @return true if a corrupt section was found, i.e. the journal ends abruptly
+        */
+        bool RecoveryJob::processSectionsInParallel(const vector<RecoverySection>& sections) {
+            const bool apply = (storageGlobalParams.durOptions &
+                                StorageGlobalParams::DurScanOnly) == 0;
+            PartitionedWrites writes(_nWorkers);
+
+            size_t next = 0;
+            while( next < sections.size() ) {
+
+                // pick the next window of sections and parse them all at once
+                vector<RecoverySection> window;
+                unsigned long long windowBytes = 0;
+                while( next < sections.size() &&
+                       window.size() < (size_t) _nWorkers * 4 &&
+                       windowBytes < recoveryWindowBytes ) {
+                    window.push_back(sections[next++]);
+                    windowBytes += window.back().len;
+                }
+
+                for( size_t i = 0; i < window.size(); i++ ) {
+                    window[i].skip = skipSection(window[i].h);
+                    _workers->schedule(&parseRecoverySection, &window[i]);
+                }
+                _workers->join();
+
+                scoped_lock lk(_mx);
+
+                // data files in use by this window, with the partition their writes go to
+                map< pair<string,int>, pair<DurableMappedFile*,unsigned> > files;
+
+                for( size_t i = 0; i < window.size(); i++ ) {
+                    const RecoverySection& s = window[i];
+                    if( s.corrupt ) {
+                        // everything before the corrupt section is applied, as when recovering
+                        // one section at a time
+                        writes.apply(_workers);
+                        return true;
+                    }
+                    if( !s.error.isOK() ) {
+                        writes.apply(_workers);
+                        uassertStatusOK(s.error);
+                    }
+                    if( s.skip || !apply )
+                        continue;
+
+                    for( vector<ParsedJournalEntry>::const_iterator e = s.entries.begin(); e != s.entries.end(); ++e ) {
+                        if( e->e ) {
+                            pair<string,int> key(e->dbName, e->e->getFileNo());
+                            map< pair<string,int>, pair<DurableMappedFile*,unsigned> >::iterator f = files.find(key);
+                            if( f == files.end() ) {
+                                unsigned partition = files.size() % writes.numPartitions();
+                                f = files.insert(make_pair(key, make_pair(getDurableMappedFile(*e), partition))).first;
+                            }
+                            writes.add(f->second.second, f->second.first, e->e);
+                        }
+                        else if( e->op ) {
+                            writes.apply(_workers);
+                            if( e->op->needFilesClosed() ) {
+                                _close();
+                            }
+                            e->op->replay();
+                            files.clear(); // files may have been closed, created or removed
+                        }
+                    }
+                }
+
+                writes.apply(_workers);
+
+                // ctrl c check
+                killCurrentOp.checkForInterrupt(false);
+            }
+
+            return false;
         }
 
         /** apply a specific journal file, that is already mmap'd
@@ -477,27 +746,56 @@ namespace mongo {
                     }
                 }
 
+                // with recovery workers the sections are found first, then applied together
+                const bool parallel = _recovering && _workers &&
+                    !(storageGlobalParams.durOptions & StorageGlobalParams::DurDumpJournal);
+                vector<RecoverySection> sections;
+                bool abrupt = false;
+
                 // read sections
-                while ( !br.atEof() ) {
-                    JSectHeader h;
-                    br.peek(h);
-                    if( h.fileId != fileId ) {
-                        if (debug || (storageGlobalParams.durOptions &
-                                      StorageGlobalParams::DurDumpJournal)) {
-                            log() << "Ending processFileBuffer at differing fileId want:" << fileId << " got:" << h.fileId << endl;
-                            log() << "  sect len:" << h.sectionLen() << " seqnum:" << h.seqNumber << endl;
+                try {
+                    while ( !br.atEof() ) {
+                        JSectHeader h;
+                        br.peek(h);
+                        if( h.fileId != fileId ) {
+                            if (debug || (storageGlobalParams.durOptions &
+                                          StorageGlobalParams::DurDumpJournal)) {
+                                log() << "Ending processFileBuffer at differing fileId want:" << fileId << " got:" << h.fileId << endl;
+                                log() << "  sect len:" << h.sectionLen() << " seqnum:" << h.seqNumber << endl;
+                            }
+                            abrupt = true;
+                            break;
                         }
-                        return true;
+                        unsigned slen = h.sectionLen();
+                        unsigned dataLen = slen - sizeof(JSectHeader) - sizeof(JSectFooter);
+                        const char *hdr = (const char *) br.skip(h.sectionLenWithPadding());
+                        const char *data = hdr + sizeof(JSectHeader);
+                        const char *footer = data + dataLen;
+                        if( parallel ) {
+                            sections.push_back(RecoverySection((const JSectHeader*) hdr, data, dataLen,
+                                                               (const JSectFooter*) footer));
+                            continue;
+                        }
+                        processSection((const JSectHeader*) hdr, data, dataLen, (const JSectFooter*) footer);
+
+                        // ctrl c check
+                        killCurrentOp.checkForInterrupt(false);
                     }
-                    unsigned slen = h.sectionLen();
-                    unsigned dataLen = slen - sizeof(JSectHeader) - sizeof(JSectFooter);
-                    const char *hdr = (const char *) br.skip(h.sectionLenWithPadding());
-                    const char *data = hdr + sizeof(JSectHeader);
-                    const char *footer = data + dataLen;
-                    processSection((const JSectHeader*) hdr, data, dataLen, (const JSectFooter*) footer);
-
-                    // ctrl c check
-                    killCurrentOp.checkForInterrupt(false);
+                }
+                catch (const BufReader::eof&) {
+                    if( !parallel )
+                        throw;
+                    // the sections read before the truncated one are still applied
+                    abrupt = true;
+                }
+
+                if( parallel && processSectionsInParallel(sections) )
+                    abrupt = true;
+
+                if( abrupt ) {
+                    if (storageGlobalParams.durOptions & StorageGlobalParams::DurDumpJournal)
+                        log() << "ABRUPT END" << endl;
+                    return true;
                 }
             }
             catch (const BufReader::eof&) {
@@ -544,16 +842,7 @@ namespace mongo {
             _lastDataSyncedFromLastRun = journalReadLSN();
             log() << "recover lsn: " << _lastDataSyncedFromLastRun << endl;
 
-            for( unsigned i = 0; i != files.size(); ++i ) {
-                bool abruptEnd = processFile(files[i]);
-                if( abruptEnd && i+1 < files.size() ) {
-                    log() << "recover error: abrupt end to file " << files[i].string() << ", yet it isn't the last journal file" << endl;
-                    close();
-                    uasserted(13535, "recover abrupt journal file end");
-                }
-            }
-
-            close();
+            _applyFiles(files, journalRecoveryThreads);
 
             if (storageGlobalParams.durOptions & StorageGlobalParams::DurScanOnly) {
                 uasserted(13545, str::stream() << "--durOptions "
@@ -568,6 +857,48 @@ namespace mongo {
             _recovering = false;
         }
 
+        void RecoveryJob::_applyFiles(vector<boost::filesystem::path>& files, int nThreads) {
+            scoped_ptr<ThreadPool> workers;
+            if( nThreads > 1 ) {
+                workers.reset(new ThreadPool(nThreads));
+                log() << "recover using " << nThreads << " threads" << endl;
+            }
+            _workers = workers.get();
+            _nWorkers = nThreads;
+
+            try {
+                for( unsigned i = 0; i != files.size(); ++i ) {
+                    bool abruptEnd = processFile(files[i]);
+                    if( abruptEnd && i+1 < files.size() ) {
+                        log() << "recover error: abrupt end to file " << files[i].string() << ", yet it isn't the last journal file" << endl;
+                        close();
+                        uasserted(13535, "recover abrupt journal file end");
+                    }
+                }
+            }
+            catch( ... ) {
+                _workers = 0;
+                throw;
+            }
+            _workers = 0;
+
+            close();
+        }
+
+        void RecoveryJob::applyJournalFiles(vector<boost::filesystem::path>& files, int nThreads) {
+            LockMongoFilesExclusive lkFiles; // for RecoveryJob::Last
+            _recovering = true;
+            _lastDataSyncedFromLastRun = 0;
+            try {
+                _applyFiles(files, nThreads);
+            }
+            catch( ... ) {
+                _recovering = false;
+                throw;
+            }
+            _recovering = false;
+        }
+
         void _recover() {
             verify(storageGlobalParams.dur);
 
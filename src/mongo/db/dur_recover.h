@@ -40,8 +40,13 @@
 namespace mongo {
     class DurableMappedFile;
 
+    namespace threadpool {
+        class ThreadPool;
+    }
+
     namespace dur {
         struct ParsedJournalEntry;
+        struct RecoverySection;
 
         /** call go() to execute a recovery from existing journal files.
          */
@@ -57,10 +62,17 @@ namespace mongo {
             } last;        
         public:
             RecoveryJob() : _lastDataSyncedFromLastRun(0), 
-                _mx("recovery"), _recovering(false) { _lastSeqMentionedInConsoleLog = 1; }
+                _mx("recovery"), _recovering(false), _workers(NULL), _nWorkers(0),
+                _writebackWorkers(NULL) { _lastSeqMentionedInConsoleLog = 1; }
             void go(vector<boost::filesystem::path>& files);
             ~RecoveryJob();
 
+            /** applies the journal files to the data files the way go() does, but without reading
+                the lsn file or removing the journal afterwards.  for benchmarking recovery.
+                @param nThreads recovery workers to use, as journalRecoveryThreads does for go()
+            */
+            void applyJournalFiles(vector<boost::filesystem::path>& files, int nThreads);
+
             /** @param data data between header and footer. compressed if recovering. */
             void processSection(const JSectHeader *h, const void *data, unsigned len, const JSectFooter *f);
 
@@ -69,10 +81,15 @@ namespace mongo {
             static RecoveryJob & get() { return _instance; }
         private:
             void write(Last& last, const ParsedJournalEntry& entry); // actually writes to the file
+            bool fitsInFile(const ParsedJournalEntry& entry, DurableMappedFile* mmf) const;
             void applyEntry(Last& last, const ParsedJournalEntry& entry, bool apply, bool dump);
             void applyEntries(const vector<ParsedJournalEntry> &entries);
             bool processFileBuffer(const void *, unsigned len);
             bool processFile(boost::filesystem::path journalfile);
+            void _applyFiles(vector<boost::filesystem::path>& files, int nThreads);
+            bool skipSection(const JSectHeader *h);
+            bool processSectionsInParallel(const vector<RecoverySection>& sections);
+            void writeBackInParallel(const vector<ParsedJournalEntry>& entries);
             void _close(); // doesn't lock
             DurableMappedFile* getDurableMappedFile(const ParsedJournalEntry& entry);
 
@@ -85,6 +102,15 @@ namespace mongo {
         private:
             bool _recovering; // are we in recovery or WRITETODATAFILES
 
+            // decompresses sections and applies writes during recovery.  NULL if recovery
+            // is single threaded.
+            threadpool::ThreadPool* _workers;
+            int _nWorkers;
+
+            // copies WRITETODATAFILES' writes back in parallel.  created on first use, NULL if
+            // journalWritebackThreads is 1.
+            threadpool::ThreadPool* _writebackWorkers;
+
             static RecoveryJob &_instance;
         };
     }
@@ -52,10 +52,24 @@ namespace mongo {
                 unsigned long long _writeToDataFilesBytes;
 
                 unsigned long long _prepLogBufferMicros;
+                unsigned long long _mergeIntentsMicros;   // part of _prepLogBufferMicros
+                unsigned long long _prepBasicWritesMicros; // part of _prepLogBufferMicros
+                unsigned long long _writeIntents;          // after merging, before coalescing
                 unsigned long long _writeToJournalMicros;
                 unsigned long long _writeToDataFilesMicros;
                 unsigned long long _remapPrivateViewMicros;
 
+                // REMAPPRIVATEVIEW pauses (time in the write lock), bucketed by powers of 2
+                // milliseconds: <1ms, 1-2ms, 2-4ms, ... with the last bucket open-ended
+                enum { NumRemapPauseBuckets = 10 };
+                unsigned _remapPauses[NumRemapPauseBuckets];
+                unsigned long long _remapPauseMaxMicros;
+                unsigned long long _remapPrivateViewBytes;
+                unsigned long long _remapPauseMaxBytes;
+                unsigned _remapPausesOverMax; // write rate forced more than journalRemapMaxMBPerPause
+                void recordRemapPause(unsigned long long micros, unsigned long long bytes,
+                                      bool overMax);
+
                 // undesirable to be in write lock for the group commit (it can be done in a read lock), so good if we
                 // have visibility when this happens.  can happen for a couple reasons
                 // - read lock starvation
@@ -81,8 +81,9 @@ namespace mongo {
             that which is going to be a remapped on its private view - but that might not be all
             views.
 
-            (2) todo should we do this using N threads?  would be quite easy
-                see Hackenberg paper table 5 and 6.  2 threads might be a good balance.
+            (2) the writes are copied by journalWritebackThreads threads, each data file's on one
+                thread (see RecoveryJob::writeBackInParallel).  see Hackenberg paper table 5 and 6
+                for why 2 threads is the default.
 
             (3) with enough work, we could do this outside the read lock.  it's a bit tricky though.
                 - we couldn't do it from the private views then as they may be changing.  would have to then
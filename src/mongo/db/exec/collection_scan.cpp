@@ -33,6 +33,8 @@
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/storage/data_file.h"
 #include "mongo/db/structure/collection_iterator.h"
 #include "mongo/util/fail_point_service.h"
 
@@ -102,6 +104,7 @@ namespace mongo {
             if (!curr.isNull() && !diskLocInMemory(curr)) {
                 WorkingSetMember* member = _workingSet->get(_wsidForFetch);
                 member->loc = curr;
+                readAhead(curr);
                 *out = _wsidForFetch;
                 return PlanStage::NEED_FETCH;
             }
@@ -148,6 +151,33 @@ namespace mongo {
         }
     }
 
+    void CollectionScan::readAhead(const DiskLoc& loc) {
+        if (internalQueryCollScanReadAheadKB <= 0) {
+            return;
+        }
+        size_t len = static_cast<size_t>(internalQueryCollScanReadAheadKB) * 1024;
+
+        DataFile* file = cc().database()->getExtentManager().getFile(loc.a());
+        const char* fileStart = reinterpret_cast<const char*>(file->getHeader());
+        const char* fileEnd = fileStart + file->length();
+        const char* data = reinterpret_cast<const char*>(loc.rec());
+
+        const char* start;
+        if (CollectionScanParams::FORWARD == _params.direction) {
+            start = data;
+            len = std::min(len, static_cast<size_t>(fileEnd - data));
+        }
+        else {
+            // Backwards the record itself is last, so take a page more to cover it.
+            const char* end = std::min(data + Record::DefaultPrefetchBytes, fileEnd);
+            len = std::min(len, static_cast<size_t>(end - fileStart));
+            start = end - len;
+        }
+
+        Record::queuePrefetch(start, len);
+        ++_specificStats.readAheads;
+    }
+
     bool CollectionScan::isEOF() {
         if ((0 != _params.maxScan) && (_specificStats.docsTested >= _params.maxScan)) {
             return true;
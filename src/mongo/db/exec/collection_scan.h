@@ -65,6 +65,14 @@ namespace mongo {
          */
         static bool diskLocInMemory(DiskLoc loc);
 
+        /**
+         * Queues a prefetch of the internalQueryCollScanReadAheadKB after 'loc' in our direction,
+         * kept inside its data file, for the runner to issue when it yields to page 'loc' in.
+         * Records in an extent are mostly laid out in scan order so this usually covers the next
+         * ones we'll need.
+         */
+        void readAhead(const DiskLoc& loc);
+
         // WorkingSet is not owned by us.
         WorkingSet* _workingSet;
 
@@ -31,6 +31,7 @@
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/pdfile.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/util/fail_point_service.h"
 
 namespace mongo {
@@ -51,6 +52,11 @@ namespace mongo {
             return false;
         }
 
+        if (!_readAhead.empty()) {
+            // We still owe our parent the results we read ahead.
+            return false;
+        }
+
         return _child->isEOF();
     }
 
@@ -77,9 +83,17 @@ namespace mongo {
         }
 
         // If we're here, we're not waiting for a DiskLoc to be fetched.  Get another to-be-fetched
-        // result from our child.
+        // result, from those we read ahead if there are any and from our child otherwise.
         WorkingSetID id = WorkingSet::INVALID_ID;
-        StageState status = _child->work(&id);
+        StageState status;
+        if (!_readAhead.empty()) {
+            status = _readAhead.front().first;
+            id = _readAhead.front().second;
+            _readAhead.pop_front();
+        }
+        else {
+            status = _child->work(&id);
+        }
 
         if (PlanStage::ADVANCED == status) {
             WorkingSetMember* member = _ws->get(id);
@@ -101,6 +115,7 @@ namespace mongo {
                 // member->loc points to a record that's NOT in memory.  Pass a fetch request up.
                 verify(WorkingSet::INVALID_ID == _idBeingPagedIn);
                 _idBeingPagedIn = id;
+                readAhead();
                 *out = id;
                 ++_commonStats.needFetch;
                 return PlanStage::NEED_FETCH;
@@ -162,6 +177,58 @@ namespace mongo {
                 WorkingSetCommon::fetchAndInvalidateLoc(member);
             }
         }
+
+        // The same goes for the results we read ahead.
+        for (size_t i = 0; i < _readAhead.size(); ++i) {
+            if (PlanStage::ADVANCED != _readAhead[i].first) {
+                continue;
+            }
+            WorkingSetMember* member = _ws->get(_readAhead[i].second);
+            if (member->hasLoc() && (member->loc == dl)) {
+                WorkingSetCommon::fetchAndInvalidateLoc(member);
+                ++_specificStats.forcedFetches;
+            }
+        }
+    }
+
+    void FetchStage::readAhead() {
+        // NEED_TIMEs don't produce anything, so don't let a child that returns a lot of them keep
+        // us here for long.
+        int worksLeft = 2 * internalQueryFetchReadAheadDocs;
+
+        while (static_cast<int>(_readAhead.size()) < internalQueryFetchReadAheadDocs
+               && worksLeft-- > 0
+               && !_child->isEOF()) {
+
+            if (!_readAhead.empty() && PlanStage::ADVANCED != _readAhead.back().first) {
+                break;
+            }
+
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            StageState status = _child->work(&id);
+
+            if (PlanStage::NEED_TIME == status) {
+                continue;
+            }
+            if (PlanStage::IS_EOF == status) {
+                break;
+            }
+
+            _readAhead.push_back(std::make_pair(status, id));
+
+            if (PlanStage::ADVANCED == status) {
+                WorkingSetMember* member = _ws->get(id);
+                if (member->hasObj() || !member->hasLoc()) {
+                    continue;
+                }
+
+                const char* data = member->loc.rec()->dataNoThrowing();
+                if (!recordInMemory(data)) {
+                    Record::queuePrefetch(data);
+                    ++_specificStats.readAheads;
+                }
+            }
+        }
     }
 
     PlanStage::StageState FetchStage::fetchCompleted(WorkingSetID* out) {
@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <deque>
+
 #include "mongo/db/diskloc.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/jsobj.h"
@@ -41,6 +43,10 @@ namespace mongo {
      * In WorkingSetMember terms, it transitions from LOC_AND_IDX to LOC_AND_UNOWNED_OBJ by reading
      * the record at the provided loc.  Returns verbatim any data that already has an object.
      *
+     * When a record isn't in memory, the stage also reads up to internalQueryFetchReadAheadDocs
+     * more results from its child and queues prefetches for their records, so that the OS pages
+     * them in while the runner yields for the first one.
+     *
      * Preconditions: Valid DiskLoc.
      */
     class FetchStage : public PlanStage {
@@ -70,6 +76,12 @@ namespace mongo {
          */
         StageState fetchCompleted(WorkingSetID* out);
 
+        /**
+         * Reads results from our child into _readAhead and queues a prefetch for each record that
+         * isn't in memory.  Stops at the first result that isn't ADVANCED.
+         */
+        void readAhead();
+
         // _ws is not owned by us.
         WorkingSet* _ws;
         scoped_ptr<PlanStage> _child;
@@ -81,6 +93,10 @@ namespace mongo {
         // a "please page this in" result and hold on to the WSID until the next call to work(...).
         WorkingSetID _idBeingPagedIn;
 
+        // Results we took from our child ahead of time, returned in order before we work the child
+        // again.  Only the last one may be something other than ADVANCED.
+        std::deque<std::pair<StageState, WorkingSetID> > _readAhead;
+
         // Stats
         CommonStats _commonStats;
         FetchStats _specificStats;
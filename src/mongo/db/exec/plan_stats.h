@@ -184,7 +184,7 @@ namespace mongo {
     };
 
     struct CollectionScanStats : public SpecificStats {
-        CollectionScanStats() : docsTested(0) { }
+        CollectionScanStats() : docsTested(0), readAheads(0) { }
 
         virtual SpecificStats* clone() const {
             CollectionScanStats* specific = new CollectionScanStats(*this);
@@ -193,6 +193,9 @@ namespace mongo {
 
         // How many documents did we check against our filter?
         size_t docsTested;
+
+        // How many times did we ask for the records after a not-in-memory one to be prefetched?
+        size_t readAheads;
     };
 
     struct DistinctScanStats : public SpecificStats {
@@ -209,7 +212,8 @@ namespace mongo {
     struct FetchStats : public SpecificStats {
         FetchStats() : alreadyHasObj(0),
                        forcedFetches(0),
-                       matchTested(0) { }
+                       matchTested(0),
+                       readAheads(0) { }
 
         virtual ~FetchStats() { }
 
@@ -230,6 +234,10 @@ namespace mongo {
 
         // We know how many passed (it's the # of advanced) and therefore how many failed.
         size_t matchTested;
+
+        // How many not-in-memory records did we read ahead of the one being fetched and ask to
+        // have prefetched?
+        size_t readAheads;
     };
 
     struct IndexScanStats : public SpecificStats {
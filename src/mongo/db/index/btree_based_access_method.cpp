@@ -28,6 +28,7 @@
 
 #include "mongo/db/index/btree_access_method.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "mongo/base/error_codes.h"
@@ -116,6 +117,93 @@ namespace mongo {
         return Status::OK();
     }
 
+    namespace {
+        /** orders ExternalSortDatum the way an ExternalSortComparison does, for std::sort */
+        class ExternalSortLess {
+        public:
+            ExternalSortLess(const ExternalSortComparison* cmp) : _cmp(cmp) { }
+            bool operator()(const ExternalSortDatum& l, const ExternalSortDatum& r) const {
+                return _cmp->compare(l, r) < 0;
+            }
+        private:
+            const ExternalSortComparison* _cmp;
+        };
+    }
+
+    // Sort the keys of all of objs the way the btree orders them, so consecutive inserts land
+    // on the same or neighbouring buckets, and put them in
+    Status BtreeBasedAccessMethod::insertMany(const std::vector<BSONObj>& objs,
+                                              const std::vector<DiskLoc>& locs,
+                                              const InsertDeleteOptions& options,
+                                              int64_t* numInserted,
+                                              const std::vector<const PregeneratedKeysOnIndex*>* prepared ) {
+        invariant(options.dupsAllowed);
+        invariant(objs.size() == locs.size());
+
+        vector<ExternalSortDatum> keys;
+        bool multikey = false;
+        for (size_t i = 0; i < objs.size(); ++i) {
+            const PregeneratedKeysOnIndex* pregen = prepared ? (*prepared)[i] : NULL;
+
+            BSONObjSet myOwnedKeys;
+            const BSONObjSet* keysToUse = &myOwnedKeys;
+            if ( pregen && pregen->generator->getId() == getKeyGenerator()->getId() ) {
+                keysToUse = &pregen->keys;
+            }
+            else {
+                getKeys(objs[i], &myOwnedKeys);
+            }
+
+            if (keysToUse->size() > 1) {
+                multikey = true;
+            }
+            for (BSONObjSet::const_iterator k = keysToUse->begin(); k != keysToUse->end(); ++k) {
+                keys.push_back(make_pair(*k, locs[i]));
+            }
+        }
+
+        scoped_ptr<ExternalSortComparison> cmp(getComparison(_descriptor->version(),
+                                                             _descriptor->keyPattern()));
+        std::sort(keys.begin(), keys.end(), ExternalSortLess(cmp.get()));
+
+        *numInserted = 0;
+
+        // the keys we put in, so a failure can take them out again without touching one a
+        // background index build got to first
+        vector<size_t> inserted;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            try {
+                _interface->bt_insert(_btreeState,
+                                      _btreeState->head(),
+                                      keys[i].second,
+                                      keys[i].first,
+                                      options.dupsAllowed,
+                                      true);
+                inserted.push_back(i);
+            }
+            catch (AssertionException& e) {
+                if (10287 == e.getCode() && !_btreeState->isReady()) {
+                    DEV log() << "info: key already in index during bg indexing (ok)\n";
+                    continue;
+                }
+
+                problem() << " caught assertion addKeysToIndex "
+                          << _descriptor->indexNamespace() << endl;
+                for (size_t j = 0; j < inserted.size(); ++j) {
+                    removeOneKey(keys[inserted[j]].first, keys[inserted[j]].second);
+                }
+                return Status(ErrorCodes::InternalError, e.what(), e.getCode());
+            }
+        }
+        *numInserted = inserted.size();
+
+        if (multikey) {
+            _btreeState->setMultikey();
+        }
+
+        return Status::OK();
+    }
+
     bool BtreeBasedAccessMethod::removeOneKey(const BSONObj& key, const DiskLoc& loc) {
         bool ret = false;
 
@@ -244,6 +332,89 @@ namespace mongo {
     }
 
 
+    // How many leaf buckets getSeparatorKeys() reads to estimate how full the leaves are.
+    static const size_t kSeparatorLeafSample = 64;
+
+    bool BtreeBasedAccessMethod::getSeparatorKeys(const BSONObj& startKey,
+                                                  const BSONObj& endKey,
+                                                  vector<BSONObj>* keys,
+                                                  double* keysBetween) const {
+        const DiskLoc head = _btreeState->head();
+
+        // All leaves are at the same depth, so the leftmost path gives the height.
+        int height = 0;
+        for (DiskLoc loc = _interface->childAt(_btreeState, head, 0);
+             !loc.isNull();
+             loc = _interface->childAt(_btreeState, loc, 0)) {
+            height++;
+        }
+        if (0 == height) {
+            return false;
+        }
+
+        keys->clear();
+        vector<DiskLoc> leaves;
+        collectSeparatorKeys(head, height, startKey, endKey,
+                             Ordering::make(_descriptor->keyPattern()), keys, &leaves);
+        if (keys->empty()) {
+            return false;
+        }
+
+        long long sampledKeys = 0;
+        long long sampledLeaves = 0;
+        const size_t step = std::max(size_t(1), leaves.size() / kSeparatorLeafSample);
+        for (size_t i = 0; i < leaves.size(); i += step) {
+            sampledKeys += _interface->nKeys(_btreeState, leaves[i]);
+            sampledLeaves++;
+        }
+        const double keysPerLeaf = sampledLeaves ? double(sampledKeys) / sampledLeaves : 0;
+
+        *keysBetween = (keys->size() + leaves.size() * keysPerLeaf) / keys->size();
+        return true;
+    }
+
+    bool BtreeBasedAccessMethod::collectSeparatorKeys(const DiskLoc& bucket,
+                                                      int height,
+                                                      const BSONObj& startKey,
+                                                      const BSONObj& endKey,
+                                                      const Ordering& ordering,
+                                                      vector<BSONObj>* keys,
+                                                      vector<DiskLoc>* leaves) const {
+        const int n = _interface->nKeys(_btreeState, bucket);
+        for (int i = 0; i <= n; i++) {
+            BSONObj key;
+            if (i < n) {
+                key = _interface->keyAt(_btreeState, bucket, i);
+                // The child to the left of this key is entirely before the range too.
+                if (key.woCompare(startKey, ordering, false) < 0) {
+                    continue;
+                }
+            }
+
+            DiskLoc child = _interface->childAt(_btreeState, bucket, i);
+            if (!child.isNull()) {
+                if (1 == height) {
+                    leaves->push_back(child);
+                }
+                else if (!collectSeparatorKeys(child, height - 1, startKey, endKey, ordering,
+                                               keys, leaves)) {
+                    return false;
+                }
+            }
+
+            if (i == n) {
+                break;
+            }
+            if (key.woCompare(endKey, ordering, false) >= 0) {
+                return false;
+            }
+            if (_interface->keyIsUsed(_btreeState, bucket, i)) {
+                keys->push_back(key.getOwned());
+            }
+        }
+        return true;
+    }
+
     Status BtreeBasedAccessMethod::validate(int64_t* numKeys) {
         *numKeys = _interface->fullValidate(_btreeState,
                                             _btreeState->head(),
@@ -349,6 +520,17 @@ namespace mongo {
             return Status::OK();
         }
 
+        virtual Status insertMany(const std::vector<BSONObj>& objs,
+                                  const std::vector<DiskLoc>& locs,
+                                  const InsertDeleteOptions& options,
+                                  int64_t* numInserted,
+                                  const std::vector<const PregeneratedKeysOnIndex*>* prepared ) {
+            *numInserted = 0;
+            for ( size_t i = 0; i < objs.size(); i++ )
+                insert( objs[i], locs[i], options, numInserted, NULL );
+            return Status::OK();
+        }
+
         virtual Status remove(const BSONObj& obj,
                               const DiskLoc& loc,
                               const InsertDeleteOptions& options,
@@ -67,6 +67,12 @@ namespace mongo {
                               int64_t* numInserted,
                               const PregeneratedKeysOnIndex* prepared = NULL ) ;
 
+        virtual Status insertMany(const std::vector<BSONObj>& objs,
+                                  const std::vector<DiskLoc>& locs,
+                                  const InsertDeleteOptions& options,
+                                  int64_t* numInserted,
+                                  const std::vector<const PregeneratedKeysOnIndex*>* prepared );
+
         virtual Status remove(const BSONObj& obj,
                               const DiskLoc& loc,
                               const InsertDeleteOptions& options,
@@ -99,6 +105,19 @@ namespace mongo {
         // XXX: consider migrating callers to use IndexCursor instead
         virtual DiskLoc findSingle( const BSONObj& key ) const;
 
+        /**
+         * Collects, in order, the keys in [startKey, endKey) that are stored above the leaf
+         * level of the btree, without reading the leaves except for a small sample.
+         * Consecutive keys are about '*keysBetween' index keys apart, as estimated from the
+         * sampled leaves, so the result approximates quantiles of the range.
+         * Returns false if the btree has no level above the leaves or the range has no such
+         * keys; the range has to be scanned instead.
+         */
+        bool getSeparatorKeys(const BSONObj& startKey,
+                              const BSONObj& endKey,
+                              vector<BSONObj>* keys,
+                              double* keysBetween) const;
+
         // exposed for testing, used for bulk commit
         static ExternalSortComparison* getComparison(int version,
                                                      const BSONObj& keyPattern);
@@ -120,6 +139,19 @@ namespace mongo {
 
     private:
         bool removeOneKey(const BSONObj& key, const DiskLoc& loc);
+
+        /**
+         * Helper for getSeparatorKeys().  Visits 'bucket', 'height' levels above the leaves, and
+         * its descendants down to the level above the leaves.
+         * Returns false once endKey has been reached.
+         */
+        bool collectSeparatorKeys(const DiskLoc& bucket,
+                                  int height,
+                                  const BSONObj& startKey,
+                                  const BSONObj& endKey,
+                                  const Ordering& ordering,
+                                  vector<BSONObj>* keys,
+                                  vector<DiskLoc>* leaves) const;
     };
 
     /**
@@ -196,6 +196,16 @@ namespace mongo {
             }
         }
 
+        virtual DiskLoc childAt(const IndexCatalogEntry* btreeState,
+                                DiskLoc bucket, int keyOffset) const {
+            verify(!bucket.isNull());
+            const BtreeBucket<Version> *b = getBucket(btreeState,bucket);
+            if (keyOffset == b->getN()) {
+                return b->getNextChild();
+            }
+            return b->keyNode(keyOffset).prevChildBucket;
+        }
+
         virtual string dupKeyError(const IndexCatalogEntry* btreeState,
                                    DiskLoc bucket,
                                    const BSONObj& keyObj) const {
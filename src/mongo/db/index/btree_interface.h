@@ -147,6 +147,13 @@ namespace mongo {
         virtual void keyAndRecordAt(const IndexCatalogEntry* btreeState,
                                     DiskLoc bucket, int keyOffset, BSONObj* keyOut,
                                     DiskLoc* recordOut) const = 0;
+
+        /**
+         * Get the child bucket to the left of the key at (bucket, keyOffset), or the rightmost
+         * child if keyOffset is the number of keys in the bucket.  Null for a leaf.
+         */
+        virtual DiskLoc childAt(const IndexCatalogEntry* btreeState,
+                                DiskLoc bucket, int keyOffset) const = 0;
     };
 
 }  // namespace mongo
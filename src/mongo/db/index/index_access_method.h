@@ -78,6 +78,23 @@ namespace mongo {
                               int64_t* numInserted,
                               const PregeneratedKeysOnIndex* prepared = NULL ) = 0;
 
+        /**
+         * insert() for several documents at once, objs[i] being at locs[i].  The keys of all of
+         * them are put into the index together, which lets the index insert them in its own
+         * order.  Either all of the keys are inserted or none are.  'numInserted' is set to the
+         * number of keys added.
+         *
+         * Only for 'options.dupsAllowed': with a unique index, which document a duplicate is
+         * reported against depends on the order the documents go in.
+         *
+         * prepared: NULL, or one entry per document as for insert() (entries may be NULL).
+         */
+        virtual Status insertMany(const std::vector<BSONObj>& objs,
+                                  const std::vector<DiskLoc>& locs,
+                                  const InsertDeleteOptions& options,
+                                  int64_t* numInserted,
+                                  const std::vector<const PregeneratedKeysOnIndex*>* prepared ) = 0;
+
         /**
          * Analogous to above, but remove the records instead of inserting them.  If not NULL,
          * numDeleted will be set to the number of keys removed from the index for the document.
@@ -46,6 +46,7 @@
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/background.h"
+#include "mongo/db/catalog/collection.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands/fsync.h"
 #include "mongo/db/d_concurrency.h"
@@ -76,6 +77,7 @@
 #include "mongo/db/query/new_find.h"
 #include "mongo/db/repl/is_master.h"
 #include "mongo/db/repl/oplog.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/platform/process_id.h"
@@ -115,6 +117,13 @@ namespace mongo {
 
     MONGO_FP_DECLARE(rsStopGetMore);
 
+    // How long a getMore on a tailable awaitData cursor waits for new documents before replying
+    // with an empty batch
+    MONGO_EXPORT_SERVER_PARAMETER(awaitDataMaxWaitMillis, int, 4000);
+
+    // Longest single sleep while waiting, so that shutdown and killOp are noticed
+    static const int awaitDataWaitSliceMillis = 1000;
+
     void BSONElementManipulator::SetNumber(double d) {
         if ( _element.type() == NumberDouble )
             *getDur().writing( &little< double >::ref( value() ) ) = d;
@@ -711,7 +720,8 @@ namespace mongo {
         int pass = 0;
         bool exhaust = false;
         QueryResult* msgdata = 0;
-        OpTime last;
+        shared_ptr<CappedInsertNotifier> insertNotifier;
+        uint64_t insertNotifierVersion = 0;
         while( 1 ) {
             bool isCursorAuthorized = false;
             try {
@@ -727,14 +737,6 @@ namespace mongo {
                     while (MONGO_FAIL_POINT(rsStopGetMore)) {
                         sleepmillis(0);
                     }
-
-                    if (pass == 0) {
-                        mutex::scoped_lock lk(OpTime::m);
-                        last = OpTime::getLast(lk);
-                    }
-                    else {
-                        last.waitForDifferent(1000/*ms*/);
-                    }
                 }
 
                 msgdata = newGetMore(ns,
@@ -743,7 +745,9 @@ namespace mongo {
                                      curop,
                                      pass,
                                      exhaust,
-                                     &isCursorAuthorized);
+                                     &isCursorAuthorized,
+                                     &insertNotifier,
+                                     &insertNotifierVersion);
             }
             catch ( AssertionException& e ) {
                 if ( isCursorAuthorized ) {
@@ -766,23 +770,29 @@ namespace mongo {
                 if ( ! timer ) {
                     timer.reset( new Timer() );
                 }
+
+                int remainingMillis = awaitDataMaxWaitMillis - timer->millis();
+                if ( remainingMillis <= 0 ) {
+                    // return an empty batch. pass stops at 1000 normally.
+                    // we want to return occasionally so slave can checkpoint.
+                    pass = 10000;
+                }
                 else {
-                    if ( timer->seconds() >= 4 ) {
-                        // after about 4 seconds, return. pass stops at 1000 normally.
-                        // we want to return occasionally so slave can checkpoint.
-                        pass = 10000;
+                    pass++;
+                    if ( insertNotifier ) {
+                        // capped collections wake us up when something is inserted
+                        insertNotifier->waitForInsert( insertNotifierVersion,
+                                                       std::min( remainingMillis,
+                                                                 awaitDataWaitSliceMillis ) );
                     }
+                    else if (debug)
+                        sleepmillis(20);
+                    else
+                        sleepmillis(2);
                 }
-                pass++;
-                if (debug)
-                    sleepmillis(20);
-                else
-                    sleepmillis(2);
-                
-                // note: the 1100 is beacuse of the waitForDifferent above
-                // should eventually clean this up a bit
-                curop.setExpectedLatencyMs( 1100 + timer->millis() );
-                
+
+                curop.setExpectedLatencyMs( std::max( 0, int( awaitDataMaxWaitMillis ) ) + 100 );
+
                 continue;
             }
             break;
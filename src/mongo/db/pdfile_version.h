@@ -38,6 +38,11 @@ namespace mongo {
     const int PDFILE_VERSION_MINOR_INDEX_MASK = 0xf;
     const int PDFILE_VERSION_MINOR_28_FREELIST_MASK = (1 << 4); // SERVER-14081
 
+    // Set once a database has .ns overflow segments (<db>.ns.1, ...).  Older versions only read
+    // the .ns file itself, so they must refuse to open the database rather than lose the
+    // namespaces in the segments.
+    const int PDFILE_VERSION_MINOR_NS_SEGMENTS_MASK = (1 << 5);
+
     // For backward compatibility with versions before 2.4.0 all new DBs start
     // with PDFILE_VERSION_MINOR_22_AND_OLDER and are converted when the first
     // index using a new plugin is created. See the logic in
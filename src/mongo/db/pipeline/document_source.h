@@ -55,6 +55,7 @@ namespace mongo {
     class ExpressionFieldPath;
     class ExpressionObject;
     class DocumentSourceLimit;
+    class DocumentSourceSkipInserts;
     class Runner;
 
     class DocumentSource : public IntrusiveCounterUnsigned {
@@ -224,6 +225,10 @@ namespace mongo {
 
             virtual bool isCapped(const NamespaceString& ns) = 0;
 
+            // The optime most recently handed out for an oplog entry. Cheap to call, for noticing
+            // that nothing has been logged since an earlier look at the oplog.
+            virtual OpTime lastOpTime() = 0;
+
             // Add new methods as needed.
         };
 
@@ -472,6 +477,36 @@ namespace mongo {
             BSONElement elem,
             const intrusive_ptr<ExpressionContext> &pExpCtx);
 
+        typedef intrusive_ptr<Accumulator> (*AccumulatorFactory)();
+
+        /**
+          Look up a group operator by name.
+
+          @param opName the operator name including the leading '$', e.g. "$sum"
+          @returns the factory for that operator's Accumulator, or NULL if
+                there is no such operator
+         */
+        static AccumulatorFactory getAccumulatorFactory(const char* opName);
+
+        /**
+          Check whether the documents this source outputs can later be combined
+          with mergeResults(). This is false if any accumulator is an $avg.
+         */
+        bool canMergeResults() const;
+
+        /**
+          Combine two output documents for the same group.
+
+          This is used to fold the result of grouping newly added input into
+          a result that was produced earlier.
+
+          @param existing an earlier output document
+          @param delta an output document with the same _id, computed over
+                input that was not seen by existing
+          @returns a document with existing's _id and the merged accumulators
+         */
+        Document mergeResults(const Document& existing, const Document& delta) const;
+
         // Virtuals for SplittableDocumentSource
         virtual intrusive_ptr<DocumentSource> getShardSource();
         virtual intrusive_ptr<DocumentSource> getMergeSource();
@@ -591,6 +626,19 @@ namespace mongo {
          */
         BSONObj redactSafePortion() const;
 
+        /** Returns a query that a document must match before an $unwind of unwindPath for any of
+         *  the documents unwound from it to match this. If this returns an empty BSONObj, nothing
+         *  can be said about the document before the $unwind.
+         *
+         *  Conditions on subfields of the unwound array, like {"items.sku": 5} after unwinding
+         *  "items", become an {items: {$elemMatch: {sku: 5}}}. Only conditions that reject
+         *  documents missing the field are used, since $elemMatch doesn't look at array elements
+         *  that aren't objects. Documents with nested arrays in "items" are also kept, as the
+         *  conditions apply to each element of those once unwound:
+         *  {$or: [{items: {$elemMatch: {sku: 5}}}, {items: {$elemMatch: {$type: 4}}}]}
+         */
+        BSONObj elemMatchBeforeUnwind(const string& unwindPath) const;
+
         static bool isTextQuery(const BSONObj& query);
         bool isTextQuery() const { return _isTextQuery; }
 
@@ -643,6 +691,12 @@ namespace mongo {
             CursorAndConnection(ConnectionString host, NamespaceString ns, CursorId id);
             ScopedDbConnection connection;
             DBClientCursor cursor;
+
+            // True while a getMore has been sent on 'connection' but its reply not yet read.
+            bool getMorePending;
+
+            // Size of the last batch received, used to estimate the size of a pending reply.
+            int lastBatchBytes;
         };
 
         // using list to enable removing arbitrary elements
@@ -655,6 +709,17 @@ namespace mongo {
         // Converts _cursorIds into active _cursors.
         void start();
 
+        /**
+         * Sends a getMore for 'cursor' without waiting for the reply, provided the remote cursor
+         * is still alive and the estimated size of all outstanding replies stays within
+         * internalAggMergeCursorsPrefetchBytes. A getMore is always allowed when none is pending
+         * so that the merge can make progress.
+         */
+        void prefetch(CursorAndConnection* cursor);
+
+        // Blocks until the reply to a getMore sent by prefetch() has been received.
+        void finishPrefetch(CursorAndConnection* cursor);
+
         // This is the description of cursors to merge.
         const CursorIds _cursorIds;
 
@@ -662,6 +727,9 @@ namespace mongo {
         Cursors _cursors;
         Cursors::iterator _currentCursor;
 
+        // Sum of lastBatchBytes over all cursors with a getMore in flight.
+        long long _bytesInFlight;
+
         bool _unstarted;
     };
 
@@ -682,6 +750,31 @@ namespace mongo {
 
         const NamespaceString& getOutputNs() const { return _outputNs; }
 
+        /// True if this was created with mode "incremental".
+        bool isIncremental() const { return _incremental; }
+
+        /**
+         * Sets up the refresh of an incremental $out. Called by PipelineD once the mongod
+         * interface has been injected.
+         *
+         * If the output collection still reflects the same pipeline over the same source, and
+         * only inserts have been made to the source since it was last refreshed, this returns a
+         * source that produces just those inserted documents. The caller must put it at the front
+         * of the pipeline, and the results of 'group' are then merged into the existing output.
+         * Otherwise this returns NULL and the output is rebuilt, as of the current end of the
+         * oplog: the caller must put getRebuildFilter() right after the cursor, so documents
+         * inserted while the rebuild yields are left for the next refresh to merge in.
+         *
+         * @param group the $group directly preceding this stage
+         * @param refreshSpec identifies the results being maintained: {ns: ..., pipeline: [...]}
+         */
+        intrusive_ptr<DocumentSource> prepareIncrementalRefresh(
+            const intrusive_ptr<DocumentSourceGroup>& group,
+            const BSONObj& refreshSpec);
+
+        /// The filter a rebuild of incremental output runs its input through, or NULL.
+        intrusive_ptr<DocumentSource> getRebuildFilter() const;
+
         /**
           Create a document source for output and pass-through.
 
@@ -698,19 +791,149 @@ namespace mongo {
 
         static const char outName[];
 
+        // Holds one {_id: <output ns>, spec: <refreshSpec>, ts: <optime>, refresh: <"rebuild" or
+        // "delta">} document for each incrementally maintained output collection.
+        static const char refreshStateNs[];
+
     private:
         DocumentSourceOut(const NamespaceString& outputNs,
+                          bool incremental,
                           const intrusive_ptr<ExpressionContext> &pExpCtx);
 
+        // Fails if _outputNs can't be written to by $out.
+        void checkOutputNs();
+
         // Sets _tempsNs and prepares it to receive data.
         void prepTempCollection();
 
         void spill(DBClientBase* conn, const vector<BSONObj>& toInsert);
 
+        // Returns true if the oplog has entries in (after, upTo] that change the source in ways
+        // other than inserts.
+        bool sourceChangedBetween(DBClientBase* conn, const OpTime& after, const OpTime& upTo);
+
+        // Returns the source of the documents inserted since the last refresh if they can be
+        // merged into the output as it is, otherwise NULL.
+        intrusive_ptr<DocumentSource> prepareDeltaRefresh(DBClientBase* conn);
+
+        // Folds each delta result from pSource into the existing output collection.
+        void mergeDeltas(DBClientBase* conn);
+
+        // Returns the optime of the newest entry in the oplog.
+        OpTime getLastOpTime(DBClientBase* conn);
+
+        void saveRefreshState(DBClientBase* conn);
+        void forgetRefreshState(DBClientBase* conn);
+
         bool _done;
 
         NamespaceString _tempNs; // output goes here as it is being processed.
         const NamespaceString _outputNs; // output will go here after all data is processed.
+
+        // Only used in incremental mode. These are set up by prepareIncrementalRefresh().
+        const bool _incremental;
+        intrusive_ptr<DocumentSourceGroup> _group;
+        BSONObj _refreshSpec;
+        string _oplogNs;
+        bool _deltaRefresh; // only merging what was inserted since the last refresh
+        OpTime _refreshUpTo; // the output reflects the source as of this oplog entry when done
+        intrusive_ptr<DocumentSourceSkipInserts> _rebuildFilter; // only when rebuilding
+    };
+
+
+    /**
+     * Produces the documents inserted into a collection between two points in the oplog. This is
+     * used as the initial source when incrementally refreshing the results of an aggregation.
+     */
+    class DocumentSourceOplogInserts : public DocumentSource
+                                     , public DocumentSourceNeedsMongod {
+    public:
+        // virtuals from DocumentSource
+        virtual boost::optional<Document> getNext();
+        virtual const char *getSourceName() const;
+        virtual Value serialize(bool explain = false) const;
+        virtual bool isValidInitialSource() const { return true; }
+        virtual void dispose();
+
+        /**
+         * @param oplogNs the oplog collection to read
+         * @param ns the collection whose inserts are wanted
+         * @param after only inserts logged after this optime are returned
+         * @param upTo ... and at or before this one
+         */
+        static intrusive_ptr<DocumentSourceOplogInserts> create(
+            const string& oplogNs,
+            const NamespaceString& ns,
+            const OpTime& after,
+            const OpTime& upTo,
+            const intrusive_ptr<ExpressionContext> &pExpCtx);
+
+        static const char name[];
+
+    private:
+        DocumentSourceOplogInserts(const string& oplogNs,
+                                   const NamespaceString& ns,
+                                   const OpTime& after,
+                                   const OpTime& upTo,
+                                   const intrusive_ptr<ExpressionContext> &pExpCtx);
+
+        BSONObj getQuery() const;
+
+        const string _oplogNs;
+        const NamespaceString _ns;
+        const OpTime _after;
+        const OpTime _upTo;
+        auto_ptr<DBClientCursor> _cursor;
+    };
+
+
+    /**
+     * Drops the documents that were inserted into a collection after a point in the oplog. Put
+     * right after the cursor of a rebuild that yields, it makes the results reflect the source as
+     * of that point as far as inserts go, so the next incremental refresh can merge in everything
+     * inserted since without counting any of it twice.
+     */
+    class DocumentSourceSkipInserts : public DocumentSource
+                                    , public DocumentSourceNeedsMongod {
+    public:
+        // virtuals from DocumentSource
+        virtual boost::optional<Document> getNext();
+        virtual const char *getSourceName() const;
+        virtual Value serialize(bool explain = false) const;
+        virtual GetDepsReturn getDependencies(DepsTracker* deps) const;
+
+        /// False if more documents were inserted during the run than could be kept track of, in
+        /// which case some of them may have been passed through.
+        bool complete() const { return !_overflowed; }
+
+        /**
+         * @param oplogNs the oplog collection to read
+         * @param ns the collection the documents come from
+         * @param after documents whose inserts were logged after this optime are dropped
+         */
+        static intrusive_ptr<DocumentSourceSkipInserts> create(
+            const string& oplogNs,
+            const NamespaceString& ns,
+            const OpTime& after,
+            const intrusive_ptr<ExpressionContext> &pExpCtx);
+
+        static const char name[];
+
+    private:
+        DocumentSourceSkipInserts(const string& oplogNs,
+                                  const NamespaceString& ns,
+                                  const OpTime& after,
+                                  const intrusive_ptr<ExpressionContext> &pExpCtx);
+
+        // Adds the _ids of the inserts logged since _seenUpTo to _inserted.
+        void readNewInserts();
+
+        const string _oplogNs;
+        const NamespaceString _ns;
+        const OpTime _after;
+        OpTime _seenUpTo; // _inserted holds every insert logged in (_after, _seenUpTo]
+        ValueSet _inserted;
+        bool _overflowed;
     };
 
     
@@ -1039,6 +1262,9 @@ namespace mongo {
 
         static const char unwindName[];
 
+        /// The dotted path of the array being unwound, without the leading '$'.
+        string getUnwindPath() const { return _unwindPath->getPath(false); }
+
     private:
         DocumentSourceUnwind(const intrusive_ptr<ExpressionContext> &pExpCtx);
 
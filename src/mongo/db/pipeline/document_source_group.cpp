@@ -238,6 +238,18 @@ namespace mongo {
 
     static const size_t NGroupOp = sizeof(GroupOpTable)/sizeof(GroupOpTable[0]);
 
+    DocumentSourceGroup::AccumulatorFactory DocumentSourceGroup::getAccumulatorFactory(
+            const char* opName) {
+        GroupOpDesc key;
+        key.name = opName;
+        const GroupOpDesc *pOp =
+            (const GroupOpDesc *)bsearch(
+                  &key, GroupOpTable, NGroupOp, sizeof(GroupOpDesc),
+                          GroupOpDescCmp);
+
+        return pOp ? pOp->factory : NULL;
+    }
+
     intrusive_ptr<DocumentSource> DocumentSourceGroup::createFromBson(
             BSONElement elem,
             const intrusive_ptr<ExpressionContext> &pExpCtx) {
@@ -294,15 +306,11 @@ namespace mongo {
                     BSONElement subElement(subIterator.next());
 
                     /* look for the specified operator */
-                    GroupOpDesc key;
-                    key.name = subElement.fieldName();
-                    const GroupOpDesc *pOp =
-                        (const GroupOpDesc *)bsearch(
-                              &key, GroupOpTable, NGroupOp, sizeof(GroupOpDesc),
-                                      GroupOpDescCmp);
+                    const char* opName = subElement.fieldName();
+                    AccumulatorFactory factory = getAccumulatorFactory(opName);
 
-                    uassert(15952, str::stream() << "unknown group operator '" << key.name << "'",
-                            pOp);
+                    uassert(15952, str::stream() << "unknown group operator '" << opName << "'",
+                            factory);
 
                     intrusive_ptr<Expression> pGroupExpr;
 
@@ -313,13 +321,13 @@ namespace mongo {
                     }
                     else if (elementType == Array) {
                         uasserted(15953, str::stream()
-                                << "aggregating group operators are unary (" << key.name << ")");
+                                << "aggregating group operators are unary (" << opName << ")");
                     }
                     else { /* assume its an atomic single operand */
                         pGroupExpr = Expression::parseOperand(subElement, vps);
                     }
 
-                    pGroup->addAccumulator(pFieldName, pOp->factory, pGroupExpr);
+                    pGroup->addAccumulator(pFieldName, factory, pGroupExpr);
                 }
 
                 uassert(15954, str::stream() <<
@@ -619,6 +627,38 @@ namespace mongo {
 
         return pMerger;
     }
+
+    bool DocumentSourceGroup::canMergeResults() const {
+        // $avg only outputs the final average, which can't be combined with another one.
+        for (size_t i = 0; i < vpAccumulatorFactory.size(); i++) {
+            if (vpAccumulatorFactory[i] == &AccumulatorAvg::create)
+                return false;
+        }
+        return true;
+    }
+
+    Document DocumentSourceGroup::mergeResults(const Document& existing,
+                                               const Document& delta) const {
+        dassert(canMergeResults());
+
+        MutableDocument out(existing);
+        const size_t n = vFieldName.size();
+        for (size_t i = 0; i < n; ++i) {
+            intrusive_ptr<Accumulator> pAccumulator = (*vpAccumulatorFactory[i])();
+
+            const Value existingValue = existing[vFieldName[i]];
+            if (!existingValue.missing())
+                pAccumulator->process(existingValue, true);
+
+            const Value deltaValue = delta[vFieldName[i]];
+            if (!deltaValue.missing())
+                pAccumulator->process(deltaValue, true);
+
+            out[vFieldName[i]] = pAccumulator->getValue(false);
+        }
+
+        return out.freeze();
+    }
 }
 
 #include "db/sorter/sorter.cpp"
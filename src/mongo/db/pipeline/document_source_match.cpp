@@ -291,6 +291,30 @@ namespace {
         return redactSafePortionTopLevel(getQuery()).toBson();
     }
 
+    BSONObj DocumentSourceMatch::elemMatchBeforeUnwind(const string& unwindPath) const {
+        // A redact-safe condition never matches a missing field, so it can only match after the
+        // $unwind if the array element it was unwound from is an object with that field. The
+        // redact-safe portion also excludes numeric path components, which would mean something
+        // different once the element is no longer in an array.
+        const string prefix = unwindPath + '.';
+        BSONObjBuilder elemMatch;
+        BSONForEach(field, redactSafePortion()) {
+            const StringData fieldName = field.fieldNameStringData();
+            if (fieldName.startsWith(prefix))
+                elemMatch.appendAs(field, fieldName.substr(prefix.size()));
+        }
+
+        const BSONObj conditions = elemMatch.obj();
+        if (conditions.isEmpty())
+            return BSONObj();
+
+        // An element that is itself an array becomes an array after the $unwind, and the
+        // conditions are then applied to each of its elements, which $elemMatch doesn't do.
+        return BSON("$or" << BSON_ARRAY(
+                        BSON(unwindPath << BSON("$elemMatch" << conditions))
+                     << BSON(unwindPath << BSON("$elemMatch" << BSON("$type" << Array)))));
+    }
+
     void DocumentSourceMatch::setSource(DocumentSource* source) {
         uassert(17313, "$match with $text is only allowed as the first pipeline stage",
                 !_isTextQuery);
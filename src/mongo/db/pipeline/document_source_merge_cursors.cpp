@@ -30,9 +30,14 @@
 
 #include "mongo/db/pipeline/document_source.h"
 
+#include "mongo/db/server_parameters.h"
 
 namespace mongo {
 
+    // Upper bound on the estimated size of getMore replies that may be outstanding at once
+    // across all shard cursors being merged.
+    MONGO_EXPORT_SERVER_PARAMETER(internalAggMergeCursorsPrefetchBytes, int, 16 * 1024 * 1024);
+
     const char DocumentSourceMergeCursors::name[] = "$mergeCursors";
 
     const char* DocumentSourceMergeCursors::getSourceName() const {
@@ -49,6 +54,7 @@ namespace mongo {
             const intrusive_ptr<ExpressionContext> &pExpCtx)
         : DocumentSource(pExpCtx)
         , _cursorIds(cursorIds)
+        , _bytesInFlight(0)
         , _unstarted(true)
     {}
 
@@ -93,6 +99,8 @@ namespace mongo {
             CursorId id)
         : connection(host)
         , cursor(connection.get(), ns, id, 0, 0)
+        , getMorePending(false)
+        , lastBatchBytes(0)
     {}
 
     vector<DBClientCursor*> DocumentSourceMergeCursors::getCursors() {
@@ -127,11 +135,42 @@ namespace mongo {
                     "error reading response from " + _cursors.back()->connection->toString(),
                     ok);
             verify(!retry);
+            (*it)->lastBatchBytes = (*it)->cursor.getMessage()->size();
         }
 
         _currentCursor = _cursors.begin();
     }
 
+    void DocumentSourceMergeCursors::prefetch(CursorAndConnection* cursor) {
+        if (cursor->getMorePending || cursor->cursor.isDead())
+            return;
+
+        if (_bytesInFlight > 0
+                && _bytesInFlight + cursor->lastBatchBytes > internalAggMergeCursorsPrefetchBytes)
+            return;
+
+        // A DBClientCursor with a live cursor id assembles a getMore rather than a query.
+        cursor->cursor.initLazy();
+        cursor->getMorePending = true;
+        _bytesInFlight += cursor->lastBatchBytes;
+    }
+
+    void DocumentSourceMergeCursors::finishPrefetch(CursorAndConnection* cursor) {
+        verify(cursor->getMorePending);
+
+        bool retry = false;
+        const bool ok = cursor->cursor.initLazyFinish(retry); // blocks here for the reply
+        cursor->getMorePending = false;
+        _bytesInFlight -= cursor->lastBatchBytes;
+
+        uassert(28600, "error reading response from " + cursor->connection->toString(), ok);
+        verify(!retry);
+        cursor->lastBatchBytes = cursor->cursor.getMessage()->size();
+
+        // Keep the shard busy producing its next batch while we consume this one.
+        prefetch(cursor);
+    }
+
     Document DocumentSourceMergeCursors::nextSafeFrom(DBClientCursor* cursor) {
         const BSONObj next = cursor->next();
         if (next.hasField("$err")) {
@@ -144,30 +183,67 @@ namespace mongo {
     }
 
     boost::optional<Document> DocumentSourceMergeCursors::getNext() {
-        if (_unstarted)
+        if (_unstarted) {
             start();
 
-        // purge eof cursors and release their connections
-        while (!_cursors.empty() && !(*_currentCursor)->cursor.more()) {
-            (*_currentCursor)->connection.done();
-            _cursors.erase(_currentCursor);
-            _currentCursor = _cursors.begin();
+            // Every shard has answered with its first batch, so request the second ones now.
+            for (Cursors::const_iterator it = _cursors.begin(); it != _cursors.end(); ++it) {
+                prefetch(it->get());
+            }
         }
 
-        if (_cursors.empty())
-            return boost::none;
-
-        const Document next = nextSafeFrom(&((*_currentCursor)->cursor));
-
-        // advance _currentCursor, wrapping if needed
-        if (++_currentCursor == _cursors.end())
-            _currentCursor = _cursors.begin();
-
-        return next;
+        while (true) {
+            // Visit each cursor once, starting from _currentCursor, looking for one that already
+            // has results buffered. Along the way, release exhausted cursors and issue getMores
+            // for drained ones so that slow shards are not waited on while others have data.
+            Cursors::iterator it = _currentCursor;
+            Cursors::iterator pending = _cursors.end();
+            for (size_t toVisit = _cursors.size(); toVisit > 0; --toVisit) {
+                CursorAndConnection* const cursor = it->get();
+
+                if (cursor->cursor.moreInCurrentBatch()) {
+                    const Document next = nextSafeFrom(&cursor->cursor);
+
+                    // advance _currentCursor, wrapping if needed
+                    if (++it == _cursors.end())
+                        it = _cursors.begin();
+                    _currentCursor = it;
+
+                    return next;
+                }
+
+                if (!cursor->getMorePending && cursor->cursor.isDead()) {
+                    // purge eof cursors and release their connections
+                    cursor->connection.done();
+                    it = _cursors.erase(it);
+                }
+                else {
+                    prefetch(cursor);
+                    if (cursor->getMorePending && pending == _cursors.end())
+                        pending = it;
+                    ++it;
+                }
+
+                if (it == _cursors.end())
+                    it = _cursors.begin();
+            }
+
+            if (_cursors.empty()) {
+                _currentCursor = _cursors.end();
+                return boost::none;
+            }
+
+            // Nothing is buffered locally, so wait for the first outstanding reply. There must be
+            // one: prefetch() only declines to send a getMore while another is in flight.
+            verify(pending != _cursors.end());
+            finishPrefetch(pending->get());
+            _currentCursor = pending;
+        }
     }
 
     void DocumentSourceMergeCursors::dispose() {
         _cursors.clear();
         _currentCursor = _cursors.end();
+        _bytesInFlight = 0;
     }
 }
@@ -0,0 +1,194 @@
+/**
+ * Copyright 2014 (c) 10gen Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects for
+ * all of the code used other than as permitted herein. If you modify file(s)
+ * with this exception, you may extend this exception to your version of the
+ * file(s), but you are not obligated to do so. If you do not wish to do so,
+ * delete this exception statement from your version. If you delete this
+ * exception statement from all source files in the program, then also delete
+ * it in the license file.
+ */
+
+#include "mongo/pch.h"
+
+#include "mongo/db/pipeline/document_source.h"
+
+namespace mongo {
+
+    const char DocumentSourceOplogInserts::name[] = "$oplogInserts";
+
+    const char* DocumentSourceOplogInserts::getSourceName() const {
+        return name;
+    }
+
+    BSONObj DocumentSourceOplogInserts::getQuery() const {
+        return BSON("ts" << BSON("$gt" << _after << "$lte" << _upTo)
+                 << "ns" << _ns.ns()
+                 << "op" << "i");
+    }
+
+    boost::optional<Document> DocumentSourceOplogInserts::getNext() {
+        pExpCtx->checkForInterrupt();
+
+        if (!_cursor.get()) {
+            verify(_mongod);
+            // OplogReplay lets the query start at the first entry after _after rather than
+            // scanning the whole oplog.
+            _cursor = _mongod->directClient()->query(_oplogNs, getQuery(), 0, 0, NULL,
+                                                     QueryOption_OplogReplay);
+            uassert(28623, str::stream() << "failed to query " << _oplogNs, _cursor.get());
+        }
+
+        while (_cursor->more()) {
+            BSONObj entry = _cursor->nextSafe();
+            if (entry["o"].type() == Object)
+                return Document(entry["o"].Obj().getOwned());
+        }
+
+        return boost::none;
+    }
+
+    void DocumentSourceOplogInserts::dispose() {
+        _cursor.reset();
+    }
+
+    Value DocumentSourceOplogInserts::serialize(bool explain) const {
+        return Value(DOC(getSourceName() << DOC("oplog" << _oplogNs
+                                             << "query" << getQuery())));
+    }
+
+    DocumentSourceOplogInserts::DocumentSourceOplogInserts(
+            const string& oplogNs,
+            const NamespaceString& ns,
+            const OpTime& after,
+            const OpTime& upTo,
+            const intrusive_ptr<ExpressionContext>& pExpCtx)
+        : DocumentSource(pExpCtx)
+        , _oplogNs(oplogNs)
+        , _ns(ns)
+        , _after(after)
+        , _upTo(upTo)
+    {}
+
+    intrusive_ptr<DocumentSourceOplogInserts> DocumentSourceOplogInserts::create(
+            const string& oplogNs,
+            const NamespaceString& ns,
+            const OpTime& after,
+            const OpTime& upTo,
+            const intrusive_ptr<ExpressionContext>& pExpCtx) {
+        return new DocumentSourceOplogInserts(oplogNs, ns, after, upTo, pExpCtx);
+    }
+
+
+    const char DocumentSourceSkipInserts::name[] = "$skipInserts";
+
+    // Past this many inserts during one run we stop keeping track, and the run can no longer be
+    // used as the starting point of an incremental refresh.
+    static const size_t maxSkippedInserts = 1000 * 1000;
+
+    const char* DocumentSourceSkipInserts::getSourceName() const {
+        return name;
+    }
+
+    boost::optional<Document> DocumentSourceSkipInserts::getNext() {
+        pExpCtx->checkForInterrupt();
+
+        while (boost::optional<Document> next = pSource->getNext()) {
+            if (_overflowed)
+                return next;
+
+            // The document was visible, so its insert and the oplog entry for it are both done.
+            // If nothing at all has been logged since we last looked, there is nothing to read.
+            if (_mongod->lastOpTime() != _seenUpTo)
+                readNewInserts();
+
+            if (!_overflowed && _inserted.count((*next)["_id"]))
+                continue;
+
+            return next;
+        }
+
+        return boost::none;
+    }
+
+    void DocumentSourceSkipInserts::readNewInserts() {
+        DBClientBase* conn = _mongod->directClient();
+
+        // Entries are added to the oplog in order, so every entry up to the newest one there is
+        // already in place.
+        const BSONObj last = conn->findOne(_oplogNs, Query().sort(BSON("$natural" << -1)));
+        if (last.isEmpty())
+            return;
+        const OpTime upTo = last["ts"]._opTime();
+
+        const BSONObj query = BSON("ts" << BSON("$gt" << _seenUpTo << "$lte" << upTo)
+                                << "ns" << _ns.ns()
+                                << "op" << "i");
+        const BSONObj fields = BSON("o._id" << 1);
+        auto_ptr<DBClientCursor> cursor = conn->query(_oplogNs, query, 0, 0, &fields,
+                                                      QueryOption_OplogReplay);
+        uassert(28637, str::stream() << "failed to query " << _oplogNs, cursor.get());
+
+        while (cursor->more()) {
+            const BSONObj entry = cursor->nextSafe();
+            if (_inserted.size() >= maxSkippedInserts) {
+                _overflowed = true;
+                _inserted.clear();
+                return;
+            }
+            _inserted.insert(Value(entry.getFieldDotted("o._id")));
+        }
+
+        _seenUpTo = upTo;
+    }
+
+    Value DocumentSourceSkipInserts::serialize(bool explain) const {
+        return Value(DOC(getSourceName() << DOC("oplog" << _oplogNs
+                                             << "ns" << _ns.ns()
+                                             << "after" << _after)));
+    }
+
+    DocumentSource::GetDepsReturn DocumentSourceSkipInserts::getDependencies(
+            DepsTracker* deps) const {
+        deps->fields.insert("_id");
+        return SEE_NEXT;
+    }
+
+    DocumentSourceSkipInserts::DocumentSourceSkipInserts(
+            const string& oplogNs,
+            const NamespaceString& ns,
+            const OpTime& after,
+            const intrusive_ptr<ExpressionContext>& pExpCtx)
+        : DocumentSource(pExpCtx)
+        , _oplogNs(oplogNs)
+        , _ns(ns)
+        , _after(after)
+        , _seenUpTo(after)
+        , _overflowed(false)
+    {}
+
+    intrusive_ptr<DocumentSourceSkipInserts> DocumentSourceSkipInserts::create(
+            const string& oplogNs,
+            const NamespaceString& ns,
+            const OpTime& after,
+            const intrusive_ptr<ExpressionContext>& pExpCtx) {
+        return new DocumentSourceSkipInserts(oplogNs, ns, after, pExpCtx);
+    }
+}
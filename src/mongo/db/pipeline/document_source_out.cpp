@@ -32,6 +32,7 @@
 
 namespace mongo {
     const char DocumentSourceOut::outName[] = "$out";
+    const char DocumentSourceOut::refreshStateNs[] = "local.aggregate.refresh";
 
     DocumentSourceOut::~DocumentSourceOut() {
         DESTRUCTOR_GUARD(
@@ -47,14 +48,7 @@ namespace mongo {
         return outName;
     }
 
-    static AtomicUInt32 aggOutCounter;
-    void DocumentSourceOut::prepTempCollection() {
-        verify(_mongod);
-        verify(_tempNs.size() == 0);
-
-        DBClientBase* conn = _mongod->directClient();
-
-        // Fail early by checking before we do any work.
+    void DocumentSourceOut::checkOutputNs() {
         uassert(17017, str::stream() << "namespace '" << _outputNs.ns()
                                      << "' is sharded so it can't be used for $out'",
                 !_mongod->isSharded(_outputNs));
@@ -63,6 +57,17 @@ namespace mongo {
         uassert(17152, str::stream() << "namespace '" << _outputNs.ns()
                                      << "' is capped so it can't be used for $out",
                 !_mongod->isCapped(_outputNs));
+    }
+
+    static AtomicUInt32 aggOutCounter;
+    void DocumentSourceOut::prepTempCollection() {
+        verify(_mongod);
+        verify(_tempNs.size() == 0);
+
+        DBClientBase* conn = _mongod->directClient();
+
+        // Fail early by checking before we do any work.
+        checkOutputNs();
 
         _tempNs = StringData(str::stream() << _outputNs.db()
                                            << ".tmp.agg_out."
@@ -114,12 +119,21 @@ namespace mongo {
         verify(_mongod);
         DBClientBase* conn = _mongod->directClient();
 
+        if (_incremental && _deltaRefresh) {
+            mergeDeltas(conn);
+            return boost::none;
+        }
+
         prepTempCollection();
         verify(_tempNs.size() != 0);
 
+        // A rebuild of incremental output is no longer described by any earlier refresh state.
+        if (_incremental)
+            forgetRefreshState(conn);
+
         vector<BSONObj> bufferedObjects;
         int bufferedBytes = 0;
-        while (boost::optional<Document> next = pSource->getNext()) {
+        for (boost::optional<Document> next = pSource->getNext(); next; next = pSource->getNext()) {
             BSONObj toInsert = next->toBson();
             bufferedBytes += toInsert.objsize();
             if (!bufferedObjects.empty() && bufferedBytes > BSONObjMaxUserSize) {
@@ -150,36 +164,220 @@ namespace mongo {
         // We don't need to drop the temp collection in our destructor if the rename succeeded.
         _tempNs = NamespaceString("");
 
+        // The pipeline yields as usual while it runs, but _rebuildFilter kept out whatever was
+        // inserted after _refreshUpTo, so the next refresh can merge it in. Anything else done
+        // to the source in the meantime is found by that refresh, which then rebuilds.
+        if (_incremental && _rebuildFilter->complete())
+            saveRefreshState(conn);
+
         // This "DocumentSource" doesn't produce output documents. This can change in the future
         // if we support using $out in "tee" mode.
         return boost::none;
     }
 
+    bool DocumentSourceOut::sourceChangedBetween(DBClientBase* conn,
+                                                 const OpTime& after,
+                                                 const OpTime& upTo) {
+        // Commands may have dropped, emptied or replaced the source.
+        const string sourceNs = pExpCtx->ns.ns();
+        const string sourceColl = pExpCtx->ns.coll().toString();
+        const string cmdNs = pExpCtx->ns.getCommandNS();
+        const BSONObj sourceWrites = BSON("ns" << sourceNs << "op" << BSON("$ne" << "i"));
+        const BSONObj query = BSON("ts" << BSON("$gt" << after
+                                             << "$lte" << upTo)
+                                << "$or" << BSON_ARRAY(
+                                       sourceWrites
+                                    << BSON("ns" << cmdNs << "o.drop" << sourceColl)
+                                    << BSON("ns" << cmdNs << "o.emptycapped" << sourceColl)
+                                    << BSON("ns" << cmdNs
+                                         << "o.convertToCapped" << sourceColl)
+                                    << BSON("ns" << cmdNs
+                                         << "o.dropDatabase" << BSON("$exists" << true))
+                                    << BSON("o.renameCollection" << sourceNs)
+                                    << BSON("o.to" << sourceNs)));
+        return !conn->findOne(_oplogNs, query, NULL, QueryOption_OplogReplay).isEmpty();
+    }
+
+    void DocumentSourceOut::mergeDeltas(DBClientBase* conn) {
+        checkOutputNs();
+
+        // If we fail part way through the output is partially refreshed, so the next refresh must
+        // rebuild it rather than apply the same deltas again.
+        forgetRefreshState(conn);
+
+        while (boost::optional<Document> delta = pSource->getNext()) {
+            pExpCtx->checkForInterrupt();
+
+            const BSONObj idQuery = DOC("_id" << (*delta)["_id"]).toBson();
+            const BSONObj existing = conn->findOne(_outputNs.ns(), idQuery);
+            const Document merged = existing.isEmpty() ? *delta
+                                                       : _group->mergeResults(Document(existing),
+                                                                              *delta);
+
+            conn->update(_outputNs.ns(), idQuery, merged.toBson(), /*upsert*/true);
+            BSONObj err = conn->getLastErrorDetailed();
+            uassert(28613, str::stream() << "update for incremental $out failed: " << err,
+                    DBClientWithCommands::getLastErrorString(err).empty());
+        }
+
+        saveRefreshState(conn);
+    }
+
+    OpTime DocumentSourceOut::getLastOpTime(DBClientBase* conn) {
+        BSONObj last = conn->findOne(_oplogNs, Query().sort(BSON("$natural" << -1)));
+        uassert(28614, str::stream() << "incremental $out found no entries in " << _oplogNs,
+                !last.isEmpty());
+        return last["ts"]._opTime();
+    }
+
+    void DocumentSourceOut::saveRefreshState(DBClientBase* conn) {
+        conn->update(refreshStateNs,
+                     QUERY("_id" << _outputNs.ns()),
+                     BSON("_id" << _outputNs.ns()
+                       << "spec" << _refreshSpec
+                       << "ts" << _refreshUpTo
+                       << "refresh" << (_deltaRefresh ? "delta" : "rebuild")),
+                     /*upsert*/true);
+        BSONObj err = conn->getLastErrorDetailed();
+        uassert(28615, str::stream() << "saving incremental $out state failed: " << err,
+                DBClientWithCommands::getLastErrorString(err).empty());
+    }
+
+    void DocumentSourceOut::forgetRefreshState(DBClientBase* conn) {
+        conn->remove(refreshStateNs, QUERY("_id" << _outputNs.ns()));
+        BSONObj err = conn->getLastErrorDetailed();
+        uassert(28616, str::stream() << "clearing incremental $out state failed: " << err,
+                DBClientWithCommands::getLastErrorString(err).empty());
+    }
+
+    intrusive_ptr<DocumentSource> DocumentSourceOut::prepareIncrementalRefresh(
+            const intrusive_ptr<DocumentSourceGroup>& group,
+            const BSONObj& refreshSpec) {
+        verify(_incremental);
+        verify(_mongod);
+
+        uassert(28617, "incremental $out can't be used with $avg, use $sum and $divide instead",
+                group->canMergeResults());
+
+        _group = group;
+        _refreshSpec = refreshSpec.getOwned();
+        _deltaRefresh = false;
+        _rebuildFilter.reset();
+
+        DBClientBase* conn = _mongod->directClient();
+
+        if (conn->exists("local.oplog.rs")) {
+            _oplogNs = "local.oplog.rs";
+        }
+        else if (conn->exists("local.oplog.$main")) {
+            _oplogNs = "local.oplog.$main";
+        }
+        else {
+            uasserted(28618, "incremental $out requires an oplog: "
+                             "run with --replSet or --master");
+        }
+
+        // Our caller holds the source's database lock, so no more entries can be logged for it
+        // until the cursor over the source or the deltas has been set up.
+        _refreshUpTo = getLastOpTime(conn);
+
+        intrusive_ptr<DocumentSource> inserted = prepareDeltaRefresh(conn);
+        if (inserted)
+            return inserted;
+
+        _rebuildFilter = DocumentSourceSkipInserts::create(_oplogNs, pExpCtx->ns, _refreshUpTo,
+                                                           pExpCtx);
+        return NULL;
+    }
+
+    intrusive_ptr<DocumentSource> DocumentSourceOut::getRebuildFilter() const {
+        return _rebuildFilter;
+    }
+
+    intrusive_ptr<DocumentSource> DocumentSourceOut::prepareDeltaRefresh(DBClientBase* conn) {
+        // The deltas can only be used if the output still holds the results of this exact
+        // pipeline as of a point the oplog still covers.
+        const BSONObj state = conn->findOne(refreshStateNs, QUERY("_id" << _outputNs.ns()));
+        if (state.isEmpty()
+                || state["spec"].type() != Object
+                || state["spec"].Obj().woCompare(_refreshSpec) != 0
+                || state["ts"].type() != Timestamp
+                || !conn->exists(_outputNs.ns()))
+            return NULL;
+
+        const OpTime lastRefresh = state["ts"]._opTime();
+        const BSONObj first = conn->findOne(_oplogNs, Query().sort(BSON("$natural" << 1)));
+        if (first.isEmpty() || lastRefresh < first["ts"]._opTime())
+            return NULL; // the oplog has rolled over since the last refresh
+
+        // Updates and deletes can't be folded into the output, so any of these forces a rebuild.
+        if (sourceChangedBetween(conn, lastRefresh, _refreshUpTo))
+            return NULL;
+
+        _deltaRefresh = true;
+        return DocumentSourceOplogInserts::create(_oplogNs, pExpCtx->ns,
+                                                  lastRefresh, _refreshUpTo, pExpCtx);
+    }
+
     DocumentSourceOut::DocumentSourceOut(const NamespaceString& outputNs,
+                                         bool incremental,
                                          const intrusive_ptr<ExpressionContext>& pExpCtx)
         : DocumentSource(pExpCtx)
         , _done(false)
         , _tempNs("") // filled in by prepTempCollection
         , _outputNs(outputNs)
+        , _incremental(incremental)
+        , _deltaRefresh(false)
     {}
 
     intrusive_ptr<DocumentSource> DocumentSourceOut::createFromBson(
             BSONElement elem,
             const intrusive_ptr<ExpressionContext> &pExpCtx) {
-        uassert(16990, str::stream() << "$out only supports a string argument, not "
+        uassert(16990, str::stream() << "$out only supports a string or object argument, not "
                                      << typeName(elem.type()),
-                elem.type() == String);
-        
-        NamespaceString outputNs(pExpCtx->ns.db().toString() + '.' + elem.str());
-        uassert(17385, "Can't $out to special collection: " + elem.str(),
+                elem.type() == String || elem.type() == Object);
+
+        string collection;
+        bool incremental = false;
+        if (elem.type() == String) {
+            collection = elem.str();
+        }
+        else {
+            BSONForEach(arg, elem.embeddedObject()) {
+                const StringData argName = arg.fieldNameStringData();
+                if (argName == "collection") {
+                    uassert(28619, "$out's 'collection' option must be a string",
+                            arg.type() == String);
+                    collection = arg.str();
+                }
+                else if (argName == "mode") {
+                    uassert(28620, "$out's 'mode' option must be \"replace\" or \"incremental\"",
+                            arg.type() == String
+                                && (arg.str() == "replace" || arg.str() == "incremental"));
+                    incremental = arg.str() == "incremental";
+                }
+                else {
+                    uasserted(28621, str::stream() << "unrecognized $out option: " << argName);
+                }
+            }
+            uassert(28622, "$out requires a 'collection' option", !collection.empty());
+        }
+
+        NamespaceString outputNs(pExpCtx->ns.db().toString() + '.' + collection);
+        uassert(17385, "Can't $out to special collection: " + collection,
                 !outputNs.isSpecial());
-        return new DocumentSourceOut(outputNs, pExpCtx);
+        return new DocumentSourceOut(outputNs, incremental, pExpCtx);
     }
 
     Value DocumentSourceOut::serialize(bool explain) const {
         massert(17000, "$out shouldn't have different db than input",
                 _outputNs.db() == pExpCtx->ns.db());
 
+        if (_incremental) {
+            return Value(DOC(getSourceName() << DOC("collection" << _outputNs.coll()
+                                                 << "mode" << "incremental")));
+        }
+
         return Value(DOC(getSourceName() << _outputNs.coll()));
     }
 
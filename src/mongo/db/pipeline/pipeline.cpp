@@ -212,6 +212,7 @@ namespace mongo {
         // efficiency of the final pipeline. Be Careful!
         Optimizations::Local::moveMatchBeforeSort(pPipeline.get());
         Optimizations::Local::moveLimitBeforeSkip(pPipeline.get());
+        Optimizations::Local::addElemMatchBeforeUnwind(pPipeline.get());
         Optimizations::Local::coalesceAdjacent(pPipeline.get());
         Optimizations::Local::optimizeEachDocumentSource(pPipeline.get());
         Optimizations::Local::duplicateMatchBeforeInitalRedact(pPipeline.get());
@@ -319,6 +320,25 @@ namespace mongo {
         }
     }
 
+    void Pipeline::Optimizations::Local::addElemMatchBeforeUnwind(Pipeline* pipeline) {
+        SourceContainer& sources = pipeline->sources;
+        for (size_t i = 1; i < sources.size(); i++) {
+            DocumentSourceUnwind* unwind = dynamic_cast<DocumentSourceUnwind*>(sources[i-1].get());
+            DocumentSourceMatch* match = dynamic_cast<DocumentSourceMatch*>(sources[i].get());
+            if (!unwind || !match || match->isTextQuery())
+                continue;
+
+            const BSONObj elemMatch = match->elemMatchBeforeUnwind(unwind->getUnwindPath());
+            if (!elemMatch.isEmpty()) {
+                sources.insert(sources.begin() + (i - 1),
+                               DocumentSourceMatch::createFromBson(
+                                   BSON("$match" << elemMatch).firstElement(),
+                                   pipeline->pCtx));
+                i++; // skip over the $unwind we just moved
+            }
+        }
+    }
+
     void Pipeline::addRequiredPrivileges(Command* commandTemplate,
                                          const string& db,
                                          BSONObj cmdObj,
@@ -58,11 +58,66 @@ namespace {
             return collection && collection->isCapped();
         }
 
+        OpTime lastOpTime() {
+            mongo::mutex::scoped_lock lk(OpTime::m);
+            return OpTime::getLast(lk);
+        }
+
     private:
         DBDirectClient _client;
     };
 }
 
+    void PipelineD::prepareIncrementalOut(const intrusive_ptr<Pipeline>& pPipeline,
+                                          const intrusive_ptr<ExpressionContext>& pExpCtx) {
+        Pipeline::SourceContainer& sources = pPipeline->sources;
+        DocumentSourceOut* out = dynamic_cast<DocumentSourceOut*>(sources.back().get());
+        verify(out && out->isIncremental());
+
+        uassert(28624, "incremental $out can't be used on a sharded collection",
+                !sources.front()->isValidInitialSource());
+
+        intrusive_ptr<DocumentSourceGroup> group;
+        if (sources.size() >= 2)
+            group = dynamic_cast<DocumentSourceGroup*>(sources[sources.size() - 2].get());
+        uassert(28625, "incremental $out must directly follow a $group", group);
+
+        // Every stage before the $group must handle each input document on its own, so that
+        // running them over only the new documents gives the same results for those documents.
+        vector<Value> stages;
+        for (size_t i = 0; i < sources.size() - 1; i++) {
+            DocumentSource* source = sources[i].get();
+            uassert(28626, str::stream() << "incremental $out can't be used with "
+                                         << source->getSourceName() << " before the $group",
+                    source == group.get()
+                    || dynamic_cast<DocumentSourceMatch*>(source)
+                    || dynamic_cast<DocumentSourceProject*>(source)
+                    || dynamic_cast<DocumentSourceRedact*>(source)
+                    || dynamic_cast<DocumentSourceUnwind*>(source));
+            source->serializeToArray(stages);
+        }
+
+        const BSONObj refreshSpec = BSON("ns" << pExpCtx->ns.ns()
+                                      << "pipeline" << Value(stages));
+
+        intrusive_ptr<DocumentSource> inserted = out->prepareIncrementalRefresh(group, refreshSpec);
+        if (inserted) {
+            dynamic_cast<DocumentSourceNeedsMongod*>(inserted.get())
+                ->injectMongodInterface(boost::make_shared<MongodImplementation>());
+            sources.push_front(inserted);
+        }
+        else {
+            // The filter goes right after the cursor, which takes the place of a leading $match.
+            intrusive_ptr<DocumentSource> filter = out->getRebuildFilter();
+            dynamic_cast<DocumentSourceNeedsMongod*>(filter.get())
+                ->injectMongodInterface(boost::make_shared<MongodImplementation>());
+            Pipeline::SourceContainer::iterator pos = sources.begin();
+            if (dynamic_cast<DocumentSourceMatch*>(pos->get()))
+                ++pos;
+            sources.insert(pos, filter);
+        }
+    }
+
     boost::shared_ptr<Runner> PipelineD::prepareCursorSource(
             const intrusive_ptr<Pipeline>& pPipeline,
             const intrusive_ptr<ExpressionContext>& pExpCtx) {
@@ -82,6 +137,13 @@ namespace {
             }
         }
 
+        DocumentSourceOut* out = sources.empty()
+                               ? NULL
+                               : dynamic_cast<DocumentSourceOut*>(sources.back().get());
+        if (out && out->isIncremental()) {
+            prepareIncrementalOut(pPipeline, pExpCtx);
+        }
+
         if (!sources.empty() && sources.front()->isValidInitialSource()) {
             if (dynamic_cast<DocumentSourceMergeCursors*>(sources.front().get())) {
                 // Enable the hooks for setting up authentication on the subsequent internal
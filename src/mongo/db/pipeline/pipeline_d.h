@@ -76,6 +76,14 @@ namespace mongo {
 
     private:
         PipelineD(); // does not exist:  prevent instantiation
+
+        /**
+         * Checks that a pipeline ending in an incremental $out has a shape whose results can be
+         * maintained, and sets up its refresh. This may put a source of newly inserted documents
+         * at the front of the pipeline.
+         */
+        static void prepareIncrementalOut(const intrusive_ptr<Pipeline>& pPipeline,
+                                          const intrusive_ptr<ExpressionContext>& pExpCtx);
     };
 
 } // namespace mongo
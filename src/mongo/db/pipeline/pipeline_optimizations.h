@@ -87,6 +87,16 @@ namespace mongo {
          * BSONObjs converted to Documents.
          */
         static void duplicateMatchBeforeInitalRedact(Pipeline* pipeline);
+
+        /**
+         * Optimizes [$unwind, $match] to [$match, $unwind, $match] if the $match has conditions
+         * on fields inside the unwound array elements.
+         *
+         * The added $match uses $elemMatch to drop documents without any array element that could
+         * match, before they are unwound. The original $match is still needed to filter the
+         * unwound documents.
+         */
+        static void addElemMatchBeforeUnwind(Pipeline* pipeline);
     };
 
     /**
@@ -497,12 +497,14 @@ namespace mongo {
         else if (STAGE_COLLSCAN == stats.stageType) {
             CollectionScanStats* spec = static_cast<CollectionScanStats*>(stats.specific.get());
             bob->appendNumber("docsTested", spec->docsTested);
+            bob->appendNumber("readAheads", spec->readAheads);
         }
         else if (STAGE_FETCH == stats.stageType) {
             FetchStats* spec = static_cast<FetchStats*>(stats.specific.get());
             bob->appendNumber("alreadyHasObj", spec->alreadyHasObj);
             bob->appendNumber("forcedFetches", spec->forcedFetches);
             bob->appendNumber("matchTested", spec->matchTested);
+            bob->appendNumber("readAheads", spec->readAheads);
         }
         else if (STAGE_GEO_2D == stats.stageType) {
             TwoDStats* spec = static_cast<TwoDStats*>(stats.specific.get());
@@ -562,7 +562,10 @@ namespace mongo {
                     restoreState();
                 }
                 else {
-                    // We're set to manually yield.  We go to disk in the lock.
+                    // We're set to manually yield.  We go to disk in the lock, but still let
+                    // any read-ahead the stages asked for overlap with it.
+                    LockMongoFilesShared lk;
+                    Record::issuePrefetches();
                     record->touch();
                 }
 
@@ -142,7 +142,9 @@ namespace mongo {
      * Also called by db/ops/query.cpp.  This is the new getMore entry point.
      */
     QueryResult* newGetMore(const char* ns, int ntoreturn, long long cursorid, CurOp& curop,
-                            int pass, bool& exhaust, bool* isCursorAuthorized) {
+                            int pass, bool& exhaust, bool* isCursorAuthorized,
+                            shared_ptr<CappedInsertNotifier>* insertNotifier,
+                            uint64_t* insertNotifierVersion) {
         // For testing, we may want to fail if we receive a getmore.
         if (MONGO_FAIL_POINT(failReceivedGetmore)) {
             invariant(0);
@@ -202,6 +204,16 @@ namespace mongo {
             // TODO: What is pass?
             if (0 == pass) { cc->updateSlaveLocation(curop); }
 
+            // Inserts need the write lock, so the version read here is from before any document
+            // this getMore could miss.
+            const int awaitDataOptions = QueryOption_CursorTailable | QueryOption_AwaitData;
+            if (insertNotifier && (cc->queryOptions() & awaitDataOptions) == awaitDataOptions) {
+                *insertNotifier = collection->getCappedInsertNotifier();
+                if (*insertNotifier) {
+                    *insertNotifierVersion = (*insertNotifier)->getVersion();
+                }
+            }
+
             if (cc->isAggCursor) {
                 // Agg cursors handle their own locking internally.
                 ctx.reset(); // unlocks
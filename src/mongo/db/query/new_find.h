@@ -39,11 +39,19 @@
 
 namespace mongo {
 
+    class CappedInsertNotifier;
+
     /**
      * Called from the getMore entry point in ops/query.cpp.
+     *
+     * Returns NULL if a tailable awaitData cursor on a capped collection has nothing new.  In
+     * that case 'insertNotifier' and 'insertNotifierVersion', if given, are set up for waiting on
+     * the next insert before trying again.
      */
     QueryResult* newGetMore(const char* ns, int ntoreturn, long long cursorid, CurOp& curop,
-                            int pass, bool& exhaust, bool* isCursorAuthorized);
+                            int pass, bool& exhaust, bool* isCursorAuthorized,
+                            shared_ptr<CappedInsertNotifier>* insertNotifier = NULL,
+                            uint64_t* insertNotifierVersion = NULL);
 
     /**
      * Run the query 'q' and place the result in 'result'.
@@ -62,4 +62,8 @@ namespace mongo {
 
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryMaxScansToExplode, int, 200);
 
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryFetchReadAheadDocs, int, 16);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryCollScanReadAheadKB, int, 256);
+
 }  // namespace mongo
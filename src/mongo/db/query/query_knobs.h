@@ -92,4 +92,16 @@ namespace mongo {
     // during explodeForSort?
     extern int internalQueryMaxScansToExplode;
 
+    //
+    // Read-ahead.
+    //
+
+    // When a fetch has to go to disk, how many more of its child's results do we read ahead and
+    // ask the OS to prefetch while the fetch yields?  0 turns fetch read-ahead off.
+    extern int internalQueryFetchReadAheadDocs;
+
+    // When a collection scan has to go to disk, how many KB past the current record do we ask the
+    // OS to prefetch while the scan yields?  0 turns collection scan read-ahead off.
+    extern int internalQueryCollScanReadAheadKB;
+
 }  // namespace mongo
@@ -28,6 +28,7 @@
 
 #include "mongo/db/range_deleter.h"
 
+#include <algorithm>
 #include <boost/date_time/posix_time/posix_time_duration.hpp>
 #include <memory>
 
@@ -179,9 +180,13 @@ namespace mongo {
         }
     }
 
-    void RangeDeleter::startWorkers() {
-        if (!_worker) {
-            _worker.reset(new boost::thread(boost::bind(&RangeDeleter::doWork, this)));
+    void RangeDeleter::startWorkers(int numWorkers) {
+        if (_workers.size() > 0) {
+            return;
+        }
+
+        for (int i = 0; i < std::max(numWorkers, 1); i++) {
+            _workers.create_thread(boost::bind(&RangeDeleter::doWork, this));
         }
     }
 
@@ -191,9 +196,7 @@ namespace mongo {
             _stopRequested = true;
         }
 
-        if (_worker) {
-            _worker->join();
-        }
+        _workers.join_all();
 
         scoped_lock sl(_queueMutex);
         while (_stats->hasInProgress_inlock()) {
@@ -392,12 +395,14 @@ namespace mongo {
             sleepmillis(checkIntervalMillis);
         }
 
+        long long deletedDocs = 0;
         bool result = _env->deleteRange(ns, min, max, shardKeyPattern,
-                                        secondaryThrottle, errMsg);
+                                        secondaryThrottle, &deletedDocs, errMsg);
 
         {
             scoped_lock sl(_queueMutex);
             _deleteSet.erase(&deleteRange);
+            recordDelete_inlock(result, deletedDocs);
 
             _stats->decInProgressDeletes_inlock();
             _stats->decTotalDeletes_inlock();
@@ -544,12 +549,15 @@ namespace mongo {
                 _stats->incInProgressDeletes_inlock();
             }
 
-            if (!_env->deleteRange(nextTask->ns,
-                                   nextTask->min,
-                                   nextTask->max,
-                                   nextTask->shardKeyPattern,
-                                   nextTask->secondaryThrottle,
-                                   &errMsg)) {
+            long long deletedDocs = 0;
+            const bool deleted = _env->deleteRange(nextTask->ns,
+                                                   nextTask->min,
+                                                   nextTask->max,
+                                                   nextTask->shardKeyPattern,
+                                                   nextTask->secondaryThrottle,
+                                                   &deletedDocs,
+                                                   &errMsg);
+            if (!deleted) {
                 warning() << "Error encountered while trying to delete range: "
                           << errMsg << endl;
             }
@@ -559,6 +567,7 @@ namespace mongo {
 
                 NSMinMax setEntry(nextTask->ns, nextTask->min, nextTask->max);
                 deletePtrElement(&_deleteSet, &setEntry);
+                recordDelete_inlock(deleted, deletedDocs);
                 _stats->decInProgressDeletes_inlock();
                 _stats->decTotalDeletes_inlock();
 
@@ -572,6 +581,16 @@ namespace mongo {
         }
     }
 
+    void RangeDeleter::recordDelete_inlock(bool succeeded, long long deletedDocs) {
+        if (succeeded) {
+            _stats->incCompletedDeletes_inlock();
+        }
+        else {
+            _stats->incFailedDeletes_inlock();
+        }
+        _stats->addDeletedDocuments_inlock(deletedDocs);
+    }
+
     bool RangeDeleter::isBlacklisted_inlock(const StringData& ns,
                                             const BSONObj& min,
                                             const BSONObj& max,
@@ -53,9 +53,10 @@ namespace mongo {
      *
      * Threading assumptions:
      *
-     *   This class has (currently) one worker thread attacking the queue, one
-     *   job at a time. If we want an immediate deletion, that job is going to
-     *   be performed on the thread that is requesting it.
+     *   This class has a pool of worker threads attacking the queue, each working on
+     *   one job at a time. Jobs never overlap, so workers don't contend for the same
+     *   documents. If we want an immediate deletion, that job is going to be performed
+     *   on the thread that is requesting it.
      *
      *   All calls regarding deletion are synchronized.
      *
@@ -89,15 +90,15 @@ namespace mongo {
         //
 
         /**
-         * Starts the background thread to work on this queue. Does nothing if the worker
-         * thread is already active.
+         * Starts 'numWorkers' background threads to work on this queue. Does nothing if the
+         * workers are already active.
          *
          * This call is _not_ thread safe and must be issued before any other call.
          */
-        void startWorkers();
+        void startWorkers(int numWorkers = 1);
 
         /**
-         * Stops the background thread working on this queue. This will block if there are
+         * Stops the background threads working on this queue. This will block if there are
          * tasks that are being deleted, but will leave the pending tasks in the queue.
          *
          * Steps:
@@ -110,9 +111,9 @@ namespace mongo {
          *
          * + restarting this deleter with startWorkers after stopping it is not supported.
          *
-         * + the worker thread could be running a call in the environment. The thread is
+         * + the worker threads could be running a call in the environment. A thread is
          *   only going to be returned when the environment decides so. In production,
-         *   KillCurrentOp::killAll can be used to get the thread back from the environment.
+         *   KillCurrentOp::killAll can be used to get the threads back from the environment.
          */
         void stopWorkers();
 
@@ -200,9 +201,12 @@ namespace mongo {
 
         typedef std::set<NSMinMax*, NSMinMaxCmp> NSMinMaxSet; // owned here
 
-        /** Body of the worker thread */
+        /** Body of the worker threads */
         void doWork();
 
+        /** Records the outcome of a delete in the stats. Assumes _queueMutex is held */
+        void recordDelete_inlock(bool succeeded, long long deletedDocs);
+
         /** Returns true if range is blacklisted. Assumes _queueMutex is held */
         bool isBlacklisted_inlock(const StringData& ns,
                                   const BSONObj& min,
@@ -220,8 +224,8 @@ namespace mongo {
 
         scoped_ptr<RangeDeleterEnv> _env;
 
-        // Initially not active. Must be started explicitly.
-        scoped_ptr<boost::thread> _worker;
+        // Initially empty. Must be started explicitly.
+        boost::thread_group _workers;
 
         // Protects _stopRequested.
         mutable mutex _stopMutex;
@@ -282,13 +286,15 @@ namespace mongo {
          * to be able to perform deletions.
          *
          * Must be a synchronous call. Docs should be deleted after call ends.
-         * Must not throw Exceptions.
+         * Must not throw Exceptions. Sets deletedDocs to the number of documents
+         * deleted, even if the delete failed part way.
          */
         virtual bool deleteRange(const StringData& ns,
                                  const BSONObj& inclusiveLower,
                                  const BSONObj& exclusiveUpper,
                                  const BSONObj& shardKeyPattern,
                                  bool secondaryThrottle,
+                                 long long* deletedDocs,
                                  std::string* errMsg) = 0;
 
         /**
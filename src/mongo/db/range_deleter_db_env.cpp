@@ -59,8 +59,10 @@ namespace mongo {
                                         const BSONObj& exclusiveUpper,
                                         const BSONObj& keyPattern,
                                         bool secondaryThrottle,
+                                        long long* deletedDocs,
                                         std::string* errMsg) {
         const bool initiallyHaveClient = haveClient();
+        *deletedDocs = 0;
 
         if (!initiallyHaveClient) {
             Client::initThread("RangeDeleter");
@@ -102,6 +104,7 @@ namespace mongo {
                     return false;
                 }
 
+                *deletedDocs = numDeleted;
                 log() << "rangeDeleter deleted " << numDeleted
                       << " documents for " << ns
                       << " from " << inclusiveLower
@@ -105,6 +105,7 @@ namespace mongo {
                                           const BSONObj& max,
                                           const BSONObj& shardKeyPattern,
                                           bool secondaryThrottle,
+                                          long long* deletedDocs,
                                           string* errMsg) {
 
         {
@@ -135,6 +136,7 @@ namespace mongo {
             _deleteList.push_back(entry);
         }
 
+        *deletedDocs = 0;
         return true;
     }
 
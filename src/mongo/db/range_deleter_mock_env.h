@@ -131,6 +131,7 @@ namespace mongo {
                          const BSONObj& max,
                          const BSONObj& shardKeyPattern,
                          bool secondaryThrottle,
+                         long long* deletedDocs,
                          string* errMsg);
 
         /**
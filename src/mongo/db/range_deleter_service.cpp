@@ -29,7 +29,9 @@
 #include "mongo/db/range_deleter_service.h"
 
 #include "mongo/base/init.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/range_deleter_db_env.h"
+#include "mongo/db/server_parameters.h"
 
 namespace {
 
@@ -38,6 +40,8 @@ namespace {
 
 namespace mongo {
 
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(rangeDeleterWorkers, int, 2);
+
     MONGO_INITIALIZER(RangeDeleterInit)(InitializerContext* context) {
         _deleter = new RangeDeleter(new RangeDeleterDBEnv);
         return Status::OK();
@@ -46,4 +50,14 @@ namespace mongo {
     RangeDeleter* getDeleter() {
         return _deleter;
     }
+
+    class RangeDeleterServerStatusSection : public ServerStatusSection {
+    public:
+        RangeDeleterServerStatusSection() : ServerStatusSection( "rangeDeleter" ) {}
+        virtual bool includeByDefault() const { return false; }
+
+        BSONObj generateSection( const BSONElement& configElement ) const {
+            return getDeleter()->getStats()->toBSON();
+        }
+    } rangeDeleterServerStatusSection;
 }
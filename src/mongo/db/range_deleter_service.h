@@ -33,6 +33,9 @@
 
 namespace mongo {
 
+    // Number of worker threads the global deleter is started with.
+    extern int rangeDeleterWorkers;
+
     /**
      * Gets the global instance of the deleter and starts it.
      */
@@ -198,6 +198,16 @@ namespace {
                                          &inProgressCount, NULL /* don't care errMsg */));
         ASSERT_EQUALS(0, inProgressCount);
 
+        long long completedCount = 0;
+        ASSERT_TRUE(FieldParser::extract(stats, RangeDeleterStats::CompletedDeletesField,
+                                         &completedCount, NULL /* don't care errMsg */));
+        ASSERT_EQUALS(1, completedCount);
+
+        long long failedCount = 0;
+        ASSERT_TRUE(FieldParser::extract(stats, RangeDeleterStats::FailedDeletesField,
+                                         &failedCount, NULL /* don't care errMsg */));
+        ASSERT_EQUALS(0, failedCount);
+
         deleter.stopWorkers();
     }
 
@@ -32,6 +32,9 @@ namespace mongo {
     const BSONField<int> RangeDeleterStats::TotalDeletesField("totalDeletes");
     const BSONField<int> RangeDeleterStats::PendingDeletesField("pendingDeletes");
     const BSONField<int> RangeDeleterStats::InProgressDeletesField("inProgressDeletes");
+    const BSONField<long long> RangeDeleterStats::CompletedDeletesField("completedDeletes");
+    const BSONField<long long> RangeDeleterStats::FailedDeletesField("failedDeletes");
+    const BSONField<long long> RangeDeleterStats::DeletedDocumentsField("deletedDocuments");
 
     BSONObj RangeDeleterStats::toBSON() const {
         scoped_lock sl(*_lockPtr);
@@ -40,6 +43,9 @@ namespace mongo {
         builder << TotalDeletesField(_totalDeletes);
         builder << PendingDeletesField(_pendingDeletes);
         builder << InProgressDeletesField(_inProgressDeletes);
+        builder << CompletedDeletesField(_completedDeletes);
+        builder << FailedDeletesField(_failedDeletes);
+        builder << DeletedDocumentsField(_deletedDocuments);
 
         return builder.obj();
     }
@@ -52,6 +52,15 @@ namespace mongo {
         // Total number of deletes that are currently in progress.
         static const BSONField<int> InProgressDeletesField;
 
+        // Number of deletes that finished successfully.
+        static const BSONField<long long> CompletedDeletesField;
+
+        // Number of deletes that finished with an error.
+        static const BSONField<long long> FailedDeletesField;
+
+        // Number of documents removed by finished deletes.
+        static const BSONField<long long> DeletedDocumentsField;
+
         /**
          * Creates a stat object given the mutex from the RangeDeleter object
          * that this instance is keeping track of.
@@ -60,7 +69,10 @@ namespace mongo {
             _lockPtr(lockPtr),
             _totalDeletes(0),
             _pendingDeletes(0),
-            _inProgressDeletes(0) {
+            _inProgressDeletes(0),
+            _completedDeletes(0),
+            _failedDeletes(0),
+            _deletedDocuments(0) {
         }
 
         /**
@@ -104,6 +116,18 @@ namespace mongo {
             return _inProgressDeletes > 0;
         }
 
+        void incCompletedDeletes_inlock() {
+            _completedDeletes++;
+        }
+
+        void incFailedDeletes_inlock() {
+            _failedDeletes++;
+        }
+
+        void addDeletedDocuments_inlock(long long numDocs) {
+            _deletedDocuments += numDocs;
+        }
+
     private:
         // Protects all data structures below this. Not owned here.
         mutable mutex* _lockPtr;
@@ -111,5 +135,9 @@ namespace mongo {
         int _totalDeletes;
         int _pendingDeletes;
         int _inProgressDeletes;
+
+        long long _completedDeletes;
+        long long _failedDeletes;
+        long long _deletedDocuments;
     };
 }
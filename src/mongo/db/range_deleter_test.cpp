@@ -339,6 +339,64 @@ namespace {
         deleter.stopWorkers();
     }
 
+    // With several workers, a delete in progress doesn't hold up the next one.
+    TEST(MixedDeletes, ConcurrentWorkers) {
+        const string ns("test.user");
+
+        RangeDeleterMockEnv* env = new RangeDeleterMockEnv();
+        RangeDeleter deleter(env);
+        deleter.startWorkers(2);
+
+        env->pauseDeletes();
+
+        Notification notifyDone1;
+        ASSERT_TRUE(deleter.queueDelete(ns,
+                                        BSON("x" << 10),
+                                        BSON("x" << 20),
+                                        BSON("x" << 1),
+                                        true,
+                                        &notifyDone1,
+                                        NULL /* don't care errMsg */));
+
+        Notification notifyDone2;
+        ASSERT_TRUE(deleter.queueDelete(ns,
+                                        BSON("x" << 20),
+                                        BSON("x" << 30),
+                                        BSON("x" << 1),
+                                        true,
+                                        &notifyDone2,
+                                        NULL /* don't care errMsg */));
+
+        // Both deletes get picked up while neither has finished.
+        env->waitForNthPausedDelete(2u);
+
+        const BSONObj stats(deleter.getStats()->toBSON());
+        int inProgressCount = 0;
+        ASSERT_TRUE(FieldParser::extract(stats, RangeDeleterStats::InProgressDeletesField,
+                                         &inProgressCount, NULL /* don't care errMsg */));
+        ASSERT_EQUALS(2, inProgressCount);
+
+        // Let them finish one at a time, resuming both at once could wake the same one twice.
+        for (long long done = 1; done <= 2; done++) {
+            env->resumeOneDelete();
+
+            long long completedCount = 0;
+            while (completedCount < done) {
+                mongo::sleepmillis(10);
+                const BSONObj statsNow(deleter.getStats()->toBSON());
+                ASSERT_TRUE(FieldParser::extract(statsNow,
+                                                 RangeDeleterStats::CompletedDeletesField,
+                                                 &completedCount,
+                                                 NULL /* don't care errMsg */));
+            }
+        }
+
+        notifyDone1.waitToBeNotified();
+        notifyDone2.waitToBeNotified();
+
+        deleter.stopWorkers();
+    }
+
     // Should not be able to delete ranges that overlaps with a black listed range.
     TEST(BlackList, CantDeleteBlackListed) {
         RangeDeleterMockEnv* env = new RangeDeleterMockEnv();
@@ -206,6 +206,16 @@ namespace mongo {
         if ( ok ) {
             LOG(2) << fo.op() << " file " << q.string() << endl;
         }
+        // overflow segments of the .ns file
+        for ( int n = 1; n < NamespaceIndex::MaxSegments; n++ ) {
+            stringstream ss;
+            ss << c << "ns." << n;
+            q = p / ss.str();
+            MONGO_ASSERT_ON_EXCEPTION( ok = fo.apply( q ) );
+            if ( !ok )
+                break;
+            LOG(2) << fo.op() << " file " << q.string() << endl;
+        }
         int i = 0;
         int extra = 10; // should not be necessary, this is defensive in case there are missing files
         while ( 1 ) {
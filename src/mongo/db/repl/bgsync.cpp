@@ -35,6 +35,7 @@
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/rs_sync.h"
 #include "mongo/db/repl/rs.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/base/counter.h"
 #include "mongo/db/stats/timer_stats.h"
@@ -47,6 +48,13 @@ namespace replset {
 
     MONGO_FP_DECLARE(rsBgSyncProduce);
 
+    // Have the sync target stream its oplog as exhaust replies, rather than waiting a round trip
+    // for each getMore.  Takes effect the next time a sync target is chosen.
+    MONGO_EXPORT_SERVER_PARAMETER(replExhaustOplogFetch, bool, true);
+
+    // Rates reported by getCounters() are averaged over at least this long
+    static const long long throughputSampleMillis = 10 * 1000;
+
     BackgroundSync* BackgroundSync::s_instance = 0;
     boost::mutex BackgroundSync::s_mutex;
 
@@ -92,7 +100,10 @@ namespace replset {
                                        _appliedBuffer(true),
                                        _assumingPrimary(false),
                                        _currentSyncTarget(NULL),
-                                       _consumedOpTime(0, 0) {
+                                       _consumedOpTime(0, 0),
+                                       _fetchedOpsPerSec(0),
+                                       _fetchedBytesPerSec(0),
+                                       _appliedOpsPerSec(0) {
     }
 
     BackgroundSync* BackgroundSync::get() {
@@ -314,6 +325,10 @@ namespace replset {
             return;
         }
 
+        if (replExhaustOplogFetch && !startOplogStream(r)) {
+            return;
+        }
+
         while (!inShutdown()) {
             if (!r.moreInCurrentBatch()) {
                 // Check some things periodically
@@ -382,9 +397,16 @@ namespace replset {
             }
 
             // At this point, we are guaranteed to have at least one thing to read out
-            // of the oplogreader cursor.
-            BSONObj o = r.nextSafe().getOwned();
-            opsReadStats.increment();
+            // of the oplogreader cursor.  The ops are copied out of the batch, since the cursor
+            // reuses its buffer, and handed to the buffer all at once.
+            std::vector<BSONObj> ops;
+            size_t batchBytes = 0;
+            while (r.moreInCurrentBatch()) {
+                BSONObj o = r.nextSafe().getOwned();
+                batchBytes += getSize(o);
+                ops.push_back(o);
+            }
+            opsReadStats.increment(ops.size());
 
             {
                 boost::unique_lock<boost::mutex> lock(_mutex);
@@ -395,20 +417,51 @@ namespace replset {
                 LOG(2) << "bgsync buffer has " << _buffer.size() << " bytes" << rsLog;
             }
             // the blocking queue will wait (forever) until there's room for us to push
-            _buffer.push(o);
-            bufferCountGauge.increment();
-            bufferSizeGauge.increment(getSize(o));
+            _buffer.pushAll(ops.begin(), ops.end());
+            bufferCountGauge.increment(ops.size());
+            bufferSizeGauge.increment(batchBytes);
 
             {
                 boost::unique_lock<boost::mutex> lock(_mutex);
-                _lastH = o["h"].numberLong();
-                _lastOpTimeFetched = o["ts"]._opTime();
+                _lastH = ops.back()["h"].numberLong();
+                _lastOpTimeFetched = ops.back()["ts"]._opTime();
                 LOG(3) << "replSet lastOpTimeFetched: "
                        << _lastOpTimeFetched.toStringPretty() << rsLog;
             }
         }
     }
 
+    bool BackgroundSync::startOplogStream(OplogReader& r) {
+        OpTime lastOpTimeFetched;
+        long long lastH;
+        {
+            boost::unique_lock<boost::mutex> lock(_mutex);
+            lastOpTimeFetched = _lastOpTimeFetched;
+            lastH = _lastH;
+        }
+
+        // Nothing else can be sent over the connection once the stream starts, which is why the
+        // rollback check above uses an ordinary cursor.
+        r.resetCursor();
+        r.setTailingQueryOptions(r.getTailingQueryOptions() | QueryOption_Exhaust);
+        r.tailingQueryGTE(rsoplog, lastOpTimeFetched);
+
+        if (!r.haveCursor() || !r.more()) {
+            return false;
+        }
+
+        // The op we already have comes first.  Anything else means the sync target's oplog
+        // changed after isRollbackRequired() looked at it; the next pass will handle that.
+        BSONObj o = r.nextSafe();
+        if (o["ts"]._opTime() != lastOpTimeFetched || o["h"].numberLong() != lastH) {
+            log() << "replSet sync source's oplog changed before streaming started" << rsLog;
+            return false;
+        }
+
+        LOG(1) << "replSet streaming oplog from " << r.conn()->getServerAddress() << rsLog;
+        return true;
+    }
+
     bool BackgroundSync::shouldChangeSyncTarget() {
         boost::unique_lock<boost::mutex> lock(_mutex);
 
@@ -527,6 +580,38 @@ namespace replset {
         }
     }
 
+    BSONObj BackgroundSync::getCounters() {
+        ThroughputSample now;
+        now.millis = curTimeMillis64();
+        now.opsFetched = opsReadStats.get();
+        now.bytesFetched = networkByteStats.get();
+        now.opsApplied = SyncTail::numOpsApplied();
+
+        BSONObjBuilder b;
+        {
+            boost::unique_lock<boost::mutex> lock(_mutex);
+            long long elapsedMillis = now.millis - _throughputSample.millis;
+            if (elapsedMillis >= throughputSampleMillis) {
+                // the first sample is taken against zeros, giving the averages since startup
+                double secs = elapsedMillis / 1000.0;
+                _fetchedOpsPerSec = (now.opsFetched - _throughputSample.opsFetched) / secs;
+                _fetchedBytesPerSec = (now.bytesFetched - _throughputSample.bytesFetched) / secs;
+                _appliedOpsPerSec = (now.opsApplied - _throughputSample.opsApplied) / secs;
+                _throughputSample = now;
+            }
+            b.append("fetchedOpsPerSec", _fetchedOpsPerSec);
+            b.append("fetchedBytesPerSec", _fetchedBytesPerSec);
+            b.append("appliedOpsPerSec", _appliedOpsPerSec);
+        }
+        b.append("fetchedOps", now.opsFetched);
+        b.append("fetchedBytes", now.bytesFetched);
+        b.append("appliedOps", now.opsApplied);
+        b.append("bufferCount", bufferCountGauge.get());
+        b.append("bufferSizeBytes", bufferSizeGauge.get());
+        b.append("bufferMaxSizeBytes", bufferMaxSizeGauge);
+        return b.obj();
+    }
+
     bool BackgroundSync::isRollbackRequired(OplogReader& r) {
         string hn = r.conn()->getServerAddress();
 
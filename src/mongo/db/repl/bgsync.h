@@ -99,6 +99,20 @@ namespace replset {
 
         OpTime _consumedOpTime; // not locked, only used by notifier thread
 
+        // Monitoring, protected by _mutex.  Rates are recomputed from the counters whenever the
+        // sample they were taken against gets old enough.
+        struct ThroughputSample {
+            ThroughputSample() : millis(0), opsFetched(0), bytesFetched(0), opsApplied(0) {}
+            long long millis;
+            long long opsFetched;
+            long long bytesFetched;
+            long long opsApplied;
+        };
+        ThroughputSample _throughputSample;
+        double _fetchedOpsPerSec;
+        double _fetchedBytesPerSec;
+        double _appliedOpsPerSec;
+
         BackgroundSync();
         BackgroundSync(const BackgroundSync& s);
         BackgroundSync operator=(const BackgroundSync& s);
@@ -109,6 +123,10 @@ namespace replset {
         void produce();
         // Check if rollback is necessary
         bool isRollbackRequired(OplogReader& r);
+        // Re-issue the oplog query on r as an exhaust cursor, so the sync target streams batches
+        // without waiting for getMores.  Returns false if the sync target's oplog no longer
+        // starts with the last op fetched.
+        bool startOplogStream(OplogReader& r);
         void getOplogReader(OplogReader& r);
         // Evaluate if the current sync target is still good
         bool shouldChangeSyncTarget();
@@ -145,7 +163,8 @@ namespace replset {
         virtual const Member* getSyncTarget();
         virtual void waitForMore();
 
-        // For monitoring
+        // For monitoring: ops and bytes fetched from the sync target, ops applied, what is
+        // waiting in the buffer, and recent fetch and apply rates
         BSONObj getCounters();
 
         // Wait for replication to finish and buffer to be applied so that the member can become
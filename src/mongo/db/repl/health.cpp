@@ -443,6 +443,16 @@ namespace mongo {
                 bb.append("maintenanceMode", maintenance);
             }
 
+            if (myState.startup2()) {
+                BSONObjBuilder progress(bb.subobjStart("initialSyncProgress"));
+                _appendInitialSyncProgress(progress);
+                progress.done();
+            }
+
+            if (myState.secondary() || myState.recovering()) {
+                bb.append("syncThroughput", replset::BackgroundSync::get()->getCounters());
+            }
+
             if (theReplSet) {
                 string s = theReplSet->hbmsg();
                 if( !s.empty() )
@@ -575,6 +575,7 @@ namespace mongo {
                                     const Member* source);
         void _initialSync();
         void syncDoInitialSync();
+        void _appendInitialSyncProgress(BSONObjBuilder& b) const; // for replSetGetStatus
         void _syncThread();
         void syncTail();
         unsigned _syncRollback(OplogReader& r);
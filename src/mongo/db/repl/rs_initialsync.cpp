@@ -41,6 +41,8 @@
 #include "mongo/bson/optime.h"
 #include "mongo/db/repl/replication_server_status.h"  // replSettings
 #include "mongo/db/repl/rs_sync.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/fail_point_service.h"
 #include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
@@ -50,6 +52,19 @@ namespace mongo {
 
     void dropAllDatabasesExceptLocal();
 
+    // Number of collections of a database initial sync copies at once
+    MONGO_EXPORT_SERVER_PARAMETER(initialSyncParallelCollections, int, 4);
+
+    // For looking at the progress of a finished data copy in tests
+    MONGO_FP_DECLARE(initialSyncHangAfterDataCopy);
+
+    // Collections, documents and bytes copied by the current (or last) initial sync
+    static CloneProgress initialSyncProgress;
+
+    void ReplSetImpl::_appendInitialSyncProgress(BSONObjBuilder& b) const {
+        initialSyncProgress.append(b);
+    }
+
     // add try/catch with sleep
 
     void isyncassert(const string& msg, bool expr) {
@@ -108,6 +123,8 @@ namespace mongo {
             options.mayBeInterrupted = false;
             options.syncData = dataPass;
             options.syncIndexes = ! dataPass;
+            options.parallelCollections = initialSyncParallelCollections;
+            options.progress = &initialSyncProgress;
 
             if (!cloner.go(ctx.ctx(), master.c_str(), options, NULL, err, &errCode)) {
                 sethbmsg(str::stream() << "initial sync: error while "
@@ -400,6 +417,7 @@ namespace mongo {
             dropAllDatabasesExceptLocal();
 
             sethbmsg("initial sync clone all databases", 0);
+            initialSyncProgress.reset();
 
             list<string> dbs = r.conn()->getDatabaseNames();
 
@@ -410,6 +428,16 @@ namespace mongo {
                 return;
             }
 
+            {
+                BSONObjBuilder progress;
+                initialSyncProgress.append(progress);
+                log() << "replSet initial sync data copy done: " << progress.obj() << rsLog;
+            }
+
+            while (MONGO_FAIL_POINT(initialSyncHangAfterDataCopy)) {
+                sleepsecs(1);
+            }
+
             sethbmsg("initial sync data copy, starting syncup",0);
 
             // prime oplog
@@ -85,6 +85,10 @@ namespace replset {
     static ServerStatusMetricField<Counter64> displayOpsApplied( "repl.apply.ops",
                                                                 &opsAppliedStats );
 
+    long long SyncTail::numOpsApplied() {
+        return opsAppliedStats.get();
+    }
+
 
     SyncTail::SyncTail(BackgroundSyncInterface *q) :
         Sync(""), oplogVersion(0), _networkQueue(q), _applyFunc(multiSyncApply) {}
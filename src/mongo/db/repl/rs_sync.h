@@ -62,6 +62,9 @@ namespace replset {
         void oplogApplication();
         bool peek(BSONObj* obj);
 
+        // Number of ops applied by secondaries since startup
+        static long long numOpsApplied();
+
         class OpQueue {
         public:
             OpQueue() : _size(0) {}
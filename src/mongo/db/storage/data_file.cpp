@@ -184,6 +184,14 @@ namespace mongo {
                                           | PDFILE_VERSION_MINOR_24_AND_NEWER);
     }
 
+    bool DataFileHeader::hasNsSegments() const {
+        return versionMinor & PDFILE_VERSION_MINOR_NS_SEGMENTS_MASK;
+    }
+
+    void DataFileHeader::setHasNsSegments() {
+        getDur().writingInt(versionMinor) = versionMinor | PDFILE_VERSION_MINOR_NS_SEGMENTS_MASK;
+    }
+
     void DataFileHeader::init(int fileno, int filelength, const char* filename) {
         if ( uninitialized() ) {
             DEV log() << "datafileheader::init initializing " << filename << " n:" << fileno << endl;
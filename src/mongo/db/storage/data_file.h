@@ -74,7 +74,8 @@ namespace mongo {
 
             // Masking off the 2.8 freelist bit since this version of the code is safe to use with
             // it. SERVER-15319
-            const int minor = versionMinor & ~PDFILE_VERSION_MINOR_28_FREELIST_MASK;
+            const int minor = versionMinor & ~PDFILE_VERSION_MINOR_28_FREELIST_MASK
+                                           & ~PDFILE_VERSION_MINOR_NS_SEGMENTS_MASK;
             return minor == PDFILE_VERSION_MINOR_22_AND_OLDER
                 || minor == PDFILE_VERSION_MINOR_24_AND_NEWER;
         }
@@ -82,6 +83,9 @@ namespace mongo {
         bool is24IndexClean() const;
         void setIs24IndexClean();
 
+        bool hasNsSegments() const;
+        void setHasNsSegments();
+
         bool uninitialized() const { return version == 0; }
 
         void init(int fileno, int filelength, const char* filename);
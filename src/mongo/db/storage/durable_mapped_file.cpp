@@ -58,6 +58,33 @@ namespace mongo {
         fassert( 16112, _view_private == old );
     }
 
+    unsigned long long DurableMappedFile::remapPrivateViewRegion(unsigned long long maxBytes) {
+        verify(storageGlobalParams.dur);
+
+        if( !_remapping ) {
+            if( !_willNeedRemap )
+                return 0;
+            _willNeedRemap = false;
+            _remapping = true;
+            _remapOfs = 0;
+        }
+
+#if defined(_WIN32)
+        // the private view can only be replaced as a whole here
+        remapThePrivateView();
+        unsigned long long len = length() - _remapOfs;
+#else
+        unsigned long long regions = std::max(maxBytes / RemapRegionBytes, 1ULL);
+        unsigned long long len = std::min(regions * RemapRegionBytes, length() - _remapOfs);
+        remapPrivateViewRange(_view_private, _remapOfs, len);
+#endif
+
+        _remapOfs += len;
+        if( _remapOfs >= length() )
+            _remapping = false;
+        return len;
+    }
+
     /** register view. threadsafe */
     void PointerToDurableMappedFile::add(void *view, DurableMappedFile *f) {
         verify(view);
@@ -169,7 +196,7 @@ namespace mongo {
         return false;
     }
 
-    DurableMappedFile::DurableMappedFile() : _willNeedRemap(false) {
+    DurableMappedFile::DurableMappedFile() : _willNeedRemap(false), _remapping(false), _remapOfs(0) {
         _view_write = _view_private = 0;
     }
 
@@ -97,6 +97,16 @@ namespace mongo {
 
         void remapThePrivateView();
 
+        /** private views are remapped a region of this size at a time */
+        static const unsigned long long RemapRegionBytes = 16 * 1024 * 1024;
+
+        /** remap up to maxBytes of the private view (at least one region), continuing where the
+            last call stopped.  a pass over the whole file starts when willNeedRemap() is set, and
+            resets it.
+            @return bytes remapped.  0 if this file has no pass in progress.
+        */
+        unsigned long long remapPrivateViewRegion(unsigned long long maxBytes);
+
         virtual bool isDurableMappedFile() { return true; }
 
     private:
@@ -104,6 +114,8 @@ namespace mongo {
         void *_view_write;
         void *_view_private;
         bool _willNeedRemap;
+        bool _remapping;                 // a pass of remapPrivateViewRegion() is in progress
+        unsigned long long _remapOfs;    // where the next region of the pass starts
         RelativePath _p;   // e.g. "somepath/dbname"
         int _fileSuffixNo;  // e.g. 3.  -1="ns"
 
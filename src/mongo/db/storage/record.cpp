@@ -40,6 +40,8 @@
 #include "mongo/db/pdfile.h"
 #include "mongo/platform/bits.h"
 #include "mongo/platform/unordered_set.h"
+#include "mongo/util/concurrency/threadlocal.h"
+#include "mongo/util/mmap.h"
 #include "mongo/util/net/listen.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/stack_introspect.h"
@@ -51,6 +53,7 @@ namespace mongo {
     void RecordStats::record( BSONObjBuilder& b ) {
         b.appendNumber( "accessesNotInMemory" , accessesNotInMemory.load() );
         b.appendNumber( "pageFaultExceptionsThrown" , pageFaultExceptionsThrown.load() );
+        b.appendNumber( "readAheadsIssued" , readAheadsIssued.load() );
 
     }
 
@@ -371,18 +374,24 @@ namespace mongo {
 
         };
      
-        void appendWorkingSetInfo( BSONObjBuilder& b ) {
+        /** @return the oldest timestamp of the pages added */
+        time_t addWorkingSetPages( unordered_set<size_t>* pages ) {
             boost::scoped_array<Slice> mySlices( new Slice[NumSlices] );
 
-            unordered_set<size_t> totalPages;
-            Timer t;
-
             time_t timestamp = 0;
 
             for ( int i = 0; i < BigHashSize; i++ ) {
-                time_t myOldestTimestamp = rolling[i].addPages( &totalPages, mySlices.get() );
+                time_t myOldestTimestamp = rolling[i].addPages( pages, mySlices.get() );
                 timestamp = std::max( timestamp, myOldestTimestamp );
             }
+            return timestamp;
+        }
+
+        void appendWorkingSetInfo( BSONObjBuilder& b ) {
+            unordered_set<size_t> totalPages;
+            Timer t;
+
+            time_t timestamp = addWorkingSetPages( &totalPages );
 
             b.append( "note", "thisIsAnEstimate" );
             b.appendNumber( "pagesInMemory", totalPages.size() );
@@ -452,6 +461,57 @@ namespace mongo {
         ps::appendWorkingSetInfo( b );
     }
 
+    void Record::getWorkingSetPages( unordered_set<size_t>* pages ) {
+        ps::addWorkingSetPages( pages );
+    }
+
+    /** the ranges a thread asked to read ahead, waiting for its next yield */
+    struct RecordPrefetchQueue {
+        RecordPrefetchQueue() : era( 0 ) { }
+
+        enum { MaxRanges = 256 };
+
+        // LockMongoFilesShared::getEra() when the ranges were queued
+        unsigned era;
+        vector< pair<const char*, size_t> > ranges;
+    };
+
+    TSP_DECLARE(RecordPrefetchQueue, recordPrefetchQueue)
+    TSP_DEFINE(RecordPrefetchQueue, recordPrefetchQueue)
+
+    void Record::queuePrefetch( const char* data, size_t len ) {
+        RecordPrefetchQueue* q = recordPrefetchQueue.get();
+        if ( ! q ) {
+            q = new RecordPrefetchQueue();
+            recordPrefetchQueue.reset( q );
+        }
+
+        unsigned era = LockMongoFilesShared::getEra();
+        if ( q->era != era ) {
+            q->ranges.clear();
+            q->era = era;
+        }
+
+        if ( q->ranges.size() >= RecordPrefetchQueue::MaxRanges )
+            return;
+        q->ranges.push_back( make_pair( data, len ) );
+    }
+
+    void Record::issuePrefetches() {
+        RecordPrefetchQueue* q = recordPrefetchQueue.get();
+        if ( ! q || q->ranges.empty() )
+            return;
+
+        LockMongoFilesShared::assertAtLeastReadLocked();
+        if ( q->era == LockMongoFilesShared::getEra() ) {
+            for ( size_t i = 0; i < q->ranges.size(); i++ ) {
+                prefetchMappedRange( q->ranges[i].first, q->ranges[i].second );
+            }
+            recordStats.readAheadsIssued.fetchAndAdd( q->ranges.size() );
+        }
+        q->ranges.clear();
+    }
+
     bool Record::likelyInPhysicalMemory() const {
         return likelyInPhysicalMemory( _data );
     }
@@ -32,6 +32,7 @@
 
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/platform/unordered_set.h"
 #include "mongo/db/storage/extent.h"
 
 namespace mongo {
@@ -121,6 +122,29 @@ namespace mongo {
         static void appendStats( BSONObjBuilder& b );
 
         static void appendWorkingSetInfo( BSONObjBuilder& b );
+
+        /** adds the pages (address >> 12) recently seen in memory to pages */
+        static void getWorkingSetPages( unordered_set<size_t>* pages );
+
+        // ---------------------
+        // read-ahead
+        // ---------------------
+
+        enum PrefetchSizeValue { DefaultPrefetchBytes = 8 * 1024 };
+
+        /**
+         * remembers that this thread is about to read [data, data+len) so that its next yield
+         * can have the OS start paging that range in while no lock is held.
+         * call with the db lock held; the queue is bounded and further requests are dropped.
+         */
+        static void queuePrefetch( const char* data, size_t len = DefaultPrefetchBytes );
+
+        /**
+         * hands the ranges queued by this thread to the OS as async prefetch hints and clears
+         * the queue.  the caller must hold LockMongoFilesShared; ranges queued before a file
+         * was closed or remapped are dropped.
+         */
+        static void issuePrefetches();
     private:
 
         little<int> _netLength() const { return _lengthWithHeaders - HeaderSize; }
@@ -181,6 +205,7 @@ namespace mongo {
 
         AtomicInt64 accessesNotInMemory;
         AtomicInt64 pageFaultExceptionsThrown;
+        AtomicInt64 readAheadsIssued;
     };
 
     // ------------------
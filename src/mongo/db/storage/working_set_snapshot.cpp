@@ -0,0 +1,436 @@
+// working_set_snapshot.cpp
+
+/**
+*    Copyright (C) 2014 MongoDB Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/db/storage/working_set_snapshot.h"
+
+#include <algorithm>
+#include <boost/filesystem/operations.hpp>
+
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/durable_mapped_file.h"
+#include "mongo/db/storage/record.h"
+#include "mongo/db/storage_options.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/background.h"
+#include "mongo/util/bufreader.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/file.h"
+#include "mongo/util/paths.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    // 0 turns the snapshots off
+    MONGO_EXPORT_SERVER_PARAMETER(workingSetSnapshotIntervalSecs, int, 300);
+
+    // 0 turns the warm-up off
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(workingSetWarmupThreads, int, 4);
+
+    namespace {
+
+        const char SnapshotMagic[] = "WSS1";
+        const int PageShift = 12; // the page size Record tracks
+        const unsigned ReadChunkBytes = 1024 * 1024;
+        const unsigned long long TaskBytes = 32 * 1024 * 1024;
+
+        /** a run of pages in a data file */
+        struct PageRange {
+            unsigned first;
+            unsigned count;
+        };
+
+        struct FilePages {
+            std::string file; // relative to the dbpath
+            std::vector<PageRange> ranges;
+        };
+
+        boost::filesystem::path snapshotPath() {
+            return boost::filesystem::path( storageGlobalParams.dbpath ) / "workingSet.snapshot";
+        }
+
+        // ---- status for serverStatus ----
+
+        SimpleMutex statusMutex( "workingSetSnapshot" );
+        std::string warmupState = "none";
+        long long warmupBytesTotal = 0;
+        int warmupFilesMissing = 0;
+        long long warmupMillis = 0;
+        Timer warmupTimer;
+        AtomicInt64 warmupBytesRead;
+
+        Date_t lastSnapshot;
+        long long lastSnapshotPages = 0;
+        long long lastSnapshotRanges = 0;
+        int lastSnapshotMillis = 0;
+
+        // ---- writing ----
+
+        struct MappedView {
+            size_t start;
+            size_t length;
+            std::string file;
+
+            bool operator<( const MappedView& other ) const { return start < other.start; }
+        };
+
+        class ViewCollector {
+        public:
+            ViewCollector( std::vector<MappedView>* views ) : _views( views ) {}
+            void operator()( MongoFile* mf ) {
+                DurableMappedFile* mmf = dynamic_cast<DurableMappedFile*>( mf );
+                if ( !mmf || !mmf->getView() )
+                    return;
+                MappedView v;
+                v.start = reinterpret_cast<size_t>( mmf->getView() );
+                v.length = mmf->length();
+                v.file = RelativePath::fromFullPath( mmf->filename() ).toString();
+                _views->push_back( v );
+            }
+        private:
+            std::vector<MappedView>* _views;
+        };
+
+        /** maps the pages Record has recently seen in memory back to data file offsets
+            @return the number of pages
+        */
+        long long collectWorkingSet( std::vector<FilePages>* out ) {
+            unordered_set<size_t> pages;
+            Record::getWorkingSetPages( &pages );
+
+            std::vector<MappedView> views;
+            MongoFile::forEach( ViewCollector( &views ) );
+            std::sort( views.begin(), views.end() );
+
+            std::map< std::string, std::vector<unsigned> > byFile;
+            long long n = 0;
+            for ( unordered_set<size_t>::const_iterator i = pages.begin(); i != pages.end(); ++i ) {
+                MappedView key;
+                key.start = *i << PageShift;
+                std::vector<MappedView>::const_iterator v =
+                    std::upper_bound( views.begin(), views.end(), key );
+                if ( v == views.begin() )
+                    continue;
+                --v;
+                if ( key.start >= v->start + v->length )
+                    continue;
+                byFile[v->file].push_back( ( key.start - v->start ) >> PageShift );
+                n++;
+            }
+
+            for ( std::map< std::string, std::vector<unsigned> >::iterator i = byFile.begin();
+                  i != byFile.end(); ++i ) {
+                std::vector<unsigned>& filePages = i->second;
+                std::sort( filePages.begin(), filePages.end() );
+
+                FilePages fp;
+                fp.file = i->first;
+                for ( size_t j = 0; j < filePages.size(); j++ ) {
+                    if ( !fp.ranges.empty() &&
+                         fp.ranges.back().first + fp.ranges.back().count == filePages[j] ) {
+                        fp.ranges.back().count++;
+                        continue;
+                    }
+                    PageRange r;
+                    r.first = filePages[j];
+                    r.count = 1;
+                    fp.ranges.push_back( r );
+                }
+                out->push_back( fp );
+            }
+            return n;
+        }
+
+        /** replaces the snapshot file, via a rename so a crash leaves the old or the new one */
+        bool writeSnapshot( const std::vector<FilePages>& files ) {
+            BufBuilder b;
+            b.appendBuf( SnapshotMagic, 4 );
+            b.appendNum( static_cast<int>( files.size() ) );
+            for ( size_t i = 0; i < files.size(); i++ ) {
+                b.appendStr( files[i].file );
+                b.appendNum( static_cast<int>( files[i].ranges.size() ) );
+                for ( size_t j = 0; j < files[i].ranges.size(); j++ ) {
+                    b.appendNum( files[i].ranges[j].first );
+                    b.appendNum( files[i].ranges[j].count );
+                }
+            }
+
+            std::string path = snapshotPath().string();
+            std::string tmp = path + ".tmp";
+            try {
+                boost::filesystem::remove( tmp );
+                {
+                    File f;
+                    f.open( tmp.c_str() );
+                    if ( !f.is_open() )
+                        return false;
+                    f.write( 0, b.buf(), b.len() );
+                    f.fsync();
+                    if ( f.bad() )
+                        return false;
+                }
+                boost::filesystem::rename( tmp, path );
+            }
+            catch ( const std::exception& e ) {
+                warning() << "couldn't write working set snapshot " << path << ": " << e.what();
+                return false;
+            }
+            return true;
+        }
+
+        void snapshotWorkingSet() {
+            Timer t;
+            std::vector<FilePages> files;
+            long long pages = collectWorkingSet( &files );
+            if ( pages == 0 ) {
+                // nothing seen yet; keep whatever the last snapshot had
+                return;
+            }
+
+            if ( !writeSnapshot( files ) )
+                return;
+
+            long long ranges = 0;
+            for ( size_t i = 0; i < files.size(); i++ )
+                ranges += files[i].ranges.size();
+
+            SimpleMutex::scoped_lock lk( statusMutex );
+            lastSnapshot = jsTime();
+            lastSnapshotPages = pages;
+            lastSnapshotRanges = ranges;
+            lastSnapshotMillis = t.millis();
+            LOG(1) << "wrote working set snapshot: " << pages << " pages in " << ranges
+                   << " ranges, " << lastSnapshotMillis << "ms";
+        }
+
+        // ---- warm-up ----
+
+        bool readSnapshot( std::vector<FilePages>* files ) {
+            std::string path = snapshotPath().string();
+            if ( !boost::filesystem::exists( path ) )
+                return false;
+
+            File f;
+            f.open( path.c_str(), true );
+            if ( !f.is_open() )
+                return false;
+            fileofs len = f.len();
+            if ( len < 8 || len > 0x7fffffff )
+                return false;
+            std::vector<char> buf( len );
+            f.read( 0, &buf[0], len );
+            if ( f.bad() )
+                return false;
+
+            try {
+                BufReader r( &buf[0], len );
+                if ( memcmp( r.skip( 4 ), SnapshotMagic, 4 ) != 0 ) {
+                    warning() << "ignoring working set snapshot " << path << ": bad header";
+                    return false;
+                }
+                int nFiles;
+                r.read( nFiles );
+                for ( int i = 0; i < nFiles; i++ ) {
+                    FilePages fp;
+                    r.readStr( fp.file );
+                    int nRanges;
+                    r.read( nRanges );
+                    for ( int j = 0; j < nRanges; j++ ) {
+                        PageRange range;
+                        r.read( range.first );
+                        r.read( range.count );
+                        fp.ranges.push_back( range );
+                    }
+                    files->push_back( fp );
+                }
+            }
+            catch ( const std::exception& e ) {
+                warning() << "ignoring working set snapshot " << path << ": " << e.what();
+                return false;
+            }
+            return true;
+        }
+
+        struct WarmupTask {
+            std::string path;
+            std::vector<PageRange> ranges;
+        };
+
+        /** reads a task's ranges, so that mapping them later doesn't have to go to disk */
+        void warmRanges( const WarmupTask* task ) {
+            try {
+                if ( !boost::filesystem::exists( task->path ) ) {
+                    SimpleMutex::scoped_lock lk( statusMutex );
+                    warmupFilesMissing++;
+                    return;
+                }
+
+                File f;
+                f.open( task->path.c_str(), true );
+                if ( !f.is_open() )
+                    return;
+                fileofs fileLen = f.len();
+                std::vector<char> buf( ReadChunkBytes );
+
+                for ( size_t i = 0; i < task->ranges.size(); i++ ) {
+                    fileofs ofs = static_cast<fileofs>( task->ranges[i].first ) << PageShift;
+                    fileofs end = std::min( fileLen,
+                        ofs + ( static_cast<fileofs>( task->ranges[i].count ) << PageShift ) );
+                    while ( ofs < end ) {
+                        if ( inShutdown() )
+                            return;
+                        unsigned n = static_cast<unsigned>( std::min<fileofs>( ReadChunkBytes,
+                                                                                end - ofs ) );
+                        f.read( ofs, &buf[0], n );
+                        if ( f.bad() )
+                            return;
+                        warmupBytesRead.fetchAndAdd( n );
+                        ofs += n;
+                    }
+                }
+            }
+            catch ( const std::exception& e ) {
+                warning() << "working set warm-up of " << task->path << " stopped: " << e.what();
+            }
+        }
+
+        void warmUp() {
+            std::vector<FilePages> files;
+            if ( workingSetWarmupThreads <= 0 || !readSnapshot( &files ) )
+                return;
+
+            // split into tasks small enough to spread a few big files over all the threads
+            std::vector<WarmupTask> tasks;
+            long long total = 0;
+            for ( size_t i = 0; i < files.size(); i++ ) {
+                std::string path = RelativePath::fromRelativePath( files[i].file ).asFullPath();
+                unsigned long long taskBytes = TaskBytes;
+                for ( size_t j = 0; j < files[i].ranges.size(); j++ ) {
+                    if ( taskBytes >= TaskBytes ) {
+                        tasks.push_back( WarmupTask() );
+                        tasks.back().path = path;
+                        taskBytes = 0;
+                    }
+                    const PageRange& range = files[i].ranges[j];
+                    tasks.back().ranges.push_back( range );
+                    unsigned long long bytes = static_cast<unsigned long long>( range.count ) << PageShift;
+                    taskBytes += bytes;
+                    total += bytes;
+                }
+            }
+
+            {
+                SimpleMutex::scoped_lock lk( statusMutex );
+                warmupState = "running";
+                warmupBytesTotal = total;
+                warmupTimer.reset();
+            }
+            log() << "warming up working set from " << snapshotPath().string() << ": "
+                  << total / ( 1024 * 1024 ) << "MB in " << files.size() << " files, "
+                  << workingSetWarmupThreads << " threads";
+
+            {
+                threadpool::ThreadPool pool( workingSetWarmupThreads );
+                for ( size_t i = 0; i < tasks.size(); i++ )
+                    pool.schedule( &warmRanges, &tasks[i] );
+                pool.join();
+            }
+
+            SimpleMutex::scoped_lock lk( statusMutex );
+            warmupState = inShutdown() ? "interrupted" : "done";
+            warmupMillis = warmupTimer.millis();
+            log() << "working set warm-up " << warmupState << ": read "
+                  << warmupBytesRead.load() / ( 1024 * 1024 ) << "MB in " << warmupMillis << "ms";
+        }
+
+        class WorkingSetSnapshotter : public BackgroundJob {
+        public:
+            WorkingSetSnapshotter() : BackgroundJob( true /* selfDelete */ ) {}
+            virtual std::string name() const { return "WorkingSetSnapshotter"; }
+
+            virtual void run() {
+                // nothing is written until the warm-up is over, as the pages it reads back
+                // aren't tracked and the old snapshot is still the better one
+                warmUp();
+
+                int secs = 0;
+                while ( !inShutdown() ) {
+                    sleepsecs( 1 );
+                    int interval = workingSetSnapshotIntervalSecs;
+                    if ( interval <= 0 || ++secs < interval )
+                        continue;
+                    secs = 0;
+                    snapshotWorkingSet();
+                }
+            }
+        };
+
+        class WorkingSetSnapshotSSS : public ServerStatusSection {
+        public:
+            WorkingSetSnapshotSSS() : ServerStatusSection( "workingSetSnapshot" ) {}
+            virtual bool includeByDefault() const { return true; }
+
+            BSONObj generateSection( const BSONElement& configElement ) const {
+                SimpleMutex::scoped_lock lk( statusMutex );
+                BSONObjBuilder b;
+                {
+                    BSONObjBuilder warmup( b.subobjStart( "warmup" ) );
+                    warmup.append( "state", warmupState );
+                    warmup.appendNumber( "bytesTotal", warmupBytesTotal );
+                    warmup.appendNumber( "bytesRead", warmupBytesRead.load() );
+                    warmup.append( "filesMissing", warmupFilesMissing );
+                    warmup.appendNumber( "millis", warmupState == "running" ?
+                                         static_cast<long long>( warmupTimer.millis() ) :
+                                         warmupMillis );
+                    warmup.done();
+                }
+                {
+                    BSONObjBuilder last( b.subobjStart( "lastSnapshot" ) );
+                    if ( lastSnapshot.millis )
+                        last.appendDate( "time", lastSnapshot );
+                    last.appendNumber( "pages", lastSnapshotPages );
+                    last.appendNumber( "ranges", lastSnapshotRanges );
+                    last.append( "millis", lastSnapshotMillis );
+                    last.done();
+                }
+                return b.obj();
+            }
+        } workingSetSnapshotSSS;
+
+    }
+
+    void startWorkingSetSnapshots() {
+        WorkingSetSnapshotter* job = new WorkingSetSnapshotter();
+        job->go();
+    }
+
+}
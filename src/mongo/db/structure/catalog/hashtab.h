@@ -150,6 +150,27 @@ namespace mongo {
             return true;
         }
 
+        /** for a key the caller knows isn't in the table: takes the first free node on its
+            chain, without probing the rest of the chain for the key.
+            @return the stored value, or 0 if the chain is full
+        */
+        Type* putNew(const Key& k, const Type& value) {
+            int h = k.hash();
+            int i = h % n;
+            for ( int chain = 0; chain < maxChain; chain++ ) {
+                if ( !nodes(i).inUse() ) {
+                    Node* node = getDur().writing( &nodes(i) );
+                    node->k = k;
+                    node->hash = h;
+                    node->value = value;
+                    return &nodes(i).value;
+                }
+                i = (i+1) % n;
+            }
+            out() << "error: hashtable " << name << " max chain reached:" << maxChain << endl;
+            return 0;
+        }
+
         typedef void (*IteratorCallback)( const Key& k , Type& v );
         void iterAll( IteratorCallback callback ) {
             for ( int i=0; i<n; i++ ) {
@@ -44,8 +44,10 @@
 #include "mongo/db/ops/delete.h"
 #include "mongo/db/ops/update.h"
 #include "mongo/db/pdfile.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/durable_mapped_file.h"
 #include "mongo/db/structure/catalog/hashtab.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/scripting/engine.h"
 #include "mongo/util/startup_test.h"
 
@@ -65,6 +67,393 @@ namespace mongo {
     static ServerStatusMetricField<Counter64> dFreelist3( "storage.freelist.search.scanned",
                                                           &freelistIterations );
 
+    static Counter64 freelistIndexBuilds;
+    static ServerStatusMetricField<Counter64> dFreelist4( "storage.freelist.index.builds",
+                                                          &freelistIndexBuilds );
+
+    // Collections with more deleted records than this search the deleted lists bucket by bucket
+    // instead of keeping an index of them by size.  0 turns the index off.  Startup only: an
+    // index that missed changes to the lists while it was off could not be trusted again.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(freelistIndexMaxRecords, int, 1000000);
+
+    // The most deleted records indexed across all collections together.  A collection that would
+    // take the total past it goes unindexed, as if it had more than freelistIndexMaxRecords.
+    // 0 means no limit.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(freelistIndexMaxTotalRecords, int, 4000000);
+
+    namespace {
+
+        // deleted records in all the indexes
+        AtomicInt64 indexedDeletedRecords;
+
+        /** @return true if indexing one more deleted record would go past the global budget */
+        bool overTotalBudget() {
+            return freelistIndexMaxTotalRecords > 0 &&
+                indexedDeletedRecords.load() >= freelistIndexMaxTotalRecords;
+        }
+
+        /** An in-memory mirror of a non-capped collection's deleted lists, ordered by size so that
+            alloc() can find the best fit without walking the lists.  The lists on disk are
+            unchanged and stay authoritative: the index is built from them on first use, and each
+            deleted record remembers which record links to it so it can be unlinked directly.
+        */
+        class DeletedListIndex : boost::noncopyable {
+        public:
+            DeletedListIndex() : mutex( "deletedListIndex" ), _bytes(0), _overflow(false) { }
+            ~DeletedListIndex() { indexedDeletedRecords.subtractAndFetch( _entries.size() ); }
+
+            /** held while the index is used.  writers also hold the database write lock */
+            SimpleMutex mutex;
+
+            /** @return false if there are more than maxRecords deleted records, or too many
+                for the global budget */
+            bool build( const NamespaceDetails* d, size_t maxRecords ) {
+                for ( int b = 0; b < Buckets; b++ ) {
+                    DiskLoc prev;
+                    for ( DiskLoc cur = d->deletedListEntry( b ); !cur.isNull();
+                          cur = cur.drec()->nextDeleted() ) {
+                        if ( _entries.size() >= maxRecords || overTotalBudget() )
+                            return false;
+                        _insert( cur, cur.drec()->lengthWithHeaders(), b, prev );
+                        prev = cur;
+                    }
+                }
+                return true;
+            }
+
+            /** loc was pushed on the front of bucket b's list, ahead of oldHead
+                @return false if the index was out of step with the lists */
+            bool added( const DiskLoc& loc, int len, int b, const DiskLoc& oldHead ) {
+                if ( !oldHead.isNull() ) {
+                    Entries::iterator i = _entries.find( oldHead );
+                    if ( i == _entries.end() || !i->second.prev.isNull() )
+                        return false;
+                    i->second.prev = loc;
+                }
+                _insert( loc, len, b, DiskLoc() );
+                return true;
+            }
+
+            /** loc was unlinked; next was the record after it */
+            bool removed( const DiskLoc& loc, const DiskLoc& next ) {
+                Entries::iterator i = _entries.find( loc );
+                if ( i == _entries.end() )
+                    return false;
+                if ( !next.isNull() ) {
+                    Entries::iterator n = _entries.find( next );
+                    if ( n == _entries.end() )
+                        return false;
+                    n->second.prev = i->second.prev;
+                }
+                _bytes -= i->second.bySize->first;
+                _bySize.erase( i->second.bySize );
+                _entries.erase( i );
+                indexedDeletedRecords.subtractAndFetch( 1 );
+                return true;
+            }
+
+            /** @return the smallest deleted record of at least len, null if there isn't one
+                @param prev set to the record linking to it, null if it heads its list
+                @param b set to its bucket
+            */
+            DiskLoc bestFit( int len, DiskLoc* prev, int* b ) const {
+                BySize::const_iterator i = _bySize.lower_bound( len );
+                if ( i == _bySize.end() )
+                    return DiskLoc();
+                const Entry& e = _entries.find( i->second )->second;
+                *prev = e.prev;
+                *b = e.bucket;
+                return i->second;
+            }
+
+            /** @return the deleted records in [begin, end) */
+            void recordsBetween( const DiskLoc& begin, const DiskLoc& end,
+                                 vector<DiskLoc>* locs ) const {
+                for ( Entries::const_iterator i = _entries.lower_bound( begin );
+                      i != _entries.end() && i->first < end; ++i ) {
+                    locs->push_back( i->first );
+                }
+            }
+
+            /** @return false if loc isn't indexed
+                @param prev set to the record linking to loc, null if it heads its list
+                @param b set to its bucket
+            */
+            bool find( const DiskLoc& loc, DiskLoc* prev, int* b ) const {
+                Entries::const_iterator i = _entries.find( loc );
+                if ( i == _entries.end() )
+                    return false;
+                *prev = i->second.prev;
+                *b = i->second.bucket;
+                return true;
+            }
+
+            size_t records() const { return _entries.size(); }
+            long long bytes() const { return _bytes; }
+            int largest() const { return _bySize.empty() ? 0 : _bySize.rbegin()->first; }
+
+            /** set when the collection had too many deleted records to index */
+            bool overflow() const { return _overflow; }
+            void setOverflow() {
+                indexedDeletedRecords.subtractAndFetch( _entries.size() );
+                _bySize.clear();
+                _entries.clear();
+                _bytes = 0;
+                _overflow = true;
+            }
+
+        private:
+            typedef std::multimap<int, DiskLoc> BySize;
+            struct Entry {
+                BySize::iterator bySize;
+                DiskLoc prev; // record whose nextDeleted is this one, null at the head of the list
+                int bucket;
+            };
+            typedef std::map<DiskLoc, Entry> Entries;
+
+            void _insert( const DiskLoc& loc, int len, int b, const DiskLoc& prev ) {
+                Entry e;
+                e.bySize = _bySize.insert( make_pair( len, loc ) );
+                e.prev = prev;
+                e.bucket = b;
+                _entries[loc] = e;
+                _bytes += len;
+                indexedDeletedRecords.addAndFetch( 1 );
+            }
+
+            BySize _bySize;
+            Entries _entries;
+            long long _bytes;
+            bool _overflow;
+        };
+
+        /** the in-memory state of a non-capped collection's deleted lists */
+        struct DeletedListState {
+            DeletedListState() : emptyingLength(0) { }
+
+            shared_ptr<DeletedListIndex> index; // null until built, or after being dropped
+
+            // an extent whose deleted records are kept off the lists, see beginEmptyingExtent()
+            DiskLoc emptyingExtent;
+            int emptyingLength;
+        };
+
+        // NamespaceDetails live in the memory mapped .ns files, so their state is kept here,
+        // keyed by address.  The mutex is only for the map, which is shared by all databases;
+        // each index has a mutex of its own.  Never wait for an index's mutex while holding it.
+        SimpleMutex deletedListIndexesMutex( "deletedListIndexes" );
+        typedef std::map<const NamespaceDetails*, DeletedListState> DeletedListIndexes;
+        DeletedListIndexes deletedListIndexes;
+
+        /** locks the index of a NamespaceDetails, if it has one that isn't overflowed */
+        class DeletedListIndexLock : boost::noncopyable {
+        public:
+            explicit DeletedListIndexLock( const NamespaceDetails* d ) : _d( d ) {
+                if ( d->isCapped() )
+                    return;
+                {
+                    SimpleMutex::scoped_lock lk( deletedListIndexesMutex );
+                    DeletedListIndexes::iterator i = deletedListIndexes.find( d );
+                    if ( i == deletedListIndexes.end() )
+                        return;
+                    _emptyingBegin = i->second.emptyingExtent;
+                    _emptyingEnd = DiskLoc( _emptyingBegin.a(),
+                                            _emptyingBegin.getOfs() + i->second.emptyingLength );
+                    if ( freelistIndexMaxRecords <= 0 || !i->second.index )
+                        return;
+                    _index = i->second.index;
+                }
+                _index->mutex.lock();
+                if ( _index->overflow() ) {
+                    _index->mutex.unlock();
+                    _index.reset();
+                }
+            }
+
+            ~DeletedListIndexLock() {
+                if ( _index )
+                    _index->mutex.unlock();
+            }
+
+            /** @return the index, NULL if there is none */
+            DeletedListIndex* get() const { return _index.get(); }
+
+            /** @return true if loc is in the extent being emptied, if there is one */
+            bool inExtentBeingEmptied( const DiskLoc& loc ) const {
+                return !_emptyingBegin.isNull() && _emptyingBegin < loc && loc < _emptyingEnd;
+            }
+
+            /** forgets the index, which is out of step with the deleted lists */
+            void drop() {
+                warning() << "deleted list index out of step with the deleted lists, dropping it"
+                          << endl;
+                {
+                    SimpleMutex::scoped_lock lk( deletedListIndexesMutex );
+                    DeletedListIndexes::iterator i = deletedListIndexes.find( _d );
+                    if ( i != deletedListIndexes.end() && i->second.index == _index )
+                        i->second.index.reset();
+                }
+                _index->mutex.unlock();
+                _index.reset();
+            }
+
+        private:
+            const NamespaceDetails* _d;
+            shared_ptr<DeletedListIndex> _index;
+            DiskLoc _emptyingBegin;
+            DiskLoc _emptyingEnd;
+        };
+
+        /** makes the index for d from its deleted lists if it has none yet.  the caller holds
+            d's database write lock, so the lists hold still while they are walked, which is
+            done without deletedListIndexesMutex: faulting them in must not hold up the other
+            databases.
+        */
+        void buildDeletedListIndex( const NamespaceDetails* d ) {
+            if ( d->isCapped() || freelistIndexMaxRecords <= 0 )
+                return;
+            {
+                SimpleMutex::scoped_lock lk( deletedListIndexesMutex );
+                DeletedListIndexes::const_iterator i = deletedListIndexes.find( d );
+                if ( i != deletedListIndexes.end() && i->second.index )
+                    return;
+            }
+
+            shared_ptr<DeletedListIndex> built( new DeletedListIndex() );
+            freelistIndexBuilds.increment();
+            if ( !built->build( d, freelistIndexMaxRecords ) )
+                built->setOverflow();
+
+            SimpleMutex::scoped_lock lk( deletedListIndexesMutex );
+            DeletedListState& state = deletedListIndexes[d];
+            if ( !state.index )
+                state.index = built;
+        }
+    }
+
+    void NamespaceDetails::forgetDeletedListIndex( const NamespaceDetails* d ) {
+        SimpleMutex::scoped_lock lk( deletedListIndexesMutex );
+        deletedListIndexes.erase( d );
+    }
+
+    void NamespaceDetails::forgetDeletedListIndexes( const void* begin, unsigned long long len ) {
+        SimpleMutex::scoped_lock lk( deletedListIndexesMutex );
+        const NamespaceDetails* b = static_cast<const NamespaceDetails*>( begin );
+        const NamespaceDetails* e = reinterpret_cast<const NamespaceDetails*>(
+            static_cast<const char*>( begin ) + len );
+        deletedListIndexes.erase( deletedListIndexes.lower_bound( b ),
+                                  deletedListIndexes.lower_bound( e ) );
+    }
+
+    /** totals for the deleted lists of d, from its index.  the lists themselves are never
+        walked here: a collection without an index has too many deleted records for that.
+        @return false if d has no index to take them from
+    */
+    static bool deletedListTotals( const NamespaceDetails* d,
+                                   long long* records, long long* bytes, int* largest ) {
+        DeletedListIndexLock index( d );
+        if ( !index.get() )
+            return false;
+        *records = index.get()->records();
+        *bytes = index.get()->bytes();
+        *largest = index.get()->largest();
+        return true;
+    }
+
+    bool NamespaceDetails::deletedListSize( long long* bytes ) const {
+        long long records;
+        int largest;
+        return deletedListTotals( this, &records, bytes, &largest );
+    }
+
+    void NamespaceDetails::beginEmptyingExtent( const DiskLoc& extentLoc, int extentLength ) {
+        verify( !isCapped() );
+        {
+            SimpleMutex::scoped_lock lk( deletedListIndexesMutex );
+            DeletedListState& state = deletedListIndexes[this];
+            state.emptyingExtent = extentLoc;
+            state.emptyingLength = extentLength;
+        }
+
+        const DiskLoc begin = extentLoc;
+        const DiskLoc end( extentLoc.a(), extentLoc.getOfs() + extentLength );
+        DeletedListIndexLock index( this );
+        if ( index.get() ) {
+            // the index has the extent's records side by side, with the records linking to
+            // them, so they are unlinked without walking the lists
+            vector<DiskLoc> locs;
+            index.get()->recordsBetween( begin, end, &locs );
+            bool inStep = true;
+            for ( vector<DiskLoc>::const_iterator i = locs.begin(); i != locs.end(); ++i ) {
+                DiskLoc prev;
+                int b;
+                inStep = index.get()->find( *i, &prev, &b );
+                if ( !inStep )
+                    break;
+                DiskLoc& link = prev.isNull() ? _deletedList[b] : prev.drec()->nextDeleted();
+                DiskLoc next = i->drec()->nextDeleted();
+                inStep = link == *i && index.get()->removed( *i, next );
+                if ( !inStep )
+                    break;
+                getDur().writingDiskLoc( link ) = next;
+                i->drec()->nextDeleted().writing().setInvalid(); // defensive.
+            }
+            if ( inStep )
+                return;
+            index.drop();
+        }
+
+        for ( int b = 0; b < Buckets; b++ ) {
+            DiskLoc* link = &_deletedList[b];
+            while ( !link->isNull() ) {
+                DiskLoc cur = *link;
+                DeletedRecord* d = cur.drec();
+                if ( !( begin < cur && cur < end ) ) {
+                    link = &d->nextDeleted();
+                    continue;
+                }
+
+                DiskLoc next = d->nextDeleted();
+                getDur().writingDiskLoc( *link ) = next;
+                d->nextDeleted().writing().setInvalid(); // defensive.
+            }
+        }
+    }
+
+    bool NamespaceDetails::isEmptyingExtent( const DiskLoc& extentLoc ) const {
+        SimpleMutex::scoped_lock lk( deletedListIndexesMutex );
+        DeletedListIndexes::const_iterator i = deletedListIndexes.find( this );
+        return i != deletedListIndexes.end() && i->second.emptyingExtent == extentLoc;
+    }
+
+    void NamespaceDetails::endEmptyingExtent() {
+        SimpleMutex::scoped_lock lk( deletedListIndexesMutex );
+        DeletedListIndexes::iterator i = deletedListIndexes.find( this );
+        if ( i != deletedListIndexes.end() ) {
+            i->second.emptyingExtent = DiskLoc();
+            i->second.emptyingLength = 0;
+        }
+    }
+
+    void NamespaceDetails::appendDeletedListStats( BSONObjBuilder* result,
+                                                   long long storageSize,
+                                                   int scale ) const {
+        long long records;
+        long long bytes;
+        int largest;
+        bool indexed = deletedListTotals( this, &records, &bytes, &largest );
+
+        BSONObjBuilder b( result->subobjStart( "deletedRecords" ) );
+        if ( indexed ) {
+            b.appendNumber( "count", records );
+            b.appendNumber( "size", bytes / scale );
+            b.appendNumber( "largest", largest / scale );
+            b.append( "fragmentation", storageSize ? (double) bytes / storageSize : 0.0 );
+        }
+        b.appendBool( "indexed", indexed );
+        b.done();
+    }
+
     BSONObj idKeyPattern = fromjson("{\"_id\":1}");
 
     /* Deleted list buckets are used to quickly locate free space based on size.  Each bucket
@@ -135,11 +524,26 @@ namespace mongo {
             }
         }
         else {
+            DeletedListIndexLock index( this );
+            if ( index.inExtentBeingEmptied( dloc ) ) {
+                // stays off the lists, the extent's free space is given back when it is done
+                d->nextDeleted().Null();
+                return;
+            }
+
             int b = bucket(d->lengthWithHeaders());
             DiskLoc& list = _deletedList[b];
             DiskLoc oldHead = list;
             getDur().writingDiskLoc(list) = dloc;
             d->nextDeleted() = oldHead;
+
+            if ( index.get() ) {
+                if ( !index.get()->added( dloc, d->lengthWithHeaders(), b, oldHead ) )
+                    index.drop();
+                else if ( index.get()->records() > static_cast<size_t>( freelistIndexMaxRecords ) ||
+                          overTotalBudget() )
+                    index.get()->setOverflow();
+            }
         }
     }
 
@@ -245,6 +649,34 @@ namespace mongo {
     */
     DiskLoc NamespaceDetails::__stdAlloc(int len, bool peekOnly) {
         freelistAllocs.increment();
+
+        if ( !peekOnly ) {
+            // best fit from the size index, when there is one
+            buildDeletedListIndex( this );
+            DeletedListIndexLock index( this );
+            if ( index.get() ) {
+                DiskLoc prev;
+                int b;
+                DiskLoc loc = index.get()->bestFit( len, &prev, &b );
+                freelistIterations.increment( 1 );
+                if ( loc.isNull() )
+                    return loc;
+
+                DeletedRecord *r = loc.drec();
+                DiskLoc next = r->nextDeleted();
+                DiskLoc& link = prev.isNull() ? _deletedList[b] : prev.drec()->nextDeleted();
+                if ( link == loc && r->lengthWithHeaders() >= len &&
+                     index.get()->removed( loc, next ) ) {
+                    getDur().writingDiskLoc( link ) = next;
+                    r->nextDeleted().writing().setInvalid(); // defensive.
+                    verify( r->extentOfs() < loc.getOfs() );
+                    return loc;
+                }
+                index.drop();
+                // fall through to searching the lists
+            }
+        }
+
         DiskLoc *prev;
         DiskLoc *bestprev = 0;
         DiskLoc bestmatch;
@@ -707,6 +1139,7 @@ namespace mongo {
     }
 
     void NamespaceDetails::orphanDeletedList() {
+        forgetDeletedListIndex( this );
         for( int i = 0; i < Buckets; i++ ) {
             _deletedList[i].writing().Null();
         }
@@ -211,6 +211,36 @@ namespace mongo {
 
         void orphanDeletedList();
 
+        /** appends the number and total size of the records on the deleted lists, and how much
+            of storageSize they are, for collStats.  they are only known for collections whose
+            deleted records are indexed, which is reported as well.  not for capped collections.
+        */
+        void appendDeletedListStats( BSONObjBuilder* result, long long storageSize, int scale ) const;
+
+        /** @param bytes set to the total size of the records on the deleted lists
+            @return false if it isn't known, as the deleted records aren't indexed
+        */
+        bool deletedListSize( long long* bytes ) const;
+
+        /** unlinks the deleted records that lie inside an extent from the deleted lists, so that
+            nothing is allocated there while the extent is being emptied.  until
+            endEmptyingExtent(), records deleted in the extent stay off the lists as well, and it
+            is up to the caller to give the extent's free space back.  not for capped
+            collections.
+        */
+        void beginEmptyingExtent( const DiskLoc& extentLoc, int extentLength );
+        bool isEmptyingExtent( const DiskLoc& extentLoc ) const;
+        void endEmptyingExtent();
+
+        /** non-capped collections keep an in-memory index of their deleted records by size (see
+            namespace_details.cpp).  it must be forgotten when the NamespaceDetails it describes
+            goes away or its deleted lists are changed some other way.
+        */
+        static void forgetDeletedListIndex( const NamespaceDetails* d );
+
+        /** forgets the indexes of every NamespaceDetails in [begin, begin+len) */
+        static void forgetDeletedListIndexes( const void* begin, unsigned long long len );
+
         /**
          * @param max in and out, will be adjusted
          * @return if the value is valid at all
@@ -38,16 +38,20 @@
 
 namespace mongo {
 
+    // overflow segments double in size up to this
+    static const unsigned long long MaxSegmentLen = 1024 * 1024 * 1024;
+
     NamespaceDetails* NamespaceIndex::details(const StringData& ns) {
         Namespace n(ns);
         return details(n);
     }
 
     NamespaceDetails* NamespaceIndex::details(const Namespace& ns) {
-        if ( !_ht.get() )
+        Entries::const_iterator i = _entries.find( ns.toString() );
+        if ( i == _entries.end() )
             return 0;
-        NamespaceDetails *d = _ht->get(ns);
-        if ( d && d->isCapped() )
+        NamespaceDetails *d = i->second.details;
+        if ( d->isCapped() )
             d->cappedCheckMigrate();
         return d;
     }
@@ -67,15 +71,41 @@ namespace mongo {
         Lock::assertWriteLocked( nsString );
         massert( 17315, "no . in ns", nsString.find( '.' ) != string::npos );
         init();
-        uassert( 10081, "too many namespaces/collections", _ht->put(ns, *details));
+
+        Entries::const_iterator i = _entries.find( nsString );
+        if ( i != _entries.end() ) {
+            NamespaceDetails* d = i->second.details;
+            *d->writingWithoutExtra() = *details;
+            NamespaceDetails::forgetDeletedListIndex( d );
+            return;
+        }
+
+        int n = _segmentForNew( ns );
+        Segment* segment = _segments[n];
+        NamespaceDetails* d = segment->ht->putNew( ns, *details );
+        uassert( 10081, "too many namespaces/collections", d );
+        segment->used++;
+
+        Entry e;
+        e.details = d;
+        e.segment = n;
+        _entries[nsString] = e;
+        NamespaceDetails::forgetDeletedListIndex( d );
+    }
+
+    NamespaceIndex::~NamespaceIndex() {
+        for ( size_t i = 0; i < _segments.size(); i++ ) {
+            NamespaceDetails::forgetDeletedListIndexes( _segments[i]->f.getView(),
+                                                        _segments[i]->f.length() );
+        }
     }
 
     void NamespaceIndex::kill_ns(const StringData& ns) {
         Lock::assertWriteLocked(ns);
-        if ( !_ht.get() )
+        if ( _segments.empty() )
             return;
         Namespace n(ns);
-        _ht->kill(n);
+        _kill(n);
 
         if (ns.size() <= Namespace::MaxNsColletionLen) {
             // Larger namespace names don't have room for $extras so they can't exist. The code
@@ -84,7 +114,7 @@ namespace mongo {
             for( int i = 0; i<=1; i++ ) {
                 try {
                     Namespace extra(n.extraName(i));
-                    _ht->kill(extra);
+                    _kill(extra);
                 }
                 catch(DBException&) {
                     MONGO_DLOG(3) << "caught exception in kill_ns" << endl;
@@ -93,6 +123,17 @@ namespace mongo {
         }
     }
 
+    void NamespaceIndex::_kill( const Namespace& ns ) {
+        Entries::iterator i = _entries.find( ns.toString() );
+        if ( i == _entries.end() )
+            return;
+        Segment* segment = _segments[i->second.segment];
+        NamespaceDetails::forgetDeletedListIndex( i->second.details );
+        segment->ht->kill(ns);
+        segment->used--;
+        _entries.erase(i);
+    }
+
     bool NamespaceIndex::exists() const {
         return !boost::filesystem::exists(path());
     }
@@ -105,21 +146,29 @@ namespace mongo {
         return ret;
     }
 
-    static void namespaceGetNamespacesCallback( const Namespace& k , NamespaceDetails& v , void * extra ) {
-        list<string> * l = (list<string>*)extra;
-        if ( ! k.hasDollarSign() || k == "local.oplog.$main" ) {
-            // we call out local.oplog.$main specifically as its the only "normal"
-            // collection that has a $, so we make sure it gets added
-            l->push_back( (string)k );
-        }
+    boost::filesystem::path NamespaceIndex::segmentPath( int n ) const {
+        verify( n > 0 );
+        return path().string() + "." + BSONObjBuilder::numStr( n );
+    }
+
+    unsigned long long NamespaceIndex::fileLength() const {
+        unsigned long long len = 0;
+        for ( size_t i = 0; i < _segments.size(); i++ )
+            len += _segments[i]->f.length();
+        return len;
     }
 
     void NamespaceIndex::getNamespaces( list<string>& tofill , bool onlyCollections ) const {
         verify( onlyCollections ); // TODO: need to implement this
-        //                                  need boost::bind or something to make this less ugly
 
-        if ( _ht.get() )
-            _ht->iterAll( namespaceGetNamespacesCallback , (void*)&tofill );
+        for ( Entries::const_iterator i = _entries.begin(); i != _entries.end(); ++i ) {
+            const string& ns = i->first;
+            if ( ns.find( '$' ) == string::npos || ns == "local.oplog.$main" ) {
+                // we call out local.oplog.$main specifically as its the only "normal"
+                // collection that has a $, so we make sure it gets added
+                tofill.push_back( ns );
+            }
+        }
     }
 
     void NamespaceIndex::maybeMkdir() const {
@@ -131,42 +180,55 @@ namespace mongo {
             MONGO_ASSERT_ON_EXCEPTION_WITH_MSG( boost::filesystem::create_directory( dir ), "create dir for db " );
     }
 
-    NOINLINE_DECL void NamespaceIndex::_init() {
-        verify( !_ht.get() );
-
-        Lock::assertWriteLocked(_database);
+    int NamespaceIndex::_segmentForNew( const Namespace& ns ) {
+        if ( ns.isExtra() ) {
+            // found by offset from the base namespace, so has to be mapped alongside it
+            string base = ns.toString();
+            base.resize( base.size() - 6 /*strlen("$extra")*/ );
+            Entries::const_iterator i = _entries.find( base );
+            if ( i != _entries.end() )
+                return i->second.segment;
+        }
 
-        /* if someone manually deleted the datafiles for a database,
-           we need to be sure to clear any cached info for the database in
-           local.*.
-        */
-        /*
-        if ( "local" != _database ) {
-            DBInfo i(_database.c_str());
-            i.dbDropped();
+        // past half full, chains get long enough to slow down inserts and drops
+        for ( size_t n = 0; n < _segments.size(); n++ ) {
+            if ( _segments[n]->used < _segments[n]->ht->n / 2 )
+                return n;
         }
-        */
 
-        unsigned long long len = 0;
-        boost::filesystem::path nsPath = path();
-        string pathString = nsPath.string();
+        int n = _segments.size();
+        uassert( 28636, "too many namespaces/collections", n < MaxSegments );
+        unsigned long long len = _segments[0]->f.length();
+        for ( int i = 0; i < n && len < MaxSegmentLen; i++ )
+            len *= 2;
+        len = std::min( len, MaxSegmentLen );
+        verify( _openSegment( n, len ) );
+        return n;
+    }
+
+    bool NamespaceIndex::_openSegment( int n, unsigned long long len ) {
+        verify( n == static_cast<int>( _segments.size() ) );
+
+        string pathString = ( n == 0 ? path() : segmentPath( n ) ).string();
+        auto_ptr<Segment> segment( new Segment() );
         void *p = 0;
-        if ( boost::filesystem::exists(nsPath) ) {
-            if( _f.open(pathString, true) ) {
-                len = _f.length();
+        if ( boost::filesystem::exists(pathString) ) {
+            if( segment->f.open(pathString, true) ) {
+                len = segment->f.length();
                 if ( len % (1024*1024) != 0 ) {
                     log() << "bad .ns file: " << pathString << endl;
                     uassert( 10079 ,  "bad .ns file length, cannot open database", len % (1024*1024) == 0 );
                 }
-                p = _f.getView();
+                p = segment->f.getView();
             }
         }
         else {
-            // use storageGlobalParams.lenForNewNsFiles, we are making a new database
-            massert(10343, "bad storageGlobalParams.lenForNewNsFiles",
-                    storageGlobalParams.lenForNewNsFiles >= 1024*1024);
+            if ( len == 0 )
+                return false;
+
+            massert(10343, "bad storageGlobalParams.lenForNewNsFiles", len >= 1024*1024);
             maybeMkdir();
-            unsigned long long l = storageGlobalParams.lenForNewNsFiles;
+            unsigned long long l = len;
             log() << "allocating new ns file " << pathString << ", filling with zeroes..." << endl;
 
             {
@@ -196,11 +258,10 @@ namespace mongo {
                 massert(18826, str::stream() << "failure writing file " << pathString, !file.bad() );
             }
 
-            if ( _f.create(pathString, l, true) ) {
+            if ( segment->f.create(pathString, l, true) ) {
                 getDur().createdFile(pathString, l); // always a new file
-                len = l;
-                verify(len == storageGlobalParams.lenForNewNsFiles);
-                p = _f.getView();
+                verify(l == len);
+                p = segment->f.getView();
 
                 if ( p ) {
                     // we do this so the durability system isn't mad at us for
@@ -219,7 +280,47 @@ namespace mongo {
 
 
         verify( len <= 0x7fffffff );
-        _ht.reset(new HashTable<Namespace,NamespaceDetails>(p, (int) len, "namespace index"));
+        segment->ht.reset(new Table(p, (int) len, "namespace index"));
+
+        for ( int i = 0; i < segment->ht->n; i++ ) {
+            Table::Node& node = segment->ht->nodes(i);
+            if ( !node.inUse() )
+                continue;
+            Entry e;
+            e.details = &node.value;
+            e.segment = n;
+            _entries[node.k.toString()] = e;
+            segment->used++;
+        }
+
+        _segments.push_back( segment.release() );
+        return true;
+    }
+
+    NOINLINE_DECL void NamespaceIndex::_init() {
+        verify( _segments.empty() );
+
+        Lock::assertWriteLocked(_database);
+
+        /* if someone manually deleted the datafiles for a database,
+           we need to be sure to clear any cached info for the database in
+           local.*.
+        */
+        /*
+        if ( "local" != _database ) {
+            DBInfo i(_database.c_str());
+            i.dbDropped();
+        }
+        */
+
+        Timer t;
+        _openSegment( 0, storageGlobalParams.lenForNewNsFiles );
+        for ( int n = 1; n < MaxSegments; n++ ) {
+            if ( !_openSegment( n, 0 ) )
+                break;
+        }
+        LOG(1) << "opened namespace index for " << _database << ": " << _entries.size()
+               << " namespaces in " << _segments.size() << " segments, " << t.millis() << "ms";
     }
 
 
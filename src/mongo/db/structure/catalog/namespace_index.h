@@ -33,9 +33,11 @@
 #include <list>
 #include <string>
 
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/db/diskloc.h"
 #include "mongo/db/structure/catalog/hashtab.h"
 #include "mongo/db/structure/catalog/namespace.h"
+#include "mongo/platform/unordered_map.h"
 
 namespace mongo {
 
@@ -43,17 +45,25 @@ namespace mongo {
 
     /* NamespaceIndex is the ".ns" file you see in the data directory.  It is the "system catalog"
        if you will: at least the core parts.  (Additional info in system.* collections.)
+
+       Once the .ns file is half full, new namespaces go to overflow segments <db>.ns.1,
+       <db>.ns.2, ..., each twice the size of the one before.  A segment never moves once
+       mapped, so NamespaceDetails pointers stay valid, and a namespace's $extra entries are
+       always kept in its own segment, as they are found by offset from it.  Lookups go through
+       an in memory map built when the database is opened, rather than probing the hashtables.
     */
     class NamespaceIndex {
     public:
         NamespaceIndex(const std::string &dir, const std::string &database) :
-            _ht( 0 ), _dir( dir ), _database( database ) {}
+            _dir( dir ), _database( database ) {}
+
+        ~NamespaceIndex();
 
         /* returns true if new db will be created if we init lazily */
         bool exists() const;
 
         void init() {
-            if ( !_ht.get() )
+            if ( _segments.empty() )
                 _init();
         }
 
@@ -66,20 +76,54 @@ namespace mongo {
 
         void kill_ns(const StringData& ns);
 
-        bool allocated() const { return _ht.get() != 0; }
+        bool allocated() const { return !_segments.empty(); }
 
         void getNamespaces( std::list<std::string>& tofill , bool onlyCollections = true ) const;
 
         boost::filesystem::path path() const;
 
-        unsigned long long fileLength() const { return _f.length(); }
+        /** path of overflow segment n, n > 0 */
+        boost::filesystem::path segmentPath( int n ) const;
+
+        /** total length of the .ns file and its overflow segments */
+        unsigned long long fileLength() const;
+
+        int numSegments() const { return _segments.size(); }
+
+        /** the most segments a database may have */
+        static const int MaxSegments = 64;
 
     private:
+        typedef HashTable<Namespace,NamespaceDetails> Table;
+
+        struct Segment {
+            Segment() : used( 0 ) {}
+            DurableMappedFile f;
+            auto_ptr<Table> ht;
+            int used; // nodes in use
+        };
+
+        struct Entry {
+            NamespaceDetails* details;
+            int segment;
+        };
+        typedef unordered_map<std::string, Entry> Entries;
+
         void _init();
         void maybeMkdir() const;
 
-        DurableMappedFile _f;
-        auto_ptr<HashTable<Namespace,NamespaceDetails> > _ht;
+        /** maps segment n, creating it with length len if it doesn't exist and len > 0
+            @return false if it doesn't exist and len is 0
+        */
+        bool _openSegment( int n, unsigned long long len );
+
+        void _kill( const Namespace& ns );
+
+        /** the segment a new namespace goes in, adding one if they are all too full */
+        int _segmentForNew( const Namespace& ns );
+
+        OwnedPointerVector<Segment> _segments;
+        Entries _entries;
         std::string _dir;
         std::string _database;
     };
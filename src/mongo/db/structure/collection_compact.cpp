@@ -30,6 +30,8 @@
 
 #include "mongo/db/catalog/collection.h"
 
+#include <algorithm>
+
 #include "mongo/base/counter.h"
 #include "mongo/base/owned_pointer_map.h"
 #include "mongo/db/catalog/index_create.h"
@@ -200,6 +202,145 @@ namespace mongo {
 
     }
 
+    namespace {
+
+        /** puts the space in an extent that isn't covered by one of its records back on the
+            deleted lists, as compactLastExtent took it all off
+        */
+        void giveBackExtentSpace( NamespaceDetails* d, ExtentManager* em,
+                                  const DiskLoc& extentLoc ) {
+            d->endEmptyingExtent();
+            Extent* e = extentLoc.ext();
+
+            vector< pair<int,int> > used;
+            for ( DiskLoc L = e->firstRecord; !L.isNull(); L = em->getNextRecordInExtent( L ) )
+                used.push_back( make_pair( L.getOfs(), L.rec()->lengthWithHeaders() ) );
+            std::sort( used.begin(), used.end() );
+            used.push_back( make_pair( extentLoc.getOfs() + e->length, 0 ) );
+
+            int ofs = extentLoc.getOfs() + Extent::HeaderSize();
+            for ( size_t i = 0; i < used.size(); i++ ) {
+                int gap = used[i].first - ofs;
+                if ( gap >= 24 ) {
+                    DiskLoc loc( extentLoc.a(), ofs );
+                    DeletedRecord* drec = getDur().writing( loc.drec() );
+                    drec->lengthWithHeaders() = gap;
+                    drec->extentOfs() = extentLoc.getOfs();
+                    drec->nextDeleted().Null();
+                    d->addDeletedRec( drec, loc );
+                }
+                ofs = used[i].first + used[i].second;
+            }
+        }
+
+    }
+
+    StatusWith<bool> Collection::compactLastExtent( int maxRecords, OnlineCompactStats* stats ) {
+
+        if ( isCapped() )
+            return StatusWith<bool>( ErrorCodes::BadValue, "cannot compact capped collection" );
+
+        if ( _indexCatalog.numIndexesInProgress() ) {
+            stopCompactingLastExtent( stats );
+            return StatusWith<bool>( ErrorCodes::BadValue,
+                                     "cannot compact when indexes in progress" );
+        }
+
+        NamespaceDetails* d = details();
+        DiskLoc extentLoc = d->lastExtent();
+        if ( extentLoc.isNull() || extentLoc == d->firstExtent() ) {
+            stopCompactingLastExtent( stats );
+            stats->stopReason = "only one extent left";
+            return StatusWith<bool>( false );
+        }
+
+        Extent* e = extentLoc.ext();
+        e->assertOk();
+
+        // the extent is set up once, and stays off the deleted lists across batches: the lists
+        // and the extent are only walked here, not for every batch
+        if ( stats->emptyingExtent != extentLoc || !d->isEmptyingExtent( extentLoc ) ) {
+            // the first batch, or an extent was appended since the last one: the extent we
+            // were on, if any, is usable again
+            stopCompactingLastExtent( stats );
+
+            // nothing may be allocated in the extent we are emptying
+            d->beginEmptyingExtent( extentLoc, e->length );
+            stats->emptyingExtent = extentLoc;
+
+            long long used = 0;
+            for ( DiskLoc L = e->firstRecord; !L.isNull(); L = getExtentManager()->getNextRecordInExtent( L ) )
+                used += L.rec()->lengthWithHeaders();
+            long long free;
+            if ( d->deletedListSize( &free ) && used > free ) {
+                stopCompactingLastExtent( stats );
+                stats->stopReason = "not enough free space in earlier extents";
+                return StatusWith<bool>( false );
+            }
+        }
+
+        _infoCache.notifyOfWriteOp();
+
+        int moved = 0;
+        DiskLoc L = e->firstRecord;
+        while ( !L.isNull() && moved < maxRecords ) {
+            DiskLoc next = getExtentManager()->getNextRecordInExtent( L );
+            BSONObj obj = BSONObj::make( L.rec() );
+
+            DiskLoc newLoc = _recordStore->relocateRecord( L );
+            if ( newLoc.isNull() ) {
+                stopCompactingLastExtent( stats );
+                stats->stopReason = "no free space large enough for a document";
+                return StatusWith<bool>( false );
+            }
+
+            // the document stays indexed at L unless all of its keys made it to newLoc
+            Status status = _indexCatalog.relocateIndexEntries( obj, L, newLoc );
+            if ( !status.isOK() ) {
+                _recordStore->deleteRecord( newLoc );
+                stopCompactingLastExtent( stats );
+                stats->stopReason = str::stream() << "could not index document at "
+                                                  << L.toString() << " in its new location: "
+                                                  << status.toString();
+                return StatusWith<bool>( false );
+            }
+
+            _cursorCache.invalidateDocument( L, INVALIDATION_DELETION );
+            _recordStore->dropRelocatedRecord( L );
+
+            moved++;
+            stats->recordsMoved++;
+            L = next;
+        }
+
+        // more to move next batch.  records deleted from the extent until then stay off the
+        // deleted lists too
+        if ( !e->firstRecord.isNull() )
+            return StatusWith<bool>( true );
+
+        d->endEmptyingExtent();
+        stats->emptyingExtent = DiskLoc();
+
+        DiskLoc newLast = e->xprev;
+        d->lastExtent().writing() = newLast;
+        newLast.ext()->xnext.writing().Null();
+        d->setLastExtentSize( newLast.ext()->length );
+        stats->extentsFreed++;
+        stats->bytesFreed += e->length;
+        getDur().writing(e)->markEmpty();
+        getExtentManager()->freeExtents( extentLoc, extentLoc );
+
+        return StatusWith<bool>( true );
+    }
+
+    void Collection::stopCompactingLastExtent( OnlineCompactStats* stats ) {
+        DiskLoc extentLoc = stats->emptyingExtent;
+        stats->emptyingExtent = DiskLoc();
+        if ( extentLoc.isNull() || !details()->isEmptyingExtent( extentLoc ) )
+            return;
+        giveBackExtentSpace( details(), getExtentManager(), extentLoc );
+    }
+
     BSONObj _compactAdjustIndexSpec( const BSONObj& oldSpec ) {
         BSONObjBuilder b;
         BSONObj::iterator i( oldSpec );
@@ -265,6 +406,7 @@ namespace mongo {
 
         log() << "compact orphan deleted lists" << endl;
         d->orphanDeletedList();
+        d->endEmptyingExtent();
 
         // Start over from scratch with our extent sizing and growth
         d->setLastExtentSize( 0 );
@@ -44,6 +44,24 @@ namespace mongo {
     RecordStore::~RecordStore() {
     }
 
+    Status RecordStore::insertRecords( const std::vector<BSONObj>& docs,
+                                       int quotaMax,
+                                       std::vector<DiskLoc>* locs ) {
+        size_t first = locs->size();
+        for ( size_t i = 0; i < docs.size(); i++ ) {
+            StatusWith<DiskLoc> loc = insertRecord( docs[i].objdata(), docs[i].objsize(), quotaMax );
+            if ( !loc.isOK() ) {
+                while ( locs->size() > first ) {
+                    deleteRecord( locs->back() );
+                    locs->pop_back();
+                }
+                return loc.getStatus();
+            }
+            locs->push_back( loc.getValue() );
+        }
+        return Status::OK();
+    }
+
     // -------------------------------
 
     RecordStoreV1Base::RecordStoreV1Base( const StringData& ns,
@@ -109,10 +127,126 @@ namespace mongo {
         return loc;
     }
 
+    Status RecordStoreV1Base::insertRecords( const std::vector<BSONObj>& docs,
+                                             int quotaMax,
+                                             std::vector<DiskLoc>* locs ) {
+        if ( docs.size() < 2 || _details->isCapped() )
+            return RecordStore::insertRecords( docs, quotaMax, locs );
+
+        // each record gets the padded size insertRecord() would have given it, aligned the
+        // way alloc() aligns, so the records can sit back to back
+        std::vector<int> lens( docs.size() );
+        long long total = 0;
+        for ( size_t i = 0; i < docs.size(); i++ ) {
+            int lenWHdr = _details->getRecordAllocationSize( docs[i].objsize() + Record::HeaderSize );
+            fassert( 28631, lenWHdr >= ( docs[i].objsize() + Record::HeaderSize ) );
+            lens[i] = ( lenWHdr + 3 ) & 0xfffffffc;
+            total += lens[i];
+        }
+        if ( total > BSONObjMaxInternalSize )
+            return RecordStore::insertRecords( docs, quotaMax, locs );
+
+        StatusWith<DiskLoc> region = allocRecord( total, quotaMax );
+        if ( !region.isOK() )
+            return region.getStatus();
+
+        DiskLoc regionLoc = region.getValue();
+        Record* first = recordFor( regionLoc );
+        int regionLen = first->lengthWithHeaders();
+        int extentOfs = first->extentOfs();
+        fassert( 28632, regionLen >= total );
+
+        // whatever alloc() handed back beyond the batch goes back on the free lists if it is
+        // big enough to be a record of its own, otherwise to the last record
+        int slack = regionLen - total;
+        if ( slack < 24 )
+            lens.back() += slack;
+
+        char* p = reinterpret_cast<char*>( getDur().writingPtr( first, total ) );
+        int ofs = 0;
+        for ( size_t i = 0; i < docs.size(); i++ ) {
+            DiskLoc loc = regionLoc;
+            loc.inc( ofs );
+
+            Record* r = reinterpret_cast<Record*>( p + ofs );
+            r->lengthWithHeaders() = lens[i];
+            r->extentOfs() = extentOfs;
+            memcpy( r->data(), docs[i].objdata(), docs[i].objsize() );
+
+            _addRecordToRecListInExtent( r, loc );
+            _details->incrementStats( r->netLength(), 1 );
+
+            locs->push_back( loc );
+            ofs += lens[i];
+        }
+
+        if ( slack >= 24 ) {
+            DiskLoc delLoc = regionLoc;
+            delLoc.inc( total );
+            DeletedRecord* d = getDur().writing( delLoc.drec() );
+            d->extentOfs() = extentOfs;
+            d->lengthWithHeaders() = slack;
+            d->nextDeleted().Null();
+            _details->addDeletedRec( delLoc.drec(), delLoc );
+        }
+
+        return Status::OK();
+    }
+
+    DiskLoc RecordStoreV1Base::relocateRecord( const DiskLoc& loc ) {
+        Record* old = recordFor( loc );
+        int lenWHdr = old->lengthWithHeaders();
+
+        DiskLoc newLoc = _details->alloc( NULL, _ns, lenWHdr );
+        if ( newLoc.isNull() )
+            return newLoc;
+
+        Record* r = recordFor( newLoc );
+        fassert( 28630, r->lengthWithHeaders() >= lenWHdr );
+
+        int size = little<int>::ref( old->data() );
+        r = reinterpret_cast<Record*>( getDur().writingPtr(r, Record::HeaderSize + size) );
+        memcpy( r->data(), old->data(), size );
+
+        _addRecordToRecListInExtent(r, newLoc);
+        _details->incrementStats( r->netLength(), 1 );
+
+        return newLoc;
+    }
+
+    void RecordStoreV1Base::dropRelocatedRecord( const DiskLoc& loc ) {
+        _unlinkRecord( recordFor( loc ), loc );
+    }
+
     void RecordStoreV1Base::deleteRecord( const DiskLoc& dl ) {
 
         Record* todelete = recordFor( dl );
+        _unlinkRecord( todelete, dl );
 
+        /* add to the free list */
+        {
+            if ( _isSystemIndexes ) {
+                /* temp: if in system.indexes, don't reuse, and zero out: we want to be
+                   careful until validated more, as IndexDetails has pointers
+                   to this disk location.  so an incorrectly done remove would cause
+                   a lot of problems.
+                */
+                memset( getDur().writingPtr(todelete, todelete->lengthWithHeaders() ),
+                        0, todelete->lengthWithHeaders() );
+            }
+            else {
+                DEV {
+                    //unsigned long long *p = reinterpret_cast<unsigned long long *>( todelete->data() );
+					little<unsigned long long> *p = &little<unsigned long long >::ref( todelete->data() );
+                    *getDur().writing(p) = 0;
+                }
+                _details->addDeletedRec((DeletedRecord*)todelete, dl);
+            }
+        }
+
+    }
+
+    void RecordStoreV1Base::_unlinkRecord( Record* todelete, const DiskLoc& dl ) {
         /* remove ourself from the record next/prev chain */
         {
             if ( todelete->prevOfs() != DiskLoc::NullOfs ) {
@@ -145,29 +279,7 @@ namespace mongo {
             }
         }
 
-        /* add to the free list */
-        {
-            _details->incrementStats( -1 * todelete->netLength(), -1 );
-
-            if ( _isSystemIndexes ) {
-                /* temp: if in system.indexes, don't reuse, and zero out: we want to be
-                   careful until validated more, as IndexDetails has pointers
-                   to this disk location.  so an incorrectly done remove would cause
-                   a lot of problems.
-                */
-                memset( getDur().writingPtr(todelete, todelete->lengthWithHeaders() ),
-                        0, todelete->lengthWithHeaders() );
-            }
-            else {
-                DEV {
-                    //unsigned long long *p = reinterpret_cast<unsigned long long *>( todelete->data() );
-					little<unsigned long long> *p = &little<unsigned long long >::ref( todelete->data() );
-                    *getDur().writing(p) = 0;
-                }
-                _details->addDeletedRec((DeletedRecord*)todelete, dl);
-            }
-        }
-
+        _details->incrementStats( -1 * todelete->netLength(), -1 );
     }
 
     void RecordStoreV1Base::_addRecordToRecListInExtent(Record *r, DiskLoc loc) {
@@ -30,11 +30,14 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/db/diskloc.h"
 
 namespace mongo {
 
+    class BSONObj;
     class Collection;
     class DocWriter;
     class ExtentManager;
@@ -56,6 +59,18 @@ namespace mongo {
 
         virtual StatusWith<DiskLoc> insertRecord( const DocWriter* doc, int quotaMax ) = 0;
 
+        /** inserts each of docs as its own record, appending the locations to locs in order.
+            either all of them are inserted or, on error, none are.
+            the default just calls insertRecord() for each.
+        */
+        virtual Status insertRecords( const std::vector<BSONObj>& docs,
+                                      int quotaMax,
+                                      std::vector<DiskLoc>* locs );
+
+        virtual DiskLoc relocateRecord( const DiskLoc& loc ) = 0;
+
+        virtual void dropRelocatedRecord( const DiskLoc& loc ) = 0;
+
     protected:
         std::string _ns;
     };
@@ -77,9 +92,31 @@ namespace mongo {
 
         StatusWith<DiskLoc> insertRecord( const DocWriter* doc, int quotaMax );
 
+        /** allocates one region large enough for all of docs, declares a single write intent
+            over it and carves it into consecutive records.  capped collections, and batches too
+            large for one allocation, go through insertRecord() one at a time.
+        */
+        Status insertRecords( const std::vector<BSONObj>& docs,
+                              int quotaMax,
+                              std::vector<DiskLoc>* locs );
+
+        /** copies the record at loc, padding included, into free space from the deleted lists.
+            the original stays in place until dropRelocatedRecord(); deleteRecord() on the copy
+            undoes the move.  never allocates a new extent.  the caller handles indexes and
+            cursors.
+            @return the new location, null if no deleted record is large enough
+        */
+        DiskLoc relocateRecord( const DiskLoc& loc );
+
+        /** drops the original of a relocated record without putting it on the deleted lists */
+        void dropRelocatedRecord( const DiskLoc& loc );
+
     protected:
         virtual StatusWith<DiskLoc> allocRecord( int lengthWithHeaders, int quotaMax ) = 0;
 
+        /** remove a record from its extent's record chain and from the collection's stats */
+        void _unlinkRecord( Record* r, const DiskLoc& loc );
+
         /** add a record to the end of the linked list chain within this extent.
             require: you must have already declared write intent for the record header.
         */
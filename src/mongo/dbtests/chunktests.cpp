@@ -42,7 +42,7 @@ namespace mongo {
             const_cast<ShardKeyPattern&>(_key) = ShardKeyPattern( keyPattern );
         }
         void setSingleChunkForShards( const vector<BSONObj> &splitPoints ) {
-            ChunkMap &chunkMap = const_cast<ChunkMap&>( _chunkMap );
+            ChunkMap chunkMap;
             ChunkRangeManager &chunkRanges = const_cast<ChunkRangeManager&>( _chunkRanges );
             set<Shard> &shards = const_cast<set<Shard>&>( _shards );
             
@@ -247,6 +247,37 @@ namespace ChunkTests {
             }
         };
 
+        class FindIntersectingChunk {
+        public:
+            void run() {
+                ChunkManager chunkManager;
+                chunkManager.setShardKey( BSON( "a" << 1 << "b" << 1 ) );
+                vector<BSONObj> splitPoints;
+                splitPoints.push_back( BSON( "a" << 5 << "b" << 10 ) );
+                splitPoints.push_back( BSON( "a" << 5 << "b" << 20 ) );
+                splitPoints.push_back( BSON( "a" << "x" << "b" << MINKEY ) );
+                chunkManager.setSingleChunkForShards( splitPoints );
+
+                assertShard( chunkManager, BSON( "a" << MINKEY << "b" << MINKEY ), "0" );
+                assertShard( chunkManager, BSON( "a" << 5 << "b" << 9 ), "0" );
+                assertShard( chunkManager, BSON( "a" << 5 << "b" << 10 ), "1" );
+                assertShard( chunkManager, BSON( "a" << 5 << "b" << 19.5 ), "1" );
+                assertShard( chunkManager, BSON( "a" << 5 << "b" << 20 ), "2" );
+                assertShard( chunkManager, BSON( "a" << 6 << "b" << MINKEY ), "2" );
+                assertShard( chunkManager, BSON( "a" << "w" << "b" << 1 ), "2" );
+                assertShard( chunkManager, BSON( "a" << "x" << "b" << MINKEY ), "3" );
+                assertShard( chunkManager, BSON( "a" << "x" << "b" << 1 ), "3" );
+                assertShard( chunkManager, BSON( "a" << MAXKEY << "b" << 1 ), "3" );
+            }
+        private:
+            void assertShard( const ChunkManager& chunkManager, const BSONObj& point,
+                              const string& shardName ) {
+                ChunkPtr chunk = chunkManager.findIntersectingChunk( point );
+                ASSERT( chunk->containsPoint( point ) );
+                ASSERT_EQUALS( shardName, chunk->getShard().getName() );
+            }
+        };
+
     } // namespace ChunkManagerTests
     
     class All : public Suite {
@@ -275,6 +306,7 @@ namespace ChunkTests {
             add<ChunkManagerTests::InequalityThenUnsatisfiable>();
             add<ChunkManagerTests::OrEqualityUnsatisfiableInequality>();
             add<ChunkManagerTests::InMultiShard>();
+            add<ChunkManagerTests::FindIntersectingChunk>();
         }
     } myall;
     
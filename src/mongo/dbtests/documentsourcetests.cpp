@@ -1898,6 +1898,50 @@ namespace DocumentSourceTests {
             }
         };
 
+        class ElemMatchBeforeUnwind {
+        public:
+            void test(string input, string unwindPath, string elemMatch) {
+                try {
+                    intrusive_ptr<DocumentSourceMatch> match = makeMatch(input);
+                    ASSERT_EQUALS(match->elemMatchBeforeUnwind(unwindPath), fromjson(elemMatch));
+                } catch(...) {
+                    unittest::log() << "Problem with elemMatchBeforeUnwind(" << unwindPath
+                                    << ") of: " << input;
+                    throw;
+                }
+            }
+
+            void run() {
+                test("{}", "a", "{}");
+
+                // Conditions on other fields or on the array itself aren't used
+                test("{b: 1}", "a", "{}");
+                test("{ab: 1}", "a", "{}");
+                test("{a: 1}", "a", "{}");
+
+                // Documents with nested arrays are always kept
+                test("{'a.b': 1}", "a",
+                     "{$or: [{a: {$elemMatch: {b: 1}}}, {a: {$elemMatch: {$type: 4}}}]}");
+
+                test("{'a.b': {$gt: 1, $lt: 5}, 'a.c.d': 'x', e: 1}", "a",
+                     "{$or: [{a: {$elemMatch: {b: {$gt: 1, $lt: 5}, 'c.d': 'x'}}},"
+                     "       {a: {$elemMatch: {$type: 4}}}]}");
+
+                test("{'a.b.c': {$in: [1, 2]}}", "a.b",
+                     "{$or: [{'a.b': {$elemMatch: {c: {$in: [1, 2]}}}},"
+                     "       {'a.b': {$elemMatch: {$type: 4}}}]}");
+
+                // Only the conditions that can't match a missing field are used
+                test("{'a.b': 1, 'a.c': {$ne: 1}, 'a.d': null}", "a",
+                     "{$or: [{a: {$elemMatch: {b: 1}}}, {a: {$elemMatch: {$type: 4}}}]}");
+
+                test("{'a.b': {$exists: false}}", "a", "{}");
+
+                // Numeric components would refer to a position in the array
+                test("{'a.0': 1, 'a.b.0': 1}", "a", "{}");
+            }
+        };
+
         class Coalesce {
         public:
             void run() {
@@ -2025,6 +2069,7 @@ namespace DocumentSourceTests {
             add<DocumentSourceGeoNear::LimitCoalesce>();
 
             add<DocumentSourceMatch::RedactSafePortion>();
+            add<DocumentSourceMatch::ElemMatchBeforeUnwind>();
             add<DocumentSourceMatch::Coalesce>();
         }
     } myall;
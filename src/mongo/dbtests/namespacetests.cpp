@@ -32,6 +32,8 @@
 // Where IndexDetails defined.
 #include "mongo/pch.h"
 
+#include <boost/filesystem/operations.hpp>
+
 #include "mongo/db/db.h"
 #include "mongo/db/index/btree_key_generator.h"
 #include "mongo/db/index/hash_key_generator.h"
@@ -41,6 +43,7 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/queryutil.h"
 #include "mongo/db/structure/catalog/namespace.h"
+#include "mongo/db/structure/catalog/namespace_index.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/dbtests/dbtests.h"
 
@@ -1750,6 +1753,108 @@ namespace NamespaceTests {
 
     } // namespace NamespaceDetailsTests
 
+    namespace NamespaceIndexTests {
+
+        /** creates, looks up and drops many times more namespaces than one small .ns file holds,
+            reopens the catalog, and logs the latency of each step */
+        class Scale {
+        public:
+            Scale() : _oldLen( storageGlobalParams.lenForNewNsFiles ) {
+                // a 1MB .ns file holds under 1700 namespaces
+                storageGlobalParams.lenForNewNsFiles = 1024 * 1024;
+                removeFiles();
+            }
+            ~Scale() {
+                storageGlobalParams.lenForNewNsFiles = _oldLen;
+                removeFiles();
+            }
+            void run() {
+                Lock::GlobalWrite lk;
+                const int n = 50000;
+
+                {
+                    NamespaceIndex nsi( storageGlobalParams.dbpath, dbName() );
+
+                    Timer t;
+                    for ( int i = 0; i < n; i++ ) {
+                        nsi.add_ns( ns( i ), DiskLoc(), false );
+                        getDur().commitIfNeeded();
+                    }
+                    report( "create", n, t.micros() );
+                    ASSERT( nsi.numSegments() > 1 );
+
+                    // an $extra entry goes with its collection, and is dropped with it
+                    string extra = Namespace( ns( n - 1 ) ).extraName( 0 );
+                    nsi.add_ns( extra, DiskLoc(), false );
+                    ASSERT( nsi.details( extra ) );
+                    nsi.kill_ns( ns( n - 1 ) );
+                    ASSERT( !nsi.details( extra ) );
+                    nsi.add_ns( ns( n - 1 ), DiskLoc(), false );
+
+                    t.reset();
+                    for ( int i = 0; i < n; i++ )
+                        ASSERT( nsi.details( ns( i ) ) );
+                    report( "lookup", n, t.micros() );
+
+                    t.reset();
+                    for ( int i = 0; i < n; i++ )
+                        ASSERT( !nsi.details( ns( i ) + "_missing" ) );
+                    report( "missing lookup", n, t.micros() );
+
+                    t.reset();
+                    for ( int i = 0; i < n; i += 2 ) {
+                        nsi.kill_ns( ns( i ) );
+                        getDur().commitIfNeeded();
+                    }
+                    report( "drop", n / 2, t.micros() );
+                    ASSERT( !nsi.details( ns( 0 ) ) );
+                    ASSERT( nsi.details( ns( 1 ) ) );
+
+                    getDur().commitNow();
+                }
+
+                Timer t;
+                NamespaceIndex nsi( storageGlobalParams.dbpath, dbName() );
+                nsi.init();
+                report( "open", 1, t.micros() );
+
+                list<string> all;
+                nsi.getNamespaces( all );
+                ASSERT_EQUALS( n / 2, (int)all.size() );
+                for ( int i = 0; i < n; i++ )
+                    ASSERT_EQUALS( i % 2 == 1, nsi.details( ns( i ) ) != 0 );
+
+                // dropped slots are reused before the catalog grows again
+                int segments = nsi.numSegments();
+                for ( int i = 0; i < n; i += 2 ) {
+                    nsi.add_ns( ns( i ), DiskLoc(), false );
+                    getDur().commitIfNeeded();
+                }
+                ASSERT_EQUALS( segments, nsi.numSegments() );
+
+                getDur().commitNow();
+            }
+        private:
+            static string dbName() { return "nsindextests"; }
+            static string ns( int i ) {
+                return str::stream() << dbName() << ".c" << i;
+            }
+            static void report( const char* what, int n, long long micros ) {
+                mongo::log() << "namespace index " << what << ": " << n << " in " << micros / 1000
+                      << "ms, " << micros / std::max( n, 1 ) << "us each" << endl;
+            }
+            void removeFiles() {
+                NamespaceIndex nsi( storageGlobalParams.dbpath, dbName() );
+                boost::filesystem::remove( nsi.path() );
+                for ( int i = 1; i < NamespaceIndex::MaxSegments; i++ )
+                    boost::filesystem::remove( nsi.segmentPath( i ) );
+            }
+
+            unsigned _oldLen;
+        };
+
+    } // namespace NamespaceIndexTests
+
     class All : public Suite {
     public:
         All() : Suite( "namespace" ) {
@@ -1820,6 +1925,7 @@ namespace NamespaceTests {
             add< NamespaceDetailsTests::SwapIndexEntriesTest >();
             //            add< NamespaceDetailsTests::BigCollection >();
             add< NamespaceDetailsTests::Size >();
+            add< NamespaceIndexTests::Scale >();
             add< MissingFieldTests::BtreeIndexMissingField >();
             add< MissingFieldTests::TwoDIndexMissingField >();
             add< MissingFieldTests::HashedIndexMissingField >();
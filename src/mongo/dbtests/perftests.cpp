@@ -40,7 +40,10 @@
 #include <boost/thread/thread.hpp>
 #include <fstream>
 
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/database.h"
 #include "mongo/db/db.h"
+#include "mongo/db/dur_recover.h"
 #include "mongo/db/dur_stats.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/json.h"
@@ -49,6 +52,9 @@
 #include "mongo/db/taskqueue.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/dbtests/framework_options.h"
+#include "mongo/s/chunk.h"
+#include "mongo/s/chunk_version.h"
+#include "mongo/s/type_chunk.h"
 #include "mongo/util/checksum.h"
 #include "mongo/util/compress.h"
 #include "mongo/util/concurrency/qlock.h"
@@ -500,6 +506,138 @@ namespace PerfTests {
         }
     };
 
+    /** Builds a ChunkMap of N chunks on {a: 1} spread over a few shards. */
+    template <int N>
+    class ChunkRoutingBase : public B {
+    protected:
+        virtual int howLongMillis() { return 3000; }
+        virtual bool showDurStats() { return false; }
+
+        void prep() {
+            const Shard shards[] = { Shard("s0", "localhost:30000"),
+                                     Shard("s1", "localhost:30001"),
+                                     Shard("s2", "localhost:30002"),
+                                     Shard("s3", "localhost:30003") };
+            BSONObj min = BSON("a" << MINKEY);
+            for (int i = 0; i < N; i++) {
+                BSONObj max = (i == N - 1) ? BSON("a" << MAXKEY) : BSON("a" << (i + 1) * 10);
+                ChunkPtr chunk(new Chunk(NULL, min, max, shards[i % 4]));
+                _chunkMap.insert(_chunkMap.end(), make_pair(max, chunk));
+                min = max;
+            }
+        }
+
+        BSONObj randomPoint() const { return BSON("a" << (rand() % N) * 10 + 5); }
+
+        ChunkMap _chunkMap;
+        ChunkRangeManager _table;
+    };
+
+    /** Routing a point with ChunkRangeManager, and with ChunkMap as a baseline. */
+    template <int N>
+    class ChunkRoutingLookup : public ChunkRoutingBase<N> {
+    public:
+        string name() { return str::stream() << "chunk-routing-lookup-" << N; }
+        string name2() { return str::stream() << "chunk-map-lookup-" << N; }
+
+        void prep() {
+            ChunkRoutingBase<N>::prep();
+            this->_table.reloadAll(this->_chunkMap);
+        }
+
+        void timed() {
+            verify(this->_table.upperBoundChunk(this->randomPoint()));
+        }
+
+        void timed2(DBClientBase&) {
+            verify(this->_chunkMap.upper_bound(this->randomPoint()) != this->_chunkMap.end());
+        }
+    };
+
+    /** Building the ChunkRangeManager after a ChunkManager reload. */
+    template <int N>
+    class ChunkRoutingReload : public ChunkRoutingBase<N> {
+    public:
+        string name() { return str::stream() << "chunk-routing-reload-" << N; }
+        virtual int howLongMillis() { return 0; }
+
+        void timed() {
+            this->_table.reloadAll(this->_chunkMap);
+            verify(this->_table.numChunks() == size_t(N));
+        }
+    };
+
+    /**
+     * Loading a ChunkManager of N chunks from config.chunks, end to end: the query, applying the
+     * diff, and building the ChunkMap and ChunkRangeManager.  Connections to the config server
+     * are redirected to this process.
+     */
+    template <int N>
+    class ChunkManagerLoad : public B, public ConnectionString::ConnectionHook {
+    public:
+        string name() { return str::stream() << "chunk-manager-load-" << N; }
+        virtual int howLongMillis() { return 0; }
+        virtual bool showDurStats() { return false; }
+
+        virtual DBClientBase* connect(const ConnectionString& connStr,
+                                      string& errmsg,
+                                      double socketTimeout) {
+            // Note - must be new, since it gets owned elsewhere
+            return new CustomDirectClient();
+        }
+
+    protected:
+        void prep() {
+            ConnectionString::setConnectionHook(this);
+
+            // the host doesn't matter, so long as it's prefixed with a "$"
+            _shard = Shard("shard0000", "$perfChunkLoad:27017");
+            _shard.setAddress(_shard.getAddress());
+
+            client().dropCollection(ChunkType::ConfigNS);
+            client().ensureIndex(ChunkType::ConfigNS,
+                                 BSON(ChunkType::ns() << 1 <<
+                                      ChunkType::DEPRECATED_lastmod() << 1));
+
+            ChunkVersion version(1, 0, OID::gen());
+            BSONObj min = BSON("a" << MINKEY);
+            for (int i = 0; i < N; i++) {
+                BSONObj max = (i == N - 1) ? BSON("a" << MAXKEY) : BSON("a" << (i + 1) * 10);
+
+                BSONObjBuilder b;
+                b << ChunkType::name(Chunk::genID(ns(), min)) << ChunkType::ns(ns())
+                  << ChunkType::min(min) << ChunkType::max(max)
+                  << ChunkType::shard(_shard.getName());
+                version.addToBSON(b, ChunkType::DEPRECATED_lastmod());
+                client().insert(ChunkType::ConfigNS, b.obj());
+
+                version.incMinor();
+                min = max;
+            }
+        }
+
+        void timed() {
+            ChunkManager manager(ns(), ShardKeyPattern(BSON("a" << 1)), false);
+            manager.loadExistingRanges(_shard.getConnString());
+            verify(manager.numChunks() == N);
+        }
+
+        void post() {
+            client().dropCollection(ChunkType::ConfigNS);
+            ConnectionString::setConnectionHook(NULL);
+        }
+
+    private:
+        class CustomDirectClient : public DBDirectClient {
+        public:
+            virtual ConnectionString::ConnectionType type() const {
+                return ConnectionString::CUSTOM;
+            }
+        };
+
+        Shard _shard;
+    };
+
     unsigned long long aaa;
 
     class Timer : public B {
@@ -1010,6 +1148,123 @@ namespace PerfTests {
         }
     };
 
+    /** replays a synthetic journal of a few GB of basic writes spread over several data files,
+        with the recovery workers and then with recovery on one thread
+    */
+    class JournalRecovery : public B {
+    public:
+        enum { NumDataFiles = 8, DataFileSize = 64 * 1024 * 1024, WriteSize = 8 * 1024,
+               WritesPerSection = 256, SectionsPerJournalFile = 128 };
+        string name() { return "journal-recovery"; }
+        string name2() { return "journal-recovery-1-thread"; }
+        virtual int howLongMillis() { return 0; }
+        virtual bool showDurStats() { return false; }
+        virtual unsigned batchSize() { return 1; }
+
+        ~JournalRecovery() {
+            boost::filesystem::remove_all(journalDir());
+            for( int i = 0; i < NumDataFiles; i++ )
+                boost::filesystem::remove(dataFile(i));
+        }
+
+        void prep() {
+            unsigned sections = 1024; // 2GB of writes
+            DEV sections = 32;
+
+            for( int i = 0; i < NumDataFiles; i++ ) {
+                std::ofstream f(dataFile(i).c_str(), ios_base::binary | ios_base::trunc);
+                f.seekp(DataFileSize - 1);
+                f.put(0);
+                ASSERT( f.good() );
+            }
+
+            boost::filesystem::path dir = journalDir();
+            boost::filesystem::remove_all(dir);
+            boost::filesystem::create_directory(dir);
+
+            _files.clear();
+            unsigned long long seq = 1;
+            for( unsigned s = 0; s < sections; s += SectionsPerJournalFile ) {
+                boost::filesystem::path fn = dir / string(str::stream() << "j._" << _files.size());
+                std::ofstream f(fn.string().c_str(), ios_base::binary | ios_base::trunc);
+                dur::JHeader h(fn.string());
+                f.write((const char *) &h, sizeof(h));
+                for( unsigned i = s; i < sections && i < s + SectionsPerJournalFile; i++ )
+                    writeSection(f, h.fileId, seq++);
+                ASSERT( f.good() );
+                _files.push_back(fn);
+            }
+        }
+
+        void timed() {
+            dur::RecoveryJob job;
+            job.applyJournalFiles(_files, 4);
+        }
+
+        void timed2(DBClientBase&) {
+            dur::RecoveryJob job;
+            job.applyJournalFiles(_files, 1);
+        }
+
+        void post() {
+            // the last write in the journal is in the data file
+            std::ifstream f(dataFile(_lastFileNo).c_str(), ios_base::binary);
+            f.seekg(_lastOfs);
+            char buf[WriteSize];
+            f.read(buf, WriteSize);
+            ASSERT( f.good() );
+            ASSERT( memcmp(buf, _lastData, WriteSize) == 0 );
+        }
+
+    private:
+        static string dataFile(int fileNo) {
+            return (boost::filesystem::path(storageGlobalParams.dbpath) /
+                    string(str::stream() << "recoverperf." << fileNo)).string();
+        }
+
+        static boost::filesystem::path journalDir() {
+            return boost::filesystem::path(storageGlobalParams.dbpath) / "recoverperf_journal";
+        }
+
+        /** a group commit of basic writes to random places in the data files */
+        void writeSection(std::ofstream& f, unsigned long long fileId, unsigned long long seq) {
+            BufBuilder uncompressed;
+            dur::JDbContext c;
+            uncompressed.appendStruct(c);
+            uncompressed.appendStr("recoverperf");
+            for( int i = 0; i < WritesPerSection; i++ ) {
+                dur::JEntry e;
+                e.len = WriteSize;
+                e.ofs = (rand() % (DataFileSize / WriteSize)) * WriteSize;
+                e.setFileNo(rand() % NumDataFiles);
+                uncompressed.appendStruct(e);
+                char *data = uncompressed.skip(WriteSize);
+                for( int j = 0; j < WriteSize; j++ )
+                    data[j] = (char) (seq + i + j / 64);
+                _lastFileNo = e.getFileNo();
+                _lastOfs = e.ofs;
+                memcpy(_lastData, data, WriteSize);
+            }
+
+            dur::JSectHeader h;
+            h.seqNumber = seq;
+            h.fileId = fileId;
+            string compressed;
+            compress(uncompressed.buf(), uncompressed.len(), &compressed);
+            string sect = string((const char *) &h, sizeof(h)) + compressed;
+            ((dur::JSectHeader *) &sect[0])->setSectionLen(sect.size() + sizeof(dur::JSectFooter));
+            dur::JSectFooter footer(sect.data(), sect.size());
+            sect.append((const char *) &footer, sizeof(footer));
+            sect.resize(((dur::JSectHeader *) sect.data())->sectionLenWithPadding(), 0);
+            f.write(sect.data(), sect.size());
+        }
+
+        vector<boost::filesystem::path> _files;
+        int _lastFileNo;
+        unsigned _lastOfs;
+        char _lastData[WriteSize];
+    };
+
     class InsertDup : public B {
         const BSONObj o;
     public:
@@ -1107,6 +1362,45 @@ namespace PerfTests {
         }
     };
 
+    /** inserts 64 documents per timed() straight into the collection, one at a time or as one
+        group through Collection::insertDocuments(), for the insert throughput of each
+    */
+    template <bool Grouped>
+    class InsertGroup : public B {
+    public:
+        enum { GroupSize = 64 };
+        virtual int howLongMillis() { return profiling ? 30000 : 5000; }
+        virtual unsigned batchSize() { return 4; }
+        string name() { return Grouped ? "insert-64-grouped" : "insert-64-singly"; }
+        void prep() {
+            client().insert( ns(), BSONObj() );
+            client().ensureIndex(ns(), BSON("x"<<1));
+            _id = 0;
+        }
+        void timed() {
+            vector<BSONObj> docs;
+            for( int i = 0; i < GroupSize; i++ )
+                docs.push_back( BSON("_id" << _id++ << "x" << rand() << "y" << rand() << "z" << 33) );
+
+            Client::WriteContext ctx(ns());
+            Collection* coll = ctx.ctx().db()->getCollection(ns());
+            if( Grouped ) {
+                vector<DiskLoc> locs;
+                verify( coll->insertDocuments( docs, false, NULL, &locs ).isOK() );
+            }
+            else {
+                for( int i = 0; i < GroupSize; i++ )
+                    verify( coll->insertDocument( docs[i], false ).isOK() );
+            }
+            getDur().commitIfNeeded();
+        }
+        void post() {
+            verify( client().count(ns()) == (unsigned long long) _id + 1 );
+        }
+    private:
+        long long _id;
+    };
+
     /** upserts about 32k records and then keeps updating them
         2 indexes
     */
@@ -1140,6 +1434,38 @@ namespace PerfTests {
         }
     };
 
+    /** splitVector over 200k keys, estimated from the upper levels of the index and walked. */
+    class SplitVector : public B {
+    public:
+        virtual string name() { return "splitvector-sampled"; }
+        virtual string name2() { return "splitvector-exact"; }
+        virtual int howLongMillis() { return 3000; }
+        virtual bool showDurStats() { return false; }
+        void prep() {
+            client().ensureIndex(ns(), BSON("x"<<1));
+            for (int i = 0; i < 200000; i++) {
+                client().insert(ns(), BSON("x" << i << "y" << "abcdefghijklmnopqrstuvwxyz"));
+            }
+        }
+        void timed() {
+            splitVector(client(), true);
+        }
+        virtual void timed2(DBClientBase& c) {
+            splitVector(c, false);
+        }
+    private:
+        void splitVector(DBClientBase& c, bool sampled) {
+            BSONObj res;
+            verify(c.runCommand("admin",
+                                BSON("splitVector" << ns() <<
+                                     "keyPattern" << BSON("x"<<1) <<
+                                     "maxChunkSize" << 1 <<
+                                     "sampled" << sampled),
+                                res));
+            verify(res["sampled"].trueValue() == sampled);
+        }
+    };
+
     template <typename T>
     class MoreIndexes : public T {
     public:
@@ -1370,6 +1696,7 @@ namespace PerfTests {
                 add< Dummy >();
                 add< ChecksumTest >();
                 add< Compress >();
+                add< JournalRecovery >();
                 add< TLS >();
 #if defined(_WIN32)
                 add< TLS2 >();
@@ -1421,6 +1748,14 @@ namespace PerfTests {
                 add< CTM >();
                 add< CTMicros >();
                 add< KeyTest >();
+                add< ChunkRoutingLookup<10000> >();
+                add< ChunkRoutingLookup<100000> >();
+                add< ChunkRoutingLookup<1000000> >();
+                add< ChunkRoutingReload<10000> >();
+                add< ChunkRoutingReload<100000> >();
+                add< ChunkRoutingReload<1000000> >();
+                add< ChunkManagerLoad<10000> >();
+                add< ChunkManagerLoad<100000> >();
                 add< Bldr >();
                 add< StkBldr >();
                 add< BSONIter >();
@@ -1431,8 +1766,13 @@ namespace PerfTests {
                 add< Insert1 >();
                 add< InsertRandom >();
                 add< MoreIndexes<InsertRandom> >();
+                add< InsertGroup<false> >();
+                add< InsertGroup<true> >();
+                add< MoreIndexes< InsertGroup<false> > >();
+                add< MoreIndexes< InsertGroup<true> > >();
                 add< Update1 >();
                 add< MoreIndexes<Update1> >();
+                add< SplitVector >();
                 add< InsertBig >();
                 add< FailPointTest<false, false> >();
                 add< FailPointTest<true, false> >();
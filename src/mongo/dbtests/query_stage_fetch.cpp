@@ -424,6 +424,97 @@ namespace QueryStageFetch {
         }
     };
 
+    //
+    // Test that the results read ahead of a fetch come back in order, and survive invalidation.
+    //
+    class FetchStageReadAhead : public QueryStageFetchBase {
+    public:
+        void run() {
+            Client::WriteContext ctx(ns());
+            Database* db = ctx.ctx().db();
+            Collection* coll = db->getCollection(ns());
+            if (!coll) {
+                coll = db->createCollection(ns());
+            }
+            WorkingSet ws;
+
+            // Add some objects to the DB.
+            for (int i = 0; i < 3; ++i) {
+                insert(BSON("foo" << i));
+            }
+            vector<DiskLoc> locs;
+            {
+                set<DiskLoc> locSet;
+                getLocs(&locSet, coll);
+                ASSERT_EQUALS(size_t(3), locSet.size());
+                locs.assign(locSet.begin(), locSet.end());
+            }
+            vector<int> foos;
+            for (size_t i = 0; i < locs.size(); ++i) {
+                foos.push_back(locs[i].obj()["foo"].numberInt());
+            }
+
+            // Create a mock stage that returns a WSM for each.
+            auto_ptr<MockStage> mockStage(new MockStage(&ws));
+            for (size_t i = 0; i < locs.size(); ++i) {
+                WorkingSetMember mockMember;
+                mockMember.state = WorkingSetMember::LOC_AND_IDX;
+                mockMember.loc = locs[i];
+                mockStage->pushBack(mockMember);
+            }
+
+            auto_ptr<FetchStage> fetchStage(new FetchStage(&ws, mockStage.release(), NULL));
+
+            // Set the fail point to return not in memory.
+            FailPointRegistry* reg = getGlobalFailPointRegistry();
+            FailPoint* fetchInMemoryFail = reg->getFailPoint("fetchInMemoryFail");
+            fetchInMemoryFail->setMode(FailPoint::alwaysOn);
+
+            // The fetch request for the first record reads the other two ahead.
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            PlanStage::StageState state;
+            state = fetchStage->work(&id);
+            ASSERT_EQUALS(PlanStage::NEED_FETCH, state);
+            ASSERT_EQUALS(locs[0], ws.get(id)->loc);
+            {
+                scoped_ptr<PlanStageStats> stats(fetchStage->getStats());
+                FetchStats* specific = static_cast<FetchStats*>(stats->specific.get());
+                ASSERT_EQUALS(size_t(2), specific->readAheads);
+            }
+            {
+                LockMongoFilesShared lk;
+                Record::issuePrefetches();
+            }
+
+            // Deleting a record we read ahead forces its fetch.
+            fetchStage->invalidate(locs[1], INVALIDATION_DELETION);
+
+            BSONElement elt;
+            state = fetchStage->work(&id);
+            ASSERT_EQUALS(PlanStage::ADVANCED, state);
+            ASSERT_TRUE(ws.get(id)->getFieldDotted("foo", &elt));
+            ASSERT_EQUALS(foos[0], elt.numberInt());
+
+            state = fetchStage->work(&id);
+            ASSERT_EQUALS(PlanStage::ADVANCED, state);
+            ASSERT_EQUALS(WorkingSetMember::OWNED_OBJ, ws.get(id)->state);
+            ASSERT_TRUE(ws.get(id)->getFieldDotted("foo", &elt));
+            ASSERT_EQUALS(foos[1], elt.numberInt());
+
+            state = fetchStage->work(&id);
+            ASSERT_EQUALS(PlanStage::NEED_FETCH, state);
+            ASSERT_EQUALS(locs[2], ws.get(id)->loc);
+            state = fetchStage->work(&id);
+            ASSERT_EQUALS(PlanStage::ADVANCED, state);
+            ASSERT_TRUE(ws.get(id)->getFieldDotted("foo", &elt));
+            ASSERT_EQUALS(foos[2], elt.numberInt());
+
+            ASSERT_TRUE(fetchStage->isEOF());
+
+            fetchInMemoryFail->setMode(FailPoint::off);
+        }
+    };
+
     class All : public Suite {
     public:
         All() : Suite( "query_stage_fetch" ) { }
@@ -434,6 +525,7 @@ namespace QueryStageFetch {
             add<FetchStageAlreadyFetched>();
             add<FetchStageInvalidation>();
             add<FetchStageFilter>();
+            add<FetchStageReadAhead>();
         }
     }  queryStageFetchAll;
 
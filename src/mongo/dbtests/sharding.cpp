@@ -260,7 +260,7 @@ namespace ShardingTests {
 
             ASSERT( manager->getVersion().epoch() == version.epoch() );
             ASSERT( manager->getVersion().minorVersion() == ( numChunks - 1 ) );
-            ASSERT( static_cast<int>( manager->getChunkMap().size() ) == numChunks );
+            ASSERT( static_cast<int>( manager->numChunks() ) == numChunks );
 
             // Modify chunks collection
             BSONObjBuilder b;
@@ -275,7 +275,7 @@ namespace ShardingTests {
 
             ASSERT( newManager.getVersion().toLong() == laterVersion.toLong() );
             ASSERT( newManager.getVersion().epoch() == laterVersion.epoch() );
-            ASSERT( static_cast<int>( newManager.getChunkMap().size() ) == numChunks );
+            ASSERT( static_cast<int>( newManager.numChunks() ) == numChunks );
         }
 
     };
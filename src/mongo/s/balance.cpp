@@ -30,9 +30,13 @@
 
 #include "mongo/s/balance.h"
 
+#include <boost/thread/thread.hpp>
+
 #include "mongo/base/owned_pointer_map.h"
 #include "mongo/client/dbclientcursor.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/s/chunk.h"
 #include "mongo/s/cluster_write.h"
@@ -55,9 +59,20 @@ namespace mongo {
 
     MONGO_FP_DECLARE(skipBalanceRound);
 
+    // The most migrations the balancer runs at the same time. Each shard still only takes part in
+    // one migration at a time, and a collection can have one migration per disjoint pair of
+    // shards in flight.
+    MONGO_EXPORT_SERVER_PARAMETER(balancerMaxConcurrentMigrations, int, 8);
+
     Balancer balancer;
 
-    Balancer::Balancer() : _balancedLastTime(0), _policy( new BalancerPolicy() ) {}
+    Balancer::Balancer()
+        : _balancedLastTime(0),
+          _policy( new BalancerPolicy() ),
+          _migrationsMutex( "Balancer::_migrationsMutex" ),
+          _numMigrationsSucceeded(0),
+          _numMigrationsFailed(0) {
+    }
 
     Balancer::~Balancer() {
     }
@@ -66,11 +81,105 @@ namespace mongo {
                               bool secondaryThrottle,
                               bool waitForDelete)
     {
-        int movedCount = 0;
+        AtomicUInt movedCount;
+
+        const size_t maxConcurrent = std::max(1, balancerMaxConcurrentMigrations);
+        vector<CandidateChunkPtr> pending( candidateChunks->begin(), candidateChunks->end() );
+
+        while ( ! pending.empty() ) {
+            // A shard can only be the donor or the recipient of one migration at a time, so only
+            // migrations between disjoint pairs of shards go in the same batch. The rest wait for
+            // a later batch, in their original order.
+            set<string> busyShards;
+            vector<CandidateChunkPtr> batch;
+            vector<CandidateChunkPtr> deferred;
+            for ( vector<CandidateChunkPtr>::const_iterator it = pending.begin(); it != pending.end(); ++it ) {
+                const CandidateChunk& chunkInfo = *it->get();
+                if ( batch.size() < maxConcurrent &&
+                     ! busyShards.count( chunkInfo.from ) &&
+                     ! busyShards.count( chunkInfo.to ) ) {
+                    busyShards.insert( chunkInfo.from );
+                    busyShards.insert( chunkInfo.to );
+                    batch.push_back( *it );
+                }
+                else {
+                    deferred.push_back( *it );
+                }
+            }
+
+            if ( batch.size() == 1 ) {
+                _moveChunk( batch.front(), secondaryThrottle, waitForDelete, &movedCount );
+            }
+            else {
+                LOG(1) << "starting " << batch.size() << " concurrent migrations" << endl;
+
+                boost::thread_group threads;
+                for ( vector<CandidateChunkPtr>::const_iterator it = batch.begin(); it != batch.end(); ++it ) {
+                    threads.create_thread( boost::bind( &Balancer::_moveChunk, this, *it,
+                                                        secondaryThrottle, waitForDelete,
+                                                        &movedCount ) );
+                }
+                threads.join_all();
+            }
+
+            pending.swap( deferred );
+        }
+
+        return movedCount.get();
+    }
+
+    void Balancer::_moveChunk(CandidateChunkPtr chunkInfo,
+                              bool secondaryThrottle,
+                              bool waitForDelete,
+                              AtomicUInt* moved)
+    {
+        {
+            scoped_lock lk( _migrationsMutex );
+            _activeMigrations[chunkInfo] = jsTime();
+        }
+
+        Timer t;
+        bool ok = false;
+        try {
+            ok = _doMoveChunk( *chunkInfo, secondaryThrottle, waitForDelete );
+        }
+        catch ( const std::exception& ex ) {
+            // This may be running on its own thread, so nothing can be allowed to escape.
+            warning() << "could not move chunk " << chunkInfo->chunk.toString()
+                      << ", continuing balancing round" << causedBy( ex ) << endl;
+        }
+
+        if ( ok )
+            moved->signedAdd( 1 );
 
-        for ( vector<CandidateChunkPtr>::const_iterator it = candidateChunks->begin(); it != candidateChunks->end(); ++it ) {
-            const CandidateChunk& chunkInfo = *it->get();
+        {
+            scoped_lock lk( _migrationsMutex );
+            _activeMigrations.erase( chunkInfo );
+            if ( ok )
+                _numMigrationsSucceeded++;
+            else
+                _numMigrationsFailed++;
+        }
+
+        try {
+            configServer.logChange( "balancer.moveChunk" , chunkInfo->ns ,
+                                    BSON( "from" << chunkInfo->from <<
+                                          "to" << chunkInfo->to <<
+                                          "min" << chunkInfo->chunk.min <<
+                                          "max" << chunkInfo->chunk.max <<
+                                          "ok" << ok <<
+                                          "millis" << t.millis() ) );
+        }
+        catch ( const std::exception& ex ) {
+            warning() << "could not log balancer migration to changelog" << causedBy( ex ) << endl;
+        }
+    }
 
+    bool Balancer::_doMoveChunk(const CandidateChunk& chunkInfo,
+                                bool secondaryThrottle,
+                                bool waitForDelete)
+    {
+        {
             // Changes to metadata, borked metadata, and connectivity problems should cause us to
             // abort this chunk move, but shouldn't cause us to abort the entire round of chunks.
             // TODO: Handle all these things more cleanly, since they're expected problems
@@ -93,7 +202,7 @@ namespace mongo {
                     c = cm->findIntersectingChunk( chunkInfo.chunk.min );
                     if ( c->getMin().woCompare( chunkInfo.chunk.min ) || c->getMax().woCompare( chunkInfo.chunk.max ) ) {
                         log() << "chunk mismatch after reload, ignoring will retry issue " << chunkInfo.chunk.toString() << endl;
-                        continue;
+                        return false;
                     }
                 }
 
@@ -104,8 +213,7 @@ namespace mongo {
                                      waitForDelete,
                                      0, /* maxTimeMS */
                                      res)) {
-                    movedCount++;
-                    continue;
+                    return true;
                 }
 
                 // the move requires acquiring the collection metadata's lock, which can fail
@@ -127,8 +235,8 @@ namespace mongo {
                     if ( ! res["ok"].trueValue() ) {
                         log() << "marking chunk as jumbo: " << c->toString() << endl;
                         c->markAsJumbo();
-                        // we increment moveCount so we do another round right away
-                        movedCount++;
+                        // we count this as moved so we do another round right away
+                        return true;
                     }
 
                 }
@@ -139,9 +247,43 @@ namespace mongo {
             }
         }
 
-        return movedCount;
+        return false;
     }
 
+    void Balancer::appendMigrationStats( BSONObjBuilder& b ) const {
+        scoped_lock lk( _migrationsMutex );
+
+        const Date_t now = jsTime();
+        BSONArrayBuilder active( b.subarrayStart( "activeMigrations" ) );
+        for ( map<CandidateChunkPtr, Date_t>::const_iterator it = _activeMigrations.begin();
+              it != _activeMigrations.end();
+              ++it ) {
+            const CandidateChunk& chunkInfo = *it->first;
+            active.append( BSON( "ns" << chunkInfo.ns <<
+                                 "from" << chunkInfo.from <<
+                                 "to" << chunkInfo.to <<
+                                 "min" << chunkInfo.chunk.min <<
+                                 "max" << chunkInfo.chunk.max <<
+                                 "millis" << static_cast<long long>( now - it->second ) ) );
+        }
+        active.done();
+
+        b.append( "migrationsSucceeded" , _numMigrationsSucceeded );
+        b.append( "migrationsFailed" , _numMigrationsFailed );
+    }
+
+    class BalancerServerStatusSection : public ServerStatusSection {
+    public:
+        BalancerServerStatusSection() : ServerStatusSection( "balancer" ) {}
+        virtual bool includeByDefault() const { return true; }
+
+        BSONObj generateSection( const BSONElement& configElement ) const {
+            BSONObjBuilder b;
+            balancer.appendMigrationStats( b );
+            return b.obj();
+        }
+    } balancerServerStatusSection;
+
     void Balancer::_ping( bool waiting ) {
         clusterUpdate( MongosType::ConfigNS,
                        BSON( MongosType::name( _myid )),
@@ -397,8 +539,25 @@ namespace mongo {
                 continue;
             }
 
-            CandidateChunk* p = _policy->balance( ns, status, _balancedLastTime );
-            if ( p ) candidateChunks->push_back( CandidateChunkPtr( p ) );
+            // Ask the policy for one migration at a time, each time leaving out the shards that
+            // already take part in one, so the collection gets a migration for every disjoint
+            // pair of shards that needs one.
+            ShardInfoMap availableShards( shardInfo );
+            const size_t maxCandidates = std::max(1, balancerMaxConcurrentMigrations);
+            for ( size_t numCandidates = 0; numCandidates < maxCandidates; numCandidates++ ) {
+                DistributionStatus available( availableShards, shardToChunksMap.map() );
+                for ( vector<TagRange>::const_iterator r = ranges.begin(); r != ranges.end(); ++r ) {
+                    available.addTagRange( *r );
+                }
+
+                CandidateChunk* p = _policy->balance( ns, available, _balancedLastTime );
+                if ( !p )
+                    break;
+
+                availableShards.erase( p->from );
+                availableShards.erase( p->to );
+                candidateChunks->push_back( CandidateChunkPtr( p ) );
+            }
         }
     }
 
@@ -45,7 +45,8 @@ namespace mongo {
      *
      * The balancer does act continuously but in "rounds". At a given round, it would decide if there is an imbalance by
      * checking the difference in chunks between the most and least loaded shards. It would issue a request for a chunk
-     * migration per round, if it found so.
+     * migration per collection and disjoint pair of shards per round, if it found so. Migrations that don't share a
+     * shard are run concurrently.
      */
     class Balancer : public BackgroundJob {
     public:
@@ -58,6 +59,12 @@ namespace mongo {
 
         virtual string name() const { return "Balancer"; }
 
+        /**
+         * Appends the migrations this balancer currently has in flight, and how many it has
+         * issued so far, for serverStatus.
+         */
+        void appendMigrationStats( BSONObjBuilder& b ) const;
+
     private:
         typedef MigrateInfo CandidateChunk;
         typedef shared_ptr<CandidateChunk> CandidateChunkPtr;
@@ -88,12 +95,13 @@ namespace mongo {
          * be moved.
          *
          * @param conn is the connection with the config server(s)
-         * @param candidateChunks (IN/OUT) filled with candidate chunks, one per collection, that could possibly be moved
+         * @param candidateChunks (IN/OUT) filled with candidate chunks, at most one per collection and shard, that could possibly be moved
          */
         void _doBalanceRound( DBClientBase& conn, vector<CandidateChunkPtr>* candidateChunks );
 
         /**
-         * Issues chunk migration request, one at a time.
+         * Issues chunk migration requests, in batches in which no shard is the donor or the
+         * recipient of more than one migration. The migrations in a batch run concurrently.
          *
          * @param candidateChunks possible chunks to move
          * @param secondaryThrottle wait for secondaries to catch up before pushing more deletes
@@ -104,6 +112,24 @@ namespace mongo {
                         bool secondaryThrottle,
                         bool waitForDelete);
 
+        /**
+         * Issues a single chunk migration request and records its outcome.
+         *
+         * @param moved (OUT) incremented if the chunk was moved, or was marked as jumbo
+         */
+        void _moveChunk(CandidateChunkPtr chunkInfo,
+                        bool secondaryThrottle,
+                        bool waitForDelete,
+                        AtomicUInt* moved);
+
+        /**
+         * @return true if the chunk was moved, or if it was too big to move and was marked as
+         *      jumbo
+         */
+        bool _doMoveChunk(const CandidateChunk& chunkInfo,
+                          bool secondaryThrottle,
+                          bool waitForDelete);
+
         /**
          * Marks this balancer as being live on the config server(s).
          */
@@ -114,6 +140,14 @@ namespace mongo {
          */
         bool _checkOIDs();
 
+        // Protects the migration bookkeeping below, which is read by serverStatus.
+        mutable mongo::mutex _migrationsMutex;
+
+        // migrations in flight, with when they were started
+        map<CandidateChunkPtr, Date_t> _activeMigrations;
+
+        long long _numMigrationsSucceeded;
+        long long _numMigrationsFailed;
     };
 
     extern Balancer balancer;
@@ -272,9 +272,9 @@ namespace mongo {
             }
         }
 
-        const ChunkMap& chunkMap = chunkMgr.getChunkMap();
-        for (ChunkMap::const_iterator it = chunkMap.begin(); it != chunkMap.end(); ++it) {
-            const ChunkPtr chunkPtr = it->second;
+        const vector<ChunkPtr>& chunks = chunkMgr.getChunks();
+        for (vector<ChunkPtr>::const_iterator it = chunks.begin(); it != chunks.end(); ++it) {
+            const ChunkPtr chunkPtr = *it;
 
             auto_ptr<ChunkType> chunk(new ChunkType());
             chunk->setNS(chunkPtr->getns());
@@ -33,6 +33,7 @@
 #include "mongo/s/chunk.h"
 
 #include "mongo/base/owned_pointer_map.h"
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/client/connpool.h"
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/db/query/lite_parsed_query.h"
@@ -260,7 +261,8 @@ namespace mongo {
         conn.done();
     }
 
-    void Chunk::pickSplitVector( vector<BSONObj>& splitPoints , int chunkSize /* bytes */, int maxPoints, int maxObjs ) const {
+    void Chunk::pickSplitVector( vector<BSONObj>& splitPoints , int chunkSize /* bytes */, int maxPoints, int maxObjs,
+                                 bool sampled ) const {
         // Ask the mongod holding this chunk to figure out the split points.
         ScopedDbConnection conn(getShard().getConnString());
         BSONObj result;
@@ -272,6 +274,8 @@ namespace mongo {
         cmd.append( "maxChunkSizeBytes" , chunkSize );
         cmd.append( "maxSplitPoints" , maxPoints );
         cmd.append( "maxChunkObjects" , maxObjs );
+        if ( sampled )
+            cmd.appendBool( "sampled" , true );
         BSONObj cmdObj = cmd.obj();
 
         if ( ! conn->runCommand( "admin" , cmdObj , result )) {
@@ -297,7 +301,9 @@ namespace mongo {
         if ( ! force ) {
             vector<BSONObj> candidates;
             const int maxPoints = 2;
-            pickSplitVector( candidates , getManager()->getCurrentDesiredChunkSize() , maxPoints , MaxObjectPerChunk );
+            // an estimated split point is good enough for auto-splitting
+            pickSplitVector( candidates , getManager()->getCurrentDesiredChunkSize() , maxPoints , MaxObjectPerChunk ,
+                             true /* sampled */ );
             if ( candidates.size() <= 1 ) {
                 // no split points means there isn't enough data to split on
                 // 1 split point means we have between half the chunk size to full chunk size
@@ -748,10 +754,9 @@ namespace mongo {
                     // These variables are const for thread-safety. Since the
                     // constructor can only be called from one thread, we don't have
                     // to worry about that here.
-                    const_cast<ChunkMap&>(_chunkMap).swap(chunkMap);
                     const_cast<set<Shard>&>(_shards).swap(shards);
                     const_cast<ShardVersionMap&>(_shardVersions).swap(shardVersions);
-                    const_cast<ChunkRangeManager&>(_chunkRanges).reloadAll(_chunkMap);
+                    const_cast<ChunkRangeManager&>(_chunkRanges).reloadAll(chunkMap);
 
                     // Once we load data, clear reference to old manager
                     _oldManager.reset();
@@ -760,7 +765,7 @@ namespace mongo {
                 }
             }
 
-            if (_chunkMap.size() < 10) {
+            if (numChunks() < 10) {
                 _printChunks();
             }
             
@@ -833,15 +838,17 @@ namespace mongo {
             // Load a copy of the old versions
             shardVersions = oldManager->_shardVersions;
 
-            // Load a copy of the chunk map, replacing the chunk manager with our own
-            const ChunkMap& oldChunkMap = oldManager->getChunkMap();
+            // Load a copy of the chunks, replacing the chunk manager with our own
+            const vector<ChunkPtr>& oldChunks = oldManager->getChunks();
 
             // Could be v.expensive
             // TODO: If chunks were immutable and didn't reference the manager, we could do more
             // interesting things here
-            for( ChunkMap::const_iterator it = oldChunkMap.begin(); it != oldChunkMap.end(); it++ ){
+            // The old chunks are already in order, so hinting each insert at the end makes
+            // filling the new map linear instead of a full descent per chunk.
+            for( vector<ChunkPtr>::const_iterator it = oldChunks.begin(); it != oldChunks.end(); it++ ){
 
-                ChunkPtr oldC = it->second;
+                ChunkPtr oldC = *it;
                 ChunkPtr c( new Chunk( this, oldC->getMin(),
                                              oldC->getMax(),
                                              oldC->getShard(),
@@ -849,7 +856,7 @@ namespace mongo {
 
                 c->setBytesWritten( oldC->getBytesWritten() );
 
-                chunkMap.insert( make_pair( oldC->getMax(), c ) );
+                chunkMap.insert( chunkMap.end(), make_pair( oldC->getMax(), c ) );
             }
 
             // Also get any minor versions stored for reload
@@ -857,7 +864,7 @@ namespace mongo {
 
             LOG(2) << "loading chunk manager for collection " << _ns
                    << " using old chunk manager w/ version " << _version.toString()
-                   << " and " << oldChunkMap.size() << " chunks" << endl;
+                   << " and " << oldChunks.size() << " chunks" << endl;
         }
 
         // Attach a diff tracker for the versioned chunk data
@@ -1004,8 +1011,9 @@ namespace mongo {
     }
 
     void ChunkManager::_printChunks() const {
-        for (ChunkMap::const_iterator it=_chunkMap.begin(), end=_chunkMap.end(); it != end; ++it) {
-            log() << *it->second << endl;
+        const vector<ChunkPtr>& chunks = getChunks();
+        for (vector<ChunkPtr>::const_iterator it=chunks.begin(), end=chunks.end(); it != end; ++it) {
+            log() << **it << endl;
         }
     }
 
@@ -1023,7 +1031,7 @@ namespace mongo {
                                                 vector<BSONObj>* splitPoints,
                                                 vector<Shard>* shards ) const
     {
-        verify( _chunkMap.size() == 0 );
+        verify( numChunks() == 0 );
 
         unsigned long long numObjects = 0;
         Chunk c(this, _key.globalMin(), _key.globalMax(), primary);
@@ -1130,15 +1138,7 @@ namespace mongo {
 
     ChunkPtr ChunkManager::findIntersectingChunk( const BSONObj& point ) const {
         {
-            BSONObj foo;
-            ChunkPtr c;
-            {
-                ChunkMap::const_iterator it = _chunkMap.upper_bound( point );
-                if (it != _chunkMap.end()) {
-                    foo = it->first;
-                    c = it->second;
-                }
-            }
+            ChunkPtr c = _chunkRanges.upperBoundChunk( point );
 
             if ( c ) {
                 if ( c->containsPoint( point ) ){
@@ -1146,7 +1146,6 @@ namespace mongo {
                     return c;
                 }
 
-                PRINT(foo);
                 PRINT(*c);
                 PRINT( point );
 
@@ -1159,7 +1158,7 @@ namespace mongo {
                      str::stream() << "couldn't find a chunk intersecting: " << point
                                    << " for ns: " << _ns
                                    << " at version: " << _version.toString()
-                                   << ", number of chunks: " << _chunkMap.size() );
+                                   << ", number of chunks: " << numChunks() );
     }
 
     ChunkPtr ChunkManager::findChunkForDoc( const BSONObj& doc ) const {
@@ -1168,8 +1167,9 @@ namespace mongo {
     }
 
     ChunkPtr ChunkManager::findChunkOnServer( const Shard& shard ) const {
-        for ( ChunkMap::const_iterator i=_chunkMap.begin(); i!=_chunkMap.end(); ++i ) {
-            ChunkPtr c = i->second;
+        const vector<ChunkPtr>& chunks = getChunks();
+        for ( vector<ChunkPtr>::const_iterator i=chunks.begin(); i!=chunks.end(); ++i ) {
+            ChunkPtr c = *i;
             if ( c->getShard() == shard )
                 return c;
         }
@@ -1178,6 +1178,18 @@ namespace mongo {
     }
 
     void ChunkManager::getShardsForQuery( set<Shard>& shards , const BSONObj& query ) const {
+        _getShardsForQuery( shards, NULL, query );
+    }
+
+    void ChunkManager::getShardBoundsForQuery( ShardBoundsMap& bounds,
+                                               const BSONObj& query ) const {
+        set<Shard> shards;
+        _getShardsForQuery( shards, &bounds, query );
+    }
+
+    void ChunkManager::_getShardsForQuery( set<Shard>& shards,
+                                           ShardBoundsMap* bounds,
+                                           const BSONObj& query ) const {
         // TODO Determine if the third argument to OrRangeGenerator() is necessary, see SERVER-5165.
         OrRangeGenerator org(_ns.c_str(), query, false);
 
@@ -1200,7 +1212,7 @@ namespace mongo {
             // special case if most-significant field isn't in query
             FieldRange range = frsp->shardKeyRange(_key.key().firstElementFieldName());
             if ( range.universal() ) {
-                getShardsForRange( shards, _key.globalMin(), _key.globalMax() );
+                _getShardsForRange( shards, bounds, _key.globalMin(), _key.globalMax() );
                 return;
             }
             
@@ -1208,10 +1220,10 @@ namespace mongo {
                 BoundList ranges = _key.keyBounds( frsp->getSingleKeyFRS() );
                 for ( BoundList::const_iterator it=ranges.begin(); it != ranges.end(); ++it ){
 
-                    getShardsForRange( shards, it->first /*min*/, it->second /*max*/ );
+                    _getShardsForRange( shards, bounds, it->first /*min*/, it->second /*max*/ );
 
                     // once we know we need to visit all shards no need to keep looping
-                    if( shards.size() == _shards.size() ) return;
+                    if( shards.size() == _shards.size() && ! bounds ) return;
                 }
             }
 
@@ -1226,23 +1238,49 @@ namespace mongo {
         // than return an empty set of shards.
         if ( shards.empty() ) {
             massert( 16068, "no chunk ranges available", !_chunkRanges.ranges().empty() );
-            shards.insert( _chunkRanges.ranges().begin()->second->getShard() );
+            const ChunkRange& first = *_chunkRanges.ranges().front();
+            shards.insert( first.getShard() );
+            if ( bounds ) {
+                (*bounds)[ first.getShard() ] = make_pair( first.getMin(), first.getMax() );
+            }
         }
     }
 
     void ChunkManager::getShardsForRange( set<Shard>& shards,
                                           const BSONObj& min,
                                           const BSONObj& max ) const {
+        _getShardsForRange( shards, NULL, min, max );
+    }
 
-        ChunkRangeMap::const_iterator it = _chunkRanges.upper_bound(min);
-        ChunkRangeMap::const_iterator end = _chunkRanges.upper_bound(max);
+    void ChunkManager::_getShardsForRange( set<Shard>& shards,
+                                           ShardBoundsMap* bounds,
+                                           const BSONObj& min,
+                                           const BSONObj& max ) const {
+
+        ChunkRangeManager::Ranges::const_iterator it = _chunkRanges.upper_bound(min);
+        ChunkRangeManager::Ranges::const_iterator end = _chunkRanges.upper_bound(max);
 
         massert( 13507 , str::stream() << "no chunks found between bounds " << min << " and " << max , it != _chunkRanges.ranges().end() );
 
         if( end != _chunkRanges.ranges().end() ) ++end;
 
         for( ; it != end; ++it ){
-            shards.insert(it->second->getShard());
+            const ChunkRange& range = **it;
+            shards.insert(range.getShard());
+
+            if (bounds) {
+                ShardBoundsMap::iterator b = bounds->find(range.getShard());
+                if (b == bounds->end()) {
+                    (*bounds)[range.getShard()] = make_pair(range.getMin(), range.getMax());
+                }
+                else {
+                    if (range.getMin().woCompare(b->second.first) < 0)
+                        b->second.first = range.getMin();
+                    if (range.getMax().woCompare(b->second.second) > 0)
+                        b->second.second = range.getMax();
+                }
+                continue;
+            }
 
             // once we know we need to visit all shards no need to keep looping
             if (shards.size() == _shards.size()) break;
@@ -1300,11 +1338,29 @@ namespace mongo {
         LOG(1) << "ChunkManager::drop : " << _ns << endl;
 
         // lock all shards so no one can do a split/migrate
-        for ( ChunkMap::const_iterator i=_chunkMap.begin(); i!=_chunkMap.end(); ++i ) {
-            ChunkPtr c = i->second;
+        const vector<ChunkPtr>& chunks = getChunks();
+        for ( vector<ChunkPtr>::const_iterator i=chunks.begin(); i!=chunks.end(); ++i ) {
+            ChunkPtr c = *i;
             seen.insert( c->getShard() );
         }
 
+        // Migrations hold the chunks lock of their donor, which always owns chunks here
+        OwnedPointerVector<ScopedDistributedLock> shardLocks;
+        for ( set<Shard>::iterator i=seen.begin(); i!=seen.end(); i++ ) {
+            ScopedDistributedLock* shardLock =
+                new ScopedDistributedLock( ConnectionString( configServer.modelServer(),
+                                                             ConnectionString::SYNC ),
+                                           shardChunksLockName( _ns, i->getName() ) );
+            shardLocks.mutableVector().push_back( shardLock );
+            shardLock->setLockMessage( "drop" );
+
+            string errMsg;
+            uassert( 28639,
+                     str::stream() << "collection's metadata is undergoing changes on shard "
+                                   << i->getName() << ". Please try again." << causedBy( errMsg ),
+                     shardLock->tryAcquire( &errMsg ) );
+        }
+
         LOG(1) << "ChunkManager::drop : " << _ns << "\t all locked" << endl;
 
         map<string,BSONObj> errors;
@@ -1402,70 +1458,126 @@ namespace mongo {
     string ChunkManager::toString() const {
         stringstream ss;
         ss << "ChunkManager: " << _ns << " key:" << _key.toString() << '\n';
-        for ( ChunkMap::const_iterator i=_chunkMap.begin(); i!=_chunkMap.end(); ++i ) {
-            const ChunkPtr c = i->second;
+        const vector<ChunkPtr>& chunks = getChunks();
+        for ( vector<ChunkPtr>::const_iterator i=chunks.begin(); i!=chunks.end(); ++i ) {
+            const ChunkPtr c = *i;
             ss << "\t" << c->toString() << '\n';
         }
         return ss.str();
     }
 
-    void ChunkRangeManager::assertValid() const {
+    namespace {
+        // orders a point against the max keys of ranges, as ChunkMap orders keys
+        struct RangeMaxCmp {
+            bool operator()(const BSONObj& point, const shared_ptr<ChunkRange>& range) const {
+                return point.woCompare(range->getMax()) < 0;
+            }
+            bool operator()(const shared_ptr<ChunkRange>& range, const BSONObj& point) const {
+                return range->getMax().woCompare(point) < 0;
+            }
+        };
+    }
+
+    void ChunkRangeManager::assertValid(const ChunkMap& chunks) const {
         if (_ranges.empty())
             return;
 
         try {
             // No Nulls
-            for (ChunkRangeMap::const_iterator it=_ranges.begin(), end=_ranges.end(); it != end; ++it) {
-                verify(it->second);
+            for (Ranges::const_iterator it=_ranges.begin(), end=_ranges.end(); it != end; ++it) {
+                verify(*it);
             }
 
             // Check endpoints
-            verify(allOfType(MinKey, _ranges.begin()->second->getMin()));
-            verify(allOfType(MaxKey, boost::prior(_ranges.end())->second->getMax()));
+            verify(allOfType(MinKey, _ranges.front()->getMin()));
+            verify(allOfType(MaxKey, _ranges.back()->getMax()));
 
             // Make sure there are no gaps or overlaps
-            for (ChunkRangeMap::const_iterator it=boost::next(_ranges.begin()), end=_ranges.end(); it != end; ++it) {
-                ChunkRangeMap::const_iterator last = boost::prior(it);
-                verify(it->second->getMin() == last->second->getMax());
-            }
-
-            // Check Map keys
-            for (ChunkRangeMap::const_iterator it=_ranges.begin(), end=_ranges.end(); it != end; ++it) {
-                verify(it->first == it->second->getMax());
+            for (Ranges::const_iterator it=boost::next(_ranges.begin()), end=_ranges.end(); it != end; ++it) {
+                Ranges::const_iterator last = boost::prior(it);
+                verify((*it)->getMin() == (*last)->getMax());
             }
 
             // Make sure we match the original chunks
-            const ChunkMap chunks = _ranges.begin()->second->getManager()->_chunkMap;
-            for ( ChunkMap::const_iterator i=chunks.begin(); i!=chunks.end(); ++i ) {
+            verify(_chunks.size() == chunks.size());
+            size_t n = 0;
+            for ( ChunkMap::const_iterator i=chunks.begin(); i!=chunks.end(); ++i, ++n ) {
                 const ChunkPtr chunk = i->second;
 
-                ChunkRangeMap::const_iterator min = _ranges.upper_bound(chunk->getMin());
-                ChunkRangeMap::const_iterator max = _ranges.lower_bound(chunk->getMax());
+                verify(_chunks[n] == chunk);
+                verify(maxAt(n).binaryEqual(chunk->getMax()));
+
+                Ranges::const_iterator min = upper_bound(chunk->getMin());
+                Ranges::const_iterator max = std::lower_bound(_ranges.begin(), _ranges.end(),
+                                                              chunk->getMax(), RangeMaxCmp());
 
                 verify(min != _ranges.end());
                 verify(max != _ranges.end());
                 verify(min == max);
-                verify(min->second->getShard() == chunk->getShard());
-                verify(min->second->containsPoint( chunk->getMin() ));
-                verify(min->second->containsPoint( chunk->getMax() ) || (min->second->getMax() == chunk->getMax()));
+                verify((*min)->getShard() == chunk->getShard());
+                verify((*min)->containsPoint( chunk->getMin() ));
+                verify((*min)->containsPoint( chunk->getMax() ) || ((*min)->getMax() == chunk->getMax()));
             }
 
         }
         catch (...) {
-            error() << "\t invalid ChunkRangeMap! printing ranges:" << endl;
+            error() << "\t invalid ChunkRangeManager! printing ranges:" << endl;
 
-            for (ChunkRangeMap::const_iterator it=_ranges.begin(), end=_ranges.end(); it != end; ++it)
-                cout << it->first << ": " << *it->second << endl;
+            for (Ranges::const_iterator it=_ranges.begin(), end=_ranges.end(); it != end; ++it)
+                cout << **it << endl;
 
             throw;
         }
     }
 
-    void ChunkRangeManager::reloadAll(const ChunkMap& chunks) {
+    void ChunkRangeManager::clear() {
+        _keyData.clear();
+        _keyOffsets.clear();
+        _chunks.clear();
         _ranges.clear();
+    }
+
+    void ChunkRangeManager::reloadAll(const ChunkMap& chunks) {
+        clear();
+
+        size_t totalKeySize = 0;
+        for (ChunkMap::const_iterator it = chunks.begin(); it != chunks.end(); ++it) {
+            totalKeySize += it->first.objsize();
+        }
+
+        _keyData.reserve(totalKeySize);
+        _keyOffsets.reserve(chunks.size());
+        _chunks.reserve(chunks.size());
+
+        for (ChunkMap::const_iterator it = chunks.begin(); it != chunks.end(); ++it) {
+            _keyOffsets.push_back(_keyData.size());
+            _keyData.insert(_keyData.end(), it->first.objdata(),
+                            it->first.objdata() + it->first.objsize());
+            _chunks.push_back(it->second);
+        }
+
         _insertRange(chunks.begin(), chunks.end());
 
-        DEV assertValid();
+        DEV assertValid(chunks);
+    }
+
+    ChunkRangeManager::Ranges::const_iterator ChunkRangeManager::upper_bound(const BSONObj& o) const {
+        return std::upper_bound(_ranges.begin(), _ranges.end(), o, RangeMaxCmp());
+    }
+
+    ChunkPtr ChunkRangeManager::upperBoundChunk(const BSONObj& point) const {
+        // All keys have the shard key's field names, so only the values need to be compared.
+        size_t lo = 0;
+        size_t hi = _chunks.size();
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (point.woCompare(maxAt(mid), BSONObj(), false) < 0)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+
+        return lo < _chunks.size() ? _chunks[lo] : ChunkPtr();
     }
 
     void ChunkRangeManager::_insertRange(ChunkMap::const_iterator begin, const ChunkMap::const_iterator end) {
@@ -1476,7 +1588,7 @@ namespace mongo {
                 ++begin;
 
             shared_ptr<ChunkRange> cr (new ChunkRange(first, begin));
-            _ranges[cr->getMax()] = cr;
+            _ranges.push_back(cr);
         }
     }
 
@@ -48,9 +48,8 @@ namespace mongo {
 
     typedef shared_ptr<const Chunk> ChunkPtr;
 
-    // key is max for each Chunk or ChunkRange
+    // key is max for each Chunk
     typedef map<BSONObj,ChunkPtr,BSONObjCmp> ChunkMap;
-    typedef map<BSONObj,shared_ptr<ChunkRange>,BSONObjCmp> ChunkRangeMap;
 
     typedef shared_ptr<const ChunkManager> ChunkManagerPtr;
 
@@ -153,8 +152,11 @@ namespace mongo {
          * @param chunkSize chunk size to target in bytes
          * @param maxPoints limits the number of split points that are needed, zero is max (optional)
          * @param maxObjs limits the number of objects in each chunk, zero is as max (optional)
+         * @param sampled estimate the split points from the shard key index's upper levels
+         *        instead of counting every key (optional)
          */
-        void pickSplitVector( vector<BSONObj>& splitPoints , int chunkSize , int maxPoints = 0, int maxObjs = 0) const;
+        void pickSplitVector( vector<BSONObj>& splitPoints , int chunkSize , int maxPoints = 0, int maxObjs = 0,
+                              bool sampled = false ) const;
 
         //
         // migration support
@@ -317,25 +319,56 @@ namespace mongo {
     };
 
 
+    /**
+     * The chunks of a ChunkManager, and the ranges of adjacent chunks on the same shard, laid
+     * out flat for lookups.
+     *
+     * The chunks' max keys are copied back to back into one buffer, in order, and binary searched
+     * to route a point to its chunk.  Compared to descending a ChunkMap this touches far less
+     * memory per lookup, and it is built in a single linear pass without any per-chunk
+     * allocations.  The ranges are kept in a vector in order, and binary searched the same way.
+     *
+     * This is the only copy of the chunk layout a ChunkManager keeps.  The ChunkMap that config
+     * diffs are applied to while loading is dropped once this has been built from it.
+     */
     class ChunkRangeManager {
     public:
-        const ChunkRangeMap& ranges() const { return _ranges; }
+        typedef vector< shared_ptr<ChunkRange> > Ranges;
 
-        void clear() { _ranges.clear(); }
+        const Ranges& ranges() const { return _ranges; }
+
+        void clear();
 
         void reloadAll(const ChunkMap& chunks);
 
         // Slow operation -- wrap with DEV
-        void assertValid() const;
+        void assertValid(const ChunkMap& chunks) const;
+
+        /** the first range whose max is greater than o, or ranges().end() */
+        Ranges::const_iterator upper_bound(const BSONObj& o) const;
+
+        /**
+         * Returns the chunk whose max is the smallest one greater than point, which is the only
+         * chunk that can contain it. Returns an empty ChunkPtr if point is past the last chunk.
+         */
+        ChunkPtr upperBoundChunk(const BSONObj& point) const;
 
-        ChunkRangeMap::const_iterator upper_bound(const BSONObj& o) const { return _ranges.upper_bound(o); }
-        ChunkRangeMap::const_iterator lower_bound(const BSONObj& o) const { return _ranges.lower_bound(o); }
+        size_t numChunks() const { return _chunks.size(); }
+
+        /** all the chunks, in order */
+        const vector<ChunkPtr>& chunks() const { return _chunks; }
 
     private:
-        // assumes nothing in this range exists in _ranges
+        // assumes nothing in this range exists in _ranges, and that it sorts after all of them
         void _insertRange(ChunkMap::const_iterator begin, const ChunkMap::const_iterator end);
 
-        ChunkRangeMap _ranges;
+        BSONObj maxAt(size_t i) const { return BSONObj(&_keyData[_keyOffsets[i]]); }
+
+        vector<char> _keyData; // chunk max keys, in order
+        vector<size_t> _keyOffsets; // offset in _keyData of each chunk's max
+        vector<ChunkPtr> _chunks; // parallels _keyOffsets
+
+        Ranges _ranges; // in order of their max keys
     };
 
     /* config.sharding
@@ -347,6 +380,8 @@ namespace mongo {
     class ChunkManager {
     public:
         typedef map<Shard,ChunkVersion> ShardVersionMap;
+        // lowest chunk min and highest chunk max, per shard
+        typedef map<Shard, pair<BSONObj,BSONObj> > ShardBoundsMap;
 
         // Loads a new chunk manager from a collection document
         ChunkManager( const BSONObj& collDoc );
@@ -398,7 +433,7 @@ namespace mongo {
         // Methods to use once loaded / created
         //
 
-        int numChunks() const { return _chunkMap.size(); }
+        int numChunks() const { return _chunkRanges.numChunks(); }
 
         /** Given a document, returns the chunk which contains that document.
          *  This works by extracting the shard key part of the given document, then
@@ -426,7 +461,14 @@ namespace mongo {
         /** @param shards set to the shards covered by the interval [min, max], see SERVER-4791 */
         void getShardsForRange( set<Shard>& shards, const BSONObj& min, const BSONObj& max ) const;
 
-        const ChunkMap& getChunkMap() const { return _chunkMap; }
+        /**
+         * Like getShardsForQuery(), but also reports the range of shard keys each shard could
+         * return for the query, from the chunks the query touches there.
+         */
+        void getShardBoundsForQuery( ShardBoundsMap& bounds, const BSONObj& query ) const;
+
+        /** all the chunks, in shard key order */
+        const vector<ChunkPtr>& getChunks() const { return _chunkRanges.chunks(); }
 
         /**
          * Returns true if, for this shard, the chunks are identical in both chunk managers
@@ -470,12 +512,17 @@ namespace mongo {
 
         // end helpers
 
+        // If 'bounds' is set, every range is visited so that the bounds are complete
+        void _getShardsForQuery( set<Shard>& shards, ShardBoundsMap* bounds,
+                                 const BSONObj& query ) const;
+        void _getShardsForRange( set<Shard>& shards, ShardBoundsMap* bounds,
+                                 const BSONObj& min, const BSONObj& max ) const;
+
         // All members should be const for thread-safety
         const string _ns;
         const ShardKeyPattern _key;
         const bool _unique;
 
-        const ChunkMap _chunkMap;
         const ChunkRangeManager _chunkRanges;
 
         const set<Shard> _shards;
@@ -539,7 +586,6 @@ namespace mongo {
         //
 
         friend class Chunk;
-        friend class ChunkRangeManager; // only needed for CRM::assertValid()
         static AtomicUInt NextSequenceNumber;
         
         /** Just for testing */
@@ -757,12 +757,12 @@ namespace mongo {
                     // Reload the new config info.  If we created more than one initial chunk, then
                     // we need to move them around to balance.
                     ChunkManagerPtr chunkManager = config->getChunkManager( ns , true );
-                    ChunkMap chunkMap = chunkManager->getChunkMap();
+                    const vector<ChunkPtr>& chunks = chunkManager->getChunks();
                     // 2. Move and commit each "big chunk" to a different shard.
                     int i = 0;
-                    for ( ChunkMap::const_iterator c = chunkMap.begin(); c != chunkMap.end(); ++c,++i ){
+                    for ( vector<ChunkPtr>::const_iterator c = chunks.begin(); c != chunks.end(); ++c,++i ){
                         Shard to = shards[ i % numShards ];
-                        ChunkPtr chunk = c->second;
+                        ChunkPtr chunk = *c;
 
                         // can't move chunk to shard it's already on
                         if ( to == chunk->getShard() )
@@ -75,6 +75,24 @@ namespace mongo {
         // Get the distributed lock
         //
 
+        // Migrations of this shard's chunks hold the shard chunks lock rather than the collection
+        // lock for most of their run, so merges need both
+        ScopedDistributedLock shardLock( configLoc,
+                                         shardChunksLockName( nss.ns(),
+                                                              shardingState.getShardName() ) );
+        shardLock.setLockMessage( stream() << "merging chunks in " << nss.ns() << " from "
+                                           << minKey << " to " << maxKey );
+
+        if ( !shardLock.tryAcquire( errMsg ) ) {
+
+            *errMsg = stream() << "could not acquire shard chunks lock for " << nss.ns()
+                               << " to merge chunks in [" << minKey << "," << maxKey << ")"
+                               << causedBy( *errMsg );
+
+            warning() << *errMsg << endl;
+            return false;
+        }
+
         ScopedDistributedLock collLock( configLoc, nss.ns() );
         collLock.setLockMessage( stream() << "merging chunks in " << nss.ns() << " from "
                                           << minKey << " to " << maxKey );
@@ -50,6 +50,7 @@
 #include "mongo/db/auth/authorization_manager_global.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/privilege.h"
+#include "mongo/db/catalog/index_create.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/dbhelpers.h"
@@ -66,6 +67,8 @@
 #include "mongo/db/repl/rs.h"
 #include "mongo/db/repl/rs_config.h"
 #include "mongo/db/repl/write_concern.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/structure/collection_iterator.h"
 #include "mongo/logger/ramlog.h"
 #include "mongo/s/chunk.h"
 #include "mongo/s/chunk_version.h"
@@ -148,6 +151,14 @@ namespace mongo {
 #endif
         }
 
+        /**
+         * Records how long one phase of a step took in total, e.g. the time the clone step spent
+         * waiting on the donor versus inserting documents.
+         */
+        void notePhase( const string& name , long long millis ) {
+            _b.appendNumber( name , millis );
+        }
+
     private:
         Timer _t;
 
@@ -917,11 +928,22 @@ namespace mongo {
                 return false;
             }
 
-            DistributedLock lockSetup( ConnectionString( shardingState.getConfigServer() , ConnectionString::SYNC ) , ns );
-            dist_lock_try dlk;
+            // Lock the collection's chunks on both shards for the whole migration. Migrations of
+            // the same collection between other shards don't conflict with this one, so they only
+            // wait for each other while committing, under the collection lock (see 5.a).
+            const ConnectionString configLoc( shardingState.getConfigServer(),
+                                              ConnectionString::SYNC );
+            DistributedLock fromLockSetup( configLoc,
+                                           shardChunksLockName( ns, fromShard.getName() ) );
+            DistributedLock toLockSetup( configLoc, shardChunksLockName( ns, toShard.getName() ) );
+            dist_lock_try fromDlk;
+            dist_lock_try toDlk;
 
             try{
-                dlk = dist_lock_try( &lockSetup , (string)"migrate-" + min.toString(), 30.0 /*timeout*/ );
+                fromDlk = dist_lock_try( &fromLockSetup , (string)"migrate-" + min.toString(), 30.0 /*timeout*/ );
+                if ( fromDlk.got() ) {
+                    toDlk = dist_lock_try( &toLockSetup , (string)"migrate-" + min.toString(), 30.0 /*timeout*/ );
+                }
             }
             catch( LockException& e ){
                 errmsg = str::stream() << "error locking distributed lock for migration " << "migrate-" << min.toString() << causedBy( e );
@@ -929,10 +951,10 @@ namespace mongo {
                 return false;
             }
 
-            if ( ! dlk.got() ) {
+            if ( ! fromDlk.got() || ! toDlk.got() ) {
                 errmsg = str::stream() << "the collection metadata could not be locked with lock " << "migrate-" << min.toString();
                 warning() << errmsg << endl;
-                result.append( "who" , dlk.other() );
+                result.append( "who" , fromDlk.got() ? toDlk.other() : fromDlk.other() );
                 return false;
             }
 
@@ -1199,9 +1221,10 @@ namespace mongo {
                 return false;
             }
 
-            // Ensure distributed lock still held
+            // Ensure distributed locks still held
             string lockHeldMsg;
-            bool lockHeld = dlk.isLockHeld( 30.0 /* timeout */, &lockHeldMsg );
+            bool lockHeld = fromDlk.isLockHeld( 30.0 /* timeout */, &lockHeldMsg ) &&
+                            toDlk.isLockHeld( 30.0 /* timeout */, &lockHeldMsg );
             if ( !lockHeld ) {
                 errmsg = str::stream() << "not entering migrate critical section because "
                                        << lockHeldMsg;
@@ -1212,6 +1235,57 @@ namespace mongo {
             log() << "About to enter migrate critical section" << endl;
 
             {
+                // Other migrations of this collection may have committed since maxVersion was read.
+                // The collection lock keeps them out until this commit is done, so re-read the
+                // version under it and make sure the chunk is still the one being moved.
+                DistributedLock collLockSetup( configLoc, ns );
+                dist_lock_try collDlk;
+
+                try{
+                    collDlk = dist_lock_try( &collLockSetup , (string)"migrate-" + min.toString(), 30.0 /*timeout*/ );
+                }
+                catch( LockException& e ){
+                    errmsg = str::stream() << "error locking distributed lock for migration commit " << "migrate-" << min.toString() << causedBy( e );
+                    warning() << errmsg << endl;
+                    return false;
+                }
+
+                if ( ! collDlk.got() ) {
+                    errmsg = str::stream() << "the collection metadata could not be locked to commit migration " << "migrate-" << min.toString();
+                    warning() << errmsg << endl;
+                    result.append( "who" , collDlk.other() );
+                    return false;
+                }
+
+                try {
+                    ScopedDbConnection conn(shardingState.getConfigServer(), 30);
+
+                    BSONObj x = conn->findOne(ChunkType::ConfigNS,
+                                              Query(BSON(ChunkType::ns(ns)))
+                                                  .sort(BSON(ChunkType::DEPRECATED_lastmod() << -1)));
+                    BSONObj currChunk = conn->findOne(ChunkType::ConfigNS,
+                                                      shardId.wrap(ChunkType::name().c_str()));
+                    conn.done();
+
+                    if ( currChunk.isEmpty() ||
+                         currChunk[ChunkType::min()].Obj().woCompare( min ) ||
+                         currChunk[ChunkType::max()].Obj().woCompare( max ) ||
+                         currChunk[ChunkType::shard()].str() != fromShard.getName() ) {
+                        errmsg = str::stream() << "chunk " << min << " -> " << max
+                                               << " changed during the migration, now " << currChunk;
+                        warning() << "aborted moveChunk before its commit because " << errmsg
+                                  << migrateLog;
+                        return false;
+                    }
+
+                    maxVersion = ChunkVersion::fromBSON(x, ChunkType::DEPRECATED_lastmod());
+                }
+                catch( DBException& e ){
+                    errmsg = str::stream() << "aborted moveChunk because could not get chunk data from config server " << shardingState.getConfigServer() << causedBy( e );
+                    warning() << errmsg << endl;
+                    return false;
+                }
+
                 // 5.a
                 // we're under the collection lock here, so no other migrate can change maxVersion
                 // or CollectionMetadata state
@@ -1495,7 +1569,8 @@ namespace mongo {
             MONGO_FP_PAUSE_WHILE(moveChunkHangAtStep5);
 
             // 6.
-            // NOTE: It is important that the distributed collection lock be held for this step.
+            // NOTE: It is important that the distributed locks on this shard's chunks be held for
+            // this step, so no chunk of the range can migrate back in before the delete is queued.
             RangeDeleter* deleter = getDeleter();
             if (waitForDelete) {
                 log() << "doing delete inline for cleanup of chunk data" << migrateLog;
@@ -1564,6 +1639,64 @@ namespace mongo {
     MONGO_FP_DECLARE(migrateThreadHangAtStep4);
     MONGO_FP_DECLARE(migrateThreadHangAtStep5);
 
+    // When a chunk is migrated into an empty collection, build its secondary indexes with the
+    // bulk builder once the range has been cloned, instead of before the clone.
+    MONGO_EXPORT_SERVER_PARAMETER(migrateDeferSecondaryIndexes, bool, false);
+
+    /**
+     * Runs _migrateClone against the donor on a separate thread, so the next batch of
+     * documents is in flight while the current one is being inserted.
+     * Only one fetch may be outstanding, and the connection must not be used by anyone else
+     * until wait() has returned.
+     */
+    class MigrateCloneFetcher : boost::noncopyable {
+    public:
+        MigrateCloneFetcher( DBClientBase* conn ) : _conn( conn ) , _ok( false ) {}
+
+        ~MigrateCloneFetcher() {
+            if ( _thread )
+                _thread->join();
+        }
+
+        void start() {
+            verify( !_thread );
+            _thread.reset( new boost::thread( boost::bind( &MigrateCloneFetcher::_fetch ,
+                                                           this ) ) );
+        }
+
+        /**
+         * Waits for the fetch started by start().
+         * @return false if the command failed, in which case 'res' holds the reply or error
+         */
+        bool wait( BSONObj* res ) {
+            verify( _thread );
+            _thread->join();
+            _thread.reset();
+
+            *res = _res;
+            return _ok;
+        }
+
+    private:
+        void _fetch() {
+            try {
+                BSONObj res;
+                _ok = _conn->runCommand( "admin" , BSON( "_migrateClone" << 1 ) , res );
+                _res = res.getOwned();
+            }
+            catch ( const std::exception& e ) {
+                _ok = false;
+                _res = BSON( "errmsg" << e.what() );
+            }
+        }
+
+        DBClientBase* const _conn;
+        scoped_ptr<boost::thread> _thread;
+
+        bool _ok;
+        BSONObj _res;
+    };
+
     class MigrateStatus {
     public:
         
@@ -1580,6 +1713,7 @@ namespace mongo {
             clonedBytes = 0;
             numCatchup = 0;
             numSteady = 0;
+            deferredIndexes.clear();
 
             active = true;
         }
@@ -1600,6 +1734,18 @@ namespace mongo {
             }
 
             if ( state != DONE ) {
+                // Don't leave the collection without the indexes the donor has, otherwise
+                // later migrations would refuse to build them once there is data
+                try {
+                    string failure = errmsg;
+                    buildDeferredIndexes();
+                    errmsg = failure;
+                }
+                catch ( std::exception& e ) {
+                    warning() << "failed to build deferred indexes after migrate failure: "
+                              << e.what() << migrateLog;
+                }
+
                 // Unprotect the range if needed/possible on unsuccessful TO migration
                 Lock::DBWrite lk( ns );
                 string errMsg;
@@ -1679,6 +1825,17 @@ namespace mongo {
                     bool hasIndex = collection->getIndexCatalog()->
                             findIndexByKeyPattern(idxPattern, true /* include unfinished */);
 
+                    // Into an empty collection, build the indexes that range deletion and
+                    // _transferMods don't need once the clone is done, rather than updating
+                    // them for every document cloned
+                    if ( migrateDeferSecondaryIndexes &&
+                         collection->numRecords() == 0 && !hasIndex &&
+                         !shardKeyPattern.isPrefixOf( idxPattern ) &&
+                         !BSON( "_id" << 1 ).isPrefixOf( idxPattern ) ) {
+                        deferredIndexes.push_back( idx );
+                        continue;
+                    }
+
                     if (collection->numRecords() > 0 && !hasIndex) {
                         errmsg = str::stream() << "aborting migration, shard is missing "
                                                << "indexes and collection is not empty. "
@@ -1755,9 +1912,16 @@ namespace mongo {
                 // 3. initial bulk clone
                 state = CLONE;
 
+                long long fetchMillis = 0;
+                long long applyMillis = 0;
+
+                MigrateCloneFetcher fetcher( conn.get() );
+                fetcher.start();
+
                 while ( true ) {
                     BSONObj res;
-                    if ( ! conn->runCommand( "admin" , BSON( "_migrateClone" << 1 ) , res ) ) {  // gets array of objects to copy, in disk order
+                    Timer fetchTimer;
+                    if ( ! fetcher.wait( &res ) ) {  // gets array of objects to copy, in disk order
                         state = FAIL;
                         errmsg = "_migrateClone failed: ";
                         errmsg += res.toString();
@@ -1765,55 +1929,36 @@ namespace mongo {
                         conn.done();
                         return;
                     }
+                    fetchMillis += fetchTimer.millis();
 
                     BSONObj arr = res["objects"].Obj();
-                    int thisTime = 0;
-
-                    BSONObjIterator i( arr );
-                    while( i.more() ) {
-                        BSONObj o = i.next().Obj();
-                        {
-                            PageFaultRetryableSection pgrs;
-                            while ( 1 ) {
-                                try {
-                                    Client::WriteContext cx( ns );
-
-                                    BSONObj localDoc;
-                                    if ( willOverrideLocalId( o, &localDoc ) ) {
-                                        string errMsg =
-                                            str::stream() << "cannot migrate chunk, local document "
-                                                          << localDoc
-                                                          << " has same _id as cloned "
-                                                          << "remote document " << o;
-
-                                        warning() << errMsg << endl;
-
-                                        // Exception will abort migration cleanly
-                                        uasserted( 16976, errMsg );
-                                    }
-
-                                    Helpers::upsert( ns, o, true );
-                                    break;
-                                }
-                                catch ( PageFaultException& e ) {
-                                    e.touch();
-                                }
-                            }
-                        } // end PageFaultRetryableSection
-                        thisTime++;
-                        numCloned++;
-                        clonedBytes += o.objsize();
+                    if ( arr.isEmpty() )
+                        break;
+
+                    // the donor's cursor only moves forward, so ask for the next batch now
+                    fetcher.start();
+
+                    Timer applyTimer;
+                    insertCloneBatch( arr );
+                    applyMillis += applyTimer.millis();
 
-                        if ( secondaryThrottle && thisTime > 0 ) {
-                            if ( ! waitForReplication( cc().getLastOp(), 2, 60 /* seconds to wait */ ) ) {
-                                warning() << "secondaryThrottle on, but doc insert timed out after 60 seconds, continuing" << endl;
-                            }
+                    if ( secondaryThrottle ) {
+                        if ( ! waitForReplication( cc().getLastOp(), 2, 60 /* seconds to wait */ ) ) {
+                            warning() << "secondaryThrottle on, but doc insert timed out after 60 seconds, continuing" << endl;
                         }
                     }
+                }
 
-                    if ( thisTime == 0 )
-                        break;
+                timing.notePhase( "cloneFetchMillis" , fetchMillis );
+                timing.notePhase( "cloneApplyMillis" , applyMillis );
+
+                Timer indexTimer;
+                if ( !buildDeferredIndexes() ) {
+                    state = FAIL;
+                    conn.done();
+                    return;
                 }
+                timing.notePhase( "cloneIndexMillis" , indexTimer.millis() );
 
                 timing.done(3);
                 MONGO_FP_PAUSE_WHILE(migrateThreadHangAtStep3);
@@ -2037,6 +2182,139 @@ namespace mongo {
             return didAnything;
         }
 
+        /**
+         * Inserts one _migrateClone batch under a single write lock.
+         * A document whose _id is already in the range replaces the existing one, as an upsert
+         * would.
+         */
+        void insertCloneBatch( const BSONObj& arr ) {
+            vector<BSONObj> docs;
+            BSONObjIterator i( arr );
+            while ( i.more() ) {
+                docs.push_back( i.next().Obj() );
+            }
+
+            size_t next = 0;
+            PageFaultRetryableSection pgrs;
+            while ( next < docs.size() ) {
+                try {
+                    Client::WriteContext cx( ns );
+                    Collection* collection = cx.ctx().db()->getCollection( ns );
+                    uassert( 28627,
+                             str::stream() << "collection dropped during migration: " << ns,
+                             collection );
+
+                    for ( ; next < docs.size(); next++ ) {
+                        const BSONObj& o = docs[next];
+
+                        BSONObj localDoc;
+                        if ( willOverrideLocalId( o, &localDoc ) ) {
+                            string errMsg =
+                                str::stream() << "cannot migrate chunk, local document "
+                                              << localDoc
+                                              << " has same _id as cloned "
+                                              << "remote document " << o;
+
+                            warning() << errMsg << endl;
+
+                            // Exception will abort migration cleanly
+                            uasserted( 16976, errMsg );
+                        }
+
+                        if ( localDoc.isEmpty() ) {
+                            StatusWith<DiskLoc> loc = collection->insertDocument( o, true );
+                            uassertStatusOK( loc.getStatus() );
+                            logOp( "i", ns.c_str(), o, NULL, NULL, true /* fromMigrate */ );
+                        }
+                        else {
+                            Helpers::upsert( ns, o, true );
+                        }
+
+                        getDur().commitIfNeeded();
+
+                        numCloned++;
+                        clonedBytes += o.objsize();
+                    }
+                }
+                catch ( PageFaultException& e ) {
+                    // documents before 'next' are in, carry on from there
+                    e.touch();
+                }
+            }
+        }
+
+        /**
+         * Builds the indexes that step 1 left until the clone was done, all of them in one pass
+         * over the cloned documents through the bulk builder, before the donor is told it can
+         * commit the migration.  The database stays write locked for the build.
+         * @return false, with errmsg set, if an index couldn't be built
+         */
+        bool buildDeferredIndexes() {
+            if ( deferredIndexes.empty() )
+                return true;
+            vector<BSONObj> specs;
+            specs.swap( deferredIndexes );
+
+            Client::WriteContext ctx( ns );
+            Database* db = ctx.ctx().db();
+            Collection* collection = db->getCollection( ns );
+            if ( !collection ) {
+                errmsg = str::stream() << "collection dropped during migration: " << ns;
+                warning() << errmsg;
+                return false;
+            }
+
+            // an index that was created since step 1 is left as it is
+            vector<BSONObj> toBuild;
+            for ( vector<BSONObj>::const_iterator i = specs.begin(); i != specs.end(); ++i ) {
+                if ( !collection->getIndexCatalog()->findIndexByKeyPattern( (*i)["key"].Obj(),
+                                                                            true ) )
+                    toBuild.push_back( *i );
+            }
+            if ( toBuild.empty() )
+                return true;
+
+            Status status = Status::OK();
+            try {
+                MultiIndexBlock indexBlock( collection );
+                status = indexBlock.init( toBuild );
+
+                scoped_ptr<CollectionIterator> it( collection->getIterator(
+                                                       DiskLoc(),
+                                                       false,
+                                                       CollectionScanParams::FORWARD ) );
+                InsertDeleteOptions options;
+                options.logIfError = false;
+                options.dupsAllowed = true; // duplicate keys of unique indexes fail the commit
+
+                while ( status.isOK() && !it->isEOF() ) {
+                    DiskLoc loc = it->getNext();
+                    status = indexBlock.insert( collection->docFor( loc ), loc, options );
+                    getDur().commitIfNeeded();
+                }
+
+                if ( status.isOK() )
+                    status = indexBlock.commit();
+            }
+            catch ( DBException& e ) {
+                status = e.toStatus();
+            }
+
+            if ( !status.isOK() ) {
+                errmsg = str::stream() << "failed to build indexes after migrating data. "
+                                       << " indexes: " << toBuild.size()
+                                       << " error: " << status.toString();
+                warning() << errmsg;
+                return false;
+            }
+
+            for ( vector<BSONObj>::const_iterator i = toBuild.begin(); i != toBuild.end(); ++i ) {
+                logOp( "i", db->getSystemIndexesName().c_str(), *i,
+                       NULL, NULL, true /* fromMigrate */ );
+            }
+            return true;
+        }
+
         /**
          * Checks if an upsert of a remote document will override a local document with the same _id
          * but in a different range on this shard.
@@ -2157,6 +2435,9 @@ namespace mongo {
         long long numSteady;
         bool secondaryThrottle;
 
+        // index specs step 1 skipped, to be built once the range has been cloned
+        vector<BSONObj> deferredIndexes;
+
         int replSetMajorityCount;
 
         enum State { READY , CLONE , CATCHUP , STEADY , COMMIT_START , DONE , FAIL , ABORT } state;
@@ -2189,14 +2470,14 @@ namespace mongo {
         }
         bool run(const string& , BSONObj& cmdObj, int, string& errmsg, BSONObjBuilder& result, bool) {
 
-            // Active state of TO-side migrations (MigrateStatus) is serialized by distributed
-            // collection lock.
+            // Active state of TO-side migrations (MigrateStatus) is serialized by the distributed
+            // lock on this shard's chunks of the collection.
             if ( migrateStatus.getActive() ) {
                 errmsg = "migrate already in progress";
                 return false;
             }
 
-            // Pending deletes (for migrations) are serialized by the distributed collection lock,
+            // Pending deletes (for migrations) are serialized by the distributed shard chunks lock,
             // we are sure we registered a delete for a range *before* we can migrate-in a
             // subrange.
             int numDeletes = getDeleter()->getStats()->getCurrentDeletes();
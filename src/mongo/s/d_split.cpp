@@ -44,6 +44,7 @@
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/dbhelpers.h"
+#include "mongo/db/index/btree_based_access_method.h"
 #include "mongo/db/index_legacy.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/jsobj.h"
@@ -209,6 +210,61 @@ namespace mongo {
         return key.replaceFieldNames(keyPattern).clientReadable();
     }
 
+    /**
+     * Picks split keys for [min, max) about 'keyCount' keys apart from the keys in the upper
+     * levels of the index btree, rather than by counting every key in the range.
+     * Returns false if the btree can't give an estimate that fine, e.g. because it is small.
+     */
+    static bool sampleSplitKeys( Collection* collection,
+                                 IndexDescriptor* idx,
+                                 const BSONObj& keyPattern,
+                                 const BSONObj& min,
+                                 const BSONObj& max,
+                                 long long keyCount,
+                                 long long maxSplitPoints,
+                                 vector<BSONObj>* splitKeys,
+                                 set<BSONObj>* tooFrequentKeys ) {
+        BtreeBasedAccessMethod* accessMethod =
+            static_cast<BtreeBasedAccessMethod*>( collection->getIndexCatalog()->getIndex( idx ) );
+
+        vector<BSONObj> separators;
+        double keysBetween;
+        if ( !accessMethod->getSeparatorKeys( min, max, &separators, &keysBetween ) ) {
+            return false;
+        }
+
+        // Each separator should only be a small step towards the next split point
+        if ( keysBetween * 4 > keyCount ) {
+            return false;
+        }
+
+        BSONObj lastKey = prettyKey( idx->keyPattern(), min ).extractFields( keyPattern );
+        double currCount = 0;
+        long long numChunks = 0;
+        for ( vector<BSONObj>::const_iterator it = separators.begin();
+              it != separators.end(); ++it ) {
+            currCount += keysBetween;
+            if ( currCount <= keyCount )
+                continue;
+
+            BSONObj currKey = prettyKey( idx->keyPattern(), *it ).extractFields( keyPattern );
+            if ( currKey.woCompare( lastKey ) == 0 ) {
+                tooFrequentKeys->insert( currKey.getOwned() );
+                continue;
+            }
+
+            splitKeys->push_back( currKey.getOwned() );
+            lastKey = splitKeys->back();
+            currCount = 0;
+            numChunks++;
+            LOG(4) << "picked a sampled split key: " << currKey << endl;
+
+            if ( maxSplitPoints && ( numChunks >= maxSplitPoints ) )
+                break;
+        }
+        return true;
+    }
+
     class SplitVector : public Command {
     public:
         SplitVector() : Command( "splitVector" , false ) {}
@@ -224,6 +280,9 @@ namespace mongo {
                  "  \n"
                  "  { splitVector : \"blog.post\" , keyPattern:{x:1} , min:{x:10} , max:{x:20}, force: true }\n"
                  "  'force' will produce one split point even if data is small; defaults to false\n"
+                 "  { splitVector : \"blog.post\" , keyPattern:{x:1} , min:{x:10} , max:{x:20}, maxChunkSize:200, sampled: true }\n"
+                 "  'sampled' estimates split points from the upper levels of the index instead of\n"
+                 "  counting every key; not used with 'force'\n"
                  "NOTE: This command may take a while to run";
         }
         virtual Status checkAuthForCommand(ClientBasic* client,
@@ -377,6 +436,23 @@ namespace mongo {
                 //
                 
                 Timer timer;
+                set<BSONObj> tooFrequentKeys;
+
+                if ( jsobj["sampled"].trueValue() && !forceMedianSplit &&
+                     sampleSplitKeys( collection, idx, keyPattern, min, max, keyCount,
+                                      maxSplitPoints, &splitKeys, &tooFrequentKeys ) ) {
+                    for ( set<BSONObj>::const_iterator it = tooFrequentKeys.begin();
+                          it != tooFrequentKeys.end(); ++it ) {
+                        warning() << "chunk is larger than " << maxChunkSize
+                                  << " bytes because of key " << *it << endl;
+                    }
+
+                    result.appendBool( "sampled", true );
+                    result.append( "timeMillis", timer.millis() );
+                    result.append( "splitKeys" , splitKeys );
+                    return true;
+                }
+
                 long long currCount = 0;
                 long long numChunks = 0;
                 
@@ -393,7 +469,6 @@ namespace mongo {
                 // Use every 'keyCount'-th key as a split point. We add the initial key as a sentinel, to be removed
                 // at the end. If a key appears more times than entries allowed on a chunk, we issue a warning and
                 // split on the following key.
-                set<BSONObj> tooFrequentKeys;
                 splitKeys.push_back(prettyKey(idx->keyPattern(), currKey.getOwned()).extractFields( keyPattern ) );
 
                 runner->setYieldPolicy(Runner::YIELD_AUTO);
@@ -578,17 +653,33 @@ namespace mongo {
             // 2. lock the collection's metadata and get highest version for the current shard
             //
 
-            DistributedLock lockSetup( ConnectionString( shardingState.getConfigServer() , ConnectionString::SYNC) , ns );
+            // A migration of this shard's chunks holds the shard chunks lock, and any other change
+            // to the collection's chunks holds the collection lock, so take both.
+            const ConnectionString configLoc( shardingState.getConfigServer(),
+                                              ConnectionString::SYNC );
+            DistributedLock shardLockSetup( configLoc,
+                                            shardChunksLockName( ns, myShard.getName() ) );
+            DistributedLock lockSetup( configLoc , ns );
+            dist_lock_try shardDlk;
             dist_lock_try dlk;
 
             try{
-            	dlk = dist_lock_try( &lockSetup, string("split-") + min.toString() );
+            	shardDlk = dist_lock_try( &shardLockSetup, string("split-") + min.toString() );
+            	if ( shardDlk.got() ) {
+            	    dlk = dist_lock_try( &lockSetup, string("split-") + min.toString() );
+            	}
             }
             catch( LockException& e ){
             	errmsg = str::stream() << "Error locking distributed lock for split." << causedBy( e );
             	return false;
             }
 
+            if ( ! shardDlk.got() ) {
+                errmsg = "the collection's metadata lock is taken";
+                result.append( "who" , shardDlk.other() );
+                return false;
+            }
+
             if ( ! dlk.got() ) {
                 errmsg = "the collection's metadata lock is taken";
                 result.append( "who" , dlk.other() );
@@ -81,6 +81,11 @@ namespace mongo {
     bool isLockPingerEnabled() { return lockPingerEnabled; }
     void setLockPingerEnabled(bool enabled) { lockPingerEnabled = enabled; }
 
+    string shardChunksLockName( const string& ns, const string& shard ) {
+        // '$' can't appear in the name of a sharded collection, so this never names another lock
+        return str::stream() << ns << "$" << shard;
+    }
+
     class DistributedLockPinger {
     public:
 
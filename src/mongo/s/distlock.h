@@ -207,6 +207,14 @@ namespace mongo {
     bool MONGO_CLIENT_API isLockPingerEnabled();
     void MONGO_CLIENT_API setLockPingerEnabled(bool enabled);
 
+    /**
+     * Name of the distributed lock over the chunks of collection 'ns' that live on 'shard'.
+     * Migrations, splits and merges take it for every shard they touch, so operations on disjoint
+     * shards of one collection can run at once. The collection lock, named after 'ns', is still
+     * taken around every change to the collection's chunk metadata.
+     */
+    string MONGO_CLIENT_API shardChunksLockName( const string& ns, const string& shard );
+
 
     class MONGO_CLIENT_API dist_lock_try {
     public:
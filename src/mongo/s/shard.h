@@ -233,6 +233,7 @@ namespace mongo {
     };
 
     class ChunkManager;
+    class ShardConnectionSlots;
     typedef shared_ptr<const ChunkManager> ChunkManagerPtr;
 
     class ShardConnection : public AScopedConnection {
@@ -326,10 +327,18 @@ namespace mongo {
          */
         static void forgetNS( const string& ns );
 
+        /**
+         * Appends the checkout limits and wait times of shardConnectionsPerHost.
+         */
+        static void appendSharedPoolInfo( BSONObjBuilder& b );
+
     private:
         void _init();
         void _finishInit();
 
+        /** gives back the shardConnectionsPerHost slot _conn was checked out under, if any */
+        void _releaseSlot();
+
         bool _finishedInit;
 
         string _addr;
@@ -338,6 +347,9 @@ namespace mongo {
 
         DBClientBase* _conn;
         bool _setVersion;
+
+        // what the slot is charged to, which need not be the thread giving _conn back
+        boost::shared_ptr<ShardConnectionSlots> _slots;
     };
 
 
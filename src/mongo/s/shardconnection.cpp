@@ -37,6 +37,7 @@
 #include "mongo/db/commands.h"
 #include "mongo/db/lasterror.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/config.h"
 #include "mongo/s/request.h"
 #include "mongo/s/shard.h"
@@ -45,11 +46,171 @@
 #include "mongo/server.h"
 #include "mongo/util/concurrency/spin_lock.h"
 #include "mongo/util/stacktrace.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
     DBConnectionPool shardConnectionPool;
 
+    // When non-zero, at most this many connections to each shard host are checked out at once.
+    // Client threads then share them one request at a time rather than each thread keeping its
+    // own connection to every shard it has talked to.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(shardConnectionsPerHost, int, 0);
+
+    // How long a request waits for one of the shardConnectionsPerHost connections to free up.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(shardConnectionWaitTimeoutSecs, int, 30);
+
+    /**
+     * The shardConnectionsPerHost slots that one thread holds on one host.  Every connection
+     * checked out against it keeps a reference, so that a connection given back on another
+     * thread, as the cursors reaped by the cursor timeout thread are, is still charged to the
+     * thread that took it, even if that thread has gone.
+     */
+    class ShardConnectionSlots : boost::noncopyable {
+    public:
+        explicit ShardConnectionSlots( const string& addr ) : addr( addr ) {}
+
+        const string addr;
+
+        // written under SharedShardConnections::_mutex, read without it by the owning thread
+        AtomicInt32 inUse;
+    };
+
+    /**
+     * Enforces shardConnectionsPerHost, and keeps the saturation and wait time statistics that
+     * connPoolStats and shardConnPoolStats report.
+     */
+    class SharedShardConnections {
+    public:
+
+        SharedShardConnections() : _mutex( "SharedShardConnections" ) {
+        }
+
+        /**
+         * Takes one of the connection slots of slots->addr for the thread owning 'slots'.  If
+         * 'mayWait', waits up to shardConnectionWaitTimeoutSecs for one to free up; otherwise
+         * takes one even if that goes over the limit.
+         */
+        void acquire( ShardConnectionSlots* slots, bool mayWait ) {
+            const string& addr = slots->addr;
+            scoped_lock lk( _mutex );
+
+            HostStats* &host = _hosts[addr];
+            if ( ! host )
+                host = new HostStats();
+
+            host->checkouts++;
+
+            if ( mayWait && host->inUse >= shardConnectionsPerHost ) {
+                Timer timer;
+                host->waits++;
+
+                boost::xtime xt;
+                boost::xtime_get( &xt, MONGO_BOOST_TIME_UTC );
+                xt.sec += shardConnectionWaitTimeoutSecs;
+
+                while ( host->inUse >= shardConnectionsPerHost ) {
+                    if ( ! host->available.timed_wait( lk.boost(), xt ) &&
+                         host->inUse >= shardConnectionsPerHost ) {
+                        host->waitMicros += timer.micros();
+                        host->timeouts++;
+                        uasserted( 28628, str::stream() << "timed out after "
+                                                        << shardConnectionWaitTimeoutSecs
+                                                        << " seconds waiting for one of the "
+                                                        << shardConnectionsPerHost
+                                                        << " connections to " << addr );
+                    }
+                }
+
+                host->waitMicros += timer.micros();
+            }
+
+            host->inUse++;
+            if ( host->inUse > host->peakInUse )
+                host->peakInUse = host->inUse;
+            slots->inUse.addAndFetch( 1 );
+        }
+
+        /**
+         * Gives back a slot taken by acquire( slots, ... ), from whichever thread.
+         */
+        void release( ShardConnectionSlots* slots ) {
+            scoped_lock lk( _mutex );
+
+            HostMap::iterator i = _hosts.find( slots->addr );
+            verify( i != _hosts.end() );
+            verify( i->second->inUse > 0 );
+            verify( slots->inUse.load() > 0 );
+
+            slots->inUse.subtractAndFetch( 1 );
+            i->second->inUse--;
+            i->second->available.notify_one();
+        }
+
+        void appendInfo( BSONObjBuilder& b ) {
+            BSONObjBuilder shared( b.subobjStart( "sharedShardConnections" ) );
+            shared.append( "perHostLimit", shardConnectionsPerHost );
+
+            int inUse = 0;
+            long long waits = 0;
+            long long waitMicros = 0;
+            long long timeouts = 0;
+
+            BSONObjBuilder hostsB( shared.subobjStart( "hosts" ) );
+            {
+                scoped_lock lk( _mutex );
+                for ( HostMap::const_iterator i = _hosts.begin(); i != _hosts.end(); ++i ) {
+                    const HostStats* host = i->second;
+
+                    BSONObjBuilder bb( hostsB.subobjStart( i->first ) );
+                    bb.append( "inUse", host->inUse );
+                    bb.append( "peakInUse", host->peakInUse );
+                    bb.appendBool( "saturated", host->inUse >= shardConnectionsPerHost );
+                    bb.appendNumber( "checkouts", host->checkouts );
+                    bb.appendNumber( "waits", host->waits );
+                    bb.appendNumber( "waitMicros", host->waitMicros );
+                    bb.appendNumber( "timeouts", host->timeouts );
+                    bb.done();
+
+                    inUse += host->inUse;
+                    waits += host->waits;
+                    waitMicros += host->waitMicros;
+                    timeouts += host->timeouts;
+                }
+            }
+            hostsB.done();
+
+            shared.append( "totalInUse", inUse );
+            shared.appendNumber( "totalWaits", waits );
+            shared.appendNumber( "totalWaitMicros", waitMicros );
+            shared.appendNumber( "totalTimeouts", timeouts );
+            shared.done();
+        }
+
+    private:
+
+        struct HostStats : boost::noncopyable {
+            HostStats() : inUse(0), peakInUse(0), checkouts(0), waits(0), waitMicros(0),
+                          timeouts(0) {}
+
+            int inUse;
+            int peakInUse;
+            long long checkouts;
+            long long waits;
+            long long waitMicros;
+            long long timeouts;
+
+            // signalled when a slot is released
+            boost::condition available;
+        };
+
+        // protects _hosts and everything in it
+        mongo::mutex _mutex;
+        typedef map<string,HostStats*,DBConnectionPool::serverNameCompare> HostMap;
+        HostMap _hosts;
+
+    } sharedShardConnections;
+
     class ClientConnections;
 
     /**
@@ -109,6 +270,7 @@ namespace mongo {
             shardConnectionPool.appendInfo( result );
             // Thread connection info
             activeClientConnections.appendInfo( result );
+            sharedShardConnections.appendInfo( result );
             return true;
         }
 
@@ -121,12 +283,17 @@ namespace mongo {
     class ClientConnections : boost::noncopyable {
     public:
         struct Status : boost::noncopyable {
-            Status() : created(0), avail(0) {}
+            explicit Status( const string& addr ) :
+                created(0), avail(0), slots( new ShardConnectionSlots( addr ) ) {}
 
             // May be read concurrently, but only written from
             // this thread.
             long long created;
             DBClientBase* avail;
+
+            // connections to the host this thread has checked out when
+            // shardConnectionsPerHost is set; they are never cached in 'avail'
+            const boost::shared_ptr<ShardConnectionSlots> slots;
         };
 
         // Gets or creates the status object for the host
@@ -134,7 +301,7 @@ namespace mongo {
             scoped_spinlock lock( _lock );
             Status* &temp = _hosts[addr];
             if ( ! temp )
-                temp = new Status();
+                temp = new Status( addr );
             return temp;
         }
 
@@ -176,13 +343,31 @@ namespace mongo {
             if ( fromDestructor ) _hosts.clear();
         }
 
-        DBClientBase * get( const string& addr , const string& ns ) {
+        /**
+         * @param slots set to what the connection's shardConnectionsPerHost slot is charged
+         *     to, which the caller must give back to sharedShardConnections.release() along
+         *     with the connection; left empty if shardConnectionsPerHost isn't set
+         */
+        DBClientBase * get( const string& addr , const string& ns ,
+                            boost::shared_ptr<ShardConnectionSlots>* slots ) {
             _check( ns );
 
             Status* s = _getStatus( addr );
 
             auto_ptr<DBClientBase> c; // Handles cleanup if there's an exception thrown
-            if ( s->avail ) {
+            if ( shardConnectionsPerHost > 0 ) {
+                sharedShardConnections.acquire( s->slots.get(), _mayWaitFor( addr ) );
+                try {
+                    c.reset( shardConnectionPool.get( addr ) );
+                }
+                catch ( ... ) {
+                    sharedShardConnections.release( s->slots.get() );
+                    throw;
+                }
+                s->created++;
+                *slots = s->slots;
+            }
+            else if ( s->avail ) {
                 c.reset( s->avail );
                 s->avail = 0;
                 shardConnectionPool.onHandedOut( c.get() ); // May throw an exception
@@ -194,6 +379,13 @@ namespace mongo {
         }
 
         void done( const string& addr , DBClientBase* conn ) {
+            if ( shardConnectionsPerHost > 0 ) {
+                // The pool disposes of the connection if it went bad.  Not cached on the
+                // thread, so this may be called from any thread.
+                release( addr, conn );
+                return;
+            }
+
             Status* s = _hosts[addr];
             verify( s );
 
@@ -283,6 +475,20 @@ namespace mongo {
             shardConnectionPool.release( addr , conn );
         }
 
+        /**
+         * Whether this thread may wait for a slot on 'addr'.  Slots are waited for in host
+         * order: a thread that holds a slot on 'addr' or on a host that sorts after it takes
+         * one without waiting.  Otherwise two threads, or a thread and an open cursor it will
+         * read from next, could each wait for a host the other holds.
+         */
+        bool _mayWaitFor( const string& addr ) const {
+            for ( HostMap::const_iterator i = _hosts.lower_bound( addr ); i != _hosts.end(); ++i ) {
+                if ( i->second->slots->inUse.load() > 0 )
+                    return false;
+            }
+            return true;
+        }
+
         void _check( const string& ns ) {
 
             {
@@ -293,6 +499,11 @@ namespace mongo {
                 _seenNS.insert( ns );
             }
 
+            // Checking the version on every shard up front would hold a connection to each of
+            // them on this thread, which is what shardConnectionsPerHost is there to prevent
+            if ( shardConnectionsPerHost > 0 )
+                return;
+
             checkVersions( ns );
         }
         
@@ -310,6 +521,7 @@ namespace mongo {
                 bb.append( "host", i->first );
                 bb.append( "created", i->second->created );
                 bb.appendBool( "avail", static_cast<bool>( i->second->avail ) );
+                bb.append( "inUse", i->second->slots->inUse.load() );
                 bb.done();
             }
             hostsArrB.done();
@@ -403,7 +615,7 @@ namespace mongo {
 
     void ShardConnection::_init() {
         verify( _addr.size() );
-        _conn = ClientConnections::threadInstance()->get( _addr , _ns );
+        _conn = ClientConnections::threadInstance()->get( _addr , _ns , &_slots );
         _finishedInit = false;
         usingAShardConnection( _addr );
     }
@@ -429,11 +641,19 @@ namespace mongo {
     void ShardConnection::done() {
         if ( _conn ) {
             ClientConnections::threadInstance()->done( _addr , _conn );
+            _releaseSlot();
             _conn = 0;
             _finishedInit = true;
         }
     }
 
+    void ShardConnection::_releaseSlot() {
+        if ( _slots ) {
+            sharedShardConnections.release( _slots.get() );
+            _slots.reset();
+        }
+    }
+
     void ShardConnection::kill() {
         if ( _conn ) {
             if( versionManager.isVersionableCB( _conn ) ) versionManager.resetShardVersionCB( _conn );
@@ -445,6 +665,7 @@ namespace mongo {
             else {
                 delete _conn;
             }
+            _releaseSlot();
 
             _conn = 0;
             _finishedInit = true;
@@ -548,4 +769,8 @@ namespace mongo {
     void ShardConnection::forgetNS( const string& ns ) {
         ClientConnections::threadInstance()->forgetNS( ns );
     }
+
+    void ShardConnection::appendSharedPoolInfo( BSONObjBuilder& b ) {
+        sharedShardConnections.appendInfo( b );
+    }
 }
@@ -155,70 +155,90 @@ namespace mongo {
             return;
         }
 
-        ParallelSortClusteredCursor * cursor = new ParallelSortClusteredCursor( qSpec, CommandInfo() );
-        verify( cursor );
-
-        // TODO:  Move out to Request itself, not strategy based
-        try {
-            cursor->init();
-
-            if ( qSpec.isExplain() ) {
-                BSONObjBuilder explain_builder;
-                cursor->explain( explain_builder );
-                explain_builder.appendNumber( "millis",
-                                              static_cast<long long>(queryTimer.millis()) );
-                BSONObj b = explain_builder.obj();
-
-                replyToQuery( 0 , r.p() , r.m() , b );
-                delete( cursor );
-                return;
-            }
-        }
-        catch(...) {
-            delete cursor;
-            throw;
-        }
+        // A query sorted on the shard key can open shards while its first batch is being built,
+        // after the shard versions were checked (see ParallelSortClusteredCursor).  Nothing has
+        // been sent back at that point, so a stale version is retried from the start.
+        int loops = 5;
+        while ( true ) {
+            ParallelSortClusteredCursor * cursor =
+                    new ParallelSortClusteredCursor( qSpec, CommandInfo() );
+            verify( cursor );
 
-        if( cursor->isSharded() ){
-            ShardedClientCursorPtr cc (new ShardedClientCursor( q , cursor ));
+            // TODO:  Move out to Request itself, not strategy based
+            try {
+                cursor->init();
+
+                if ( qSpec.isExplain() ) {
+                    BSONObjBuilder explain_builder;
+                    cursor->explain( explain_builder );
+                    explain_builder.appendNumber( "millis",
+                                                  static_cast<long long>(queryTimer.millis()) );
+                    BSONObj b = explain_builder.obj();
+
+                    replyToQuery( 0 , r.p() , r.m() , b );
+                    delete( cursor );
+                    return;
+                }
+            }
+            catch(...) {
+                delete cursor;
+                throw;
+            }
 
-            BufBuilder buffer( ShardedClientCursor::INIT_REPLY_BUFFER_SIZE );
-            int docCount = 0;
-            const int startFrom = cc->getTotalSent();
-            bool hasMore = cc->sendNextBatch( r, q.ntoreturn, buffer, docCount );
+            if( cursor->isSharded() ){
+                ShardedClientCursorPtr cc (new ShardedClientCursor( q , cursor ));
 
-            if ( hasMore ) {
-                LOG(5) << "storing cursor : " << cc->getId() << endl;
+                BufBuilder buffer( ShardedClientCursor::INIT_REPLY_BUFFER_SIZE );
+                int docCount = 0;
+                const int startFrom = cc->getTotalSent();
+                bool hasMore;
+                try {
+                    hasMore = cc->sendNextBatch( r, q.ntoreturn, buffer, docCount );
+                }
+                catch ( StaleConfigException& e ) {
+                    if ( loops <= 0 )
+                        throw;
 
-                int cursorLeftoverMillis = maxTimeMS.getValue() - queryTimer.millis();
-                if ( maxTimeMS.getValue() == 0 ) { // 0 represents "no limit".
-                    cursorLeftoverMillis = kMaxTimeCursorNoTimeLimit;
+                    loops--;
+                    log() << "retrying query: " << q.query << causedBy( e ) << endl;
+                    continue;
                 }
-                else if ( cursorLeftoverMillis <= 0 ) {
-                    cursorLeftoverMillis = kMaxTimeCursorTimeLimitExpired;
+
+                if ( hasMore ) {
+                    LOG(5) << "storing cursor : " << cc->getId() << endl;
+
+                    int cursorLeftoverMillis = maxTimeMS.getValue() - queryTimer.millis();
+                    if ( maxTimeMS.getValue() == 0 ) { // 0 represents "no limit".
+                        cursorLeftoverMillis = kMaxTimeCursorNoTimeLimit;
+                    }
+                    else if ( cursorLeftoverMillis <= 0 ) {
+                        cursorLeftoverMillis = kMaxTimeCursorTimeLimitExpired;
+                    }
+
+                    cursorCache.store( cc, cursorLeftoverMillis );
                 }
 
-                cursorCache.store( cc, cursorLeftoverMillis );
+                replyToQuery( 0, r.p(), r.m(), buffer.buf(), buffer.len(), docCount,
+                        startFrom, hasMore ? cc->getId() : 0 );
             }
+            else{
+                // Remote cursors are stored remotely, we shouldn't need this around.
+                // TODO: we should probably just make cursor an auto_ptr
+                scoped_ptr<ParallelSortClusteredCursor> cursorDeleter( cursor );
 
-            replyToQuery( 0, r.p(), r.m(), buffer.buf(), buffer.len(), docCount,
-                    startFrom, hasMore ? cc->getId() : 0 );
-        }
-        else{
-            // Remote cursors are stored remotely, we shouldn't need this around.
-            // TODO: we should probably just make cursor an auto_ptr
-            scoped_ptr<ParallelSortClusteredCursor> cursorDeleter( cursor );
+                // TODO:  Better merge this logic.  We potentially can now use the same cursor logic for everything.
+                ShardPtr primary = cursor->getPrimary();
+                verify( primary.get() );
+                DBClientCursorPtr shardCursor = cursor->getShardCursor( *primary );
 
-            // TODO:  Better merge this logic.  We potentially can now use the same cursor logic for everything.
-            ShardPtr primary = cursor->getPrimary();
-            verify( primary.get() );
-            DBClientCursorPtr shardCursor = cursor->getShardCursor( *primary );
+                // Implicitly stores the cursor in the cache
+                r.reply( *(shardCursor->getMessage()) , shardCursor->originalHost() );
 
-            // Implicitly stores the cursor in the cache
-            r.reply( *(shardCursor->getMessage()) , shardCursor->originalHost() );
+                // We don't want to kill the cursor remotely if there's still data left
+                shardCursor->decouple();
+            }
 
-            // We don't want to kill the cursor remotely if there's still data left
-            shardCursor->decouple();
+            return;
         }
     }
 
@@ -505,7 +525,18 @@ namespace mongo {
             BufBuilder buffer( ShardedClientCursor::INIT_REPLY_BUFFER_SIZE );
             int docCount = 0;
             const int startFrom = cursor->getTotalSent();
-            bool hasMore = cursor->sendNextBatch( r, ntoreturn, buffer, docCount );
+            bool hasMore;
+            try {
+                hasMore = cursor->sendNextBatch( r, ntoreturn, buffer, docCount );
+            }
+            catch ( StaleConfigException& e ) {
+                // A shard left for later by a query sorted on the shard key was stale when it was
+                // needed.  Results have already been returned, so the query can't be retried.
+                cursorCache.remove( id );
+                uasserted( 28638, str::stream() << "chunks of " << ns << " moved while cursor "
+                                                << id << " was open, the query must be rerun"
+                                                << causedBy( e ) );
+            }
 
             if ( hasMore ) {
                 // still more data
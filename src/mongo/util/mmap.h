@@ -46,6 +46,12 @@ namespace mongo {
         unsigned _len;
     };
 
+    /**
+     * Tells the OS that [p, p+len) of a mapped view will be read soon so it can start paging it in
+     * asynchronously.  Only a hint: it does not wait for the I/O and does nothing where unsupported.
+     */
+    void prefetchMappedRange(const void* p, size_t len);
+
     // lock order: lock dbMutex before this if you lock both
     class MONGO_CLIENT_API LockMongoFilesShared {
         friend class LockMongoFilesExclusive;
@@ -240,6 +246,13 @@ namespace mongo {
 
         /** close the current private view and open a new replacement */
         void* remapPrivateView(void *oldPrivateAddr);
+
+#if !defined(_WIN32)
+        /** replace [ofs, ofs+len) of the private view with a fresh mapping of the file.
+            ofs must be a multiple of the page size.
+        */
+        void remapPrivateViewRange(void *privateAddr, unsigned long long ofs, unsigned long long len);
+#endif
     };
 
     /** p is called from within a mutex that MongoFile uses.  so be careful not to deadlock. */
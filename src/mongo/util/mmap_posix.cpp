@@ -136,6 +136,18 @@ namespace mongo {
     }
 #endif
 
+#if defined(__sunos__)
+    void prefetchMappedRange(const void*, size_t) { }
+#else
+    void prefetchMappedRange(const void* p, size_t len) {
+        void* start = _pageAlign( const_cast<void*>( p ) );
+        len += reinterpret_cast<size_t>(p) - reinterpret_cast<size_t>(start);
+
+        // a failure only means the hint is lost, so it isn't worth reporting
+        madvise( start, len, MADV_WILLNEED );
+    }
+#endif
+
     void* MemoryMappedFile::map(const char *filename, unsigned long long &length, int options) {
         // length may be updated by callee.
         setFilename(filename);
@@ -237,6 +249,28 @@ namespace mongo {
         return x;
     }
 
+    void MemoryMappedFile::remapPrivateViewRange(void *privateAddr,
+                                                 unsigned long long ofs,
+                                                 unsigned long long len) {
+#if defined(__sunos__) // SERVER-8795
+        verify( Lock::isW() );
+        LockMongoFilesExclusive lockMongoFiles;
+#endif
+        verify( ofs % g_minOSPageSizeBytes == 0 );
+        verify( ofs + len <= this->len );
+
+        void *addr = static_cast<char*>(privateAddr) + ofs;
+        void * x = mmap( addr, len, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_NORESERVE|MAP_FIXED, fd, ofs );
+        if( x == MAP_FAILED ) {
+            int err = errno;
+            error()  << "13601 Couldn't remap private view: " << errnoWithDescription(err) << endl;
+            log() << "aborting" << endl;
+            printMemInfo();
+            abort();
+        }
+        verify( x == addr );
+    }
+
     void MemoryMappedFile::flush(bool sync) {
         if ( views.empty() || fd == 0 )
             return;
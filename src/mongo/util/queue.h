@@ -69,6 +69,29 @@ namespace mongo {
             _cvNoLongerEmpty.notify_one();
         }
 
+        /**
+         * Pushes every element of [begin, end) under a single acquisition of the lock, waiting
+         * until there is room for all of them.  A run larger than the maximum size waits for the
+         * queue to empty instead.
+         */
+        template <typename Iterator>
+        void pushAll(Iterator begin, Iterator end) {
+            size_t totalSize = 0;
+            for (Iterator i = begin; i != end; ++i) {
+                totalSize += _getSize(*i);
+            }
+
+            scoped_lock l( _lock );
+            while (_currentSize > 0 && _currentSize + totalSize >= _maxSize) {
+                _cvNoLongerFull.wait( l.boost() );
+            }
+            for (Iterator i = begin; i != end; ++i) {
+                _queue.push( *i );
+            }
+            _currentSize += totalSize;
+            _cvNoLongerEmpty.notify_all();
+        }
+
         bool empty() const {
             scoped_lock l( _lock );
             return _queue.empty();